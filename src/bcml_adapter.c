@@ -1,18 +1,83 @@
 
 // src/bcml_adapter.c - BCML Middleware 整合適配器
 #include "bcml_adapter.h"
+#include "dms_control_registry.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
 
+/*-----------------------------------------------------------*/
+/* 控制項目註冊 - 實際與模擬版本共用 */
+
+static int validate_wireless_item(const char *item, const char *value);
+static void register_wireless_controls(void);
+
+// wireless 群組的項目，合併為一次 bcml_execute_wifi_transaction
+// mode 在 wireless 文件中沒有對應欄位，套用必定失敗，不註冊
+static const dms_control_item_t g_wireless_controls[] = {
+    { "channel2g",   "wireless", validate_wireless_item, WIFI_CONTROL_CHANNEL_2G },
+    { "channel5g",   "wireless", validate_wireless_item, WIFI_CONTROL_CHANNEL_5G },
+    { "power2g",     "wireless", validate_wireless_item, WIFI_CONTROL_POWER_2G },
+    { "power5g",     "wireless", validate_wireless_item, WIFI_CONTROL_POWER_5G },
+    { "bandwidth2g", "wireless", validate_wireless_item, WIFI_CONTROL_BANDWIDTH_2G },
+    { "bandwidth5g", "wireless", validate_wireless_item, WIFI_CONTROL_BANDWIDTH_5G },
+};
+
+/**
+ * @brief 解析控制項目類型
+ */
+WiFiControlType_t bcml_parse_control_type(const char *item) {
+    if (!item) return WIFI_CONTROL_UNKNOWN;
+
+    for (size_t i = 0; i < sizeof(g_wireless_controls) / sizeof(g_wireless_controls[0]); i++) {
+        if (strcmp(item, g_wireless_controls[i].item) == 0) {
+            return (WiFiControlType_t)g_wireless_controls[i].id;
+        }
+    }
+
+    return WIFI_CONTROL_UNKNOWN;
+}
+
+/**
+ * @brief 註冊表使用的 wireless 項目驗證
+ */
+static int validate_wireless_item(const char *item, const char *value) {
+    return bcml_validate_control_params(bcml_parse_control_type(item), value);
+}
+
+/**
+ * @brief 將 wireless 項目與群組註冊到控制項目註冊表
+ */
+static void register_wireless_controls(void) {
+    // middleware 未保證執行緒安全，wireless 在調用者的執行緒中套用
+    if (dms_control_registry_register_group("wireless", bcml_execute_wifi_transaction, 0) != DMS_SUCCESS ||
+        dms_control_registry_register_items(g_wireless_controls,
+            sizeof(g_wireless_controls) / sizeof(g_wireless_controls[0])) != DMS_SUCCESS) {
+        printf("⚠️  [BCML] Failed to register wireless control items\n");
+        return;
+    }
+    printf("✅ [BCML] Registered %zu wireless control items\n",
+           sizeof(g_wireless_controls) / sizeof(g_wireless_controls[0]));
+}
+
 #ifdef BCML_MIDDLEWARE_ENABLED
 
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+// 讀取 wireless 設定的緩衝區：從 INITIAL 開始，填滿或讀取失敗時加倍直到 MAX
+#define BCML_WIRELESS_CONFIG_INITIAL_SIZE  4096
+#define BCML_WIRELESS_CONFIG_MAX_SIZE      65536
+
 /*-----------------------------------------------------------*/
 /* 內部函數宣告 */
 
-static cJSON* convert_dms_to_bcml_wireless(const char *item, const char *value);
+static cJSON* read_wireless_config(void);
+static cJSON* find_radio_object(cJSON *wireless_obj);
+static int stage_wireless_item(cJSON *radio_obj, const char *item, const char *value,
+                               bool *changed);
 static int validate_channel_value(int channel, bool is5g);
 static int validate_power_value(int power);
 static const char *control_type_to_string(WiFiControlType_t type);
@@ -37,6 +102,8 @@ int bcml_adapter_init(void) {
         printf("⚠️  [BCML] Warning: Wireless module test failed\n");
     }
 
+    register_wireless_controls();
+
     printf("✅ [BCML] Adapter initialization completed\n");
     return DMS_SUCCESS;
 }
@@ -46,32 +113,6 @@ int bcml_adapter_init(void) {
  */
 void bcml_adapter_cleanup(void) {
     printf("🧹 [BCML] Cleaning up BCML adapter\n");
-    // BCML 不需要特別的清理操作
-}
-
-/**
- * @brief 解析控制項目類型
- */
-WiFiControlType_t bcml_parse_control_type(const char *item) {
-    if (!item) return WIFI_CONTROL_UNKNOWN;
-
-    if (strcmp(item, "channel2g") == 0) {
-        return WIFI_CONTROL_CHANNEL_2G;
-    } else if (strcmp(item, "channel5g") == 0) {
-        return WIFI_CONTROL_CHANNEL_5G;
-    } else if (strcmp(item, "power2g") == 0) {
-        return WIFI_CONTROL_POWER_2G;
-    } else if (strcmp(item, "power5g") == 0) {
-        return WIFI_CONTROL_POWER_5G;
-    } else if (strcmp(item, "bandwidth2g") == 0) {
-        return WIFI_CONTROL_BANDWIDTH_2G;
-    } else if (strcmp(item, "bandwidth5g") == 0) {
-        return WIFI_CONTROL_BANDWIDTH_5G;
-    } else if (strcmp(item, "mode") == 0) {
-        return WIFI_CONTROL_MODE;
-    }
-
-    return WIFI_CONTROL_UNKNOWN;
 }
 
 /**
@@ -125,146 +166,236 @@ int bcml_validate_control_params(WiFiControlType_t type, const char *value) {
 
 
 /**
- * @brief 將 DMS 控制命令轉換為 BCML JSON 格式
+ * @brief 從 BCML 讀取目前的 wireless 設定
+ *
+ * 每次交易都重新讀取，本機網頁介面等其他程式的修改不會被覆蓋。
+ * 設定超過緩衝區時加倍重讀；接受 {"wireless":{...}} 或直接為 wireless 物件的格式
+ *
+ * @return 呼叫者擁有的 wireless 物件，失敗返回 NULL
  */
+static cJSON* read_wireless_config(void) {
+    char *buffer = NULL;
+    size_t size = BCML_WIRELESS_CONFIG_INITIAL_SIZE;
+    bool read_ok = false;
+
+    for (;;) {
+        char *grown = realloc(buffer, size);
+        if (!grown) {
+            printf("❌ [BCML] Out of memory reading wireless config (%zu bytes)\n", size);
+            free(buffer);
+            return NULL;
+        }
+        buffer = grown;
+        buffer[0] = '\0';
 
-static cJSON* convert_dms_to_bcml_wireless(const char *item, const char *value) {
-    cJSON *root_obj = cJSON_CreateObject();
-    cJSON *wireless_obj = cJSON_CreateObject();
-    cJSON *radio_array = cJSON_CreateArray();
-    cJSON *radio_obj = cJSON_CreateObject();
-    cJSON *ssid_array = cJSON_CreateArray();
-    cJSON *ssid_obj = cJSON_CreateObject();
-
-    if (!root_obj || !wireless_obj || !radio_array || !radio_obj || !ssid_array || !ssid_obj) {
-        if (root_obj) cJSON_Delete(root_obj);
-        if (wireless_obj) cJSON_Delete(wireless_obj);
-        if (radio_array) cJSON_Delete(radio_array);
-        if (radio_obj) cJSON_Delete(radio_obj);
-        if (ssid_array) cJSON_Delete(ssid_array);
-        if (ssid_obj) cJSON_Delete(ssid_obj);
-        return NULL;
-    }
+        read_ok = bcml_config_get("wireless", buffer, size);
+        buffer[size - 1] = '\0';
 
-    printf("🔄 [BCML] Converting: %s = %s\n", item, value);
-
-    // 添加所有必要的 radio 預設值
-    cJSON_AddNumberToObject(radio_obj, "power", 20);
-    cJSON_AddNumberToObject(radio_obj, "channel2g", 6);
-    cJSON_AddNumberToObject(radio_obj, "channel5g", 149);
-    cJSON_AddNumberToObject(radio_obj, "bandwidth2g", 20);
-    cJSON_AddNumberToObject(radio_obj, "bandwidth5g", 80);
-    cJSON_AddBoolToObject(radio_obj, "dfs", false);
-    cJSON_AddBoolToObject(radio_obj, "atf", false);
-    cJSON_AddBoolToObject(radio_obj, "bandsteering", false);
-    cJSON_AddBoolToObject(radio_obj, "zerowait", false);
-
-    // 添加所有必要的 ssid 預設值
-    cJSON_AddStringToObject(ssid_obj, "ssid", "default_ssid");
-    cJSON_AddBoolToObject(ssid_obj, "hide", false);
-    cJSON_AddNumberToObject(ssid_obj, "security", 2);  // WPA2
-    cJSON_AddStringToObject(ssid_obj, "password", "defaultpass");
-    cJSON_AddBoolToObject(ssid_obj, "password_onscreen", false);
-    cJSON_AddBoolToObject(ssid_obj, "enable2g", true);
-    cJSON_AddBoolToObject(ssid_obj, "enable5g", true);
-    cJSON_AddBoolToObject(ssid_obj, "isolation", false);
-    cJSON_AddBoolToObject(ssid_obj, "hopping", false);
-
-    // 根據實際控制項目覆蓋對應的值
-    WiFiControlType_t type = bcml_parse_control_type(item);
-    switch (type) {
-        case WIFI_CONTROL_CHANNEL_2G:
-            cJSON_SetNumberValue(cJSON_GetObjectItemCaseSensitive(radio_obj, "channel2g"), atoi(value));
-            break;
-
-        case WIFI_CONTROL_CHANNEL_5G:
-            cJSON_SetNumberValue(cJSON_GetObjectItemCaseSensitive(radio_obj, "channel5g"), atoi(value));
+        // 讀取成功且未填滿緩衝區才是完整設定
+        if (read_ok && strlen(buffer) < size - 1) {
             break;
-
-        case WIFI_CONTROL_POWER_2G:
-        case WIFI_CONTROL_POWER_5G:
-            cJSON_SetNumberValue(cJSON_GetObjectItemCaseSensitive(radio_obj, "power"), atoi(value));
+        }
+        if (size >= BCML_WIRELESS_CONFIG_MAX_SIZE) {
+            read_ok = false;
             break;
+        }
+        size *= 2;
+    }
 
-        case WIFI_CONTROL_BANDWIDTH_2G:
-            cJSON_SetNumberValue(cJSON_GetObjectItemCaseSensitive(radio_obj, "bandwidth2g"), atoi(value));
-            break;
+    if (!read_ok) {
+        printf("❌ [BCML] Failed to read live wireless config (up to %d bytes)\n",
+               BCML_WIRELESS_CONFIG_MAX_SIZE);
+        free(buffer);
+        return NULL;
+    }
 
-        case WIFI_CONTROL_BANDWIDTH_5G:
-            cJSON_SetNumberValue(cJSON_GetObjectItemCaseSensitive(radio_obj, "bandwidth5g"), atoi(value));
-            break;
+    cJSON *root_obj = cJSON_Parse(buffer);
+    free(buffer);
+    if (!root_obj) {
+        printf("❌ [BCML] Live wireless config is not valid JSON\n");
+        return NULL;
+    }
 
-        default:
-            printf("⚠️ [BCML] Unsupported item: %s, using default values\n", item);
-            break;
+    cJSON *wireless_obj = cJSON_GetObjectItemCaseSensitive(root_obj, "wireless");
+    if (cJSON_IsObject(wireless_obj)) {
+        cJSON_DetachItemViaPointer(root_obj, wireless_obj);
+        cJSON_Delete(root_obj);
+        root_obj = wireless_obj;
     }
 
-    // 組裝完整的 BCML 期望結構: {"wireless":{"radio":[...],"ssid":[...]}}
-    cJSON_AddItemToArray(radio_array, radio_obj);
-    cJSON_AddItemToArray(ssid_array, ssid_obj);
-    cJSON_AddItemToObject(wireless_obj, "radio", radio_array);
-    cJSON_AddItemToObject(wireless_obj, "ssid", ssid_array);
-    cJSON_AddItemToObject(root_obj, "wireless", wireless_obj);
+    if (!cJSON_IsObject(root_obj) || !find_radio_object(root_obj)) {
+        printf("❌ [BCML] Live wireless config has no radio section\n");
+        cJSON_Delete(root_obj);
+        return NULL;
+    }
 
     return root_obj;
 }
 
-
+/**
+ * @brief 取得 wireless 設定中的 radio 物件（radio 陣列的第一個元素）
+ */
+static cJSON* find_radio_object(cJSON *wireless_obj) {
+    cJSON *radio = cJSON_GetObjectItemCaseSensitive(wireless_obj, "radio");
+    if (cJSON_IsArray(radio)) {
+        radio = cJSON_GetArrayItem(radio, 0);
+    }
+    return cJSON_IsObject(radio) ? radio : NULL;
+}
 
 /**
- * @brief 執行 WiFi 控制
+ * @brief 驗證控制項目並修改 radio 物件中對應的值
+ * @param changed 值與目前設定不同時設為 true
+ * @return 成功返回 DMS_SUCCESS，項目不支援或值無效時返回錯誤碼且不修改文件
  */
-int bcml_execute_wifi_control(const char *item, const char *value) {
+static int stage_wireless_item(cJSON *radio_obj, const char *item, const char *value,
+                               bool *changed) {
     if (!item || !value) {
         return DMS_ERROR_INVALID_PARAMETER;
     }
 
-    printf("📡 [BCML] WiFi Control: %s = %s\n", item, value);
-
-    // 解析和驗證參數
     WiFiControlType_t type = bcml_parse_control_type(item);
     if (type == WIFI_CONTROL_UNKNOWN) {
         printf("❌ [BCML] Unknown control item: %s\n", item);
         return DMS_ERROR_UNSUPPORTED;
     }
 
-    // 驗證參數
     int validation_result = bcml_validate_control_params(type, value);
     if (validation_result != DMS_SUCCESS) {
         printf("❌ [BCML] Invalid parameter for %s: %s\n", item, value);
         return validation_result;
     }
 
-    // 轉換為 BCML 格式
-    cJSON *wireless_obj = convert_dms_to_bcml_wireless(item, value);
-    if (!wireless_obj) {
-        printf("❌ [BCML] Failed to convert control parameters\n");
-        return DMS_ERROR_JSON_PARSE;
+    const char *field = NULL;
+    switch (type) {
+        case WIFI_CONTROL_CHANNEL_2G:   field = "channel2g"; break;
+        case WIFI_CONTROL_CHANNEL_5G:   field = "channel5g"; break;
+        case WIFI_CONTROL_POWER_2G:     field = "power2g"; break;
+        case WIFI_CONTROL_POWER_5G:     field = "power5g"; break;
+        case WIFI_CONTROL_BANDWIDTH_2G: field = "bandwidth2g"; break;
+        case WIFI_CONTROL_BANDWIDTH_5G: field = "bandwidth5g"; break;
+        default:
+            // wireless 文件中沒有對應欄位（如 mode），不寫入
+            printf("⚠️ [BCML] Unsupported item for wireless document: %s\n", item);
+            return DMS_ERROR_UNSUPPORTED;
     }
 
-    // 輸出 JSON 用於除錯
-    char *json_string = cJSON_PrintUnformatted(wireless_obj);
-    if (json_string) {
-        printf("📋 [BCML] JSON payload: %s\n", json_string);
+    int new_value = atoi(value);
+    cJSON *current = cJSON_GetObjectItemCaseSensitive(radio_obj, field);
 
-        // 使用新的 bcml_config_set API
-        bool result = bcml_config_set("wireless", json_string);
+    if (cJSON_IsNumber(current)) {
+        if (current->valueint == new_value) {
+            printf("⏭️ [BCML] %s already %d, no change\n", item, new_value);
+            return DMS_SUCCESS;
+        }
+        cJSON_SetNumberValue(current, new_value);
+    } else {
+        // 欄位不存在或型別不符時以數字取代
+        cJSON_DeleteItemFromObjectCaseSensitive(radio_obj, field);
+        if (!cJSON_AddNumberToObject(radio_obj, field, new_value)) {
+            return DMS_ERROR_MEMORY_ALLOCATION;
+        }
+    }
 
-        free(json_string);
+    printf("🔄 [BCML] Staging: %s = %s\n", item, value);
+    *changed = true;
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 執行 WiFi 控制
+ */
+int bcml_execute_wifi_control(const char *item, const char *value) {
+    if (!item || !value) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    printf("📡 [BCML] WiFi Control: %s = %s\n", item, value);
+
+    int item_result;
+    return bcml_execute_wifi_transaction(&item, &value, &item_result, 1);
+}
+
+/**
+ * @brief 以單一交易執行多個 WiFi 控制項目
+ */
+int bcml_execute_wifi_transaction(const char *const *items, const char *const *values,
+                                  int *results, size_t count) {
+    if (!items || !values || !results || count == 0) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    printf("📡 [BCML] WiFi transaction: %zu item(s)\n", count);
+
+    // 以目前的實際設定為基礎修改，未控制的欄位（SSID、密碼等）保持不變
+    cJSON *wireless_obj = read_wireless_config();
+    cJSON *radio_obj = wireless_obj ? find_radio_object(wireless_obj) : NULL;
+
+    if (!radio_obj) {
+        printf("❌ [BCML] Cannot build wireless payload without live config\n");
         cJSON_Delete(wireless_obj);
+        for (size_t i = 0; i < count; i++) {
+            results[i] = DMS_ERROR_MIDDLEWARE_FAILED;
+        }
+        return DMS_ERROR_MIDDLEWARE_FAILED;
+    }
 
-        if (result) {
-            printf("✅ [BCML] WiFi control successful: %s = %s\n", item, value);
-            return DMS_SUCCESS;
+    // 逐項驗證並合併到同一份文件
+    size_t staged = 0;
+    bool changed = false;
+    for (size_t i = 0; i < count; i++) {
+        results[i] = stage_wireless_item(radio_obj, items[i], values[i], &changed);
+        if (results[i] == DMS_SUCCESS) {
+            staged++;
+        }
+    }
+
+    if (staged > 0 && !changed) {
+        printf("⏭️ [BCML] Requested values already active, skipping wireless reload\n");
+    } else if (staged > 0) {
+        cJSON *root_obj = cJSON_CreateObject();
+        char *json_string = NULL;
+        int set_result = DMS_ERROR_INVALID_JSON;
+
+        // 組裝 BCML 期望結構: {"wireless":{...}}
+        if (root_obj) {
+            cJSON_AddItemToObject(root_obj, "wireless", wireless_obj);
+            wireless_obj = NULL;
+            json_string = cJSON_PrintUnformatted(root_obj);
+        }
+
+        if (json_string) {
+            printf("📋 [BCML] JSON payload: %s\n", json_string);
+
+            // 整個交易只呼叫一次 bcml_config_set
+            set_result = bcml_config_set("wireless", json_string) ?
+                         DMS_SUCCESS : DMS_ERROR_MIDDLEWARE_FAILED;
+            free(json_string);
         } else {
-            printf("❌ [BCML] WiFi control failed: %s = %s\n", item, value);
-            return DMS_ERROR_MIDDLEWARE_FAILED;
+            printf("❌ [BCML] Failed to generate JSON string\n");
+        }
+        cJSON_Delete(root_obj);
+
+        if (set_result == DMS_SUCCESS) {
+            printf("✅ [BCML] WiFi transaction applied: %zu/%zu item(s)\n", staged, count);
+        } else {
+            printf("❌ [BCML] WiFi transaction failed (error: %d)\n", set_result);
+            for (size_t i = 0; i < count; i++) {
+                if (results[i] == DMS_SUCCESS) {
+                    results[i] = set_result;
+                }
+            }
         }
     }
 
     cJSON_Delete(wireless_obj);
-    printf("❌ [BCML] Failed to generate JSON string\n");
-    return DMS_ERROR_JSON_PARSE;
+
+    for (size_t i = 0; i < count; i++) {
+        if (results[i] != DMS_SUCCESS) {
+            return results[i];
+        }
+    }
+    return DMS_SUCCESS;
 }
 
 /**
@@ -394,11 +525,14 @@ static const char *control_type_to_string(WiFiControlType_t type) {
 #else
 // === 模擬版本實作 (當 BCML_MIDDLEWARE_ENABLED 未定義時) ===
 
+static const char *control_type_to_string(WiFiControlType_t type);
+
 /**
  * @brief 初始化 BCML 適配器 (模擬版本)
  */
 int bcml_adapter_init(void) {
     printf("🎭 [SIMULATE] BCML adapter initialization (simulation mode)\n");
+    register_wireless_controls();
     return DMS_SUCCESS;
 }
 
@@ -448,6 +582,43 @@ int bcml_execute_wifi_control(const char *item, const char *value) {
     return DMS_SUCCESS;
 }
 
+/**
+ * @brief 以單一交易執行多個 WiFi 控制項目 (模擬版本)
+ */
+int bcml_execute_wifi_transaction(const char *const *items, const char *const *values,
+                                  int *results, size_t count) {
+    if (!items || !values || !results || count == 0) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    printf("🎭 [SIMULATE] WiFi transaction: %zu item(s)\n", count);
+
+    size_t staged = 0;
+    for (size_t i = 0; i < count; i++) {
+        WiFiControlType_t type = bcml_parse_control_type(items[i]);
+        results[i] = (type == WIFI_CONTROL_UNKNOWN || !values[i]) ?
+                     DMS_ERROR_UNSUPPORTED : bcml_validate_control_params(type, values[i]);
+        if (results[i] == DMS_SUCCESS) {
+            printf("   🔄 Staging %s = %s\n", items[i], values[i]);
+            staged++;
+        }
+    }
+
+    if (staged > 0) {
+        // 合併後只重啟一次無線介面
+        printf("   🔄 Simulating single wireless reload for %zu item(s)...\n", staged);
+        usleep(800000); // 0.8秒模擬延遲
+        printf("   ✅ WiFi transaction simulation completed\n");
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (results[i] != DMS_SUCCESS) {
+            return results[i];
+        }
+    }
+    return DMS_SUCCESS;
+}
+
 /**
  * @brief 獲取 WiFi 狀態 (模擬版本)
  */
@@ -501,31 +672,6 @@ int bcml_get_wifi_status_struct(WiFiStatus_t *status) {
     return DMS_SUCCESS;
 }
 
-/**
- * @brief 解析控制項目類型 (模擬版本)
- */
-WiFiControlType_t bcml_parse_control_type(const char *item) {
-    if (!item) return WIFI_CONTROL_UNKNOWN;
-
-    if (strcmp(item, "channel2g") == 0) {
-        return WIFI_CONTROL_CHANNEL_2G;
-    } else if (strcmp(item, "channel5g") == 0) {
-        return WIFI_CONTROL_CHANNEL_5G;
-    } else if (strcmp(item, "power2g") == 0) {
-        return WIFI_CONTROL_POWER_2G;
-    } else if (strcmp(item, "power5g") == 0) {
-        return WIFI_CONTROL_POWER_5G;
-    } else if (strcmp(item, "bandwidth2g") == 0) {
-        return WIFI_CONTROL_BANDWIDTH_2G;
-    } else if (strcmp(item, "bandwidth5g") == 0) {
-        return WIFI_CONTROL_BANDWIDTH_5G;
-    } else if (strcmp(item, "mode") == 0) {
-        return WIFI_CONTROL_MODE;
-    }
-
-    return WIFI_CONTROL_UNKNOWN;
-}
-
 /**
  * @brief 驗證控制參數 (模擬版本)
  */
@@ -4,22 +4,15 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
+
+#include "demo_config.h"   // 錯誤碼使用 dms_result_t 列舉
 
 #ifdef BCML_MIDDLEWARE_ENABLED
 #include "bcml_config.h"  // 使用新的 API 介面
 #include <cjson/cJSON.h>
 #endif
 
-/*-----------------------------------------------------------*/
-/* 錯誤碼定義 */
-
-#define DMS_SUCCESS                    0
-#define DMS_ERROR_INVALID_PARAMETER   -1
-#define DMS_ERROR_MIDDLEWARE_FAILED   -2
-#define DMS_ERROR_UNSUPPORTED         -3
-#define DMS_ERROR_JSON_PARSE          -4
-#define DMS_ERROR_MEMORY_ALLOCATION   -5
-
 /*-----------------------------------------------------------*/
 /* WiFi 控制項目枚舉 */
 
@@ -81,6 +74,22 @@ void bcml_adapter_cleanup(void);
  */
 int bcml_execute_wifi_control(const char *item, const char *value);
 
+/**
+ * @brief 以單一交易執行多個 WiFi 控制項目
+ *
+ * 以交易開始時讀取的實際 wireless 設定為基礎，所有通過驗證的項目合併修改後只呼叫一次
+ * bcml_config_set，無線介面只重啟一次；所有值都已生效時完全不呼叫。
+ * 未通過驗證的項目不寫入，不影響其他項目。
+ *
+ * @param items 控制項目名稱陣列
+ * @param values 控制值陣列
+ * @param results 輸出每個項目的結果（DMS_SUCCESS 或錯誤碼）
+ * @param count 項目數量
+ * @return 全部成功返回 DMS_SUCCESS，否則返回第一個失敗項目的錯誤碼
+ */
+int bcml_execute_wifi_transaction(const char *const *items, const char *const *values,
+                                  int *results, size_t count);
+
 /**
  * @brief 獲取 WiFi 狀態 (JSON 格式)
  * @param status_json 輸出 JSON 字串緩衝區
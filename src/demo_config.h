@@ -44,6 +44,8 @@
 
 /* MQTT 配置 */
 #define MQTT_KEEP_ALIVE_INTERVAL_SECONDS    ( 60 )
+#define MQTT_DEAD_LINK_TIMEOUT_SECONDS      ( 30 )    /* 半開連線判定上限 */
+#define MQTT_PING_MIN_TIMEOUT_MS            ( 5000 )  /* RTT 推算的 PINGRESP 等待下限，避免短暫延遲被誤判為斷線 */
 #define CONNACK_RECV_TIMEOUT_MS            ( 1000 )
 #define MQTT_PROCESS_LOOP_TIMEOUT_MS       ( 1000 )
 
@@ -53,6 +55,9 @@
 /* 傳輸逾時 */
 #define TRANSPORT_SEND_RECV_TIMEOUT_MS     ( 5000 )
 
+/* TLS session 快取檔案 - 放在 tmpfs，重啟程序可恢復且不磨損 flash */
+#define TLS_SESSION_CACHE_FILE             "/tmp/dms-client-tls-session.der"
+
 /* AWS IoT Device Shadow 主題配置 */
 #define SHADOW_UPDATE_TOPIC                "$aws/things/" CLIENT_IDENTIFIER "/shadow/update"
 #define SHADOW_UPDATE_ACCEPTED_TOPIC       "$aws/things/" CLIENT_IDENTIFIER "/shadow/update/accepted"
@@ -72,10 +77,11 @@
 #define RETRY_BACKOFF_MAX_SECONDS         ( 5400 )
 #define CONNECTION_RETRY_DELAY_MS         ( 1000 )
 
-
-/* 新增：基於 MAC 地址的隨機退避配置 */
-#define MAC_SEED_MULTIPLIER                ( 3 )    /* MAC seed 權重 */
-#define MAC_SEED_MAX_OFFSET                ( 1200 )   /* 最大隨機偏移（秒）*/
+/* 上行網路恢復（rtnetlink）時的重連 */
+#define DMS_RECONNECT_UPLINK_JITTER_MS    ( 3000U )  /* 恢復後立即重連前的隨機延遲上限 */
+#define DMS_UPLINK_MAX_LINKS              ( 32U )    /* 追蹤的網路介面上限 */
+#define DMS_UPLINK_MAX_DEFAULT_ROUTES     ( 8U )     /* 追蹤的預設路由上限 */
+#define DMS_UPLINK_MAX_ADDRESSES          ( 32U )    /* 追蹤的全域位址上限 */
 
 
 /* AWS IoT SDK 版本 */
@@ -96,6 +102,7 @@
 #define DMS_HTTP_TIMEOUT_MS               5000
 #define DMS_HTTP_MAX_RETRIES              3
 #define DMS_HTTP_USER_AGENT               "DMS-Client/1.1.0"
+#define DMS_HTTP_CA_BUNDLE_PATH           "/etc/ssl/certs/ca-certificates.crt"
 
 /* 設備資訊 */
 #define DEVICE_TYPE                       "OpenWrt-DMS-Device"
@@ -144,19 +151,82 @@
 #define JSON_QUERY_CONTROL_CONFIG         "state.control-config-change"
 #define JSON_QUERY_UPLOAD_LOGS           "state.upload_logs"
 #define JSON_QUERY_FW_UPGRADE            "state.fw_upgrade"
+#define JSON_QUERY_SHADOW_VERSION         "version"
+
+/* Shadow Delta 版本去重 - 每個命令鍵記錄最後處理的 Shadow version */
+#define DMS_COMMAND_VERSION_FILE          "/etc/dms-client/command_versions"
+#define DMS_COMMAND_VERSION_MAX_KEYS      ( 8 )
+#define DMS_COMMAND_VERSION_RESET_GAP     ( 100U )   /* 倒退超過此值視為 Shadow 重建，清空版本表 */
+
+/* 命令排程 - 優先權數字越小越先執行；並行上限為同類型同時執行的數量 */
+#define DMS_COMMAND_QUEUE_SIZE                    ( 8 )
+#define DMS_COMMAND_PRIORITY_CONTROL_CONFIG       ( 0 )
+#define DMS_COMMAND_PRIORITY_UPLOAD_LOGS          ( 1 )
+#define DMS_COMMAND_PRIORITY_FW_UPGRADE           ( 2 )
+#define DMS_COMMAND_MAX_INFLIGHT_CONTROL_CONFIG   ( 1 )
+#define DMS_COMMAND_MAX_INFLIGHT_UPLOAD_LOGS      ( 1 )
+#define DMS_COMMAND_MAX_INFLIGHT_FW_UPGRADE       ( 1 )
+
+/* 一次 control-config-change 的控制配置上限 - delta 內嵌超過上限時改經 HTTP 取得 */
+#define DMS_COMMAND_CONTROL_CONFIG_MAX            ( 10 )
+
+/* 命令 debounce - 連續的 control-config-change 合併為一次取得與套用；持續操作時最長延後 MAX */
+#define DMS_COMMAND_DEBOUNCE_CONTROL_CONFIG_MS    ( 1500U )
+#define DMS_COMMAND_DEBOUNCE_MAX_MS               ( 5000U )
+
+/* 命令回報重試 - 重設 desired 或回報結果失敗（或 Shadow 介面尚未註冊）時，命令保留為 APPLIED 稍後重試 */
+#define DMS_COMMAND_REPORT_RETRY_MS               ( 5000U )
+
+/* 命令日誌 - 崩潰或重開機後接續未完成的命令；記錄數超過門檻時壓縮 */
+#define DMS_COMMAND_JOURNAL_FILE                  "/etc/dms-client/command_journal"
+#define DMS_COMMAND_JOURNAL_COMPACT_RECORDS       ( 64 )
+
+/* JSON 索引 token 容量 - delta 除命令鍵外可內嵌控制配置；完整 Shadow 文件包含 reported 各欄位 */
+#define DMS_COMMAND_DELTA_MAX_TOKENS      ( 256 )
+#define SHADOW_DOCUMENT_MAX_TOKENS        ( 512 )
 
 
 /* Shadow 綁定資訊查詢路徑 */
 #define JSON_QUERY_REPORTED_INFO          "state.reported.info"
-#define JSON_QUERY_COMPANY_NAME           "state.reported.info.company_name"
-#define JSON_QUERY_ADDED_BY               "state.reported.info.added_by"
-#define JSON_QUERY_DEVICE_NAME            "state.reported.info.device_name"
-#define JSON_QUERY_COMPANY_ID             "state.reported.info.company_id"
 
 /* Shadow Get 相關 */
 #define SHADOW_GET_TIMEOUT_MS             ( 5000 )
 #define SHADOW_GET_MAX_RETRIES            ( 3 )
 
+/* Shadow 本地快照 - 保存最後一次 get/accepted 的完整文件 */
+#define SHADOW_SNAPSHOT_FILE              "/etc/dms-client/shadow_snapshot.json"
+#define SHADOW_SNAPSHOT_MAX_SIZE          ( 8192 )
+
+/* 系統統計取樣 - 流量統計的網路介面；空字串表示自動使用預設路由所在的 WAN 介面
+ * （不逐一加總所有介面，橋接介面 br-lan 與其成員介面會重複計算同一份流量） */
+#define SYSSTAT_NET_INTERFACE             ""
+
+/* Shadow 合併寫入與 AWS 更新速率限制 */
+#define SHADOW_COALESCE_WINDOW_MS         ( 200 )
+#define SHADOW_UPDATE_MIN_INTERVAL_MS     ( 100 )     /* 每個 thing 每秒最多 10 次更新 */
+#define SHADOW_THROTTLE_BACKOFF_BASE_MS   ( 1000 )
+#define SHADOW_THROTTLE_BACKOFF_MAX_MS    ( 32000 )
+#define SHADOW_UPDATE_ACK_TIMEOUT_MS      ( 10000 )   /* 一次只有一份更新等待 accepted，逾時重新發布 */
+
+/* 遙測取樣與上傳 - 高頻取樣，依區間降採樣為 min/avg/max 後批次發布到 PUBLISH_TOPIC */
+#define TELEMETRY_SAMPLE_INTERVAL_MS      ( 1000 )
+#define TELEMETRY_BUCKET_SECONDS          ( 60 )
+#define TELEMETRY_PUBLISH_INTERVAL_SECONDS ( 300 )
+#define TELEMETRY_MAX_BUCKETS_PER_PUBLISH ( 15 )
+#define TELEMETRY_RING_CAPACITY           ( 120 )     /* 斷線時最多保留的區間數（預設 2 小時） */
+
+/* MQTT 回報通道 - 進度與裝置資訊以 QoS1 批次發布到保留主題，省去個別的 HTTPS 連線；
+ * 伺服器支援後再逐一開啟端點，未開啟或無法發布時使用 HTTP */
+#define DMS_REPORT_TOPIC                  "dms/" CLIENT_IDENTIFIER "/report"
+#define DMS_REPORT_MQTT_CONTROL_PROGRESS  false
+#define DMS_REPORT_MQTT_FW_PROGRESS       false
+#define DMS_REPORT_MQTT_DEVICE_INFO       false
+#define DMS_REPORT_BATCH_WINDOW_MS        ( 250 )
+#define DMS_REPORT_MAX_HOLD_MS            ( 10000 )
+#define DMS_REPORT_MAX_RECORDS            ( 16 )
+#define DMS_REPORT_BATCH_BYTES            ( 2048 )    /* 一則訊息中所有回報內容的總長度上限 */
+#define DMS_REPORT_ACK_TIMEOUT_MS         ( 10000 )   /* 等待 PUBACK 的上限，逾時重新發布 */
+
 /* 字串安全操作 */
 #define SAFE_STRNCPY(dest, src, size)     do { \
     strncpy(dest, src, size - 1); \
@@ -168,51 +238,6 @@
 #define MINUTES_TO_MS(m)                  ((m) * 60 * 1000)
 #define HOURS_TO_MS(h)                    ((h) * 60 * 60 * 1000)
 
-/* Shadow JSON 模板 */
-#define SHADOW_REPORTED_JSON_TEMPLATE \
-    "{"                               \
-    "\"state\":{"                     \
-    "\"reported\":{"                  \
-    "\"connected\":%s,"               \
-    "\"status\":\"%s\","              \
-    "\"uptime\":%u,"                  \
-    "\"timestamp\":%u,"               \
-    "\"firmware\":\"%s\","            \
-    "\"device_type\":\"%s\","         \
-    "\"cpu_usage\":%.2f,"             \
-    "\"memory_usage\":%.2f,"          \
-    "\"network_sent\":%lu,"           \
-    "\"network_received\":%lu"        \
-    "}}}"
-
-/* Shadow 命令重設 JSON 模板 */
-#define SHADOW_RESET_COMMAND_JSON_TEMPLATE \
-    "{"                                    \
-    "\"state\":{"                          \
-    "\"desired\":{"                        \
-    "\"%s\":null"                          \
-    "},"                                   \
-    "\"reported\":{"                       \
-    "\"%s\":0"                             \
-    "}}}"
-
-/* Shadow 命令結果回報 JSON 模板 */
-#define SHADOW_COMMAND_RESULT_JSON_TEMPLATE \
-    "{"                                     \
-    "\"state\":{"                           \
-    "\"reported\":{"                        \
-    "\"%s_result\":%d,"                     \
-    "\"%s_timestamp\":%u"                   \
-    "}}}"
-
-/* 指數退避計算 */
-#define CALCULATE_BACKOFF_DELAY(retry_count) \
-    MIN(RETRY_BACKOFF_BASE_SECONDS * (1 << (retry_count)), RETRY_BACKOFF_MAX_SECONDS)
-
-/* 新的基於 MAC seed 的退避計算宏 */
-#define CALCULATE_BACKOFF_DELAY_WITH_MAC_SEED(retry_count, reconnect_state) \
-    calculateBackoffDelayWithSeed(retry_count, (reconnect_state)->macAddressSeed)
-
 
 /* 設備資訊相關宏定義 */
 #define MAX_DEVICE_MODEL_LENGTH           64
@@ -279,6 +304,10 @@ typedef enum {
     DMS_ERROR_REGISTRATION_FAILED,         // 設備註冊失敗
     DMS_ERROR_PINCODE_FAILED,              // PIN 碼獲取失敗
     DMS_ERROR_BDID_CALCULATION,            // BDID 計算失敗
+    DMS_ERROR_BUFFER_OVERFLOW,             // 輸出超過緩衝區大小
+    DMS_ERROR_INVALID_JSON,                // JSON 格式錯誤
+    DMS_ERROR_UNSUPPORTED,                 // 不支援的控制項目
+    DMS_ERROR_MIDDLEWARE_FAILED,           // BCML Middleware 操作失敗
     DMS_ERROR_UNKNOWN
 } DMSErrorCode_t;
 
@@ -326,6 +355,7 @@ typedef struct {
     int value;
     char key[64];
     uint32_t timestamp;
+    uint32_t version;       /* Shadow 文件版本，0 表示 delta 未帶 version */
     bool processed;
 } DMSCommand_t;
 
@@ -371,17 +401,6 @@ typedef struct {
     uint64_t networkBytesReceived;
 } ShadowReportedState_t;
 
-/* 重連狀態結構 */
-typedef struct {
-    ConnectionState_t state;
-    uint32_t retryCount;
-    uint32_t nextRetryDelaySeconds;
-    uint32_t lastConnectTime;
-    uint32_t totalReconnects;
-    char macAddressSeed[18];        /* 新增：MAC 地址作為 seed */
-    uint32_t seedValue;             /* 新增：計算出的數字 seed */
-} ReconnectState_t;
-
 /* 設備資訊結構 */
 typedef struct {
     char deviceId[64];
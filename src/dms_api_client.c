@@ -17,7 +17,11 @@
 #include <openssl/err.h>
 
 #include "dms_api_client.h"
-#include "core_json.h"
+#include "dms_credentials.h"
+#include "dms_json_writer.h"
+#include "dms_json_index.h"
+#include "dms_json_decode.h"
+#include "dms_report.h"
 
 
 
@@ -29,46 +33,56 @@ static char g_base_url[DMS_API_BASE_URL_SIZE] = DMS_API_BASE_URL_TEST;
 
 
 /* 前置聲明和輔助函數 */
-static DMSAPIResult_t parse_control_config_response(char* jsonData, 
+static DMSAPIResult_t parse_control_config_response(const char* jsonData,
                                                    size_t jsonSize,
                                                    DMSControlConfig_t* configs,
                                                    int maxConfigs,
                                                    int* configCount);
 
-static bool parse_single_config_object(char* objectData, size_t objectLength, 
+static bool parse_single_config_object(const dms_json_index_t* index, int32_t object,
                                       DMSControlConfig_t* config);
+static DMSAPIResult_t index_api_response(const char* data, size_t size, dms_json_index_t* index);
+static DMSAPIResult_t post_report(dms_report_endpoint_t endpoint, const char* payload);
+static dms_result_t report_http_fallback(dms_report_endpoint_t endpoint, const char* body);
+static CURLcode ssl_ctx_callback(CURL* curl, void* sslctx, void* userptr);
 
 #ifndef MIN
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif
 
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 處理 JSON 轉義字符 \/ -> /
- */
-static void unescapeJsonString(char* str)
-{
-    if (str == NULL) {
-        return;
-    }
-    
-    char* src = str;
-    char* dst = str;
-    
-    while (*src) {
-        if (*src == '\\' && *(src + 1) == '/') {
-            *dst = '/';
-            src += 2;  // 跳過 \/
-        } else {
-            *dst = *src;
-            src++;
-        }
-        dst++;
-    }
-    *dst = '\0';
-}
+/* 回報端點的 HTTP 路徑 - MQTT 回報通道無法使用時的回退 */
+static const char* const g_report_paths[DMS_REPORT_ENDPOINT_COUNT] = {
+    [DMS_REPORT_CONTROL_PROGRESS] = DMS_API_CONTROL_PROGRESS,
+    [DMS_REPORT_FW_PROGRESS]      = DMS_API_FW_PROGRESS,
+    [DMS_REPORT_DEVICE_INFO]      = DMS_API_DEVICE_INFO_UPDATE
+};
+
+/* 回應欄位描述表 */
+static const dms_json_field_t g_control_config_fields[] = {
+    DMS_JSON_FIELD(DMSControlConfig_t, statusProgressId, "status_progress_id", DMS_JSON_FIELD_INT32, 0),
+    DMS_JSON_FIELD(DMSControlConfig_t, item, "item", DMS_JSON_FIELD_STRING,
+                   DMS_JSON_FIELD_REQUIRED | DMS_JSON_FIELD_TRUNCATE),
+    DMS_JSON_FIELD(DMSControlConfig_t, type, "type", DMS_JSON_FIELD_INT32, 0),
+    DMS_JSON_FIELD(DMSControlConfig_t, value, "value", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_TRUNCATE),
+};
+
+static const dms_json_field_t g_pincode_fields[] = {
+    DMS_JSON_FIELD(DMSPincodeResponse_t, pincode, "pincode", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_REQUIRED),
+    DMS_JSON_FIELD(DMSPincodeResponse_t, expiredAt, "expired_at", DMS_JSON_FIELD_UINT32, 0),
+};
+
+static const dms_json_field_t g_country_code_fields[] = {
+    DMS_JSON_FIELD(DMSCountryCodeResponse_t, countryCode, "country_code", DMS_JSON_FIELD_STRING,
+                   DMS_JSON_FIELD_REQUIRED),
+};
+
+static const dms_json_field_t g_server_config_fields[] = {
+    DMS_JSON_FIELD(DMSServerConfig_t, apiUrl, "api", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_TRUNCATE),
+    DMS_JSON_FIELD(DMSServerConfig_t, mqttUrl, "mqtt", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_TRUNCATE),
+    DMS_JSON_FIELD(DMSServerConfig_t, mqttIotUrl, "mqtt_iot", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_TRUNCATE),
+    DMS_JSON_FIELD(DMSServerConfig_t, mdaJsonUrl, "mda_json", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_TRUNCATE),
+    DMS_JSON_FIELD(DMSServerConfig_t, certPath, "cert_path", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_TRUNCATE),
+};
 
 
 /*-----------------------------------------------------------*/
@@ -141,6 +155,28 @@ static char* base64_encode(const unsigned char* input, int length)
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief libcurl SSL_CTX 回調 - 套用共用的 HTTP 信任庫
+ *
+ * 信任庫由憑證管理模組載入一次，每個 curl handle 只增加參考計數
+ */
+static CURLcode ssl_ctx_callback(CURL* curl, void* sslctx, void* userptr)
+{
+    (void)curl;
+    (void)userptr;
+
+    X509_STORE* store = dms_credentials_get_http_trust_store();
+    if (store == NULL) {
+        return CURLE_SSL_CACERT_BADFILE;
+    }
+
+    X509_STORE_up_ref(store);
+    SSL_CTX_set_cert_store((SSL_CTX*)sslctx, store);
+    return CURLE_OK;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief 初始化 DMS API 客戶端
  */
@@ -308,6 +344,13 @@ DMSAPIResult_t dms_http_request(DMSHTTPMethod_t method,
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
 
+    /* 使用共用信任庫，不讓 libcurl 為每個 handle 重新載入 CA bundle */
+    if (dms_credentials_get_http_trust_store() != NULL &&
+        curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, ssl_ctx_callback) == CURLE_OK) {
+        curl_easy_setopt(curl, CURLOPT_CAINFO, NULL);
+        curl_easy_setopt(curl, CURLOPT_CAPATH, NULL);
+    }
+
     if (method == DMS_HTTP_POST) {
         curl_easy_setopt(curl, CURLOPT_POST, 1L);
         if (payload != NULL) {
@@ -512,20 +555,18 @@ DMSAPIResult_t dms_api_control_config_list(const char* uniqueId,
 
 /**
  * @brief 解析控制配置的JSON回應 (完整實現版本)
- * 使用現有的core_json庫解析control-config-list API回應
+ * 建立一次索引後走訪 control-configs 陣列，每個元素依描述表解碼
  */
-static DMSAPIResult_t parse_control_config_response(char* jsonData, 
+static DMSAPIResult_t parse_control_config_response(const char* jsonData,
                                                    size_t jsonSize,
                                                    DMSControlConfig_t* configs,
                                                    int maxConfigs,
                                                    int* configCount)
 {
-    JSONStatus_t jsonResult;
-    char* resultCodeValue = NULL;
+    dms_json_index_t index;
+    const char* resultCodeValue = NULL;
     size_t resultCodeLength = 0;
-    char* configsArrayValue = NULL;
-    size_t configsArrayLength = 0;
-    
+
     if (jsonData == NULL || configs == NULL || configCount == NULL || maxConfigs <= 0) {
         return DMS_API_ERROR_INVALID_PARAM;
     }
@@ -533,25 +574,22 @@ static DMSAPIResult_t parse_control_config_response(char* jsonData,
     *configCount = 0;
     printf("🔍 [DMS-API] Parsing control config JSON response...\n");
     
-    /* ✅ 驗證JSON格式 */
-    jsonResult = JSON_Validate(jsonData, jsonSize);
-    if (jsonResult != JSONSuccess) {
+    /* ✅ 驗證JSON格式並建立索引 */
+    if (index_api_response(jsonData, jsonSize, &index) != DMS_API_SUCCESS) {
         printf("❌ [DMS-API] Invalid JSON format in response\n");
         return DMS_API_ERROR_JSON_PARSE;
     }
     
     /* ✅ 檢查result_code */
-    jsonResult = JSON_Search(jsonData, jsonSize,
-                           "result_code", strlen("result_code"),
-                           &resultCodeValue, &resultCodeLength);
-    
-    if (jsonResult != JSONSuccess || resultCodeValue == NULL) {
+    if (!dms_json_index_value(&index,
+                              dms_json_index_child(&index, DMS_JSON_INDEX_ROOT, "result_code", 11),
+                              &resultCodeValue, &resultCodeLength)) {
         printf("❌ [DMS-API] No result_code found in JSON\n");
         return DMS_API_ERROR_JSON_PARSE;
     }
     
     /* 檢查result_code是否為200 (完全符合規格) */
-    if (strncmp(resultCodeValue, "200", 3) != 0) {
+    if (resultCodeLength != 3 || strncmp(resultCodeValue, "200", 3) != 0) {
         printf("❌ [DMS-API] result_code is not 200, received: %.*s\n", 
                (int)resultCodeLength, resultCodeValue);
         return DMS_API_ERROR_SERVER;
@@ -560,52 +598,34 @@ static DMSAPIResult_t parse_control_config_response(char* jsonData,
     printf("✅ [DMS-API] result_code: 200 (success, spec compliant)\n");
     
     /* ✅ 尋找control-configs陣列 */
-    jsonResult = JSON_Search(jsonData, jsonSize,
-                           "control-configs", strlen("control-configs"),
-                           &configsArrayValue, &configsArrayLength);
+    int32_t configsArray = dms_json_index_child(&index, DMS_JSON_INDEX_ROOT,
+                                                "control-configs", strlen("control-configs"));
     
-    if (jsonResult != JSONSuccess || configsArrayValue == NULL) {
+    if (dms_json_index_type(&index, configsArray) != DMS_JSON_TYPE_ARRAY) {
         printf("⚠️  [DMS-API] No control-configs array found, using empty list\n");
         *configCount = 0;
         return DMS_API_SUCCESS;
     }
     
-    printf("✅ [DMS-API] Found control-configs array (%zu bytes)\n", configsArrayLength);
+    printf("✅ [DMS-API] Found control-configs array (%u bytes)\n",
+           index.tokens[configsArray].length);
     
     /* ✅ 解析陣列中的每個配置項目 */
-    /* 簡化的陣列解析：尋找每個配置物件 */
-    char* searchPos = configsArrayValue;
-    size_t remainingLength = configsArrayLength;
     int configIndex = 0;
+    int elementIndex = 0;
     
-    while (configIndex < maxConfigs && remainingLength > 0) {
-        /* 尋找下一個物件的開始 */
-        char* objectStart = strstr(searchPos, "{");
-        if (objectStart == NULL || objectStart >= searchPos + remainingLength) {
-            break;
-        }
-        
-        /* 尋找對應的物件結束 */
-        char* objectEnd = strstr(objectStart, "}");
-        if (objectEnd == NULL || objectEnd >= searchPos + remainingLength) {
-            break;
-        }
-        
-        size_t objectLength = objectEnd - objectStart + 1;
-        printf("🔍 [DMS-API] Parsing config object %d (%zu bytes)\n", 
-               configIndex, objectLength);
+    for (int32_t element = dms_json_index_first_child(&index, configsArray);
+         element != DMS_JSON_INDEX_NOT_FOUND && configIndex < maxConfigs;
+         element = dms_json_index_next_sibling(&index, configsArray, element), elementIndex++) {
+        printf("🔍 [DMS-API] Parsing config object %d\n", elementIndex);
         
         /* ✅ 解析單個配置物件 */
-        if (parse_single_config_object(objectStart, objectLength, &configs[configIndex])) {
+        if (parse_single_config_object(&index, element, &configs[configIndex])) {
             configIndex++;
             printf("✅ [DMS-API] Successfully parsed config %d\n", configIndex);
         } else {
-            printf("⚠️  [DMS-API] Failed to parse config object %d\n", configIndex);
+            printf("⚠️  [DMS-API] Failed to parse config object %d\n", elementIndex);
         }
-        
-        /* 移動到下一個可能的物件位置 */
-        searchPos = objectEnd + 1;
-        remainingLength = configsArrayLength - (searchPos - configsArrayValue);
     }
     
     *configCount = configIndex;
@@ -617,78 +637,20 @@ static DMSAPIResult_t parse_control_config_response(char* jsonData,
 /**
  * @brief 解析單個控制配置物件
  */
-static bool parse_single_config_object(char* objectData, size_t objectLength, 
+static bool parse_single_config_object(const dms_json_index_t* index, int32_t object,
                                       DMSControlConfig_t* config)
 {
-    JSONStatus_t jsonResult;
-    char* fieldValue = NULL;
-    size_t fieldLength = 0;
-    
-    if (objectData == NULL || config == NULL || objectLength == 0) {
+    if (index == NULL || config == NULL) {
         return false;
     }
     
     /* 初始化配置結構 */
     memset(config, 0, sizeof(DMSControlConfig_t));
     
-    /* ✅ 解析status_progress_id (規格: integer) */
-    jsonResult = JSON_Search(objectData, objectLength,
-                           "status_progress_id", strlen("status_progress_id"),
-                           &fieldValue, &fieldLength);
-    if (jsonResult == JSONSuccess && fieldValue != NULL) {
-        config->statusProgressId = atoi(fieldValue);
-        printf("   📊 status_progress_id: %d (spec: integer ✅)\n", config->statusProgressId);
-    }
-    
-    /* ✅ 解析item (規格: string, control item name) */
-    jsonResult = JSON_Search(objectData, objectLength,
-                           "item", strlen("item"),
-                           &fieldValue, &fieldLength);
-    if (jsonResult == JSONSuccess && fieldValue != NULL && fieldLength > 0) {
-        /* 移除引號並複製 */
-        size_t copyLength = fieldLength;
-        const char* copyStart = fieldValue;
-        if (fieldValue[0] == '"' && fieldValue[fieldLength-1] == '"') {
-            copyStart++;
-            copyLength -= 2;
-        }
-        size_t maxCopy = MIN(copyLength, sizeof(config->item) - 1);
-        strncpy(config->item, copyStart, maxCopy);
-        config->item[maxCopy] = '\0';
-        printf("   📝 item: %s (spec: control item name ✅)\n", config->item);
-    }
-    
-    /* ✅ 解析type (規格: integer, 1-String 2-JSON Object) */
-    jsonResult = JSON_Search(objectData, objectLength,
-                           "type", strlen("type"),
-                           &fieldValue, &fieldLength);
-    if (jsonResult == JSONSuccess && fieldValue != NULL) {
-        config->type = atoi(fieldValue);
-        printf("   🔢 type: %d (spec: 1-String 2-JSON Object ✅)\n", config->type);
-        
-        /* 驗證type值符合規格 */
-        if (config->type != 1 && config->type != 2) {
-            printf("   ⚠️  Warning: type %d not in spec range (1-2)\n", config->type);
-        }
-    }
-    
-    /* ✅ 解析value (規格: string, control value) */
-    jsonResult = JSON_Search(objectData, objectLength,
-                           "value", strlen("value"),
-                           &fieldValue, &fieldLength);
-    if (jsonResult == JSONSuccess && fieldValue != NULL && fieldLength > 0) {
-        /* 移除引號並複製 */
-        size_t copyLength = fieldLength;
-        const char* copyStart = fieldValue;
-        if (fieldValue[0] == '"' && fieldValue[fieldLength-1] == '"') {
-            copyStart++;
-            copyLength -= 2;
-        }
-        size_t maxCopy = MIN(copyLength, sizeof(config->value) - 1);
-        strncpy(config->value, copyStart, maxCopy);
-        config->value[maxCopy] = '\0';
-        printf("   💾 value: %s (spec: control value ✅)\n", config->value);
-    }
+    /* ✅ 依描述表解碼：status_progress_id、item、type、value */
+    dms_result_t decodeResult = dms_json_decode(index, object, g_control_config_fields,
+                                                ARRAY_SIZE(g_control_config_fields),
+                                                config, NULL);
     
     /* ✅ 驗證必要欄位符合規格要求 */
     if (strlen(config->item) == 0) {
@@ -696,6 +658,15 @@ static bool parse_single_config_object(char* objectData, size_t objectLength,
         return false;
     }
     
+    if (decodeResult != DMS_SUCCESS) {
+        printf("   ⚠️  Warning: some config fields could not be decoded (%d)\n", decodeResult);
+    }
+    
+    /* 驗證type值符合規格 */
+    if (config->type != 1 && config->type != 2) {
+        printf("   ⚠️  Warning: type %d not in spec range (1-2)\n", config->type);
+    }
+    
     printf("   📋 Parsed config (spec compliant): %s = %s (ID: %d, Type: %d)\n",
            config->item, config->value, config->statusProgressId, config->type);
     
@@ -707,6 +678,62 @@ static bool parse_single_config_object(char* objectData, size_t objectLength,
     return true;
 }
 
+/**
+ * @brief 為 HTTP 回應建立 JSON 索引
+ *
+ * token 陣列為靜態配置，API 呼叫只在主迴圈中進行；
+ * 索引只在下一次呼叫前有效
+ */
+static DMSAPIResult_t index_api_response(const char* data, size_t size, dms_json_index_t* index)
+{
+    static dms_json_token_t tokens[DMS_API_JSON_MAX_TOKENS];
+
+    if (data == NULL || size == 0) {
+        return DMS_API_ERROR_JSON_PARSE;
+    }
+
+    dms_result_t indexResult = dms_json_index_build(index, data, size,
+                                                    tokens, DMS_API_JSON_MAX_TOKENS);
+    if (indexResult != DMS_SUCCESS) {
+        printf("❌ [DMS-API] Unable to index JSON response: %d\n", indexResult);
+        return DMS_API_ERROR_JSON_PARSE;
+    }
+
+    return DMS_API_SUCCESS;
+}
+
+/**
+ * @brief 以 HTTP POST 送出回報
+ */
+static DMSAPIResult_t post_report(dms_report_endpoint_t endpoint, const char* payload)
+{
+    char url[DMS_API_MAX_URL_SIZE];
+    DMSAPIResponse_t response = {0};
+
+    snprintf(url, sizeof(url), "%s%s", g_base_url, g_report_paths[endpoint]);
+
+    DMSAPIResult_t result = dms_http_request(DMS_HTTP_POST, url, payload, &response);
+    dms_api_response_free(&response);
+    return result;
+}
+
+/**
+ * @brief MQTT 回報通道的 HTTP 回退（由主迴圈調用）
+ */
+static dms_result_t report_http_fallback(dms_report_endpoint_t endpoint, const char* body)
+{
+    DMSAPIResult_t result = post_report(endpoint, body);
+
+    if (result != DMS_API_SUCCESS) {
+        printf("❌ [DMS-API] HTTP fallback for %s failed: %s\n",
+               g_report_paths[endpoint], dms_api_get_error_string(result));
+        return DMS_ERROR_NETWORK_FAILURE;
+    }
+
+    printf("✅ [DMS-API] Report sent over HTTP fallback: %s\n", g_report_paths[endpoint]);
+    return DMS_SUCCESS;
+}
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -716,55 +743,62 @@ DMSAPIResult_t dms_api_control_progress_update(const char* uniqueId,
                                               const DMSControlResult_t* results,
                                               int resultCount)
 {
-    char url[DMS_API_MAX_URL_SIZE];
     char payload[DMS_API_MAX_PAYLOAD_SIZE];
-    DMSAPIResponse_t response = {0};
     DMSAPIResult_t result;
 
     if (uniqueId == NULL || results == NULL || resultCount <= 0) {
         return DMS_API_ERROR_INVALID_PARAM;
     }
 
-    /* 建構 URL */
-    snprintf(url, sizeof(url), "%s%s", g_base_url, DMS_API_CONTROL_PROGRESS);
-
     /* 建構 JSON payload */
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"unique_id\":\"%s\","
-             "\"control_result\":["
-             "{"
-             "\"status_progress_id\":%d,"
-             "\"status\":%d",
-             uniqueId, results[0].statusProgressId, results[0].status);
+    dms_json_writer_t writer;
+    dms_json_writer_init(&writer, payload, sizeof(payload));
+    dms_json_begin_object(&writer);
+    dms_json_kv_string(&writer, "unique_id", uniqueId);
+    dms_json_key(&writer, "control_result");
+    dms_json_begin_array(&writer);
+    for (int i = 0; i < resultCount; i++) {
+        dms_json_begin_object(&writer);
+        dms_json_kv_int(&writer, "status_progress_id", results[i].statusProgressId);
+        dms_json_kv_int(&writer, "status", results[i].status);
+
+        /* 如果有失敗訊息，加入到 payload */
+        if (results[i].status == 2 && strlen(results[i].failedCode) > 0) {
+            dms_json_kv_string(&writer, "failed_code", results[i].failedCode);
+            dms_json_kv_string(&writer, "failed_reason", results[i].failedReason);
+        }
 
-    /* 如果有失敗訊息，加入到 payload */
-    if (results[0].status == 2 && strlen(results[0].failedCode) > 0) {
-        char failedInfo[256];
-        snprintf(failedInfo, sizeof(failedInfo),
-                ",\"failed_code\":\"%s\",\"failed_reason\":\"%s\"",
-                results[0].failedCode, results[0].failedReason);
-        strncat(payload, failedInfo, sizeof(payload) - strlen(payload) - 1);
+        dms_json_end_object(&writer);
+    }
+    dms_json_end_array(&writer);
+    dms_json_end_object(&writer);
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        printf("❌ [DMS-API] Control progress payload exceeds buffer size\n");
+        return DMS_API_ERROR_INVALID_PARAM;
     }
-
-    strncat(payload, "}]}", sizeof(payload) - strlen(payload) - 1);
 
     printf("🎛️ [DMS-API] Updating control progress for device: %s\n", uniqueId);
-    printf("   Status Progress ID: %d, Status: %d\n",
-           results[0].statusProgressId, results[0].status);
+    for (int i = 0; i < resultCount; i++) {
+        printf("   Status Progress ID: %d, Status: %d\n",
+               results[i].statusProgressId, results[i].status);
+    }
+
+    /* MQTT 回報通道開啟時排入批次，由主迴圈以 QoS1 發布；無法排入時走 HTTP */
+    if (dms_report_submit(DMS_REPORT_CONTROL_PROGRESS, payload, dms_json_writer_length(&writer),
+                          report_http_fallback) == DMS_SUCCESS) {
+        printf("📨 [DMS-API] Control progress queued for MQTT report channel\n");
+        return DMS_API_SUCCESS;
+    }
 
     /* 執行 HTTP POST 請求 */
-    result = dms_http_request(DMS_HTTP_POST, url, payload, &response);
+    result = post_report(DMS_REPORT_CONTROL_PROGRESS, payload);
 
     if (result != DMS_API_SUCCESS) {
         printf("❌ [DMS-API] Control progress update failed\n");
-        goto cleanup;
+        return result;
     }
 
     printf("✅ [DMS-API] Control progress updated successfully\n");
-
-cleanup:
-    dms_api_response_free(&response);
     return result;
 }
 
@@ -781,9 +815,7 @@ DMSAPIResult_t dms_api_log_upload_url_attain(const DMSLogUploadRequest_t* reques
     char payload[DMS_API_MAX_PAYLOAD_SIZE];
     DMSAPIResponse_t response = {0};
     DMSAPIResult_t result;
-    JSONStatus_t jsonResult;
-    char* urlValue = NULL;
-    size_t urlValueLength = 0;
+    dms_json_index_t index;
 
     if (request == NULL || uploadUrl == NULL || urlSize == 0) {
         return DMS_API_ERROR_INVALID_PARAM;
@@ -793,16 +825,19 @@ DMSAPIResult_t dms_api_log_upload_url_attain(const DMSLogUploadRequest_t* reques
     snprintf(url, sizeof(url), "%s%s", g_base_url, DMS_API_LOG_UPLOAD_URL);
 
     /* 建構 JSON payload */
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"mac_address\":\"%s\","
-             "\"content_type\":\"%s\","
-             "\"log_file\":\"%s\","
-             "\"size\":\"%s\","
-             "\"md5\":\"%s\""
-             "}",
-             request->macAddress, request->contentType, request->logFile,
-             request->size, request->md5);
+    dms_json_writer_t writer;
+    dms_json_writer_init(&writer, payload, sizeof(payload));
+    dms_json_begin_object(&writer);
+    dms_json_kv_string(&writer, "mac_address", request->macAddress);
+    dms_json_kv_string(&writer, "content_type", request->contentType);
+    dms_json_kv_string(&writer, "log_file", request->logFile);
+    dms_json_kv_string(&writer, "size", request->size);
+    dms_json_kv_string(&writer, "md5", request->md5);
+    dms_json_end_object(&writer);
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        printf("❌ [DMS-API] Log upload payload exceeds buffer size\n");
+        return DMS_API_ERROR_INVALID_PARAM;
+    }
 
     printf("📤 [DMS-API] Requesting log upload URL for: %s\n", request->logFile);
     printf("   MAC: %s, Size: %s, MD5: %s\n",
@@ -816,32 +851,28 @@ DMSAPIResult_t dms_api_log_upload_url_attain(const DMSLogUploadRequest_t* reques
         goto cleanup;
     }
 
-    /* 解析 JSON 回應中的 upload_url */
-    jsonResult = JSON_Search(response.data, response.dataSize,
-                           "upload_url", strlen("upload_url"),
-                           &urlValue, &urlValueLength);
+    /* 解析 JSON 回應中的 upload_url（緩衝區大小由呼叫者決定） */
+    const dms_json_field_t urlField = { "upload_url", DMS_JSON_FIELD_STRING,
+                                        DMS_JSON_FIELD_REQUIRED, 0, urlSize };
 
-    if (jsonResult != JSONSuccess || urlValue == NULL || urlValueLength == 0) {
-        printf("❌ [DMS-API] upload_url not found in response\n");
-        result = DMS_API_ERROR_JSON_PARSE;
+    result = index_api_response(response.data, response.dataSize, &index);
+    if (result != DMS_API_SUCCESS) {
         goto cleanup;
     }
 
-    /* 複製 URL (移除引號) */
-    size_t copyLength = urlValueLength;
-    if (urlValue[0] == '"' && urlValue[urlValueLength-1] == '"') {
-        urlValue++;
-        copyLength -= 2;
-    }
-
-    if (copyLength >= urlSize) {
+    uploadUrl[0] = '\0';
+    dms_result_t decodeResult = dms_json_decode(&index, DMS_JSON_INDEX_ROOT,
+                                                &urlField, 1, uploadUrl, NULL);
+    if (decodeResult == DMS_ERROR_BUFFER_OVERFLOW) {
         printf("❌ [DMS-API] Upload URL too long for buffer\n");
         result = DMS_API_ERROR_INVALID_PARAM;
         goto cleanup;
     }
-
-    strncpy(uploadUrl, urlValue, copyLength);
-    uploadUrl[copyLength] = '\0';
+    if (decodeResult != DMS_SUCCESS || strlen(uploadUrl) == 0) {
+        printf("❌ [DMS-API] upload_url not found in response\n");
+        result = DMS_API_ERROR_JSON_PARSE;
+        goto cleanup;
+    }
 
     printf("✅ [DMS-API] Log upload URL obtained successfully\n");
     printf("   Upload URL: %s\n", uploadUrl);
@@ -896,50 +927,56 @@ DMSAPIResult_t dms_api_fw_progress_update(const char* macAddress,
                                         const char* failedCode,
                                         const char* failedReason)
 {
-    char url[DMS_API_MAX_URL_SIZE];
     char payload[DMS_API_MAX_PAYLOAD_SIZE];
-    DMSAPIResponse_t response = {0};
     DMSAPIResult_t result;
 
     if (macAddress == NULL || fwProgressId == NULL || version == NULL) {
         return DMS_API_ERROR_INVALID_PARAM;
     }
 
-    /* 建構 URL */
-    snprintf(url, sizeof(url), "%s%s", g_base_url, DMS_API_FW_PROGRESS);
+    /* 建構 JSON payload - status 與 percentage 依 API 規格以字串傳送 */
+    char statusText[12];
+    char percentageText[12];
+    snprintf(statusText, sizeof(statusText), "%d", status);
+    snprintf(percentageText, sizeof(percentageText), "%d", percentage);
 
-    /* 建構 JSON payload */
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"mac_address\":\"%s\","
-             "\"fw_progress_id\":\"%s\","
-             "\"version\":\"%s\","
-             "\"status\":\"%d\","
-             "\"percentage\":\"%d\"",
-             macAddress, fwProgressId, version, status, percentage);
+    dms_json_writer_t writer;
+    dms_json_writer_init(&writer, payload, sizeof(payload));
+    dms_json_begin_object(&writer);
+    dms_json_kv_string(&writer, "mac_address", macAddress);
+    dms_json_kv_string(&writer, "fw_progress_id", fwProgressId);
+    dms_json_kv_string(&writer, "version", version);
+    dms_json_kv_string(&writer, "status", statusText);
+    dms_json_kv_string(&writer, "percentage", percentageText);
 
     /* 如果有失敗訊息，加入到 payload */
     if (status == 2 && failedCode != NULL && strlen(failedCode) > 0) {
-        char failedInfo[256];
-        snprintf(failedInfo, sizeof(failedInfo),
-                ",\"failed_code\":\"%s\"", failedCode);
-        strncat(payload, failedInfo, sizeof(payload) - strlen(payload) - 1);
+        dms_json_kv_string(&writer, "failed_code", failedCode);
 
         if (failedReason != NULL && strlen(failedReason) > 0) {
-            snprintf(failedInfo, sizeof(failedInfo),
-                    ",\"failed_reason\":\"%s\"", failedReason);
-            strncat(payload, failedInfo, sizeof(payload) - strlen(payload) - 1);
+            dms_json_kv_string(&writer, "failed_reason", failedReason);
         }
     }
 
-    strncat(payload, "}", sizeof(payload) - strlen(payload) - 1);
+    dms_json_end_object(&writer);
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        printf("❌ [DMS-API] Firmware progress payload exceeds buffer size\n");
+        return DMS_API_ERROR_INVALID_PARAM;
+    }
 
     printf("🔄 [DMS-API] Updating firmware progress: %s\n", version);
     printf("   MAC: %s, Progress ID: %s, Status: %d, Percentage: %d\n",
            macAddress, fwProgressId, status, percentage);
 
+    /* 下載進度會頻繁回報，MQTT 回報通道開啟時合併為批次發布 */
+    if (dms_report_submit(DMS_REPORT_FW_PROGRESS, payload, dms_json_writer_length(&writer),
+                          report_http_fallback) == DMS_SUCCESS) {
+        printf("📨 [DMS-API] Firmware progress queued for MQTT report channel\n");
+        return DMS_API_SUCCESS;
+    }
+
     /* 執行 HTTP POST 請求 */
-    result = dms_http_request(DMS_HTTP_POST, url, payload, &response);
+    result = post_report(DMS_REPORT_FW_PROGRESS, payload);
 
     if (result == DMS_API_SUCCESS) {
         printf("✅ [DMS-API] Firmware progress updated successfully\n");
@@ -947,7 +984,6 @@ DMSAPIResult_t dms_api_fw_progress_update(const char* macAddress,
         printf("❌ [DMS-API] Firmware progress update failed\n");
     }
 
-    dms_api_response_free(&response);
     return result;
 }
 
@@ -964,52 +1000,51 @@ DMSAPIResult_t dms_api_device_info_update(const char* uniqueId,
                                          const char* panel,
                                          const char* countryCode)
 {
-    char url[DMS_API_MAX_URL_SIZE];
     char payload[DMS_API_MAX_PAYLOAD_SIZE];
-    DMSAPIResponse_t response = {0};
     DMSAPIResult_t result;
 
     if (uniqueId == NULL || serial == NULL || currentDatetime == NULL) {
         return DMS_API_ERROR_INVALID_PARAM;
     }
 
-    /* 建構 URL */
-    snprintf(url, sizeof(url), "%s%s", g_base_url, DMS_API_DEVICE_INFO_UPDATE);
-
     /* 建構 JSON payload */
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"unique_id\":\"%s\","
-             "\"version_code\":%d,"
-             "\"serial\":\"%s\","
-             "\"current_datetime\":\"%s\"",
-             uniqueId, versionCode, serial, currentDatetime);
+    dms_json_writer_t writer;
+    dms_json_writer_init(&writer, payload, sizeof(payload));
+    dms_json_begin_object(&writer);
+    dms_json_kv_string(&writer, "unique_id", uniqueId);
+    dms_json_kv_int(&writer, "version_code", versionCode);
+    dms_json_kv_string(&writer, "serial", serial);
+    dms_json_kv_string(&writer, "current_datetime", currentDatetime);
 
     /* 加入可選參數 */
     if (fwVersion != NULL && strlen(fwVersion) > 0) {
-        char temp[128];
-        snprintf(temp, sizeof(temp), ",\"fw_version\":\"%s\"", fwVersion);
-        strncat(payload, temp, sizeof(payload) - strlen(payload) - 1);
+        dms_json_kv_string(&writer, "fw_version", fwVersion);
     }
 
     if (panel != NULL && strlen(panel) > 0) {
-        char temp[128];
-        snprintf(temp, sizeof(temp), ",\"panel\":\"%s\"", panel);
-        strncat(payload, temp, sizeof(payload) - strlen(payload) - 1);
+        dms_json_kv_string(&writer, "panel", panel);
     }
 
     if (countryCode != NULL && strlen(countryCode) > 0) {
-        char temp[128];
-        snprintf(temp, sizeof(temp), ",\"country_code\":\"%s\"", countryCode);
-        strncat(payload, temp, sizeof(payload) - strlen(payload) - 1);
+        dms_json_kv_string(&writer, "country_code", countryCode);
     }
 
-    strncat(payload, "}", sizeof(payload) - strlen(payload) - 1);
+    dms_json_end_object(&writer);
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        printf("❌ [DMS-API] Device info payload exceeds buffer size\n");
+        return DMS_API_ERROR_INVALID_PARAM;
+    }
 
     printf("📱 [DMS-API] Updating device info for: %s\n", uniqueId);
 
+    if (dms_report_submit(DMS_REPORT_DEVICE_INFO, payload, dms_json_writer_length(&writer),
+                          report_http_fallback) == DMS_SUCCESS) {
+        printf("📨 [DMS-API] Device info queued for MQTT report channel\n");
+        return DMS_API_SUCCESS;
+    }
+
     /* 執行 HTTP POST 請求 */
-    result = dms_http_request(DMS_HTTP_POST, url, payload, &response);
+    result = post_report(DMS_REPORT_DEVICE_INFO, payload);
 
     if (result == DMS_API_SUCCESS) {
         printf("✅ [DMS-API] Device info updated successfully\n");
@@ -1017,7 +1052,6 @@ DMSAPIResult_t dms_api_device_info_update(const char* uniqueId,
         printf("❌ [DMS-API] Device info update failed\n");
     }
 
-    dms_api_response_free(&response);
     return result;
 }
 
@@ -1161,8 +1195,9 @@ DMSAPIResult_t dms_api_server_url_get(const char* site,
     char payload[DMS_API_MAX_PAYLOAD_SIZE];
     DMSAPIResponse_t response = {0};
     DMSAPIResult_t result;
-    JSONStatus_t jsonResult;
-    char* dataValue = NULL;
+    dms_json_index_t responseIndex;
+    int32_t data;
+    const char* dataValue = NULL;
     size_t dataValueLength = 0;
 
     if (site == NULL || environment == NULL || uniqueId == NULL || config == NULL) {
@@ -1177,13 +1212,17 @@ DMSAPIResult_t dms_api_server_url_get(const char* site,
     snprintf(url, sizeof(url), "%sv3/server_url/get", g_base_url);
 
     /* 建構 JSON payload */
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"site\":\"%s\","
-             "\"environment\":\"%s\","
-             "\"unique_id\":\"%s\""
-             "}",
-             site, environment, uniqueId);
+    dms_json_writer_t writer;
+    dms_json_writer_init(&writer, payload, sizeof(payload));
+    dms_json_begin_object(&writer);
+    dms_json_kv_string(&writer, "site", site);
+    dms_json_kv_string(&writer, "environment", environment);
+    dms_json_kv_string(&writer, "unique_id", uniqueId);
+    dms_json_end_object(&writer);
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        printf("❌ [DMS-API] Server URL payload exceeds buffer size\n");
+        return DMS_API_ERROR_INVALID_PARAM;
+    }
 
     printf("🌐 [DMS-API] Getting server URL configuration...\n");
     printf("   Site: %s, Environment: %s, Unique ID: %s\n", site, environment, uniqueId);
@@ -1209,19 +1248,17 @@ DMSAPIResult_t dms_api_server_url_get(const char* site,
            (response.dataSize > 200) ? "..." : "");
 
     /* 驗證 JSON 格式 */
-    jsonResult = JSON_Validate(response.data, response.dataSize);
-    if (jsonResult != JSONSuccess) {
+    if (index_api_response(response.data, response.dataSize, &responseIndex) != DMS_API_SUCCESS) {
         printf("❌ [DMS-API] Invalid JSON in server URL response\n");
         result = DMS_API_ERROR_JSON_PARSE;
         goto cleanup;
     }
 
     /* 尋找 data 欄位 */
-    jsonResult = JSON_Search(response.data, response.dataSize,
-                           "data", strlen("data"),
-                           &dataValue, &dataValueLength);
+    data = dms_json_index_child(&responseIndex, DMS_JSON_INDEX_ROOT, "data", strlen("data"));
 
-    if (jsonResult != JSONSuccess || dataValue == NULL) {
+    if (!dms_json_index_value(&responseIndex, data, &dataValue, &dataValueLength) ||
+        dataValueLength == 0) {
         printf("❌ [DMS-API] No 'data' field found in response\n");
         result = DMS_API_ERROR_JSON_PARSE;
         goto cleanup;
@@ -1309,37 +1346,24 @@ DMSAPIResult_t dms_api_server_url_get(const char* site,
         /* 可能是加密的 Base64 字串 */
         printf("🔐 [DMS-API] Encrypted data detected, attempting decryption...\n");
 
-        /* 提取 Base64 字串（移除 JSON 引號） */
-        char* encrypted_data = malloc(dataValueLength);
+        /* 提取 Base64 字串並反跳脫（\/ -> /），結果不會比原始文字長 */
+        char* encrypted_data = malloc(dataValueLength + 1);
         if (encrypted_data == NULL) {
             printf("❌ [DMS-API] Memory allocation failed for encrypted data\n");
             result = DMS_API_ERROR_MEMORY_ALLOCATION;
             goto cleanup;
         }
 
-
-        /* 提取 Base64 字串（移除 JSON 引號） */
-       size_t encrypted_len = dataValueLength;
-       strncpy(encrypted_data, dataValue, encrypted_len);
-       encrypted_data[encrypted_len] = '\0';
-
-       /* 處理 JSON 轉義字符 \/ -> / */
-       char* src = encrypted_data;
-       char* dst = encrypted_data;
-       while (*src) {
-         if (*src == '\\' && *(src + 1) == '/') {
-            *dst = '/';
-            src += 2;  // 跳過 \/
-        } else {
-           *dst = *src;
-           src++;
+        size_t encrypted_len = 0;
+        if (dms_json_index_get_string(&responseIndex, data, encrypted_data, dataValueLength + 1,
+                                      &encrypted_len) != DMS_SUCCESS) {
+            printf("❌ [DMS-API] Encrypted data is not a valid JSON string\n");
+            free(encrypted_data);
+            result = DMS_API_ERROR_JSON_PARSE;
+            goto cleanup;
         }
-        dst++;
-       }
-       *dst = '\0';
-       printf("   Processed Base64 string: %.50s...\n", encrypted_data);
-       
-       printf("   Extracted Base64 string (%zu chars): %.50s...\n",
+
+        printf("   Extracted Base64 string (%zu chars): %.50s...\n",
                encrypted_len, encrypted_data);
 
         /* 解密資料 */
@@ -1367,122 +1391,41 @@ DMSAPIResult_t dms_api_server_url_get(const char* site,
         /* 解析解密後的 JSON */
         printf("✅ [DMS-API] Decryption successful, parsing configuration...\n");
 
-        /* 驗證解密後的 JSON */
-        jsonResult = JSON_Validate(decrypted_json, decrypted_length);
-        if (jsonResult != JSONSuccess) {
+        /* 驗證解密後的 JSON 並依描述表解碼各 URL（含 \/ 等跳脫字元） */
+        dms_json_index_t index;
+        if (index_api_response(decrypted_json, decrypted_length, &index) != DMS_API_SUCCESS) {
             printf("❌ [DMS-API] Invalid JSON after decryption\n");
             free(decrypted_json);
             result = DMS_API_ERROR_JSON_PARSE;
             goto cleanup;
         }
 
-        /* 解析 API URL */
-        jsonResult = JSON_Search(decrypted_json, decrypted_length,
-                               "api", strlen("api"),
-                               &dataValue, &dataValueLength);
-        if (jsonResult == JSONSuccess && dataValue != NULL && dataValueLength > 0) {
-            size_t copyLen = MIN(dataValueLength, sizeof(config->apiUrl) - 1);
-            strncpy(config->apiUrl, dataValue, copyLen);
-            config->apiUrl[copyLen] = '\0';
-            /* 移除 JSON 引號 */
-            if (config->apiUrl[0] == '"' && config->apiUrl[copyLen-1] == '"') {
-                memmove(config->apiUrl, config->apiUrl + 1, copyLen - 2);
-                config->apiUrl[copyLen - 2] = '\0';
-            }
-            printf("   📡 API URL: %s\n", config->apiUrl);
-	    /* ▒~Y~U▒~P~F JSON ▒~I義▒~W符 \/ -> / */
-            unescapeJsonString(config->apiUrl);
-            printf("   ▒~_~T▒ API URL after unescape: %s\n", config->apiUrl);
-        }
-
-        /* 解析 MQTT URL */
-        jsonResult = JSON_Search(decrypted_json, decrypted_length,
-                               "mqtt", strlen("mqtt"),
-                               &dataValue, &dataValueLength);
-        if (jsonResult == JSONSuccess && dataValue != NULL && dataValueLength > 0) {
-            size_t copyLen = MIN(dataValueLength, sizeof(config->mqttUrl) - 1);
-            strncpy(config->mqttUrl, dataValue, copyLen);
-            config->mqttUrl[copyLen] = '\0';
-            /* 移除 JSON 引號 */
-            if (config->mqttUrl[0] == '"' && config->mqttUrl[copyLen-1] == '"') {
-                memmove(config->mqttUrl, config->mqttUrl + 1, copyLen - 2);
-                config->mqttUrl[copyLen - 2] = '\0';
-            }
-            printf("   📡 MQTT URL: %s\n", config->mqttUrl);
-
-  	    /* ▒~Y~U▒~P~F JSON ▒~I義▒~W符 \/ -> / */
-	    unescapeJsonString(config->mqttUrl);
-	    printf("   ▒~_~T▒ MQTT URL after unescape: %s\n", config->mqttUrl);
-        }
-
-
-
-        /* 解析 MQTT IoT URL */
-        jsonResult = JSON_Search(decrypted_json, decrypted_length,
-                               "mqtt_iot", strlen("mqtt_iot"),
-                               &dataValue, &dataValueLength);
-        if (jsonResult == JSONSuccess && dataValue != NULL && dataValueLength > 0) {
-            size_t copyLen = MIN(dataValueLength, sizeof(config->mqttIotUrl) - 1);
-            strncpy(config->mqttIotUrl, dataValue, copyLen);
-            config->mqttIotUrl[copyLen] = '\0';
-            /* 移除 JSON 引號 */
-            if (config->mqttIotUrl[0] == '"' && config->mqttIotUrl[copyLen-1] == '"') {
-                memmove(config->mqttIotUrl, config->mqttIotUrl + 1, copyLen - 2);
-                config->mqttIotUrl[copyLen - 2] = '\0';
-            }
-            printf("   📡 MQTT IoT URL: %s\n", config->mqttIotUrl);
-	    /* 處理 JSON 轉義字符 \/ -> / */
-            unescapeJsonString(config->mqttIotUrl);
-            printf("   🔧 MQTT IoT URL after unescape: %s\n", config->mqttIotUrl);
-        }
-
-
-        /* 解析 MDA JSON URL */
-        jsonResult = JSON_Search(decrypted_json, decrypted_length,
-                               "mda_json", strlen("mda_json"),
-                               &dataValue, &dataValueLength);
-        if (jsonResult == JSONSuccess && dataValue != NULL && dataValueLength > 0) {
-            size_t copyLen = MIN(dataValueLength, sizeof(config->mdaJsonUrl) - 1);
-            strncpy(config->mdaJsonUrl, dataValue, copyLen);
-            config->mdaJsonUrl[copyLen] = '\0';
-            /* 移除 JSON 引號 */
-            if (config->mdaJsonUrl[0] == '"' && config->mdaJsonUrl[copyLen-1] == '"') {
-                memmove(config->mdaJsonUrl, config->mdaJsonUrl + 1, copyLen - 2);
-                config->mdaJsonUrl[copyLen - 2] = '\0';
-            }
-            printf("   📡 MDA JSON URL: %s\n", config->mdaJsonUrl);
-	    /* 處理 JSON 轉義字符 \/ -> / */
-	    unescapeJsonString(config->mdaJsonUrl);
-	    printf("   🔧 MDA JSON URL after unescape: %s\n", config->mdaJsonUrl);
+        dms_result_t decodeResult = dms_json_decode(&index, DMS_JSON_INDEX_ROOT,
+                                                    g_server_config_fields,
+                                                    ARRAY_SIZE(g_server_config_fields),
+                                                    config, NULL);
+        if (decodeResult != DMS_SUCCESS) {
+            printf("❌ [DMS-API] Invalid server configuration after decryption: %d\n", decodeResult);
+            free(decrypted_json);
+            result = DMS_API_ERROR_JSON_PARSE;
+            goto cleanup;
         }
-
+        printf("   📡 API URL: %s\n", config->apiUrl);
+        printf("   📡 MQTT URL: %s\n", config->mqttUrl);
+        printf("   📡 MQTT IoT URL: %s\n", config->mqttIotUrl);
+        printf("   📡 MDA JSON URL: %s\n", config->mdaJsonUrl);
 
         /* 檢查憑證資訊 */
-        jsonResult = JSON_Search(decrypted_json, decrypted_length,
-                               "mqtt_iot_cert", strlen("mqtt_iot_cert"),
-                               &dataValue, &dataValueLength);
-        if (jsonResult == JSONSuccess && dataValue != NULL && dataValueLength > 0) {
+        config->hasCertInfo = (dms_json_index_child(&index, DMS_JSON_INDEX_ROOT, "mqtt_iot_cert",
+                                                    strlen("mqtt_iot_cert")) != DMS_JSON_INDEX_NOT_FOUND);
+        if (config->hasCertInfo) {
             printf("   🔐 Certificate information found\n");
-            config->hasCertInfo = true;
-
-            /* 解析憑證路徑 */
-            jsonResult = JSON_Search(decrypted_json, decrypted_length,
-                                   "cert_path", strlen("cert_path"),
-                                   &dataValue, &dataValueLength);
-            if (jsonResult == JSONSuccess && dataValue != NULL && dataValueLength > 0) {
-                size_t copyLen = MIN(dataValueLength, sizeof(config->certPath) - 1);
-                strncpy(config->certPath, dataValue, copyLen);
-                config->certPath[copyLen] = '\0';
-                /* 移除 JSON 引號 */
-                if (config->certPath[0] == '"' && config->certPath[copyLen-1] == '"') {
-                    memmove(config->certPath, config->certPath + 1, copyLen - 2);
-                    config->certPath[copyLen - 2] = '\0';
-                }
+            if (strlen(config->certPath) > 0) {
                 printf("      Certificate path: %s\n", config->certPath);
             }
         } else {
             printf("   📋 No certificate information in response\n");
-            config->hasCertInfo = false;
+            config->certPath[0] = '\0';
         }
 
         free(decrypted_json);
@@ -1513,55 +1456,30 @@ DMSAPIResult_t dms_api_server_url_get(const char* site,
         
         printf("   Extracted JSON: %.100s%s\n", jsonData, (jsonLength > 100) ? "..." : "");
         
-        /* 驗證 JSON 格式 */
-        JSONStatus_t jsonResult = JSON_Validate(jsonData, jsonLength);
-        if (jsonResult != JSONSuccess) {
+        /* 驗證 JSON 格式並依描述表解碼各 URL */
+        dms_json_index_t index;
+        if (index_api_response(jsonData, jsonLength, &index) != DMS_API_SUCCESS) {
             printf("❌ [DMS-API] Invalid JSON in unencrypted data\n");
             free(jsonData);
             result = DMS_API_ERROR_JSON_PARSE;
             goto cleanup;
         }
         
-        /* 解析 API URL */
-        char* apiValue = NULL;
-        size_t apiValueLength = 0;
-        jsonResult = JSON_Search(jsonData, jsonLength,
-                               "api", strlen("api"),
-                               &apiValue, &apiValueLength);
-        if (jsonResult == JSONSuccess && apiValue != NULL && apiValueLength > 0) {
-            size_t copyLen = MIN(apiValueLength, sizeof(config->apiUrl) - 1);
-            strncpy(config->apiUrl, apiValue, copyLen);
-            config->apiUrl[copyLen] = '\0';
-            /* 移除 JSON 引號 */
-            if (config->apiUrl[0] == '"' && config->apiUrl[copyLen-1] == '"') {
-                memmove(config->apiUrl, config->apiUrl + 1, copyLen - 2);
-                config->apiUrl[copyLen - 2] = '\0';
-            }
-            printf("   📡 API URL: %s\n", config->apiUrl);
-        }
-        
-        /* 解析 MQTT IoT URL */
-        char* mqttIotValue = NULL;
-        size_t mqttIotValueLength = 0;
-        jsonResult = JSON_Search(jsonData, jsonLength,
-                               "mqtt_iot", strlen("mqtt_iot"),
-                               &mqttIotValue, &mqttIotValueLength);
-        if (jsonResult == JSONSuccess && mqttIotValue != NULL && mqttIotValueLength > 0) {
-            size_t copyLen = MIN(mqttIotValueLength, sizeof(config->mqttIotUrl) - 1);
-            strncpy(config->mqttIotUrl, mqttIotValue, copyLen);
-            config->mqttIotUrl[copyLen] = '\0';
-            /* 移除 JSON 引號 */
-            if (config->mqttIotUrl[0] == '"' && config->mqttIotUrl[copyLen-1] == '"') {
-                memmove(config->mqttIotUrl, config->mqttIotUrl + 1, copyLen - 2);
-                config->mqttIotUrl[copyLen - 2] = '\0';
-            }
-            printf("   📡 MQTT IoT URL: %s\n", config->mqttIotUrl);
+        dms_result_t decodeResult = dms_json_decode(&index, DMS_JSON_INDEX_ROOT,
+                                                    g_server_config_fields,
+                                                    ARRAY_SIZE(g_server_config_fields),
+                                                    config, NULL);
+        if (decodeResult != DMS_SUCCESS) {
+            printf("❌ [DMS-API] Invalid server configuration in unencrypted data: %d\n", decodeResult);
+            free(jsonData);
+            result = DMS_API_ERROR_JSON_PARSE;
+            goto cleanup;
         }
-        
-        /* 解析其他欄位... */
-        /* 類似的邏輯處理 mqtt, mda_json 等欄位 */
+        printf("   📡 API URL: %s\n", config->apiUrl);
+        printf("   📡 MQTT IoT URL: %s\n", config->mqttIotUrl);
         
         config->hasCertInfo = false; /* 未加密通常不包含憑證資訊 */
+        config->certPath[0] = '\0';
         
         free(jsonData);
         printf("✅ [DMS-API] Unencrypted data parsed successfully\n");
@@ -1874,9 +1792,9 @@ DMSCryptoResult_t decrypt_dms_server_response(const char* encrypted_base64,
     
     // Step 3: 驗證解密後的 JSON 格式
     printf("📝 [CRYPTO] Step 3: JSON validation...\n");
-    JSONStatus_t jsonResult = JSON_Validate((char*)decrypted_data, decrypted_size);
-    if (jsonResult != JSONSuccess) {
-        printf("❌ [CRYPTO] Decrypted data is not valid JSON (error: %d)\n", jsonResult);
+    dms_json_index_t index;
+    if (index_api_response((const char*)decrypted_data, decrypted_size, &index) != DMS_API_SUCCESS) {
+        printf("❌ [CRYPTO] Decrypted data is not valid JSON\n");
         printf("   Decrypted content: %.*s\n", (int)MIN(200, decrypted_size), decrypted_data);
         printf("🔍 [CRYPTO] This might indicate:\n");
         printf("   1. Wrong AES key or IV\n");
@@ -2016,9 +1934,7 @@ DMSAPIResult_t dms_api_device_country_code_get(const char* uniqueId,
     char url[DMS_API_MAX_URL_SIZE];
     DMSAPIResponse_t apiResponse = {0};
     DMSAPIResult_t result;
-    JSONStatus_t jsonResult;
-    char* countryValue = NULL;
-    size_t countryValueLength = 0;
+    dms_json_index_t index;
 
     if (uniqueId == NULL || response == NULL) {
         printf("❌ [DMS-API] Invalid parameters for country code get\n");
@@ -2051,39 +1967,27 @@ DMSAPIResult_t dms_api_device_country_code_get(const char* uniqueId,
     }
 
     /* 驗證 JSON 格式 */
-    jsonResult = JSON_Validate(apiResponse.data, apiResponse.dataSize);
-    if (jsonResult != JSONSuccess) {
+    if (index_api_response(apiResponse.data, apiResponse.dataSize, &index) != DMS_API_SUCCESS) {
         printf("❌ [DMS-API] Invalid JSON in country code response\n");
         result = DMS_API_ERROR_JSON_PARSE;
         goto cleanup;
     }
 
-    /* 尋找 country_code 欄位 */
-    jsonResult = JSON_Search(apiResponse.data, apiResponse.dataSize,
-                           "country_code", strlen("country_code"),
-                           &countryValue, &countryValueLength);
-
-    if (jsonResult != JSONSuccess || countryValue == NULL || countryValueLength == 0) {
-        printf("❌ [DMS-API] country_code not found in response\n");
-        result = DMS_API_ERROR_JSON_PARSE;
-        goto cleanup;
-    }
-
-    /* 複製國家代碼 (移除引號) */
-    size_t copyLength = countryValueLength;
-    if (countryValue[0] == '"' && countryValue[countryValueLength-1] == '"') {
-        countryValue++;
-        copyLength -= 2;
-    }
-
-    if (copyLength >= sizeof(response->countryCode)) {
+    /* 依描述表解碼 country_code */
+    dms_result_t decodeResult = dms_json_decode(&index, DMS_JSON_INDEX_ROOT,
+                                                g_country_code_fields,
+                                                ARRAY_SIZE(g_country_code_fields),
+                                                response, NULL);
+    if (decodeResult == DMS_ERROR_BUFFER_OVERFLOW) {
         printf("❌ [DMS-API] Country code too long for buffer\n");
         result = DMS_API_ERROR_INVALID_PARAM;
         goto cleanup;
     }
-
-    strncpy(response->countryCode, countryValue, copyLength);
-    response->countryCode[copyLength] = '\0';
+    if (decodeResult != DMS_SUCCESS || strlen(response->countryCode) == 0) {
+        printf("❌ [DMS-API] country_code not found in response\n");
+        result = DMS_API_ERROR_JSON_PARSE;
+        goto cleanup;
+    }
 
     printf("✅ [DMS-API] Country code retrieved successfully\n");
     printf("   Country Code: %s\n", response->countryCode);
@@ -2117,33 +2021,29 @@ DMSAPIResult_t dms_api_device_register(const DMSDeviceRegisterRequest_t* request
     snprintf(url, sizeof(url), "%sv2/device/register", g_base_url);
 
     /* 建構 JSON payload */
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"bdid\":\"%s\","
-             "\"unique_id\":\"%s\","
-             "\"mac_address\":\"%s\","
-             "\"serial\":\"%s\","
-             "\"model_name\":\"%s\","
-             "\"panel\":\"%s\","
-             "\"brand\":\"%s\","
-             "\"version\":\"%s\","
-             "\"type\":\"%s\","
-             "\"sub_type\":%d,"
-             "\"country_code\":\"%s\","
-             "\"architecture\":[\"%s\"]"
-             "}",
-             request->bdid,
-             request->uniqueId,
-             request->macAddress,
-             request->serial,
-             request->modelName,
-             request->panel,
-             request->brand,
-             request->version,
-             request->type,
-             request->subType,
-             request->countryCode,
-             request->architecture);
+    dms_json_writer_t writer;
+    dms_json_writer_init(&writer, payload, sizeof(payload));
+    dms_json_begin_object(&writer);
+    dms_json_kv_string(&writer, "bdid", request->bdid);
+    dms_json_kv_string(&writer, "unique_id", request->uniqueId);
+    dms_json_kv_string(&writer, "mac_address", request->macAddress);
+    dms_json_kv_string(&writer, "serial", request->serial);
+    dms_json_kv_string(&writer, "model_name", request->modelName);
+    dms_json_kv_string(&writer, "panel", request->panel);
+    dms_json_kv_string(&writer, "brand", request->brand);
+    dms_json_kv_string(&writer, "version", request->version);
+    dms_json_kv_string(&writer, "type", request->type);
+    dms_json_kv_int(&writer, "sub_type", request->subType);
+    dms_json_kv_string(&writer, "country_code", request->countryCode);
+    dms_json_key(&writer, "architecture");
+    dms_json_begin_array(&writer);
+    dms_json_string(&writer, request->architecture);
+    dms_json_end_array(&writer);
+    dms_json_end_object(&writer);
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        printf("❌ [DMS-API] Device register payload exceeds buffer size\n");
+        return DMS_API_ERROR_INVALID_PARAM;
+    }
 
     printf("📱 [DMS-API] Registering device to DMS Server...\n");
     printf("   Device Model: %s\n", request->modelName);
@@ -2196,11 +2096,7 @@ DMSAPIResult_t dms_api_device_pincode_get(const char* uniqueId,
     char url[DMS_API_MAX_URL_SIZE];
     DMSAPIResponse_t apiResponse = {0};
     DMSAPIResult_t result;
-    JSONStatus_t jsonResult;
-    char* pincodeValue = NULL;
-    size_t pincodeValueLength = 0;
-    char* expiredValue = NULL;
-    size_t expiredValueLength = 0;
+    dms_json_index_t index;
 
     if (uniqueId == NULL || deviceType == NULL || response == NULL) {
         printf("❌ [DMS-API] Invalid parameters for pincode get\n");
@@ -2234,55 +2130,27 @@ DMSAPIResult_t dms_api_device_pincode_get(const char* uniqueId,
     }
 
     /* 驗證 JSON 格式 */
-    jsonResult = JSON_Validate(apiResponse.data, apiResponse.dataSize);
-    if (jsonResult != JSONSuccess) {
+    if (index_api_response(apiResponse.data, apiResponse.dataSize, &index) != DMS_API_SUCCESS) {
         printf("❌ [DMS-API] Invalid JSON in PIN code response\n");
         result = DMS_API_ERROR_JSON_PARSE;
         goto cleanup;
     }
 
-    /* 尋找 pincode 欄位 */
-    jsonResult = JSON_Search(apiResponse.data, apiResponse.dataSize,
-                           "pincode", strlen("pincode"),
-                           &pincodeValue, &pincodeValueLength);
-
-    if (jsonResult != JSONSuccess || pincodeValue == NULL || pincodeValueLength == 0) {
-        printf("❌ [DMS-API] pincode not found in response\n");
+    /* 依描述表解碼 pincode 與 expired_at */
+    dms_result_t decodeResult = dms_json_decode(&index, DMS_JSON_INDEX_ROOT,
+                                                g_pincode_fields, ARRAY_SIZE(g_pincode_fields),
+                                                response, NULL);
+    if (decodeResult == DMS_ERROR_BUFFER_OVERFLOW) {
+        printf("❌ [DMS-API] PIN code too long for buffer\n");
         result = DMS_API_ERROR_JSON_PARSE;
         goto cleanup;
     }
-
-    /* 複製 PIN 碼 (移除引號) */
-    size_t copyLength = pincodeValueLength;
-    if (pincodeValue[0] == '"' && pincodeValue[pincodeValueLength-1] == '"') {
-        pincodeValue++;
-        copyLength -= 2;
-    }
-
-    if (copyLength >= sizeof(response->pincode)) {
-        printf("❌ [DMS-API] PIN code too long for buffer\n");
+    if (strlen(response->pincode) == 0) {
+        printf("❌ [DMS-API] pincode not found in response\n");
         result = DMS_API_ERROR_JSON_PARSE;
         goto cleanup;
     }
 
-    strncpy(response->pincode, pincodeValue, copyLength);
-    response->pincode[copyLength] = '\0';
-
-    /* 尋找 expired_at 欄位 */
-    jsonResult = JSON_Search(apiResponse.data, apiResponse.dataSize,
-                           "expired_at", strlen("expired_at"),
-                           &expiredValue, &expiredValueLength);
-
-    if (jsonResult == JSONSuccess && expiredValue != NULL && expiredValueLength > 0) {
-        /* 轉換為數字 */
-        char expiredStr[32];
-        size_t expiredCopyLength = MIN(expiredValueLength, sizeof(expiredStr) - 1);
-        strncpy(expiredStr, expiredValue, expiredCopyLength);
-        expiredStr[expiredCopyLength] = '\0';
-        
-        response->expiredAt = (uint32_t)strtoul(expiredStr, NULL, 10);
-    }
-
     printf("✅ [DMS-API] PIN code retrieved successfully\n");
     printf("   PIN Code: %s\n", response->pincode);
     printf("   Expires At: %u\n", response->expiredAt);
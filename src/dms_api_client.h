@@ -37,6 +37,7 @@
 #define DMS_API_MAX_RESPONSE_SIZE     4096
 #define DMS_API_MAX_URL_SIZE          1024
 #define DMS_API_MAX_PAYLOAD_SIZE      4096
+#define DMS_API_JSON_MAX_TOKENS       512
 
 /*-----------------------------------------------------------*/
 
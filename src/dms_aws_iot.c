@@ -9,6 +9,8 @@
  */
 
 #include "dms_aws_iot.h"
+#include "dms_tls.h"
+#include "dms_credentials.h"
 
 /* Standard library includes */
 #include <stdio.h>
@@ -37,11 +39,18 @@ static uint8_t g_network_buffer[2048]; // 使用配置中的 NETWORK_BUFFER_SIZE
 static MQTTPubAckInfo_t g_outgoingPublishRecords[OUTGOING_PUBLISH_RECORD_COUNT];
 static MQTTPubAckInfo_t g_incomingPublishRecords[INCOMING_PUBLISH_RECORD_COUNT];
 
+/* 連線存活追蹤 */
+static aws_iot_link_stats_t g_link_stats = {0};
+static bool g_ping_outstanding = false;
+static uint32_t g_ping_sent_ms = 0;
+
 /*-----------------------------------------------------------*/
 /* 內部函數宣告 */
 
 static dms_result_t convert_mqtt_status_to_dms_result(MQTTStatus_t mqtt_status);
 static dms_result_t convert_openssl_status_to_dms_result(int openssl_status);
+static bool track_keepalive_ping(void);
+static void update_rtt_estimate(uint32_t rtt_ms);
 
 /*-----------------------------------------------------------*/
 /* 公開介面函數實作 */
@@ -85,6 +94,14 @@ dms_result_t dms_aws_iot_init(const dms_config_t* config)
     g_aws_iot_context.fixed_buffer.pBuffer = g_network_buffer;
     g_aws_iot_context.fixed_buffer.size = sizeof(g_network_buffer);
 
+    /* 解析憑證一次，之後每次重連共用 */
+    if (dms_credentials_init(&config->aws_iot) != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️  Failed to preload TLS credentials, will retry on connect");
+    }
+
+    /* 初始化 TLS 傳輸（session 快取） */
+    dms_tls_init(&config->aws_iot);
+
     g_initialized = true;
 
     DMS_LOG_INFO("✅ AWS IoT module initialized successfully");
@@ -157,8 +174,8 @@ dms_result_t dms_aws_iot_establish_tls(void)
     DMS_LOG_DEBUG("   Client Cert: %s", credentials.pClientCertPath);
     DMS_LOG_DEBUG("   Private Key: %s", credentials.pPrivateKeyPath);
 
-    /* 初始化 OpenSSL 連線 - 與原始程式碼完全相同 */
-    OpensslStatus_t opensslStatus = Openssl_Connect(
+    /* 初始化 OpenSSL 連線 - 透過 TLS 傳輸模組，重連時恢復快取的 session */
+    OpensslStatus_t opensslStatus = dms_tls_connect(
         &g_aws_iot_context.network_context,
         &serverInfo,
         &credentials,
@@ -254,6 +271,9 @@ dms_result_t dms_aws_iot_establish_mqtt(void)
     DMS_LOG_MQTT("✅ MQTT connection established successfully");
     DMS_LOG_DEBUG("   Session present: %s", sessionPresent ? "true" : "false");
 
+    /* 新連線不沿用上一條連線的 PINGREQ 狀態 */
+    g_ping_outstanding = false;
+
     return DMS_SUCCESS;
 }
 
@@ -299,6 +319,9 @@ void dms_aws_iot_event_callback(MQTTContext_t* pMqttContext,
                 break;
             case 0x40:  /* PUBACK */
                 DMS_LOG_MQTT("PUBACK received (publish confirmed)");
+                if (g_aws_iot_context.puback_callback != NULL && pDeserializedInfo != NULL) {
+                    g_aws_iot_context.puback_callback(pDeserializedInfo->packetIdentifier);
+                }
                 break;
             default:
                 DMS_LOG_DEBUG("Other MQTT packet type: %d (0x%02X)", packet_type, packet_type);
@@ -310,6 +333,14 @@ void dms_aws_iot_event_callback(MQTTContext_t* pMqttContext,
 dms_result_t dms_aws_iot_publish(const char* topic,
                                 const char* payload,
                                 size_t payload_length)
+{
+    return dms_aws_iot_publish_tracked(topic, payload, payload_length, NULL);
+}
+
+dms_result_t dms_aws_iot_publish_tracked(const char* topic,
+                                        const char* payload,
+                                        size_t payload_length,
+                                        uint16_t* packet_id)
 {
     if (!g_initialized || g_aws_iot_context.state != AWS_IOT_STATE_MQTT_CONNECTED) {
         DMS_LOG_ERROR("❌ AWS IoT not connected");
@@ -349,6 +380,10 @@ dms_result_t dms_aws_iot_publish(const char* topic,
         return convert_mqtt_status_to_dms_result(mqttStatus);
     }
 
+    if (packet_id != NULL) {
+        *packet_id = packetId;
+    }
+
     DMS_LOG_MQTT("✅ Message published successfully");
     return DMS_SUCCESS;
 }
@@ -415,14 +450,29 @@ dms_result_t dms_aws_iot_process_loop(uint32_t timeout_ms)
         DMS_LOG_DEBUG("MQTT_ProcessLoop returned status: %d", mqttStatus);
 
         /* 根據錯誤類型更新狀態 */
-        if (mqttStatus == MQTTRecvFailed || mqttStatus == MQTTSendFailed) {
+        if (mqttStatus == MQTTRecvFailed || mqttStatus == MQTTSendFailed ||
+            mqttStatus == MQTTKeepAliveTimeout) {
             g_aws_iot_context.state = AWS_IOT_STATE_DISCONNECTED;
+            g_link_stats.dead_link_count++;
+            if (mqttStatus == MQTTKeepAliveTimeout) {
+                g_link_stats.ping_timeouts++;
+            }
             DMS_LOG_WARN("🔗 Connection lost detected");
         }
 
         return convert_mqtt_status_to_dms_result(mqttStatus);
     }
 
+    /* PINGRESP 超過 RTT 推算的上限仍未回應，判定為半開連線 */
+    if (!track_keepalive_ping()) {
+        g_aws_iot_context.state = AWS_IOT_STATE_DISCONNECTED;
+        g_link_stats.ping_timeouts++;
+        g_link_stats.dead_link_count++;
+        DMS_LOG_WARN("🔗 Dead link detected: no PINGRESP within %u ms",
+                     dms_aws_iot_get_ping_timeout_ms());
+        return DMS_ERROR_TIMEOUT;
+    }
+
     g_aws_iot_context.last_process_time = Clock_GetTimeMs();
     return DMS_SUCCESS;
 }
@@ -457,6 +507,8 @@ mqtt_interface_t dms_aws_iot_get_interface(void)
         interface.subscribe = dms_aws_iot_subscribe;
         interface.is_connected = dms_aws_iot_is_connected;
         interface.process_loop = dms_aws_iot_process_loop;
+        interface.publish_tracked = dms_aws_iot_publish_tracked;
+        interface.register_puback = dms_aws_iot_register_puback_callback;
     }
 
     return interface;
@@ -488,6 +540,17 @@ void dms_aws_iot_register_message_callback(mqtt_message_callback_t callback)
     }
 }
 
+void dms_aws_iot_register_puback_callback(mqtt_puback_callback_t callback)
+{
+    if (!g_initialized) {
+        DMS_LOG_ERROR("❌ AWS IoT module not initialized before callback registration");
+        return;
+    }
+
+    g_aws_iot_context.puback_callback = callback;
+    DMS_LOG_DEBUG("📝 PUBACK callback %s", (callback != NULL) ? "registered" : "cleared");
+}
+
 
 
 aws_iot_connection_state_t dms_aws_iot_get_state(void)
@@ -530,6 +593,27 @@ dms_result_t dms_aws_iot_disconnect(void)
     return DMS_SUCCESS;
 }
 
+void dms_aws_iot_get_link_stats(aws_iot_link_stats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = g_link_stats;
+    }
+}
+
+uint32_t dms_aws_iot_get_ping_timeout_ms(void)
+{
+    uint32_t upper_ms = (g_config != NULL)
+        ? (uint32_t)g_config->aws_iot.dead_link_timeout_seconds * 1000U
+        : MQTT_DEAD_LINK_TIMEOUT_SECONDS * 1000U;
+
+    if (g_link_stats.pong_count == 0) {
+        return upper_ms;
+    }
+
+    uint32_t timeout_ms = g_link_stats.srtt_ms + 4U * g_link_stats.rttvar_ms;
+    return MIN(MAX(timeout_ms, (uint32_t)MQTT_PING_MIN_TIMEOUT_MS), upper_ms);
+}
+
 void dms_aws_iot_cleanup(void)
 {
     if (!g_initialized) {
@@ -540,6 +624,7 @@ void dms_aws_iot_cleanup(void)
 
     /* 先斷開連接 */
     dms_aws_iot_disconnect();
+    dms_tls_cleanup();
 
     /* 清理內部狀態 */
     memset(&g_aws_iot_context, 0, sizeof(g_aws_iot_context));
@@ -575,6 +660,62 @@ static dms_result_t convert_mqtt_status_to_dms_result(MQTTStatus_t mqtt_status)
     }
 }
 
+/**
+ * @brief 追蹤 coreMQTT 送出的 keepalive PINGREQ
+ *
+ * coreMQTT 在 process loop 內部處理 PINGRESP，不會觸發事件回調，
+ * 因此以 waitingForPingResp 的狀態轉換推算 RTT
+ *
+ * @return false 表示 PINGRESP 逾時，連線應視為中斷
+ */
+static bool track_keepalive_ping(void)
+{
+    const MQTTContext_t* mqtt = &g_aws_iot_context.mqtt_context;
+    uint32_t now_ms = Clock_GetTimeMs();
+
+    if (mqtt->waitingForPingResp) {
+        if (!g_ping_outstanding) {
+            g_ping_outstanding = true;
+            g_ping_sent_ms = mqtt->pingReqSendTimeMs;
+            g_link_stats.ping_count++;
+        } else if (now_ms - g_ping_sent_ms > dms_aws_iot_get_ping_timeout_ms()) {
+            g_ping_outstanding = false;
+            return false;
+        }
+    } else if (g_ping_outstanding) {
+        g_ping_outstanding = false;
+        g_link_stats.pong_count++;
+        update_rtt_estimate(now_ms - g_ping_sent_ms);
+        DMS_LOG_DEBUG("PINGRESP received: rtt=%ums srtt=%ums rttvar=%ums",
+                      g_link_stats.last_rtt_ms, g_link_stats.srtt_ms, g_link_stats.rttvar_ms);
+    }
+
+    return true;
+}
+
+/**
+ * @brief 更新 RTT 統計 - 平滑方式同 RFC 6298
+ */
+static void update_rtt_estimate(uint32_t rtt_ms)
+{
+    g_link_stats.last_rtt_ms = rtt_ms;
+
+    if (g_link_stats.pong_count == 1) {
+        g_link_stats.min_rtt_ms = rtt_ms;
+        g_link_stats.max_rtt_ms = rtt_ms;
+        g_link_stats.srtt_ms = rtt_ms;
+        g_link_stats.rttvar_ms = rtt_ms / 2U;
+        return;
+    }
+
+    uint32_t delta = (rtt_ms > g_link_stats.srtt_ms) ? (rtt_ms - g_link_stats.srtt_ms)
+                                                      : (g_link_stats.srtt_ms - rtt_ms);
+    g_link_stats.min_rtt_ms = MIN(g_link_stats.min_rtt_ms, rtt_ms);
+    g_link_stats.max_rtt_ms = MAX(g_link_stats.max_rtt_ms, rtt_ms);
+    g_link_stats.rttvar_ms = (3U * g_link_stats.rttvar_ms + delta) / 4U;
+    g_link_stats.srtt_ms = (7U * g_link_stats.srtt_ms + rtt_ms) / 8U;
+}
+
 static dms_result_t convert_openssl_status_to_dms_result(int openssl_status)
 {
     /* OpenSSL 狀態碼轉換 */
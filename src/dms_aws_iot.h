@@ -53,6 +53,15 @@ typedef void (*mqtt_message_callback_t)(const char* topic,
                                        const char* payload,
                                        size_t payload_length);
 
+/**
+ * @brief PUBACK 回調函數類型
+ *
+ * 在 dms_aws_iot_process_loop() 中（主迴圈）調用
+ *
+ * @param packet_id 收到 PUBACK 的封包 ID
+ */
+typedef void (*mqtt_puback_callback_t)(uint16_t packet_id);
+
 /**
  * @brief MQTT 介面結構 - 為依賴注入做準備
  * 這個介面將提供給 Shadow 模組使用
@@ -62,6 +71,10 @@ typedef struct {
     dms_result_t (*subscribe)(const char* topic, mqtt_message_callback_t callback);
     bool (*is_connected)(void);
     dms_result_t (*process_loop)(uint32_t timeout_ms);
+    /* 需要確認送達的模組使用：輸出封包 ID，收到 PUBACK 時經 register_puback 註冊的回調通知 */
+    dms_result_t (*publish_tracked)(const char* topic, const char* payload, size_t len,
+                                    uint16_t* packet_id);
+    void (*register_puback)(mqtt_puback_callback_t callback);
 } mqtt_interface_t;
 
 /**
@@ -74,6 +87,24 @@ typedef enum {
     AWS_IOT_STATE_ERROR
 } aws_iot_connection_state_t;
 
+/**
+ * @brief MQTT 連線存活統計
+ *
+ * PINGREQ→PINGRESP 往返時間由 coreMQTT 的 keepalive 狀態推算，
+ * 精度受 dms_aws_iot_process_loop() 呼叫間隔影響
+ */
+typedef struct {
+    uint32_t ping_count;                // 已送出的 PINGREQ
+    uint32_t pong_count;                // 已收到的 PINGRESP
+    uint32_t ping_timeouts;             // PINGRESP 逾時次數
+    uint32_t dead_link_count;           // 判定連線中斷次數
+    uint32_t last_rtt_ms;               // 最近一次 RTT
+    uint32_t min_rtt_ms;                // 最小 RTT
+    uint32_t max_rtt_ms;                // 最大 RTT
+    uint32_t srtt_ms;                   // 平滑 RTT (RFC 6298)
+    uint32_t rttvar_ms;                 // RTT 變異量 (RFC 6298)
+} aws_iot_link_stats_t;
+
 /**
  * @brief AWS IoT 模組上下文
  * 封裝原始的全域變數
@@ -85,6 +116,7 @@ typedef struct {
     aws_iot_connection_state_t state;
     uint32_t last_process_time;
     mqtt_message_callback_t message_callback;
+    mqtt_puback_callback_t puback_callback;
 } aws_iot_context_t;
 
 /*-----------------------------------------------------------*/
@@ -137,6 +169,22 @@ dms_result_t dms_aws_iot_publish(const char* topic,
                                 const char* payload,
                                 size_t payload_length);
 
+/**
+ * @brief 發佈 MQTT 訊息並輸出封包 ID
+ *
+ * 與 dms_aws_iot_publish() 相同 (QoS1)，呼叫者以封包 ID 對應之後的 PUBACK
+ *
+ * @param topic 主題
+ * @param payload 負載
+ * @param payload_length 負載長度
+ * @param packet_id 輸出封包 ID，可為 NULL
+ * @return DMS_SUCCESS 成功，其他為錯誤碼
+ */
+dms_result_t dms_aws_iot_publish_tracked(const char* topic,
+                                        const char* payload,
+                                        size_t payload_length,
+                                        uint16_t* packet_id);
+
 /**
  * @brief 訂閱 MQTT 主題
  *
@@ -203,6 +251,15 @@ mqtt_interface_t dms_aws_iot_get_interface(void);
  */
 void dms_aws_iot_register_message_callback(mqtt_message_callback_t callback);
 
+/**
+ * @brief 註冊 PUBACK 回調函數
+ *
+ * 只保留一個回調，再次註冊時取代；傳入 NULL 取消註冊
+ *
+ * @param callback 回調函數
+ */
+void dms_aws_iot_register_puback_callback(mqtt_puback_callback_t callback);
+
 /**
  * @brief 獲取連接狀態
  *
@@ -210,6 +267,23 @@ void dms_aws_iot_register_message_callback(mqtt_message_callback_t callback);
  */
 aws_iot_connection_state_t dms_aws_iot_get_state(void);
 
+/**
+ * @brief 獲取連線存活統計
+ *
+ * @param stats 輸出統計資訊
+ */
+void dms_aws_iot_get_link_stats(aws_iot_link_stats_t* stats);
+
+/**
+ * @brief 獲取目前的 PINGRESP 等待上限
+ *
+ * 依 RTT 推算 (srtt + 4 * rttvar)，介於 MQTT_PING_MIN_TIMEOUT_MS 與
+ * dead_link_timeout_seconds 之間；尚無 RTT 樣本時使用 dead_link_timeout_seconds
+ *
+ * @return 毫秒
+ */
+uint32_t dms_aws_iot_get_ping_timeout_ms(void);
+
 /**
  * @brief 清理 AWS IoT 模組
  *
@@ -15,10 +15,10 @@
 #include <errno.h>
 #include <sys/sysinfo.h>
 #include <ctype.h>
+#include <poll.h>
 
 /* AWS IoT Device SDK includes */
 #include "core_mqtt.h"
-#include "core_json.h"
 #include "transport_interface.h"
 #include "clock.h"
 
@@ -34,14 +34,25 @@
 /* AWS IOT Module */
 #include "dms_aws_iot.h" 
 
+/* TLS Transport Module */
+#include "dms_tls.h"
+#include "dms_credentials.h"
+
 /* Shadow Module */
 #include "dms_shadow.h"  
+#include "dms_telemetry.h"
+#include "dms_report.h"
+#include "dms_json_writer.h"
+#include "dms_json_index.h"
+#include "dms_json_decode.h"
 
 /* Command Module*/
 #include "dms_command.h"
+#include "dms_control_registry.h"
 
 /* Backoff module */
 #include "dms_reconnect.h"
+#include "dms_uplink.h"
 
 /* DMS API Client */
 #ifdef DMS_API_ENABLED
@@ -74,19 +85,6 @@ struct NetworkContext
 #endif
 */
 
-/*-----------------------------------------------------------*/
-
-/**
- * @brief QoS 相關緩衝區定義
- */
-#define OUTGOING_PUBLISH_RECORD_COUNT    ( 10U )
-#define INCOMING_PUBLISH_RECORD_COUNT    ( 10U )
-
-/* QoS 追蹤用的緩衝區 */
-static MQTTPubAckInfo_t g_outgoingPublishRecords[OUTGOING_PUBLISH_RECORD_COUNT];
-static MQTTPubAckInfo_t g_incomingPublishRecords[INCOMING_PUBLISH_RECORD_COUNT];
-
-
 /*-----------------------------------------------------------*/
 /* 函數宣告 */
 
@@ -107,23 +105,6 @@ static volatile bool g_exitFlag = false;
 static MQTTContext_t g_mqttContext;
 static OpensslParams_t g_opensslParams = { 0 };
 static NetworkContext_t g_networkContext = { .pParams = &g_opensslParams };
-static uint8_t g_networkBuffer[NETWORK_BUFFER_SIZE];
-static MQTTFixedBuffer_t g_fixedBuffer = {
-    .pBuffer = g_networkBuffer,
-    .size = NETWORK_BUFFER_SIZE
-};
-
-/* 重連狀態 */
-static ReconnectState_t g_reconnectState = {
-    .state = CONNECTION_STATE_DISCONNECTED,
-    .retryCount = 0,
-    .nextRetryDelaySeconds = RETRY_BACKOFF_BASE_SECONDS,
-    .lastConnectTime = 0,
-    .totalReconnects = 0
-};
-
-/* Shadow 狀態 */
-static ShadowReportedState_t g_shadowState = { 0 };
 
 /* DMS 命令處理狀態 */
 static DMSCommand_t g_currentCommand = { 0 };
@@ -152,126 +133,9 @@ static int createTestLogFile(const char* filePath);
 static int uploadLogFileToS3(const char* uploadUrl, const char* filePath);
 
 
-static void runMainLoopWithNewModule(void);
+static void waitForNextTick(uint32_t waitMs);
 static int min(int a, int b) { return (a < b) ? a : b; }
 
-
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 解析設備綁定資訊
- */
-static int parseDeviceBindInfo(const char* payload, size_t payloadLength, DeviceBindInfo_t* bindInfo)
-{
-    JSONStatus_t jsonResult;
-    char* valueStart;
-    size_t valueLength;
-
-    if (payload == NULL || bindInfo == NULL || payloadLength == 0) {
-        printf("❌ Invalid parameters for bind info parsing\n");
-        return DMS_ERROR_INVALID_PARAMETER;
-    }
-
-    /* 驗證 JSON 格式 */
-    jsonResult = JSON_Validate((char*)payload, payloadLength);
-    if (jsonResult != JSONSuccess) {
-        printf("❌ Invalid JSON format in Shadow document. Error: %d\n", jsonResult);
-        return DMS_ERROR_SHADOW_FAILURE;
-    }
-
-    printf("🔍 Parsing device bind information from Shadow...\n");
-    DMS_DEBUG_PRINT("Shadow JSON: %.*s", (int)payloadLength, payload);
-
-    /* 初始化綁定資訊 */
-    memset(bindInfo, 0, sizeof(DeviceBindInfo_t));
-    bindInfo->bindStatus = DEVICE_BIND_STATUS_UNKNOWN;
-    bindInfo->lastUpdated = (uint32_t)time(NULL);
-
-    /* 檢查是否存在 info 結構 */
-    jsonResult = JSON_Search((char*)payload, payloadLength,
-                           JSON_QUERY_REPORTED_INFO, strlen(JSON_QUERY_REPORTED_INFO),
-                           &valueStart, &valueLength);
-
-    if (jsonResult != JSONSuccess || valueLength == 0) {
-        printf("📋 No bind info found in Shadow - device is unbound\n");
-        bindInfo->bindStatus = DEVICE_BIND_STATUS_UNBOUND;
-        bindInfo->hasBindInfo = false;
-        return DMS_SUCCESS;
-    }
-
-    printf("✅ Found bind info in Shadow - device is bound\n");
-    bindInfo->bindStatus = DEVICE_BIND_STATUS_BOUND;
-    bindInfo->hasBindInfo = true;
-
-    /* 解析 company_name */
-    jsonResult = JSON_Search((char*)payload, payloadLength,
-                           JSON_QUERY_COMPANY_NAME, strlen(JSON_QUERY_COMPANY_NAME),
-                           &valueStart, &valueLength);
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        size_t copyLength = MIN(valueLength, sizeof(bindInfo->companyName) - 1);
-        strncpy(bindInfo->companyName, valueStart, copyLength);
-        bindInfo->companyName[copyLength] = '\0';
-        /* 移除 JSON 字串的引號 */
-        if (bindInfo->companyName[0] == '"' && bindInfo->companyName[copyLength-1] == '"') {
-            memmove(bindInfo->companyName, bindInfo->companyName + 1, copyLength - 2);
-            bindInfo->companyName[copyLength - 2] = '\0';
-        }
-        printf("   Company Name: %s\n", bindInfo->companyName);
-    }
-
-    /* 解析 added_by */
-    jsonResult = JSON_Search((char*)payload, payloadLength,
-                           JSON_QUERY_ADDED_BY, strlen(JSON_QUERY_ADDED_BY),
-                           &valueStart, &valueLength);
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        size_t copyLength = MIN(valueLength, sizeof(bindInfo->addedBy) - 1);
-        strncpy(bindInfo->addedBy, valueStart, copyLength);
-        bindInfo->addedBy[copyLength] = '\0';
-        /* 移除 JSON 字串的引號 */
-        if (bindInfo->addedBy[0] == '"' && bindInfo->addedBy[copyLength-1] == '"') {
-            memmove(bindInfo->addedBy, bindInfo->addedBy + 1, copyLength - 2);
-            bindInfo->addedBy[copyLength - 2] = '\0';
-        }
-        printf("   Added By: %s\n", bindInfo->addedBy);
-    }
-
-    /* 解析 device_name */
-    jsonResult = JSON_Search((char*)payload, payloadLength,
-                           JSON_QUERY_DEVICE_NAME, strlen(JSON_QUERY_DEVICE_NAME),
-                           &valueStart, &valueLength);
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        size_t copyLength = MIN(valueLength, sizeof(bindInfo->deviceName) - 1);
-        strncpy(bindInfo->deviceName, valueStart, copyLength);
-        bindInfo->deviceName[copyLength] = '\0';
-        /* 移除 JSON 字串的引號 */
-        if (bindInfo->deviceName[0] == '"' && bindInfo->deviceName[copyLength-1] == '"') {
-            memmove(bindInfo->deviceName, bindInfo->deviceName + 1, copyLength - 2);
-            bindInfo->deviceName[copyLength - 2] = '\0';
-        }
-        printf("   Device Name: %s\n", bindInfo->deviceName);
-    }
-
-    /* 解析 company_id */
-    jsonResult = JSON_Search((char*)payload, payloadLength,
-                           JSON_QUERY_COMPANY_ID, strlen(JSON_QUERY_COMPANY_ID),
-                           &valueStart, &valueLength);
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        size_t copyLength = MIN(valueLength, sizeof(bindInfo->companyId) - 1);
-        strncpy(bindInfo->companyId, valueStart, copyLength);
-        bindInfo->companyId[copyLength] = '\0';
-        /* 移除 JSON 字串的引號 */
-        if (bindInfo->companyId[0] == '"' && bindInfo->companyId[copyLength-1] == '"') {
-            memmove(bindInfo->companyId, bindInfo->companyId + 1, copyLength - 2);
-            bindInfo->companyId[copyLength - 2] = '\0';
-        }
-        printf("   Company ID: %s\n", bindInfo->companyId);
-    }
-
-    printf("✅ Device bind info parsed successfully\n");
-    return DMS_SUCCESS;
-}
-
 /*-----------------------------------------------------------*/
 
 /**
@@ -802,83 +666,6 @@ static int waitForShadowGetResponse(MQTTContext_t* pMqttContext, uint32_t timeou
     return DMS_ERROR_TIMEOUT;
 }
 
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 解析 Shadow Delta JSON 訊息
- */
-static int parseShadowDelta(const char* payload, size_t payloadLength, DMSCommand_t* command)
-{
-    JSONStatus_t jsonResult;
-    char* valueStart;
-    size_t valueLength;
-
-    if (payload == NULL || command == NULL || payloadLength == 0) {
-        printf("❌ Invalid parameters for JSON parsing\n");
-        return DMS_ERROR_INVALID_PARAMETER;
-    }
-
-    /* 驗證 JSON 格式 */
-    jsonResult = JSON_Validate(payload, payloadLength);
-    if (jsonResult != JSONSuccess) {
-        printf("❌ Invalid JSON format in Shadow Delta. Error: %d\n", jsonResult);
-        return DMS_ERROR_SHADOW_FAILURE;
-    }
-
-    printf("📋 Parsing Shadow Delta JSON...\n");
-    DMS_DEBUG_PRINT("JSON Payload: %.*s", (int)payloadLength, payload);
-
-    /* 初始化命令結構 */
-    memset(command, 0, sizeof(DMSCommand_t));
-    command->type = DMS_CMD_NONE;
-    command->timestamp = (uint32_t)time(NULL);
-
-    /* 檢查 control-config-change */
-    jsonResult = JSON_Search((char*)payload, payloadLength,
-                           JSON_QUERY_CONTROL_CONFIG, strlen(JSON_QUERY_CONTROL_CONFIG),
-                           &valueStart, &valueLength);
-
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        command->type = DMS_CMD_CONTROL_CONFIG_CHANGE;
-        command->value = (valueStart[0] == '1') ? 1 : 0;
-        SAFE_STRNCPY(command->key, DMS_COMMAND_KEY_CONTROL_CONFIG, sizeof(command->key));
-        printf("🎯 Found control-config-change command: %d\n", command->value);
-        return DMS_SUCCESS;
-    }
-
-    /* 檢查 upload_logs */
-    jsonResult = JSON_Search((char*)payload, payloadLength,
-                           JSON_QUERY_UPLOAD_LOGS, strlen(JSON_QUERY_UPLOAD_LOGS),
-                           &valueStart, &valueLength);
-
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        command->type = DMS_CMD_UPLOAD_LOGS;
-        command->value = (valueStart[0] == '1') ? 1 : 0;
-        SAFE_STRNCPY(command->key, DMS_COMMAND_KEY_UPLOAD_LOGS, sizeof(command->key));
-        printf("📤 Found upload_logs command: %d\n", command->value);
-        return DMS_SUCCESS;
-    }
-
-    /* 檢查 fw_upgrade */
-    jsonResult = JSON_Search((char*)payload, payloadLength,
-                           JSON_QUERY_FW_UPGRADE, strlen(JSON_QUERY_FW_UPGRADE),
-                           &valueStart, &valueLength);
-
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        command->type = DMS_CMD_FW_UPGRADE;
-        command->value = (valueStart[0] == '1') ? 1 : 0;
-        SAFE_STRNCPY(command->key, DMS_COMMAND_KEY_FW_UPGRADE, sizeof(command->key));
-        printf("🔄 Found fw_upgrade command: %d\n", command->value);
-        return DMS_SUCCESS;
-    }
-
-    printf("⚠️  No recognized DMS commands found in Shadow Delta\n");
-    return DMS_ERROR_SHADOW_FAILURE;
-}
-
-
-
-
 /*-----------------------------------------------------------*/
 
 /**
@@ -1088,28 +875,22 @@ static int executeControlConfig(const DMSControlConfig_t* config) {
     printf("🎛️ Executing control: %s = %s (ID: %d)\n", 
            config->item, config->value, config->statusProgressId);
     
-#ifdef BCML_MIDDLEWARE_ENABLED
-    // 使用真實 BCML Middleware 控制
-    printf("🔧 [BCML] Using real middleware for control\n");
-    
-    // 專注於 WiFi 控制項目 (channel2g, channel5g)
-    if (strstr(config->item, "channel") != NULL) {
-        int result = bcml_execute_wifi_control(config->item, config->value);
+    // 已註冊的控制項目交給對應模組處理，其餘保持原有的模擬控制
+    if (dms_control_registry_find(config->item) != NULL) {
+        const char* item = config->item;
+        const char* value = config->value;
+        int result;
+        dms_control_registry_apply(&item, &value, &result, 1);
         if (result == DMS_SUCCESS) {
-            printf("✅ [BCML] WiFi control successful\n");
+            printf("✅ Control successful: %s\n", config->item);
         } else {
-            printf("❌ [BCML] WiFi control failed (error: %d)\n", result);
+            printf("❌ Control failed: %s (error: %d)\n", config->item, result);
         }
         return result;
-    } else {
-        printf("ℹ️  [BCML] Non-WiFi control item, using simulation\n");
-        return executeWiFiSimulatedControl(config->item, config->value);
     }
-#else
-    // 保持原有的模擬控制
-    printf("🎭 [SIMULATE] Using simulation mode\n");
+
+    printf("🎭 [SIMULATE] Unregistered control item, using simulation\n");
     return executeWiFiSimulatedControl(config->item, config->value);
-#endif
 
 
 
@@ -1437,10 +1218,26 @@ static int resetDesiredState(MQTTContext_t* pMqttContext, const char* commandKey
         return DMS_ERROR_INVALID_PARAMETER;
     }
 
-    /* 準備重設 JSON 訊息 */
-    snprintf(payload, sizeof(payload),
-             SHADOW_RESET_COMMAND_JSON_TEMPLATE,
-             commandKey, commandKey);
+    /* 準備重設 JSON 訊息：desired 的命令鍵設為 null，reported 的命令鍵設為 0 */
+    dms_json_writer_t writer;
+    dms_json_writer_init(&writer, payload, sizeof(payload));
+    dms_json_begin_object(&writer);
+    dms_json_key(&writer, "state");
+    dms_json_begin_object(&writer);
+    dms_json_key(&writer, "desired");
+    dms_json_begin_object(&writer);
+    dms_json_kv_null(&writer, commandKey);
+    dms_json_end_object(&writer);
+    dms_json_key(&writer, "reported");
+    dms_json_begin_object(&writer);
+    dms_json_kv_int(&writer, commandKey, 0);
+    dms_json_end_object(&writer);
+    dms_json_end_object(&writer);
+    dms_json_end_object(&writer);
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        printf("❌ Reset payload too large for command: %s\n", commandKey);
+        return DMS_ERROR_BUFFER_OVERFLOW;
+    }
 
     /* 設定發布資訊 */
     publishInfo.qos = MQTTQoS1;
@@ -1448,7 +1245,7 @@ static int resetDesiredState(MQTTContext_t* pMqttContext, const char* commandKey
     publishInfo.pTopicName = SHADOW_UPDATE_TOPIC;
     publishInfo.topicNameLength = strlen(SHADOW_UPDATE_TOPIC);
     publishInfo.pPayload = payload;
-    publishInfo.payloadLength = strlen(payload);
+    publishInfo.payloadLength = dms_json_writer_length(&writer);
 
     /* 生成封包 ID */
     packetId = MQTT_GetPacketId(pMqttContext);
@@ -1487,11 +1284,26 @@ static int reportCommandResult(MQTTContext_t* pMqttContext, const char* commandK
         return DMS_ERROR_INVALID_PARAMETER;
     }
 
-    /* 準備結果回報 JSON 訊息 */
-    snprintf(payload, sizeof(payload),
-             SHADOW_COMMAND_RESULT_JSON_TEMPLATE,
-             commandKey, (int)result,
-             commandKey, timestamp);
+    /* 準備結果回報 JSON 訊息："<key>_result" 與 "<key>_timestamp" */
+    char resultKey[128];
+    dms_json_writer_t writer;
+    dms_json_writer_init(&writer, payload, sizeof(payload));
+    dms_json_begin_object(&writer);
+    dms_json_key(&writer, "state");
+    dms_json_begin_object(&writer);
+    dms_json_key(&writer, "reported");
+    dms_json_begin_object(&writer);
+    snprintf(resultKey, sizeof(resultKey), "%s_result", commandKey);
+    dms_json_kv_int(&writer, resultKey, (int)result);
+    snprintf(resultKey, sizeof(resultKey), "%s_timestamp", commandKey);
+    dms_json_kv_uint(&writer, resultKey, timestamp);
+    dms_json_end_object(&writer);
+    dms_json_end_object(&writer);
+    dms_json_end_object(&writer);
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        printf("❌ Result payload too large for command: %s\n", commandKey);
+        return DMS_ERROR_BUFFER_OVERFLOW;
+    }
 
     /* 設定發布資訊 */
     publishInfo.qos = MQTTQoS1;
@@ -1499,7 +1311,7 @@ static int reportCommandResult(MQTTContext_t* pMqttContext, const char* commandK
     publishInfo.pTopicName = SHADOW_UPDATE_TOPIC;
     publishInfo.topicNameLength = strlen(SHADOW_UPDATE_TOPIC);
     publishInfo.pPayload = payload;
-    publishInfo.payloadLength = strlen(payload);
+    publishInfo.payloadLength = dms_json_writer_length(&writer);
 
     /* 生成封包 ID */
     packetId = MQTT_GetPacketId(pMqttContext);
@@ -1521,54 +1333,6 @@ static int reportCommandResult(MQTTContext_t* pMqttContext, const char* commandK
 
 /*-----------------------------------------------------------*/
 
-/**
- * @brief 獲取系統運行時間
- */
-static uint32_t getSystemUptime(void)
-{
-    struct sysinfo info;
-    if (sysinfo(&info) == 0) {
-        return (uint32_t)info.uptime;
-    }
-    return 0;
-}
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 獲取系統狀態資訊
- */
-static void updateSystemStats(ShadowReportedState_t *state)
-{
-    struct sysinfo info;
-
-    /* 更新基本資訊 */
-    SAFE_STRNCPY(state->deviceId, CLIENT_IDENTIFIER, sizeof(state->deviceId));
-    SAFE_STRNCPY(state->deviceType, DEVICE_TYPE, sizeof(state->deviceType));
-    SAFE_STRNCPY(state->firmwareVersion, FIRMWARE_VERSION, sizeof(state->firmwareVersion));
-    state->connected = true;
-    state->status = DEVICE_STATUS_ONLINE;
-    state->uptime = getSystemUptime();
-    state->lastHeartbeat = (uint32_t)time(NULL);
-
-    /* 獲取系統資訊 */
-    if (sysinfo(&info) == 0) {
-        /* CPU 使用率 (簡化版本) */
-        state->cpuUsage = 0.0; // TODO: 實現真實的 CPU 使用率計算
-
-        /* 記憶體使用率 */
-        if (info.totalram > 0) {
-            state->memoryUsage = (float)(info.totalram - info.freeram) / info.totalram * 100.0;
-        }
-    }
-
-    /* 網路統計 (簡化版本) */
-    state->networkBytesSent = 0;    // TODO: 從 /proc/net/dev 讀取
-    state->networkBytesReceived = 0;
-}
-
-/*-----------------------------------------------------------*/
-
 /**
  * @brief 信號處理函數
  */
@@ -1580,614 +1344,21 @@ static void signalHandler(int signal)
     }
 }
 
-/*-----------------------------------------------------------*/
-
-/**
- * @brief MQTT 事件回調函數
- */
-static void eventCallback(MQTTContext_t *pMqttContext,
-                         MQTTPacketInfo_t *pPacketInfo,
-                         MQTTDeserializedInfo_t *pDeserializedInfo)
-{
-    uint16_t packetIdentifier;
-    const char* topicName = NULL;
-    uint16_t topicLength = 0;
-
-    (void)pMqttContext;
-    packetIdentifier = pDeserializedInfo->packetIdentifier;
-
-    /* 獲取主題資訊 */
-    if (pDeserializedInfo->pPublishInfo != NULL) {
-        topicName = pDeserializedInfo->pPublishInfo->pTopicName;
-        topicLength = pDeserializedInfo->pPublishInfo->topicNameLength;
-    }
-
-    switch (pPacketInfo->type) {
-        case MQTT_PACKET_TYPE_SUBACK:
-            printf("✓ SUBACK received for packet ID %u\n", packetIdentifier);
-            break;
-
-        case MQTT_PACKET_TYPE_PUBLISH:
-        case 50: /* AWS IoT Core uses packet type 50 for PUBLISH messages instead of standard MQTT_PACKET_TYPE_PUBLISH (48).
-                  * This appears to be an AWS IoT specific implementation detail where they use extended packet types
-                  * for their cloud service. We handle both types to ensure compatibility with standard MQTT
-                  * and AWS IoT Core specific implementations. */
-            printf("📨 PUBLISH received (type %u):\n", pPacketInfo->type);
-            printf("   Topic: %.*s\n", topicLength, topicName);
-            printf("   Payload Length: %u\n", (unsigned int)pDeserializedInfo->pPublishInfo->payloadLength);
-
-            /* 顯示 payload 預覽 (前 200 字元) */
-            int previewLength = MIN(200, (int)pDeserializedInfo->pPublishInfo->payloadLength);
-            printf("   Payload Preview: %.*s\n", previewLength, (char *)pDeserializedInfo->pPublishInfo->pPayload);
-
-            /* 處理 Shadow 回應和 Delta 訊息 */
-            if (topicName != NULL) {
-                printf("🔍 Topic matching analysis:\n");
-
-                /* 檢查 shadow/update/accepted */
-                bool isUpdateAccepted = (strstr(topicName, "/shadow/update/accepted") != NULL);
-                printf("   update/accepted: %s\n", isUpdateAccepted ? "✅ MATCH" : "❌ no match");
-
-                /* 檢查 shadow/update/rejected */
-                bool isUpdateRejected = (strstr(topicName, "/shadow/update/rejected") != NULL);
-                printf("   update/rejected: %s\n", isUpdateRejected ? "✅ MATCH" : "❌ no match");
-
-                /* 檢查 shadow/update/delta */
-                bool isUpdateDelta = (strstr(topicName, "/shadow/update/delta") != NULL);
-                printf("   update/delta: %s\n", isUpdateDelta ? "✅ MATCH" : "❌ no match");
-
-                /* 檢查 shadow/get/accepted */
-                bool isGetAccepted = (strstr(topicName, "/shadow/get/accepted") != NULL);
-                printf("   get/accepted: %s\n", isGetAccepted ? "✅ MATCH" : "❌ no match");
-
-                /* 檢查 shadow/get/rejected */
-                bool isGetRejected = (strstr(topicName, "/shadow/get/rejected") != NULL);
-                printf("   get/rejected: %s\n", isGetRejected ? "✅ MATCH" : "❌ no match");
-
-                if (isUpdateAccepted) {
-                    printf("🔄 Shadow update accepted\n");
-                } else if (isUpdateRejected) {
-                    printf("❌ Shadow update rejected\n");
-                } else if (isUpdateDelta) {
-               
-		    DMS_LOG_SHADOW("🔃 Shadow delta received - processing DMS command...");
-                    
-                    /* 🆕 使用新的命令處理模組 - 一個函數搞定所有邏輯 */
-                    dms_result_t cmdResult = dms_command_process_shadow_delta(
-                        topicName,
-                        (char *)pDeserializedInfo->pPublishInfo->pPayload,
-                        pDeserializedInfo->pPublishInfo->payloadLength
-                    );
-                    
-                    if (cmdResult == DMS_SUCCESS) {
-                        printf("✅ DMS command processed successfully via new command module\n");
-                        DMS_LOG_INFO("✅ Shadow delta command executed successfully");
-                    } else {
-                        printf("❌ DMS command processing failed via new command module: %d\n", cmdResult);
-                        DMS_LOG_ERROR("❌ Failed to process Shadow delta command: %d", cmdResult);
-                    }       
-	
-		} else if (isGetAccepted) {
-                    printf("✅ Shadow get accepted - processing device binding info\n");
-
-                    /* 解析 Shadow 文檔並檢查綁定狀態 */
-                    int parseResult = parseDeviceBindInfo(
-                        (char *)pDeserializedInfo->pPublishInfo->pPayload,
-                        pDeserializedInfo->pPublishInfo->payloadLength,
-                        &g_deviceBindInfo
-                    );
-
-                    if (parseResult == DMS_SUCCESS) {
-                        if (isDeviceBound(&g_deviceBindInfo)) {
-                            printf("🎯 Device is bound to DMS Server\n");
-                            printf("   Company: %s (ID: %s)\n",
-                                   g_deviceBindInfo.companyName, g_deviceBindInfo.companyId);
-                            printf("   Device: %s (Added by: %s)\n",
-                                   g_deviceBindInfo.deviceName, g_deviceBindInfo.addedBy);
-                        } else {
-			    DMS_LOG_WARN("▒~_~S~K Device is not bound to DMS Server");
-                            printf("   Registration required for DMS functionality\n");
-                            /* TODO: 觸發 DMS Server 註冊流程 */
-                        }
-                    } else {
-                        printf("⚠️  Failed to parse bind info from Shadow Get response\n");
-                    }
-
-                    /* 標記 Shadow Get 已接收 */
-                    g_shadowGetReceived = true;
-                    g_shadowGetPending = false;
-                    printf("🔔 Shadow Get status updated: received=true, pending=false\n");
-                } else if (isGetRejected) {
-                    printf("❌ Shadow get rejected\n");
-
-                    /* 標記 Shadow Get 失敗 */
-                    g_shadowGetReceived = false;
-                    g_shadowGetPending = false;
-                    printf("🔔 Shadow Get status updated: received=false, pending=false\n");
-                } else {
-                    printf("❓ Unknown shadow topic or non-shadow message\n");
-                    printf("   Full topic: %.*s\n", topicLength, topicName);
-                }
-            } else {
-                printf("⚠️  Topic name is NULL\n");
-            }
-            break;
-
-        case MQTT_PACKET_TYPE_PUBACK:
-            printf("✓ PUBACK received for packet ID %u\n", packetIdentifier);
-            break;
-
-        case MQTT_PACKET_TYPE_UNSUBACK:
-            printf("✓ UNSUBACK received for packet ID %u\n", packetIdentifier);
-            break;
-
-        default:
-            /* 處理非 PUBLISH 類型的封包 */
-            printf("📦 Other packet type %u received\n", pPacketInfo->type);
-
-            /* 如果是未知的 PUBLISH 類型變體，提供診斷資訊 */
-            if (pDeserializedInfo->pPublishInfo != NULL) {
-                printf("⚠️  Warning: Packet type %u has PublishInfo but is not handled as PUBLISH\n", pPacketInfo->type);
-                printf("   This might be a new AWS IoT packet type variant\n");
-                printf("   Topic: %.*s\n",
-                       pDeserializedInfo->pPublishInfo->topicNameLength,
-                       pDeserializedInfo->pPublishInfo->pTopicName);
-            }
-            break;
-    }
-}
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 建立 TLS 連線
- */
-static int establishTlsConnection(NetworkContext_t *pNetworkContext)
-{
-#ifdef USE_OPENSSL
-    int returnStatus = EXIT_SUCCESS;
-    OpensslStatus_t opensslStatus;
-    ServerInfo_t serverInfo = { 0 };
-    OpensslCredentials_t credentials = { 0 };
-
-    DMS_LOG_TLS("🔐 Establishing TLS connection...");
-
-    printf("   Endpoint: %s:%d\n", AWS_IOT_ENDPOINT, AWS_MQTT_PORT);
-
-    /* 設定伺服器資訊 */
-    serverInfo.pHostName = AWS_IOT_ENDPOINT;
-    serverInfo.hostNameLength = strlen(AWS_IOT_ENDPOINT);
-    serverInfo.port = AWS_MQTT_PORT;
-
-    /* 設定 OpenSSL 憑證資訊 */
-    credentials.pAlpnProtos = NULL;
-    credentials.alpnProtosLen = 0;
-    credentials.sniHostName = NULL;
-    credentials.maxFragmentLength = 0;
-    credentials.pRootCaPath = ROOT_CA_CERT_PATH;
-    credentials.pClientCertPath = CLIENT_CERT_PATH;
-    credentials.pPrivateKeyPath = CLIENT_PRIVATE_KEY_PATH;
-
-    /* 初始化 OpenSSL 連線 */
-    opensslStatus = Openssl_Connect(pNetworkContext,
-                                   &serverInfo,
-                                   &credentials,
-                                   TRANSPORT_SEND_RECV_TIMEOUT_MS,
-                                   TRANSPORT_SEND_RECV_TIMEOUT_MS);
-
-    if (opensslStatus != OPENSSL_SUCCESS) {
-	DMS_LOG_ERROR("❌ Failed to establish TLS connection");
-        returnStatus = EXIT_FAILURE;
-    } else {
-	DMS_LOG_TLS("✅ TLS connection established successfully");
-        g_reconnectState.lastConnectTime = (uint32_t)time(NULL);
-    }
-
-    return returnStatus;
-#else
-    printf("❌ Error: OpenSSL support not compiled in\n");
-    return EXIT_FAILURE;
-#endif
-}
-
-/*-----------------------------------------------------------*/
-
 /**
- * @brief 建立 MQTT 連線
+ * @brief 主迴圈等待到下一輪
+ *
+ * 最多等待 1 秒，重連等待期間遙測、命令與回報照常處理；
+ * 收到 rtnetlink 事件或信號時 poll() 提前返回
  */
-static int establishMqttConnection(MQTTContext_t *pMqttContext,
-                                 NetworkContext_t *pNetworkContext)
+static void waitForNextTick(uint32_t waitMs)
 {
-    int returnStatus = EXIT_SUCCESS;
-    MQTTStatus_t mqttStatus;
-    MQTTConnectInfo_t connectInfo = { 0 };
-    bool sessionPresent = false;
-
-    printf("🔌 Establishing MQTT connection...\n");
-    printf("   Client ID: %s\n", CLIENT_IDENTIFIER);
-
-    /* 設定傳輸介面 */
-    TransportInterface_t transportInterface = { 0 };
-    transportInterface.pNetworkContext = pNetworkContext;
-#ifdef USE_OPENSSL
-    transportInterface.send = Openssl_Send;
-    transportInterface.recv = Openssl_Recv;
-#endif
-
-    /* 初始化 MQTT 上下文 */
-    mqttStatus = MQTT_Init(pMqttContext, &transportInterface,
-                          Clock_GetTimeMs, eventCallback, &g_fixedBuffer);
-
-    if (mqttStatus != MQTTSuccess) {
-        printf("❌ Failed to initialize MQTT context. Status: %d\n", mqttStatus);
-        return EXIT_FAILURE;
-    }
-
-    /* 初始化 QoS1/QoS2 狀態追蹤 */
-    mqttStatus = MQTT_InitStatefulQoS(pMqttContext,
-                                     g_outgoingPublishRecords,
-                                     OUTGOING_PUBLISH_RECORD_COUNT,
-                                     g_incomingPublishRecords,
-                                     INCOMING_PUBLISH_RECORD_COUNT);
-
-    if (mqttStatus != MQTTSuccess) {
-        printf("❌ Failed to initialize stateful QoS. Status: %d\n", mqttStatus);
-        return EXIT_FAILURE;
-    } else {
-        printf("✅ QoS1/QoS2 support initialized\n");
+    if (waitMs > 1000U) {
+        waitMs = 1000U;
     }
-
-    /* 設定連線資訊 */
-    connectInfo.cleanSession = true;
-    connectInfo.pClientIdentifier = CLIENT_IDENTIFIER;
-    connectInfo.clientIdentifierLength = strlen(CLIENT_IDENTIFIER);
-    connectInfo.keepAliveSeconds = MQTT_KEEP_ALIVE_INTERVAL_SECONDS;
-
-    /* 建立 MQTT 連線 */
-    mqttStatus = MQTT_Connect(pMqttContext, &connectInfo,
-                             NULL, CONNACK_RECV_TIMEOUT_MS, &sessionPresent);
-
-    if (mqttStatus != MQTTSuccess) {
-        printf("❌ Failed to connect to MQTT broker. Status: %d\n", mqttStatus);
-        returnStatus = EXIT_FAILURE;
-    } else {
-        printf("✅ MQTT connection established successfully\n");
-        printf("   Session present: %s\n", sessionPresent ? "true" : "false");
-        g_reconnectState.state = CONNECTION_STATE_CONNECTED;
-        g_reconnectState.retryCount = 0; // 重設重連計數
-        g_reconnectState.nextRetryDelaySeconds = RETRY_BACKOFF_BASE_SECONDS;
+    if (waitMs > 0) {
+        struct pollfd pfd = { .fd = dms_uplink_get_fd(), .events = POLLIN };
+        poll(&pfd, pfd.fd >= 0 ? 1 : 0, (int)waitMs);
     }
-
-    return returnStatus;
-}
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 訂閱 Shadow 主題
- */
-static int subscribeToShadowTopics(MQTTContext_t *pMqttContext)
-{
-    MQTTStatus_t mqttStatus;
-    MQTTSubscribeInfo_t subscribeInfo[5];  // 增加到 5 個主題
-    uint16_t packetId;
-    int subscribeCount = 0;
-
-    printf("📡 Subscribing to Shadow topics...\n");
-
-    /* 設定訂閱資訊 */
-    /* 1. Shadow update accepted */
-    subscribeInfo[subscribeCount].qos = MQTTQoS1;
-    subscribeInfo[subscribeCount].pTopicFilter = SHADOW_UPDATE_ACCEPTED_TOPIC;
-    subscribeInfo[subscribeCount].topicFilterLength = strlen(SHADOW_UPDATE_ACCEPTED_TOPIC);
-    subscribeCount++;
-
-    /* 2. Shadow update rejected */
-    subscribeInfo[subscribeCount].qos = MQTTQoS1;
-    subscribeInfo[subscribeCount].pTopicFilter = SHADOW_UPDATE_REJECTED_TOPIC;
-    subscribeInfo[subscribeCount].topicFilterLength = strlen(SHADOW_UPDATE_REJECTED_TOPIC);
-    subscribeCount++;
-
-    /* 3. Shadow update delta */
-    subscribeInfo[subscribeCount].qos = MQTTQoS1;
-    subscribeInfo[subscribeCount].pTopicFilter = SHADOW_UPDATE_DELTA_TOPIC;
-    subscribeInfo[subscribeCount].topicFilterLength = strlen(SHADOW_UPDATE_DELTA_TOPIC);
-    subscribeCount++;
-
-    /* 4. Shadow get accepted */
-    subscribeInfo[subscribeCount].qos = MQTTQoS1;
-    subscribeInfo[subscribeCount].pTopicFilter = SHADOW_GET_ACCEPTED_TOPIC;
-    subscribeInfo[subscribeCount].topicFilterLength = strlen(SHADOW_GET_ACCEPTED_TOPIC);
-    subscribeCount++;
-
-    /* 5. Shadow get rejected */
-    subscribeInfo[subscribeCount].qos = MQTTQoS1;
-    subscribeInfo[subscribeCount].pTopicFilter = SHADOW_GET_REJECTED_TOPIC;
-    subscribeInfo[subscribeCount].topicFilterLength = strlen(SHADOW_GET_REJECTED_TOPIC);
-    subscribeCount++;
-
-    /* 生成封包 ID */
-    packetId = MQTT_GetPacketId(pMqttContext);
-
-    /* 訂閱主題 */
-    mqttStatus = MQTT_Subscribe(pMqttContext, subscribeInfo, subscribeCount, packetId);
-
-    if (mqttStatus != MQTTSuccess) {
-        printf("❌ Failed to subscribe to Shadow topics. Status: %d\n", mqttStatus);
-        return EXIT_FAILURE;
-    }
-
-    printf("✅ Shadow topics subscription sent successfully (Packet ID: %u)\n", packetId);
-    printf("   Subscribed to %d Shadow topics\n", subscribeCount);
-
-    /* 等待訂閱確認 - 增加等待時間確保所有訂閱完成 */
-    printf("⏳ Waiting for subscription confirmations...\n");
-    for (int i = 0; i < 10; i++) {  // 增加到 10 次迴圈
-        MQTT_ProcessLoop(pMqttContext);
-        usleep(300000); // 增加到 300ms
-    }
-
-    printf("✅ Shadow topics subscription completed\n");
-    return EXIT_SUCCESS;
-}
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 發布 Shadow 更新
- */
-static int publishShadowUpdate(MQTTContext_t *pMqttContext)
-{
-    MQTTStatus_t mqttStatus;
-    MQTTPublishInfo_t publishInfo = { 0 };
-    uint16_t packetId;
-    char payload[512];
-
-    /* 更新系統狀態 */
-    updateSystemStats(&g_shadowState);
-
-    /* 準備 Shadow JSON 訊息 */
-    snprintf(payload, sizeof(payload),
-             SHADOW_REPORTED_JSON_TEMPLATE,
-             g_shadowState.connected ? "true" : "false",
-             "online",  // status
-             g_shadowState.uptime,
-             g_shadowState.lastHeartbeat,
-             g_shadowState.firmwareVersion,
-             g_shadowState.deviceType,
-             g_shadowState.cpuUsage,
-             g_shadowState.memoryUsage,
-             g_shadowState.networkBytesSent,
-             g_shadowState.networkBytesReceived);
-
-    /* 設定發布資訊 */
-    publishInfo.qos = MQTTQoS1;
-    publishInfo.retain = false;
-    publishInfo.pTopicName = SHADOW_UPDATE_TOPIC;
-    publishInfo.topicNameLength = strlen(SHADOW_UPDATE_TOPIC);
-    publishInfo.pPayload = payload;
-    publishInfo.payloadLength = strlen(payload);
-
-    /* 生成封包 ID */
-    packetId = MQTT_GetPacketId(pMqttContext);
-
-    printf("📤 Publishing Shadow update...\n");
-    printf("   Topic: %s\n", SHADOW_UPDATE_TOPIC);
-    DMS_DEBUG_PRINT("Payload: %s", payload);
-
-    /* 發布訊息 */
-    mqttStatus = MQTT_Publish(pMqttContext, &publishInfo, packetId);
-
-    if (mqttStatus != MQTTSuccess) {
-        printf("❌ Failed to publish Shadow update. Status: %d\n", mqttStatus);
-        return EXIT_FAILURE;
-    }
-
-    printf("✅ Shadow update published successfully (Packet ID: %u)\n", packetId);
-    return EXIT_SUCCESS;
-}
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 重連函數 - 使用新的 AWS IoT 和 Shadow 模組
- */
-static int attemptReconnection(void)
-{
-    int result = EXIT_FAILURE;
-
-    printf("🔄 Attempting reconnection via new module (attempt %u/%u)...\n",
-           g_reconnectState.retryCount + 1, MAX_RETRY_ATTEMPTS);
-
-    g_reconnectState.state = CONNECTION_STATE_RECONNECTING;
-
-    /* 🆕 使用新模組進行清理和斷線 */
-    dms_aws_iot_disconnect();
-
-    /* 延遲重連 */
-    if (g_reconnectState.retryCount > 0) {
-        printf("⏳ Waiting %u seconds before reconnection...\n",
-               g_reconnectState.nextRetryDelaySeconds);
-        sleep(g_reconnectState.nextRetryDelaySeconds);
-    }
-
-    /* 🆕 使用新模組重新建立連接 */
-    if (dms_aws_iot_connect() == DMS_SUCCESS) {
-        printf("✅ AWS IoT reconnection successful via new module\n");
-        
-        /* 🆕 重新啟動 Shadow 服務（使用新模組）*/
-        if (dms_shadow_start() == DMS_SUCCESS) {
-            printf("✅ Shadow service restarted successfully\n");
-            
-            /* 等待 Shadow Get 回應 */
-            if (dms_shadow_wait_get_response(SHADOW_GET_TIMEOUT_MS) == DMS_SUCCESS) {
-                printf("✅ Reconnection and Shadow sync successful!\n");
-                g_reconnectState.totalReconnects++;
-                result = EXIT_SUCCESS;
-            } else {
-                printf("⚠️  Reconnection successful but Shadow sync timeout\n");
-                g_reconnectState.totalReconnects++;
-                result = EXIT_SUCCESS; // 仍然算成功，因為連接已建立
-            }
-        } else {
-            printf("❌ Reconnection successful but Shadow restart failed\n");
-            result = EXIT_FAILURE;
-        }
-    } else {
-        printf("❌ AWS IoT reconnection failed via new module\n");
-        result = EXIT_FAILURE;
-    }
-
-    /* 更新重連狀態 */
-    if (result == EXIT_SUCCESS) {
-        g_reconnectState.state = CONNECTION_STATE_CONNECTED;
-        g_reconnectState.retryCount = 0;
-        g_reconnectState.nextRetryDelaySeconds = RETRY_BACKOFF_BASE_SECONDS;
-        g_reconnectState.lastConnectTime = (uint32_t)time(NULL);
-        
-        printf("🎯 Connection restored successfully\n");
-        printf("   Total reconnects: %u\n", g_reconnectState.totalReconnects);
-    } else {
-        g_reconnectState.state = CONNECTION_STATE_ERROR;
-        g_reconnectState.retryCount++;
-        g_reconnectState.nextRetryDelaySeconds = CALCULATE_BACKOFF_DELAY(g_reconnectState.retryCount);
-        
-        printf("❌ Reconnection failed (attempt %u/%u)\n",
-               g_reconnectState.retryCount, MAX_RETRY_ATTEMPTS);
-        
-        if (g_reconnectState.retryCount >= MAX_RETRY_ATTEMPTS) {
-            printf("💀 Maximum reconnection attempts reached, giving up\n");
-            g_reconnectState.state = CONNECTION_STATE_ERROR;
-        }
-    }
-
-    return result;
-}
-
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 主迴圈 - 增強版本支援重連
- */
-static void runMainLoop(MQTTContext_t *pMqttContext)
-{
-    MQTTStatus_t mqttStatus;
-    uint32_t loopCount = 0;
-    uint32_t lastHeartbeatTime = 0;
-
-    printf("🔄 Entering main loop with auto-reconnect...\n");
-    printf("   Press Ctrl+C to exit gracefully\n");
-
-    while (!g_exitFlag) {
-        /* 檢查連線狀態 */
-        if (g_reconnectState.state == CONNECTION_STATE_CONNECTED) {
-            /* 處理 MQTT 事件 */
-            mqttStatus = MQTT_ProcessLoop(pMqttContext);
-
-            if (mqttStatus != MQTTSuccess) {
-                printf("❌ MQTT_ProcessLoop failed with status: %d\n", mqttStatus);
-
-                /* 根據錯誤類型決定是否重連 */
-                if (mqttStatus == MQTTRecvFailed || mqttStatus == MQTTSendFailed) {
-                    printf("🔗 Connection lost, initiating reconnection...\n");
-                    g_reconnectState.state = CONNECTION_STATE_DISCONNECTED;
-                } else {
-                    printf("💥 Unrecoverable MQTT error, exiting...\n");
-                    break;
-                }
-            }
-        }
-
-        /* 處理重連邏輯 */
-        if (g_reconnectState.state == CONNECTION_STATE_DISCONNECTED ||
-            g_reconnectState.state == CONNECTION_STATE_ERROR) {
-
-            if (g_reconnectState.retryCount < MAX_RETRY_ATTEMPTS) {
-                if (attemptReconnection() != EXIT_SUCCESS) {
-                    /* 重連失敗，等待後續嘗試 */
-                    sleep(1);
-                    continue;
-                }
-            } else {
-                printf("💀 Maximum reconnection attempts (%u) exceeded, giving up...\n",
-                       MAX_RETRY_ATTEMPTS);
-                break;
-            }
-        }
-
-        /* 正常運行時的週期性任務 */
-        if (g_reconnectState.state == CONNECTION_STATE_CONNECTED) {
-            loopCount++;
-
-            /* 每 60 秒發送 Shadow 更新 */
-            uint32_t currentTime = (uint32_t)time(NULL);
-            if (currentTime - lastHeartbeatTime >= 60) {
-                printf("💓 Sending periodic Shadow update...\n");
-                if (publishShadowUpdate(pMqttContext) == EXIT_SUCCESS) {
-                    lastHeartbeatTime = currentTime;
-                } else {
-                    printf("⚠️  Failed to send Shadow update\n");
-                }
-            }
-
-            /* 每 10 秒顯示狀態 */
-            if (loopCount % 10 == 0) {
-                printf("📊 Loop: %u | Connected: %us | Reconnects: %u\n",
-                       loopCount,
-                       currentTime - g_reconnectState.lastConnectTime,
-                       g_reconnectState.totalReconnects);
-            }
-        }
-
-        /* 短暫休眠 */
-        sleep(1);
-    }
-
-    printf("🛑 Exiting main loop\n");
-}
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief 清理資源
- */
-static void cleanup(MQTTContext_t *pMqttContext, NetworkContext_t *pNetworkContext)
-{
-    MQTTStatus_t mqttStatus;
-
-    printf("🧹 Cleaning up resources...\n");
-
-    /* 如果連線中，發送離線狀態到 Shadow */
-    if (g_reconnectState.state == CONNECTION_STATE_CONNECTED) {
-        g_shadowState.connected = false;
-        g_shadowState.status = DEVICE_STATUS_OFFLINE;
-
-        printf("📤 Sending offline status to Shadow...\n");
-        if (publishShadowUpdate(pMqttContext) == EXIT_SUCCESS) {
-            /* 等待訊息送出 */
-            for (int i = 0; i < 5; i++) {
-                MQTT_ProcessLoop(pMqttContext);
-                usleep(100000); // 100ms
-            }
-        }
-    }
-
-    /* 斷開 MQTT 連線 */
-    mqttStatus = MQTT_Disconnect(pMqttContext);
-    if (mqttStatus != MQTTSuccess) {
-        printf("⚠️  Failed to disconnect MQTT cleanly. Status: %d\n", mqttStatus);
-    } else {
-        printf("✅ MQTT disconnected cleanly\n");
-    }
-
-#ifdef USE_OPENSSL
-    /* 斷開 TLS 連線 */
-    Openssl_Disconnect(pNetworkContext);
-    printf("✅ TLS connection closed\n");
-#endif
-
-    printf("✅ Cleanup completed\n");
 }
 
 /*-----------------------------------------------------------*/
@@ -2319,6 +1490,7 @@ static int runConnectionTest(void)
         if (dms_aws_iot_process_loop(1000) != DMS_SUCCESS) {
             printf("⚠️  Event loop processing warning\n");
         }
+        dms_shadow_process();
         
         /* 每 2 秒顯示狀態 */
         static time_t last_status = 0;
@@ -2609,11 +1781,7 @@ int main(int argc, char **argv)
         goto cleanup;
     }
     
-    /* 註冊 BCML 處理器（如果啟用）- 保持原有邏輯 */
-#ifdef BCML_MIDDLEWARE_ENABLED
-    dms_command_register_bcml_handler(bcml_execute_wifi_control);
-    DMS_LOG_INFO("✅ BCML command handler registered");
-#endif
+    /* 控制項目由各模組初始化時註冊到 dms_control_registry（BCML 見 bcml_adapter_init） */
     printf("✅ Command module initialized successfully\n");
 
     /* === 步驟1.8：Shadow 模組初始化 - 保持原有邏輯 === */
@@ -2631,6 +1799,16 @@ int main(int argc, char **argv)
     
     printf("✅ Shadow module initialized successfully\n");
 
+    /* 遙測取樣與批次上傳 - 使用 Shadow 模組初始化的系統統計取樣器 */
+    if (dms_telemetry_init(&mqtt_if) != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ Telemetry initialization failed, continuing without telemetry");
+    }
+
+    /* 進度與裝置資訊的 MQTT 回報通道 - 未開啟的端點仍走 HTTP */
+    if (dms_report_init(&mqtt_if) != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ Report channel initialization failed, all reports will use HTTP");
+    }
+
     /* 
      * ✅ 重要：Message Callback 已經在 dms_shadow_init() 中自動註冊
      * 不需要手動註冊，因為 shadow_message_handler 是 static 函數
@@ -2649,6 +1827,11 @@ int main(int argc, char **argv)
                  (void*)reconnect_interface.restart_shadow);
     printf("✅ Reconnect module initialized successfully\n");
 
+    /* WAN 恢復時不等退避延遲，直接安排重連 */
+    if (dms_uplink_init(dms_reconnect_uplink_restored) != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ Uplink monitor unavailable, reconnection relies on backoff only");
+    }
+
 #ifdef BCML_MIDDLEWARE_ENABLED
     printf("✅ BCML adapter initialized\n");
 #endif
@@ -2755,30 +1938,45 @@ int main(int argc, char **argv)
 
     /* 主循環 - 保持原有邏輯 */
     while (!g_exitFlag) {
-        /* MQTT 事件處理 */
-        if (dms_aws_iot_process_loop(1000) != DMS_SUCCESS) {
-            DMS_LOG_WARN("⚠️ MQTT process loop failed, attempting reconnection...");
-            
-            /* 嘗試重連 */
-            if (dms_reconnect_attempt() == DMS_SUCCESS) {
+        /* 上行網路恢復時提前排程中的重連 */
+        dms_uplink_process();
+
+        /* 遙測取樣不受連線狀態影響，發布在斷線時自動延後 */
+        dms_telemetry_process();
+
+        /* 執行排程中的命令並回報背景命令結果 */
+        dms_command_process();
+
+        /* 發布合併的進度回報，斷線過久時改走 HTTP */
+        dms_report_process();
+
+        /* 重連等待中：到期才嘗試，其餘時間只等到下一輪，不阻塞主迴圈 */
+        if (dms_reconnect_is_pending()) {
+            if (dms_reconnect_process()) {
                 DMS_LOG_INFO("✅ Reconnection successful");
             } else {
-                DMS_LOG_ERROR("❌ Reconnection failed");
-                sleep(5); /* 避免過度重試 */
+                waitForNextTick(dms_reconnect_get_wait_ms());
             }
             continue;
         }
 
+        /* MQTT 事件處理 */
+        if (dms_aws_iot_process_loop(1000) != DMS_SUCCESS) {
+            DMS_LOG_WARN("⚠️ MQTT process loop failed, scheduling reconnection...");
+            dms_reconnect_request();
+            continue;
+        }
+
         /* 檢查連接狀態 */
         if (!dms_aws_iot_is_connected()) {
-            DMS_LOG_WARN("⚠️ AWS IoT connection lost");
-            if (dms_reconnect_attempt() != DMS_SUCCESS) {
-                DMS_LOG_ERROR("❌ Reconnection attempt failed");
-                sleep(5);
-            }
+            DMS_LOG_WARN("⚠️ AWS IoT connection lost, scheduling reconnection...");
+            dms_reconnect_request();
             continue;
         }
 
+        /* 發布合併的 Shadow 寫入（desired 重設、命令結果、狀態） */
+        dms_shadow_process();
+
         /* 定期發送狀態更新 - 使用正確的函數和參數 */
         static uint32_t lastHeartbeat = 0;
         uint32_t currentTime = (uint32_t)time(NULL);
@@ -2810,11 +2008,15 @@ cleanup:
     printf("\n🛑 === DMS Client Shutdown ===\n");
     DMS_LOG_INFO("🛑 DMS Client shutting down...");
     
+    dms_telemetry_cleanup();
+    dms_report_cleanup();
     dms_shadow_cleanup();
     dms_command_cleanup();
+    dms_uplink_cleanup();
     dms_reconnect_cleanup();
     dms_aws_iot_disconnect();
     dms_aws_iot_cleanup();
+    dms_credentials_cleanup();
     dms_config_cleanup();
     
     printf("✅ Cleanup completed\n");
@@ -2822,94 +2024,3 @@ cleanup:
     
     return returnStatus;
 }
-
-/* 🔄 第三步：實作新的主迴圈函數 */
-
-static void runMainLoopWithNewModule(void)
-{
-    uint32_t loopCount = 0;
-    uint32_t lastHeartbeatTime = 0;
-    const uint32_t HEARTBEAT_INTERVAL = 60; // 60 秒心跳間隔
-
-    printf("💓 Main loop started with new AWS IoT module...\n");
-    printf("   Press Ctrl+C to exit gracefully\n");
-
-    while (!g_exitFlag) {
-        /* 檢查連線狀態 */
-        if (g_reconnectState.state == CONNECTION_STATE_CONNECTED) {
-            /* 🆕 使用完全模組化的事件處理 */
-            dms_result_t processResult = dms_aws_iot_process_loop(1000);
-            
-            if (processResult != DMS_SUCCESS) {
-                printf("❌ MQTT process loop failed with status: %d\n", processResult);
-                
-                /* 根據錯誤類型決定是否重連 */
-                if (processResult == DMS_ERROR_NETWORK_FAILURE) {
-                    printf("🔗 Connection lost detected by new module, initiating reconnection...\n");
-                    g_reconnectState.state = CONNECTION_STATE_DISCONNECTED;
-                } else {
-                    printf("💥 Unrecoverable MQTT error detected by new module, exiting...\n");
-                    break;
-                }
-            }
-
-            /* 🆕 完全模組化的心跳和狀態更新 */
-            uint32_t currentTime = (uint32_t)time(NULL);
-            if (currentTime - lastHeartbeatTime >= HEARTBEAT_INTERVAL) {
-                printf("💓 Sending periodic Shadow update via new module...\n");
-                
-                /* 🆕 使用新的 Shadow 模組更新狀態 - 不再需要 MQTT context */
-                if (dms_shadow_update_reported(NULL) == DMS_SUCCESS) {
-                    printf("   ✅ Shadow state updated successfully via new module\n");
-                    lastHeartbeatTime = currentTime;
-                } else {
-                    printf("   ⚠️  Shadow state update failed via new module\n");
-                }
-            }
-
-            /* 每 10 秒顯示狀態 */
-            loopCount++;
-            if (loopCount % 10 == 0) {
-                uint32_t connectedTime = currentTime - g_reconnectState.lastConnectTime;
-                printf("📊 Loop: %u | Connected: %us | Reconnects: %u | Module: NEW-RECONNECT\n",
-                       loopCount, connectedTime, g_reconnectState.totalReconnects);
-            }
-
-        } else if (g_reconnectState.state == CONNECTION_STATE_DISCONNECTED ||
-                   g_reconnectState.state == CONNECTION_STATE_ERROR) {
-            
-            /* 🆕 使用新的重連模組處理重連邏輯 - 替換這整個區塊 */
-            /* 🆕 使用新模組檢查是否應該重連 */
-            if (dms_reconnect_should_retry()) {
-                /* 🆕 使用新模組執行重連 */
-                dms_result_t reconnect_result = dms_reconnect_attempt();
-                
-                if (reconnect_result == DMS_SUCCESS) {
-                    printf("🎯 Reconnection successful via new module, resuming normal operation\n");
-                    
-                    /* 🆕 同步狀態：將新模組的狀態同步到全域狀態 */
-                    g_reconnectState.state = CONNECTION_STATE_CONNECTED;
-                    dms_reconnect_get_stats(&g_reconnectState.retryCount, &g_reconnectState.totalReconnects);
-                    g_reconnectState.lastConnectTime = (uint32_t)time(NULL);
-                } else {
-                    printf("❌ Reconnection failed via new module, waiting before retry...\n");
-                    
-                    /* 🆕 同步失敗狀態 */
-                    g_reconnectState.state = CONNECTION_STATE_ERROR;
-                    dms_reconnect_get_stats(&g_reconnectState.retryCount, NULL);
-                    
-                    sleep(1); // 短暫等待後繼續嘗試
-                }
-            } else {
-                printf("💀 Maximum reconnection attempts exceeded via new module, giving up...\n");
-                break;
-            }
-        }
-
-        /* 短暫休眠避免 CPU 過度使用 */
-        sleep(1);
-    }
-
-    printf("🛑 Exiting main loop (with new reconnect module)\n");
-}
-
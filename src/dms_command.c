@@ -11,41 +11,151 @@
 
 #include "dms_command.h"
 #include "dms_shadow.h"      // 用於調用 reset 和 report 函數
-
-/* AWS IoT 和 JSON 相關 - 與原始程式碼相同 */
-#include "core_json.h"
+#include "dms_json_index.h"
+#include "dms_json_decode.h"
+#include "dms_command_journal.h"
+#include "dms_control_registry.h"
+#include "clock.h"
 
 /* 系統標頭檔 - 與原始程式碼相同 */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 
-/* 條件編譯 - 與原始程式碼相同 */
-#ifdef DMS_API_ENABLED
+/* DMSControlConfig_t 也用於 delta 內嵌的控制配置，不論是否啟用 DMS API */
 #include "dms_api_client.h"
-#endif
-
-#ifdef BCML_MIDDLEWARE_ENABLED
-#include "bcml_adapter.h"    // 用於 bcml_execute_wifi_control 聲明
-#endif
 
 /*-----------------------------------------------------------*/
 /* 內部全域變數 */
 
 static bool g_command_initialized = false;
-static bcml_command_handler_t g_bcml_handler = NULL;
 
 /* Shadow 介面函數指針 (用於依賴注入) */
 static dms_result_t (*g_shadow_reset_desired)(const char* key) = NULL;
 static dms_result_t (*g_shadow_report_result)(const char* key, bool success) = NULL;
 
+/* Delta 版本去重表 - 每個命令鍵最後處理的 Shadow version */
+typedef struct {
+    char key[64];
+    uint32_t version;
+} command_version_entry_t;
+
+static command_version_entry_t g_version_table[DMS_COMMAND_VERSION_MAX_KEYS];
+static int g_version_count = 0;
+static bool g_versions_dirty = false;   // 版本表有變更尚未寫入檔案
+static uint32_t g_suppressed_count = 0;
+
+/* Delta 中可辨識的命令 - 依此順序解析 */
+typedef struct {
+    const char* query;
+    const char* key;
+    dms_command_type_t type;
+} delta_command_entry_t;
+
+static const delta_command_entry_t g_delta_commands[] = {
+    { JSON_QUERY_CONTROL_CONFIG, DMS_COMMAND_KEY_CONTROL_CONFIG, DMS_CMD_CONTROL_CONFIG_CHANGE },
+    { JSON_QUERY_UPLOAD_LOGS,    DMS_COMMAND_KEY_UPLOAD_LOGS,    DMS_CMD_UPLOAD_LOGS },
+    { JSON_QUERY_FW_UPGRADE,     DMS_COMMAND_KEY_FW_UPGRADE,     DMS_CMD_FW_UPGRADE },
+};
+
+/* 命令排程策略 - 長時間的命令在背景執行緒執行，避免阻塞 MQTT 處理；
+ * debounce_ms 不為 0 時，短時間內連續到達的同類 delta 合併為一次執行 */
+typedef struct {
+    dms_command_type_t type;
+    uint8_t priority;
+    uint8_t max_inflight;
+    bool background;
+    uint32_t debounce_ms;
+} command_policy_t;
+
+static const command_policy_t g_command_policies[] = {
+    { DMS_CMD_CONTROL_CONFIG_CHANGE, DMS_COMMAND_PRIORITY_CONTROL_CONFIG,
+      DMS_COMMAND_MAX_INFLIGHT_CONTROL_CONFIG, false, DMS_COMMAND_DEBOUNCE_CONTROL_CONFIG_MS },
+    { DMS_CMD_UPLOAD_LOGS, DMS_COMMAND_PRIORITY_UPLOAD_LOGS,
+      DMS_COMMAND_MAX_INFLIGHT_UPLOAD_LOGS, true, 0 },
+    { DMS_CMD_FW_UPGRADE, DMS_COMMAND_PRIORITY_FW_UPGRADE,
+      DMS_COMMAND_MAX_INFLIGHT_FW_UPGRADE, true, 0 },
+};
+
+/* 命令佇列 - 背景執行緒只寫入 result 與 state（DONE），其餘欄位由主迴圈維護 */
+typedef enum {
+    COMMAND_SLOT_FREE = 0,
+    COMMAND_SLOT_QUEUED,
+    COMMAND_SLOT_RUNNING,
+    COMMAND_SLOT_DONE
+} command_slot_state_t;
+
+typedef struct {
+    dms_command_t command;
+    command_slot_state_t state;
+    uint32_t sequence;              // 同優先權依到達順序執行
+    dms_result_t result;
+    pthread_t thread;
+    bool has_thread;
+    uint32_t journal_id;            // 0 表示未記錄於日誌
+    bool applied;                   // 已執行完成（重啟前或回報失敗），只需回報
+    uint32_t queued_ms;             // 第一次排入的時間
+    uint32_t not_before_ms;         // debounce：此時間之前不執行
+    uint32_t latest_version;        // 執行中併入的最新 delta 版本，完成時一併記錄
+} command_slot_t;
+
+static command_slot_t g_slots[DMS_COMMAND_QUEUE_SIZE];
+static pthread_mutex_t g_slot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t g_next_sequence = 0;
+
+/* 內嵌於 delta 的控制配置 - count 為 0 表示需經 HTTP 取得控制配置列表 */
+typedef struct {
+    int count;
+    DMSControlConfig_t configs[DMS_COMMAND_CONTROL_CONFIG_MAX];
+} control_inline_t;
+
+/* 同鍵命令在佇列中合併，等待中的 control-config-change 最多一個，共用這份內嵌配置 */
+static control_inline_t g_queued_control_inline;
+
+/* 內嵌配置的欄位與 HTTP 回應相同；不截斷，值過長時改由 HTTP 取得 */
+static const dms_json_field_t g_inline_config_fields[] = {
+    DMS_JSON_FIELD(DMSControlConfig_t, statusProgressId, "status_progress_id", DMS_JSON_FIELD_INT32, 0),
+    DMS_JSON_FIELD(DMSControlConfig_t, item, "item", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_REQUIRED),
+    DMS_JSON_FIELD(DMSControlConfig_t, type, "type", DMS_JSON_FIELD_INT32, 0),
+    DMS_JSON_FIELD(DMSControlConfig_t, value, "value", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_REQUIRED),
+};
+
 /*-----------------------------------------------------------*/
 /* 內部函數宣告 */
 
-static dms_result_t execute_control_config_change_command(const dms_command_t* command);
+static dms_result_t parse_delta_commands(const dms_json_index_t* index,
+                                         dms_command_t* commands, size_t max_commands,
+                                         size_t* command_count, control_inline_t* control_inline);
+static dms_result_t build_delta_index(dms_json_index_t* index, const char* payload, size_t payload_len,
+                                      dms_json_token_t* tokens);
+static void parse_inline_control_configs(const dms_json_index_t* index, int32_t value,
+                                         control_inline_t* control_inline);
+static void merge_inline_control_configs(control_inline_t* queued, const control_inline_t* incoming);
+static dms_result_t execute_command(const dms_command_t* command, const control_inline_t* control_inline);
+static dms_result_t execute_control_config_change_command(const dms_command_t* command,
+                                                          const control_inline_t* control_inline);
 static dms_result_t execute_upload_logs_command(void);
 static dms_result_t execute_fw_upgrade_command(void);
+static uint32_t parse_delta_version(const dms_json_index_t* index);
+static command_version_entry_t* find_version_entry(const char* key);
+static bool is_stale_delta(const dms_command_t* command);
+static void record_command_version(const char* key, uint32_t version);
+static void load_command_versions(void);
+static void save_command_versions(void);
+static const command_policy_t* find_policy(dms_command_type_t type);
+static dms_result_t enqueue_command(const dms_command_t* command, const control_inline_t* control_inline);
+static command_slot_t* pick_next_command(void);
+static bool is_behind_debouncing_command(const command_slot_t* slot, uint8_t priority, uint32_t now_ms);
+static uint32_t count_running(dms_command_type_t type);
+static uint32_t debounce_deadline(const command_slot_t* slot, dms_command_type_t type);
+static void collect_finished_commands(void);
+static bool finish_command(const command_slot_t* slot, dms_result_t result);
+static void release_slot(command_slot_t* slot, bool reported, dms_result_t result);
+static void* command_worker(void* arg);
+static void resume_journaled_commands(void);
 
 /*-----------------------------------------------------------*/
 /* 公開介面函數實作 */
@@ -63,9 +173,18 @@ dms_result_t dms_command_init(void)
     DMS_LOG_INFO("🔧 Initializing command processing module...");
 
     /* 重設內部狀態 */
-    g_bcml_handler = NULL;
     g_shadow_reset_desired = NULL;
     g_shadow_report_result = NULL;
+    g_suppressed_count = 0;
+    memset(g_slots, 0, sizeof(g_slots));
+    g_next_sequence = 0;
+    g_queued_control_inline.count = 0;
+
+    /* 載入已處理的命令版本，重啟後仍可丟棄重複 delta */
+    load_command_versions();
+
+    /* 接續上次崩潰或重開機時未完成的命令 */
+    resume_journaled_commands();
 
     g_command_initialized = true;
     DMS_LOG_INFO("✅ Command processing module initialized successfully");
@@ -90,166 +209,180 @@ dms_result_t dms_command_process_shadow_delta(const char* topic,
         return DMS_ERROR_INVALID_PARAMETER;
     }
 
+    dms_json_token_t tokens[DMS_COMMAND_DELTA_MAX_TOKENS];
+    dms_json_index_t index;
+    dms_result_t index_result = build_delta_index(&index, payload, payload_len, tokens);
+    if (index_result != DMS_SUCCESS) {
+        return index_result;
+    }
+
+    return dms_command_process_shadow_delta_index(topic, &index);
+}
+
+/**
+ * @brief 以呼叫端已建立的索引處理 Shadow Delta
+ */
+dms_result_t dms_command_process_shadow_delta_index(const char* topic,
+                                                   const dms_json_index_t* index)
+{
+    (void)topic;
+
+    if (!g_command_initialized) {
+        DMS_LOG_ERROR("❌ Command module not initialized");
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (index == NULL) {
+        DMS_LOG_ERROR("❌ Invalid payload for command processing");
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
     DMS_LOG_SHADOW("🔃 Processing Shadow delta command...");
 
-    /* 步驟1：解析命令 - 與原始程式碼邏輯完全相同 */
-    dms_command_t command;
-    dms_result_t parse_result = dms_command_parse_shadow_delta(payload, payload_len, &command);
+    /* 步驟1：解析 delta 中的所有命令，以及 control-config-change 內嵌的控制配置 */
+    dms_command_t commands[DMS_COMMAND_MAX_PER_DELTA];
+    size_t command_count = 0;
+    control_inline_t control_inline;
+    dms_result_t parse_result = parse_delta_commands(index, commands,
+                                                     DMS_COMMAND_MAX_PER_DELTA,
+                                                     &command_count, &control_inline);
 
-    if (parse_result != DMS_SUCCESS || command.type == DMS_CMD_NONE) {
+    if (parse_result != DMS_SUCCESS || command_count == 0) {
         DMS_LOG_DEBUG("No valid command found in Shadow delta");
         return parse_result;
     }
 
-    /* 步驟2：執行命令 - 與原始程式碼邏輯完全相同 */
-    DMS_LOG_INFO("⚡ Executing DMS command: %s", command.key);
-    dms_result_t exec_result = dms_command_execute(&command);
+    dms_result_t result = DMS_SUCCESS;
 
-    /* 步驟3：重設 desired 狀態 - 委託給 Shadow 模組 */
-    if (g_shadow_reset_desired != NULL) {
-        dms_result_t reset_result = g_shadow_reset_desired(command.key);
-        if (reset_result != DMS_SUCCESS) {
-            DMS_LOG_WARN("⚠️ Failed to reset desired state for key: %s", command.key);
+    for (size_t i = 0; i < command_count; i++) {
+        /* 步驟1.5：丟棄重複或過期的 delta，避免重複的 API 與 BCML 操作 */
+        if (is_stale_delta(&commands[i])) {
+            g_suppressed_count++;
+            DMS_LOG_INFO("⏭️ Suppressed stale delta for %s (version %u, total suppressed: %u)",
+                         commands[i].key, commands[i].version, g_suppressed_count);
+            continue;
         }
-    } else {
-        DMS_LOG_WARN("⚠️ Shadow reset function not registered");
-    }
 
-    /* 步驟4：回報執行結果 - 委託給 Shadow 模組 */
-    if (g_shadow_report_result != NULL) {
-        bool success = (exec_result == DMS_SUCCESS);
-        dms_result_t report_result = g_shadow_report_result(command.key, success);
-        if (report_result != DMS_SUCCESS) {
-            DMS_LOG_WARN("⚠️ Failed to report command result for key: %s", command.key);
+        /* 步驟2：排入優先佇列，每個命令各自執行與回報 */
+        dms_result_t enqueue_result = enqueue_command(&commands[i], &control_inline);
+        if (enqueue_result != DMS_SUCCESS && result == DMS_SUCCESS) {
+            result = enqueue_result;
         }
-    } else {
-        DMS_LOG_WARN("⚠️ Shadow report function not registered");
     }
 
-    return exec_result;
+    /* 可立即執行的命令在返回前完成；debounce 中的命令由主迴圈稍後執行 */
+    dms_command_process();
+
+    return result;
 }
 
 /**
- * @brief 解析 Shadow Delta JSON - 從原始 parseShadowDelta() 函數提取
+ * @brief 執行排程中的命令並回報已完成的命令
  */
-dms_result_t dms_command_parse_shadow_delta(const char* payload,
-                                           size_t payload_len,
-                                           dms_command_t* command)
+void dms_command_process(void)
 {
-    if (payload == NULL || payload_len == 0 || command == NULL) {
-        return DMS_ERROR_INVALID_PARAMETER;
+    if (!g_command_initialized) {
+        return;
     }
 
-    /* JSON 解析變數 - 與原始程式碼完全相同 */
-    JSONStatus_t jsonResult;
-    char* valueStart;
-    size_t valueLength;
+    collect_finished_commands();
 
-    /* 驗證 JSON 格式 - 與原始程式碼邏輯完全相同 */
-    jsonResult = JSON_Validate(payload, payload_len);
-    if (jsonResult != JSONSuccess) {
-        DMS_LOG_ERROR("❌ Invalid JSON in Shadow delta. JSON_Validate Error: %d", jsonResult);
-        return DMS_ERROR_SHADOW_FAILURE;
-    }
+    command_slot_t* slot;
+    while ((slot = pick_next_command()) != NULL) {
+        const command_policy_t* policy = find_policy(slot->command.type);
 
-    DMS_LOG_DEBUG("📋 Parsing Shadow Delta JSON...");
-    DMS_LOG_DEBUG("JSON Payload: %.*s", (int)payload_len, payload);
+        pthread_mutex_lock(&g_slot_mutex);
+        slot->state = COMMAND_SLOT_RUNNING;
+        pthread_mutex_unlock(&g_slot_mutex);
 
-    /* 初始化命令結構 - 與原始程式碼完全相同 */
-    memset(command, 0, sizeof(dms_command_t));
-    command->type = DMS_CMD_NONE;
-    command->timestamp = (uint32_t)time(NULL);
+        /* 重啟前已執行完成的命令不重做，只補回報 */
+        if (slot->applied) {
+            DMS_LOG_INFO("📒 Reporting applied command: %s", slot->command.key);
+            release_slot(slot, finish_command(slot, slot->result), slot->result);
+            continue;
+        }
 
-    /* 檢查 control-config-change - 與原始程式碼邏輯完全相同 */
-    jsonResult = JSON_Search((char*)payload, payload_len,
-                           JSON_QUERY_CONTROL_CONFIG, strlen(JSON_QUERY_CONTROL_CONFIG),
-                           &valueStart, &valueLength);
+        dms_command_journal_record(slot->journal_id, DMS_COMMAND_JOURNAL_EXECUTING, NULL, DMS_SUCCESS);
 
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        command->type = DMS_CMD_CONTROL_CONFIG_CHANGE;
-        command->value = (valueStart[0] == '1') ? 1 : 0;
-        SAFE_STRNCPY(command->key, DMS_COMMAND_KEY_CONTROL_CONFIG, sizeof(command->key));
-        DMS_LOG_INFO("🎯 Found control-config-change command: %d", command->value);
-        return DMS_SUCCESS;
-    }
+        /* 步驟3：背景命令交給執行緒，完成後由 collect_finished_commands() 回報 */
+        if (policy != NULL && policy->background) {
+            if (pthread_create(&slot->thread, NULL, command_worker, slot) == 0) {
+                slot->has_thread = true;
+                DMS_LOG_INFO("⚡ Started DMS command in background: %s", slot->command.key);
+                continue;
+            }
+            DMS_LOG_WARN("⚠️ Failed to start worker for %s, executing inline", slot->command.key);
+        }
 
-    /* 檢查 upload_logs - 與原始程式碼邏輯完全相同 */
-    jsonResult = JSON_Search((char*)payload, payload_len,
-                           JSON_QUERY_UPLOAD_LOGS, strlen(JSON_QUERY_UPLOAD_LOGS),
-                           &valueStart, &valueLength);
+        /* 取出內嵌配置後佇列即可接受下一個 delta；control 命令只在主迴圈中執行 */
+        control_inline_t control_inline = { 0 };
+        if (slot->command.type == DMS_CMD_CONTROL_CONFIG_CHANGE) {
+            pthread_mutex_lock(&g_slot_mutex);
+            control_inline = g_queued_control_inline;
+            g_queued_control_inline.count = 0;
+            pthread_mutex_unlock(&g_slot_mutex);
+        }
 
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        command->type = DMS_CMD_UPLOAD_LOGS;
-        command->value = (valueStart[0] == '1') ? 1 : 0;
-        SAFE_STRNCPY(command->key, DMS_COMMAND_KEY_UPLOAD_LOGS, sizeof(command->key));
-        DMS_LOG_INFO("📤 Found upload_logs command: %d", command->value);
-        return DMS_SUCCESS;
+        DMS_LOG_INFO("⚡ Executing DMS command: %s", slot->command.key);
+        dms_result_t exec_result = execute_command(&slot->command, &control_inline);
+        dms_command_journal_record(slot->journal_id, DMS_COMMAND_JOURNAL_APPLIED, NULL, exec_result);
+        release_slot(slot, finish_command(slot, exec_result), exec_result);
     }
 
-    /* 檢查 fw_upgrade - 與原始程式碼邏輯完全相同 */
-    jsonResult = JSON_Search((char*)payload, payload_len,
-                           JSON_QUERY_FW_UPGRADE, strlen(JSON_QUERY_FW_UPGRADE),
-                           &valueStart, &valueLength);
+    /* REPORTED 記錄與版本表批次落地，記錄過多時壓縮日誌 */
+    dms_command_journal_sync();
+    if (g_versions_dirty) {
+        save_command_versions();
+    }
+}
 
-    if (jsonResult == JSONSuccess && valueLength > 0) {
-        command->type = DMS_CMD_FW_UPGRADE;
-        command->value = (valueStart[0] == '1') ? 1 : 0;
-        SAFE_STRNCPY(command->key, DMS_COMMAND_KEY_FW_UPGRADE, sizeof(command->key));
-        DMS_LOG_INFO("🔄 Found fw_upgrade command: %d", command->value);
-        return DMS_SUCCESS;
+/**
+ * @brief 獲取佇列中與執行中的命令數量
+ */
+uint32_t dms_command_get_pending_count(void)
+{
+    uint32_t count = 0;
+
+    pthread_mutex_lock(&g_slot_mutex);
+    for (size_t i = 0; i < DMS_COMMAND_QUEUE_SIZE; i++) {
+        if (g_slots[i].state != COMMAND_SLOT_FREE) {
+            count++;
+        }
     }
+    pthread_mutex_unlock(&g_slot_mutex);
 
-    /* 沒有找到任何命令 */
-    DMS_LOG_DEBUG("No recognized command found in Shadow delta");
-    return DMS_SUCCESS;  // 不是錯誤，只是沒有命令
+    return count;
 }
 
 /**
- * @brief 執行 DMS 命令 - 從原始 handleDMSCommand() 函數提取
+ * @brief 解析 Shadow Delta JSON - 從原始 parseShadowDelta() 函數提取
  */
-dms_result_t dms_command_execute(const dms_command_t* command)
+dms_result_t dms_command_parse_shadow_delta(const char* payload,
+                                           size_t payload_len,
+                                           dms_command_t* commands,
+                                           size_t max_commands,
+                                           size_t* command_count)
 {
-    if (command == NULL) {
+    if (payload == NULL || payload_len == 0) {
         return DMS_ERROR_INVALID_PARAMETER;
     }
 
-    /* 檢查命令值 - 與原始程式碼邏輯相同 */
-    if (command->value != 1) {
-        DMS_LOG_WARN("⚠️ Command value is not 1, skipping execution");
-        return DMS_ERROR_INVALID_PARAMETER;
+    dms_json_token_t tokens[DMS_COMMAND_DELTA_MAX_TOKENS];
+    dms_json_index_t index;
+    dms_result_t index_result = build_delta_index(&index, payload, payload_len, tokens);
+    if (index_result != DMS_SUCCESS) {
+        return index_result;
     }
 
-    DMS_LOG_INFO("🔧 Processing DMS command: %s (type: %d)", command->key, command->type);
-
-    /* 根據命令類型執行 - 與原始程式碼邏輯完全相同 */
-    switch (command->type) {
-        case DMS_CMD_CONTROL_CONFIG_CHANGE:
-            return execute_control_config_change_command(command);
-
-        case DMS_CMD_UPLOAD_LOGS:
-            return execute_upload_logs_command();
-
-        case DMS_CMD_FW_UPGRADE:
-            return execute_fw_upgrade_command();
-
-        case DMS_CMD_NONE:
-        default:
-            DMS_LOG_ERROR("❌ Unknown DMS command type: %d", command->type);
-            return DMS_ERROR_INVALID_PARAMETER;
-    }
+    return parse_delta_commands(&index, commands, max_commands, command_count, NULL);
 }
 
 /**
- * @brief 註冊 BCML 命令處理器
+ * @brief 執行 DMS 命令 - 從原始 handleDMSCommand() 函數提取
  */
-void dms_command_register_bcml_handler(bcml_command_handler_t handler)
+dms_result_t dms_command_execute(const dms_command_t* command)
 {
-    g_bcml_handler = handler;
-    if (handler != NULL) {
-        DMS_LOG_INFO("✅ BCML command handler registered");
-    } else {
-        DMS_LOG_WARN("⚠️ BCML command handler set to NULL");
-    }
+    return execute_command(command, NULL);
 }
 
 /**
@@ -269,6 +402,14 @@ void dms_command_register_shadow_interface(
     }
 }
 
+/**
+ * @brief 獲取被去重丟棄的 delta 數量
+ */
+uint32_t dms_command_get_suppressed_count(void)
+{
+    return g_suppressed_count;
+}
+
 /**
  * @brief 清理命令處理模組
  */
@@ -280,21 +421,744 @@ void dms_command_cleanup(void)
 
     DMS_LOG_INFO("🧹 Cleaning up command processing module...");
 
-    g_bcml_handler = NULL;
     g_shadow_reset_desired = NULL;
     g_shadow_report_result = NULL;
+    if (g_versions_dirty) {
+        save_command_versions();
+    }
+    g_version_count = 0;
+
+    /* 等待背景命令結束；尚未回報或尚未執行的命令留在日誌中，下次啟動時接續 */
+    for (size_t i = 0; i < DMS_COMMAND_QUEUE_SIZE; i++) {
+        if (g_slots[i].has_thread) {
+            DMS_LOG_INFO("⏳ Waiting for background command: %s", g_slots[i].command.key);
+            pthread_join(g_slots[i].thread, NULL);
+        }
+    }
+    memset(g_slots, 0, sizeof(g_slots));
+    dms_command_journal_close();
     g_command_initialized = false;
 
     DMS_LOG_INFO("✅ Command processing module cleanup completed");
 }
 
+/*-----------------------------------------------------------*/
+/* 內部函數實作 - Delta 解析 */
+
+/**
+ * @brief 為 Shadow Delta 建立索引
+ *
+ * @param tokens 容量為 DMS_COMMAND_DELTA_MAX_TOKENS 的 token 緩衝區
+ */
+static dms_result_t build_delta_index(dms_json_index_t* index, const char* payload, size_t payload_len,
+                                      dms_json_token_t* tokens)
+{
+    /* 一次掃描完成驗證並建立索引，之後的查詢只走訪 tape */
+    dms_result_t indexResult = dms_json_index_build(index, payload, payload_len,
+                                                    tokens, DMS_COMMAND_DELTA_MAX_TOKENS);
+    if (indexResult != DMS_SUCCESS) {
+        DMS_LOG_ERROR("❌ Invalid JSON in Shadow delta. Index Error: %d", indexResult);
+        return DMS_ERROR_SHADOW_FAILURE;
+    }
+
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 解析 Shadow Delta，並取出 control-config-change 內嵌的控制配置
+ *
+ * @param control_inline 輸出內嵌配置，可為 NULL；delta 未帶完整配置時 count 為 0
+ */
+static dms_result_t parse_delta_commands(const dms_json_index_t* index,
+                                         dms_command_t* commands, size_t max_commands,
+                                         size_t* command_count, control_inline_t* control_inline)
+{
+    if (index == NULL || commands == NULL || command_count == NULL) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    *command_count = 0;
+    if (control_inline != NULL) {
+        control_inline->count = 0;
+    }
+
+    DMS_LOG_DEBUG("📋 Parsing Shadow Delta JSON...");
+    DMS_LOG_DEBUG("JSON Payload: %.*s", (int)index->length, index->json);
+
+    uint32_t version = parse_delta_version(index);
+    uint32_t timestamp = (uint32_t)time(NULL);
+
+    /* 取出所有命令，不在第一個命中時返回 */
+    for (size_t i = 0; i < ARRAY_SIZE(g_delta_commands) && *command_count < max_commands; i++) {
+        const char* valueStart;
+        size_t valueLength;
+
+        int32_t value = dms_json_index_find(index, DMS_JSON_INDEX_ROOT, g_delta_commands[i].query);
+
+        if (!dms_json_index_value(index, value, &valueStart, &valueLength) || valueLength == 0) {
+            continue;
+        }
+
+        dms_command_t* command = &commands[(*command_count)++];
+        memset(command, 0, sizeof(dms_command_t));
+        command->type = g_delta_commands[i].type;
+        command->value = (valueStart[0] == '1') ? 1 : 0;
+
+        /* control-config-change 可直接帶控制配置：{"control-configs":[...]}，視同值為 1 */
+        if (command->type == DMS_CMD_CONTROL_CONFIG_CHANGE &&
+            dms_json_index_type(index, value) == DMS_JSON_TYPE_OBJECT) {
+            command->value = 1;
+            if (control_inline != NULL) {
+                parse_inline_control_configs(index, value, control_inline);
+            }
+        }
+        command->timestamp = timestamp;
+        command->version = version;
+        SAFE_STRNCPY(command->key, g_delta_commands[i].key, sizeof(command->key));
+        DMS_LOG_INFO("🎯 Found %s command: %d", command->key, command->value);
+    }
+
+    if (*command_count == 0) {
+        /* 沒有找到任何命令 */
+        DMS_LOG_DEBUG("No recognized command found in Shadow delta");
+    }
+    return DMS_SUCCESS;  // 沒有命令不是錯誤
+}
+
+/**
+ * @brief 解析 delta 內嵌的控制配置
+ *
+ * 項目數超過上限、欄位無法解碼或值超過緩衝區時整批捨棄（count 為 0），
+ * 由執行時改經 HTTP 取得完整列表，不只套用部分項目
+ */
+static void parse_inline_control_configs(const dms_json_index_t* index, int32_t value,
+                                         control_inline_t* control_inline)
+{
+    int32_t configsArray = dms_json_index_child(index, value, "control-configs",
+                                                strlen("control-configs"));
+    int count = 0;
+
+    control_inline->count = 0;
+    if (dms_json_index_type(index, configsArray) != DMS_JSON_TYPE_ARRAY) {
+        DMS_LOG_DEBUG("No control-configs in delta, will fetch over HTTP");
+        return;
+    }
+
+    for (int32_t element = dms_json_index_first_child(index, configsArray);
+         element != DMS_JSON_INDEX_NOT_FOUND;
+         element = dms_json_index_next_sibling(index, configsArray, element)) {
+        if (count >= DMS_COMMAND_CONTROL_CONFIG_MAX) {
+            DMS_LOG_INFO("📦 Too many control configs in delta, will fetch over HTTP");
+            return;
+        }
+
+        DMSControlConfig_t* config = &control_inline->configs[count];
+        memset(config, 0, sizeof(*config));
+
+        if (dms_json_index_type(index, element) != DMS_JSON_TYPE_OBJECT ||
+            dms_json_decode(index, element, g_inline_config_fields,
+                            ARRAY_SIZE(g_inline_config_fields), config, NULL) != DMS_SUCCESS) {
+            DMS_LOG_WARN("⚠️ Unusable control config in delta, will fetch over HTTP");
+            return;
+        }
+        count++;
+    }
+
+    control_inline->count = count;
+    DMS_LOG_DEBUG("Found %d control config(s) inline in delta", count);
+}
+
+/**
+ * @brief 合併內嵌配置到佇列中的 control 命令
+ *
+ * 同名項目以較新的 delta 為準；任一 delta 沒有內嵌配置或合併後超過上限時，
+ * 合併後的命令改經 HTTP 取得完整列表
+ */
+static void merge_inline_control_configs(control_inline_t* queued, const control_inline_t* incoming)
+{
+    if (queued->count == 0 || incoming == NULL || incoming->count == 0) {
+        queued->count = 0;
+        return;
+    }
+
+    for (int i = 0; i < incoming->count; i++) {
+        int target = 0;
+        while (target < queued->count &&
+               strcmp(queued->configs[target].item, incoming->configs[i].item) != 0) {
+            target++;
+        }
+
+        if (target == DMS_COMMAND_CONTROL_CONFIG_MAX) {
+            queued->count = 0;
+            return;
+        }
+        queued->configs[target] = incoming->configs[i];
+        if (target == queued->count) {
+            queued->count++;
+        }
+    }
+}
+
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 - 命令排程 */
+
+/**
+ * @brief 查詢命令類型的排程策略
+ */
+static const command_policy_t* find_policy(dms_command_type_t type)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(g_command_policies); i++) {
+        if (g_command_policies[i].type == type) {
+            return &g_command_policies[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 將命令排入佇列
+ *
+ * 同一命令鍵已在執行中（含已完成但尚未回報）時，新的 delta 併入該次執行，
+ * 只記下最新版本，完成時一併記錄；已在佇列中等待時以新的 delta 取代
+ * （內嵌控制配置逐項合併），同版本視為重送
+ */
+static dms_result_t enqueue_command(const dms_command_t* command, const control_inline_t* control_inline)
+{
+    command_slot_t* free_slot = NULL;
+
+    pthread_mutex_lock(&g_slot_mutex);
+    for (size_t i = 0; i < DMS_COMMAND_QUEUE_SIZE; i++) {
+        command_slot_t* slot = &g_slots[i];
+
+        if (slot->state == COMMAND_SLOT_FREE) {
+            if (free_slot == NULL) {
+                free_slot = slot;
+            }
+            continue;
+        }
+        if (strcmp(slot->command.key, command->key) != 0) {
+            continue;
+        }
+
+        /* 背景命令已執行完成、只等回報時同樣不重做；control 命令則以新的配置重新套用 */
+        const command_policy_t* policy = find_policy(slot->command.type);
+        if (slot->state == COMMAND_SLOT_RUNNING || slot->state == COMMAND_SLOT_DONE ||
+            (slot->applied && policy != NULL && policy->background)) {
+            if (command->version > slot->latest_version) {
+                slot->latest_version = command->version;
+            }
+            pthread_mutex_unlock(&g_slot_mutex);
+            DMS_LOG_DEBUG("Command already running, coalesced: %s (version %u)",
+                          command->key, command->version);
+            return DMS_SUCCESS;
+        }
+
+        if (command->version != 0 && slot->command.version == command->version) {
+            pthread_mutex_unlock(&g_slot_mutex);
+            DMS_LOG_DEBUG("Command already pending: %s (version %u)", command->key, command->version);
+            return DMS_SUCCESS;
+        }
+
+        slot->command = *command;
+        slot->applied = false;
+        slot->not_before_ms = debounce_deadline(slot, command->type);
+        if (command->type == DMS_CMD_CONTROL_CONFIG_CHANGE) {
+            merge_inline_control_configs(&g_queued_control_inline, control_inline);
+        }
+        uint32_t journal_id = slot->journal_id;
+        pthread_mutex_unlock(&g_slot_mutex);
+        dms_command_journal_record(journal_id, DMS_COMMAND_JOURNAL_RECEIVED, command, DMS_SUCCESS);
+        DMS_LOG_DEBUG("Coalesced queued command: %s (version %u)", command->key, command->version);
+        return DMS_SUCCESS;
+    }
+
+    if (free_slot == NULL) {
+        pthread_mutex_unlock(&g_slot_mutex);
+        /* 不記錄版本，AWS 重送 delta 時會再次排入 */
+        DMS_LOG_ERROR("❌ Command queue full, dropping %s", command->key);
+        return DMS_ERROR_SHADOW_FAILURE;
+    }
+
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->command = *command;
+    free_slot->sequence = g_next_sequence++;
+    free_slot->journal_id = dms_command_journal_begin(command);
+    free_slot->queued_ms = Clock_GetTimeMs();
+    free_slot->not_before_ms = debounce_deadline(free_slot, command->type);
+    free_slot->state = COMMAND_SLOT_QUEUED;
+    if (command->type == DMS_CMD_CONTROL_CONFIG_CHANGE) {
+        g_queued_control_inline.count = 0;
+        if (control_inline != NULL) {
+            g_queued_control_inline = *control_inline;
+        }
+    }
+    pthread_mutex_unlock(&g_slot_mutex);
+
+    DMS_LOG_DEBUG("Queued command: %s", command->key);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 取出下一個可執行的命令
+ *
+ * 優先權最高（數字最小）且同類型執行中數量未達上限者；同優先權依到達順序。
+ * 較早排入的高優先權命令還在 debounce 時，較低優先權的命令等它先執行，
+ * 同一 delta 中的控制變更不會被之後的日誌上傳搶先
+ */
+static command_slot_t* pick_next_command(void)
+{
+    command_slot_t* best = NULL;
+    const command_policy_t* best_policy = NULL;
+    uint32_t now_ms = Clock_GetTimeMs();
+
+    /* 背景執行緒會更新 state，掃描期間持有鎖 */
+    pthread_mutex_lock(&g_slot_mutex);
+    for (size_t i = 0; i < DMS_COMMAND_QUEUE_SIZE; i++) {
+        command_slot_t* slot = &g_slots[i];
+
+        if (slot->state != COMMAND_SLOT_QUEUED ||
+            (int32_t)(now_ms - slot->not_before_ms) < 0) {
+            continue;
+        }
+
+        const command_policy_t* policy = find_policy(slot->command.type);
+        uint8_t max_inflight = (policy != NULL) ? policy->max_inflight : 1;
+        if (count_running(slot->command.type) >= max_inflight) {
+            continue;
+        }
+
+        uint8_t priority = (policy != NULL) ? policy->priority : UINT8_MAX;
+        if (is_behind_debouncing_command(slot, priority, now_ms)) {
+            continue;
+        }
+
+        uint8_t best_priority = (best_policy != NULL) ? best_policy->priority : UINT8_MAX;
+        if (best == NULL || priority < best_priority ||
+            (priority == best_priority && (int32_t)(slot->sequence - best->sequence) < 0)) {
+            best = slot;
+            best_policy = policy;
+        }
+    }
+    pthread_mutex_unlock(&g_slot_mutex);
+
+    return best;
+}
+
+/**
+ * @brief 是否有較早排入、優先權較高且仍在 debounce 的命令
+ *
+ * 只等待尚未執行過的命令；等待回報重試的命令不阻擋其他命令。調用者須持有 g_slot_mutex
+ */
+static bool is_behind_debouncing_command(const command_slot_t* slot, uint8_t priority, uint32_t now_ms)
+{
+    for (size_t i = 0; i < DMS_COMMAND_QUEUE_SIZE; i++) {
+        const command_slot_t* other = &g_slots[i];
+
+        if (other == slot || other->state != COMMAND_SLOT_QUEUED || other->applied ||
+            (int32_t)(now_ms - other->not_before_ms) >= 0 ||
+            (int32_t)(other->sequence - slot->sequence) > 0) {
+            continue;
+        }
+
+        const command_policy_t* policy = find_policy(other->command.type);
+        if (policy != NULL && policy->priority < priority) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 計算 debounce 結束時間
+ *
+ * 每次有新的 delta 合併進來就重新計時，但從第一次排入起不超過
+ * DMS_COMMAND_DEBOUNCE_MAX_MS，持續操作時仍會執行
+ */
+static uint32_t debounce_deadline(const command_slot_t* slot, dms_command_type_t type)
+{
+    const command_policy_t* policy = find_policy(type);
+    uint32_t now_ms = Clock_GetTimeMs();
+
+    if (policy == NULL || policy->debounce_ms == 0) {
+        return now_ms;
+    }
+
+    uint32_t deadline = now_ms + policy->debounce_ms;
+    uint32_t limit = slot->queued_ms + DMS_COMMAND_DEBOUNCE_MAX_MS;
+    return ((int32_t)(deadline - limit) > 0) ? limit : deadline;
+}
+
+/**
+ * @brief 計算同類型執行中（含已完成但尚未回報）的命令數量
+ *
+ * 調用者須持有 g_slot_mutex
+ */
+static uint32_t count_running(dms_command_type_t type)
+{
+    uint32_t count = 0;
+
+    for (size_t i = 0; i < DMS_COMMAND_QUEUE_SIZE; i++) {
+        if ((g_slots[i].state == COMMAND_SLOT_RUNNING || g_slots[i].state == COMMAND_SLOT_DONE) &&
+            g_slots[i].command.type == type) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief 回報背景執行完成的命令
+ *
+ * Shadow 模組不是執行緒安全的，回報一律在主迴圈中進行
+ */
+static void collect_finished_commands(void)
+{
+    for (size_t i = 0; i < DMS_COMMAND_QUEUE_SIZE; i++) {
+        command_slot_t* slot = &g_slots[i];
+
+        pthread_mutex_lock(&g_slot_mutex);
+        bool done = (slot->state == COMMAND_SLOT_DONE);
+        pthread_mutex_unlock(&g_slot_mutex);
+
+        if (!done) {
+            continue;
+        }
+
+        pthread_join(slot->thread, NULL);
+        release_slot(slot, finish_command(slot, slot->result), slot->result);
+    }
+}
+
+/**
+ * @brief 命令完成：記錄版本、重設 desired、回報結果
+ *
+ * @return 重設與回報都成功時返回 true，此時才記錄 REPORTED
+ */
+static bool finish_command(const command_slot_t* slot, dms_result_t result)
+{
+    const dms_command_t* command = &slot->command;
+
+    /* 記錄已處理版本 - 成功執行後才記錄，中途崩潰或失敗時重送的 delta 仍會執行；
+     * 執行期間併入的較新 delta 已由這次執行涵蓋，記錄其中最新的版本 */
+    if (result == DMS_SUCCESS) {
+        pthread_mutex_lock(&g_slot_mutex);
+        uint32_t version = slot->latest_version > command->version ? slot->latest_version : command->version;
+        pthread_mutex_unlock(&g_slot_mutex);
+        record_command_version(command->key, version);
+    }
+
+    /* 步驟4：重設 desired 狀態 - 委託給 Shadow 模組 */
+    if (g_shadow_reset_desired == NULL || g_shadow_report_result == NULL) {
+        DMS_LOG_WARN("⚠️ Shadow interface not registered, will report %s later", command->key);
+        return false;
+    }
+
+    if (g_shadow_reset_desired(command->key) != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ Failed to reset desired state for key: %s, will retry", command->key);
+        return false;
+    }
+
+    /* 步驟5：回報執行結果 - 委託給 Shadow 模組 */
+    if (g_shadow_report_result(command->key, result == DMS_SUCCESS) != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ Failed to report command result for key: %s, will retry", command->key);
+        return false;
+    }
+
+    /* 回報可重複進行，REPORTED 不需立即落地 */
+    dms_command_journal_record(slot->journal_id, DMS_COMMAND_JOURNAL_REPORTED, NULL, result);
+
+    if (result == DMS_SUCCESS) {
+        DMS_LOG_INFO("✅ DMS command completed: %s", command->key);
+    } else {
+        DMS_LOG_ERROR("❌ DMS command failed: %s (%d)", command->key, result);
+    }
+    return true;
+}
+
+/**
+ * @brief 釋放已回報的命令槽
+ *
+ * 回報失敗時命令不重做：保留為已執行（日誌中仍是 APPLIED），
+ * DMS_COMMAND_REPORT_RETRY_MS 後由 dms_command_process() 只重試重設與回報
+ */
+static void release_slot(command_slot_t* slot, bool reported, dms_result_t result)
+{
+    pthread_mutex_lock(&g_slot_mutex);
+    if (reported) {
+        memset(slot, 0, sizeof(*slot));
+    } else {
+        slot->applied = true;
+        slot->result = result;
+        slot->has_thread = false;
+        slot->not_before_ms = Clock_GetTimeMs() + DMS_COMMAND_REPORT_RETRY_MS;
+        slot->state = COMMAND_SLOT_QUEUED;
+    }
+    pthread_mutex_unlock(&g_slot_mutex);
+}
+
+/**
+ * @brief 背景執行緒：執行命令後標記完成
+ */
+static void* command_worker(void* arg)
+{
+    command_slot_t* slot = (command_slot_t*)arg;
+    dms_result_t result = dms_command_execute(&slot->command);
+
+    /* 在執行緒內落地，縮小完成到回報之間的崩潰窗口 */
+    dms_command_journal_record(slot->journal_id, DMS_COMMAND_JOURNAL_APPLIED, NULL, result);
+
+    pthread_mutex_lock(&g_slot_mutex);
+    slot->result = result;
+    slot->state = COMMAND_SLOT_DONE;
+    pthread_mutex_unlock(&g_slot_mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief 從命令日誌恢復未完成的命令
+ *
+ * RECEIVED / EXECUTING 重新排入佇列執行；APPLIED 只補做重設與回報。
+ * 版本表已記錄的命令表示已被較新的 delta 取代，直接結束。
+ */
+static void resume_journaled_commands(void)
+{
+    dms_command_journal_entry_t recovered[DMS_COMMAND_QUEUE_SIZE];
+    size_t recovered_count = 0;
+
+    if (dms_command_journal_open(DMS_COMMAND_JOURNAL_FILE, recovered,
+                                 DMS_COMMAND_QUEUE_SIZE, &recovered_count) != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ Command journal unavailable, commands will not survive restart");
+    }
+
+    for (size_t i = 0; i < recovered_count; i++) {
+        dms_command_journal_entry_t* entry = &recovered[i];
+
+        if (entry->state != DMS_COMMAND_JOURNAL_APPLIED && is_stale_delta(&entry->command)) {
+            dms_command_journal_record(entry->id, DMS_COMMAND_JOURNAL_REPORTED, NULL, DMS_SUCCESS);
+            continue;
+        }
+
+        command_slot_t* slot = &g_slots[i];
+        memset(slot, 0, sizeof(*slot));
+        slot->command = entry->command;
+        slot->command.timestamp = (uint32_t)time(NULL);
+        slot->sequence = g_next_sequence++;
+        slot->journal_id = entry->id;
+        slot->applied = (entry->state == DMS_COMMAND_JOURNAL_APPLIED);
+        slot->result = entry->result;
+        slot->queued_ms = Clock_GetTimeMs();
+        slot->not_before_ms = slot->queued_ms;
+        slot->state = COMMAND_SLOT_QUEUED;
+
+        DMS_LOG_INFO("📒 Resuming %s command from journal: %s (version %u)",
+                     entry->state == DMS_COMMAND_JOURNAL_APPLIED ? "applied" :
+                     entry->state == DMS_COMMAND_JOURNAL_EXECUTING ? "interrupted" : "queued",
+                     entry->command.key, entry->command.version);
+    }
+
+    dms_command_journal_sync();
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 - Delta 版本去重 */
+
+/**
+ * @brief 解析 delta 頂層的 version 欄位
+ *
+ * @return Shadow 文件版本，缺少或格式錯誤時返回 0
+ */
+static uint32_t parse_delta_version(const dms_json_index_t* index)
+{
+    uint64_t version;
+
+    if (!dms_json_index_get_uint(index,
+                                 dms_json_index_find(index, DMS_JSON_INDEX_ROOT, JSON_QUERY_SHADOW_VERSION),
+                                 &version) ||
+        version > UINT32_MAX) {
+        return 0;
+    }
+
+    return (uint32_t)version;
+}
+
+/**
+ * @brief 在版本表中尋找命令鍵
+ */
+static command_version_entry_t* find_version_entry(const char* key)
+{
+    for (int i = 0; i < g_version_count; i++) {
+        if (strcmp(g_version_table[i].key, key) == 0) {
+            return &g_version_table[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 檢查 delta 是否為重複或過期
+ *
+ * 沒有 version 的 delta 無法判斷，一律視為新命令。版本大幅倒退表示 Shadow 被刪除後重建
+ * （版本從 1 重新開始），清空版本表，不再丟棄之後的命令
+ */
+static bool is_stale_delta(const dms_command_t* command)
+{
+    if (command->version == 0) {
+        return false;
+    }
+
+    const command_version_entry_t* entry = find_version_entry(command->key);
+    if (entry == NULL || command->version > entry->version) {
+        return false;
+    }
+
+    if (entry->version - command->version > DMS_COMMAND_VERSION_RESET_GAP) {
+        DMS_LOG_WARN("⚠️ Shadow version went back from %u to %u, assuming Shadow was recreated",
+                     entry->version, command->version);
+        g_version_count = 0;
+        g_versions_dirty = true;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 記錄命令鍵最後處理的版本
+ *
+ * 只標記變更，由 dms_command_process() 在每輪結束時一次寫入檔案
+ */
+static void record_command_version(const char* key, uint32_t version)
+{
+    if (version == 0) {
+        return;
+    }
+
+    command_version_entry_t* entry = find_version_entry(key);
+    if (entry == NULL) {
+        if (g_version_count >= DMS_COMMAND_VERSION_MAX_KEYS) {
+            DMS_LOG_WARN("⚠️ Command version table full, not tracking: %s", key);
+            return;
+        }
+        entry = &g_version_table[g_version_count++];
+        SAFE_STRNCPY(entry->key, key, sizeof(entry->key));
+    } else if (entry->version == version) {
+        return;
+    }
+
+    entry->version = version;
+    g_versions_dirty = true;
+}
+
+/**
+ * @brief 從檔案載入版本表
+ *
+ * 檔案格式為每行 "<key> <version>"，檔案不存在時視為空表
+ */
+static void load_command_versions(void)
+{
+    g_version_count = 0;
+    g_versions_dirty = false;
+
+    FILE* fp = fopen(DMS_COMMAND_VERSION_FILE, "r");
+    if (fp == NULL) {
+        DMS_LOG_DEBUG("No command version file, starting with empty table");
+        return;
+    }
+
+    char key[64];
+    unsigned int version;
+    while (g_version_count < DMS_COMMAND_VERSION_MAX_KEYS &&
+           fscanf(fp, "%63s %u", key, &version) == 2) {
+        command_version_entry_t* entry = &g_version_table[g_version_count++];
+        SAFE_STRNCPY(entry->key, key, sizeof(entry->key));
+        entry->version = (uint32_t)version;
+    }
+
+    fclose(fp);
+    DMS_LOG_INFO("📋 Loaded %d command version entries", g_version_count);
+}
+
+/**
+ * @brief 將版本表寫入檔案
+ *
+ * 先寫暫存檔再 rename，避免斷電時留下不完整的檔案
+ */
+static void save_command_versions(void)
+{
+    const char* tmp_path = DMS_COMMAND_VERSION_FILE ".tmp";
+
+    FILE* fp = fopen(tmp_path, "w");
+    if (fp == NULL) {
+        DMS_LOG_WARN("⚠️ Failed to open command version file for writing");
+        return;
+    }
+
+    for (int i = 0; i < g_version_count; i++) {
+        fprintf(fp, "%s %u\n", g_version_table[i].key, g_version_table[i].version);
+    }
+
+    fflush(fp);
+    fsync(fileno(fp));
+    fclose(fp);
+
+    if (rename(tmp_path, DMS_COMMAND_VERSION_FILE) != 0) {
+        DMS_LOG_WARN("⚠️ Failed to commit command version file");
+        unlink(tmp_path);
+        return;
+    }
+    g_versions_dirty = false;
+}
+
 /*-----------------------------------------------------------*/
 /* 內部函數實作 - 從原始 handleDMSCommand() 函數提取 */
 
+/**
+ * @brief 執行 DMS 命令
+ *
+ * @param control_inline delta 內嵌的控制配置，NULL 或 count 為 0 時經 HTTP 取得
+ */
+static dms_result_t execute_command(const dms_command_t* command, const control_inline_t* control_inline)
+{
+    if (command == NULL) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    /* 檢查命令值 - 與原始程式碼邏輯相同 */
+    if (command->value != 1) {
+        DMS_LOG_WARN("⚠️ Command value is not 1, skipping execution");
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    DMS_LOG_INFO("🔧 Processing DMS command: %s (type: %d)", command->key, command->type);
+
+    /* 根據命令類型執行 - 與原始程式碼邏輯完全相同 */
+    switch (command->type) {
+        case DMS_CMD_CONTROL_CONFIG_CHANGE:
+            return execute_control_config_change_command(command, control_inline);
+
+        case DMS_CMD_UPLOAD_LOGS:
+            return execute_upload_logs_command();
+
+        case DMS_CMD_FW_UPGRADE:
+            return execute_fw_upgrade_command();
+
+        case DMS_CMD_NONE:
+        default:
+            DMS_LOG_ERROR("❌ Unknown DMS command type: %d", command->type);
+            return DMS_ERROR_INVALID_PARAMETER;
+    }
+}
+
 /**
  * @brief 執行 control-config-change 命令
+ *
+ * delta 已帶控制配置時直接套用，省去 HTTPS 連線與伺服器往返；否則經 HTTP 取得
  */
-static dms_result_t execute_control_config_change_command(const dms_command_t* command)
+static dms_result_t execute_control_config_change_command(const dms_command_t* command,
+                                                          const control_inline_t* control_inline)
 {
     DMS_LOG_INFO("📡 Processing WiFi control-config-change command...");
 
@@ -302,50 +1166,72 @@ static dms_result_t execute_control_config_change_command(const dms_command_t* c
     /* 使用實際的 DMS API 調用 - 與原始程式碼邏輯完全相同 */
 
     /* 獲取控制配置列表 */
-    DMSControlConfig_t configs[10];
+    DMSControlConfig_t fetched[DMS_COMMAND_CONTROL_CONFIG_MAX];
+    const DMSControlConfig_t* configs = fetched;
     int configCount = 0;
-    DMSAPIResult_t apiResult = dms_api_control_config_list(
-        CLIENT_IDENTIFIER, configs, 10, &configCount);
+    DMSAPIResult_t apiResult = DMS_API_SUCCESS;
+
+    if (control_inline != NULL && control_inline->count > 0) {
+        configs = control_inline->configs;
+        configCount = control_inline->count;
+        DMS_LOG_INFO("⚡ Using %d control config(s) from delta, skipping HTTP fetch", configCount);
+    } else {
+        apiResult = dms_api_control_config_list(CLIENT_IDENTIFIER, fetched,
+                                                DMS_COMMAND_CONTROL_CONFIG_MAX, &configCount);
+    }
 
     if (apiResult == DMS_API_SUCCESS && configCount > 0) {
         DMS_LOG_INFO("✅ Control config retrieved: %d configurations", configCount);
 
-        /* 執行所有控制配置 */
+        /* 執行所有控制配置 - 經由控制項目註冊表，同一 apply-group 只套用一次，平行群組同時套用 */
+        int itemResults[DMS_COMMAND_CONTROL_CONFIG_MAX];
         bool allSuccess = true;
-        for (int i = 0; i < configCount; i++) {
-            /* 使用 BCML 處理器執行配置 */
-            if (g_bcml_handler != NULL) {
-                int execResult = g_bcml_handler(configs[i].item, configs[i].value);
-                if (execResult != DMS_SUCCESS) {
-                    DMS_LOG_ERROR("❌ Control failed for: %s", configs[i].item);
-                    allSuccess = false;
-                } else {
-                    DMS_LOG_INFO("✅ Control successful for: %s", configs[i].item);
-                }
-            } else {
-                DMS_LOG_WARN("⚠️ No BCML handler registered, simulating success");
+
+        if (dms_control_registry_get_item_count() > 0) {
+            const char* items[DMS_COMMAND_CONTROL_CONFIG_MAX];
+            const char* values[DMS_COMMAND_CONTROL_CONFIG_MAX];
+            for (int i = 0; i < configCount; i++) {
+                items[i] = configs[i].item;
+                values[i] = configs[i].value;
+            }
+            dms_control_registry_apply(items, values, itemResults, (size_t)configCount);
+        } else {
+            DMS_LOG_WARN("⚠️ No control items registered, simulating success");
+            for (int i = 0; i < configCount; i++) {
+                itemResults[i] = DMS_SUCCESS;
             }
         }
 
-        /* 回報每個控制的執行結果 - 與原始程式碼邏輯完全相同 */
+        /* 逐項回報執行結果，一次 API 調用送出全部項目 */
+        DMSControlResult_t controlResults[DMS_COMMAND_CONTROL_CONFIG_MAX];
         for (int i = 0; i < configCount; i++) {
-            DMSControlResult_t controlResult = {
-                .statusProgressId = configs[i].statusProgressId,
-                .status = allSuccess ? 1 : 2,  // 1=successful, 2=failed
-                .failedCode = "",
-                .failedReason = ""
-            };
-
-            DMSAPIResult_t updateResult = dms_api_control_progress_update(
-                CLIENT_IDENTIFIER, &controlResult, 1);
-
-            if (updateResult == DMS_API_SUCCESS) {
-                DMS_LOG_INFO("✅ Control progress reported for: %s", configs[i].item);
+            DMSControlResult_t* controlResult = &controlResults[i];
+            memset(controlResult, 0, sizeof(*controlResult));
+            controlResult->statusProgressId = configs[i].statusProgressId;
+
+            if (itemResults[i] == DMS_SUCCESS) {
+                DMS_LOG_INFO("✅ Control successful for: %s", configs[i].item);
+                controlResult->status = 1;  // 1=successful
             } else {
-                DMS_LOG_WARN("⚠️ Failed to report progress for: %s", configs[i].item);
+                DMS_LOG_ERROR("❌ Control failed for: %s (%d)", configs[i].item, itemResults[i]);
+                controlResult->status = 2;  // 2=failed
+                snprintf(controlResult->failedCode, sizeof(controlResult->failedCode),
+                         "%d", itemResults[i]);
+                snprintf(controlResult->failedReason, sizeof(controlResult->failedReason),
+                         "Failed to apply %s=%s", configs[i].item, configs[i].value);
+                allSuccess = false;
             }
         }
 
+        DMSAPIResult_t updateResult = dms_api_control_progress_update(
+            CLIENT_IDENTIFIER, controlResults, configCount);
+
+        if (updateResult == DMS_API_SUCCESS) {
+            DMS_LOG_INFO("✅ Control progress reported for %d item(s)", configCount);
+        } else {
+            DMS_LOG_WARN("⚠️ Failed to report control progress: %d", updateResult);
+        }
+
         return allSuccess ? DMS_SUCCESS : DMS_ERROR_SHADOW_FAILURE;
     } else {
         DMS_LOG_ERROR("❌ Failed to get control config list: %d", apiResult);
@@ -354,6 +1240,7 @@ static dms_result_t execute_control_config_change_command(const dms_command_t* c
 
 #else
     /* DMS API 未啟用時的模擬實作 - 與原始程式碼完全相同 */
+    (void)control_inline;
     DMS_LOG_INFO("🎛️ Processing control-config-change command (simulation)...");
     DMS_LOG_INFO("✅ Control config change command processed (placeholder)");
     return DMS_SUCCESS;
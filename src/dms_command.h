@@ -19,12 +19,18 @@
 
 #include "dms_config.h"
 #include "dms_log.h"
+#include "dms_json_index.h"
 #include "demo_config.h"    // 使用現有的錯誤碼和常數
 
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
 
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define DMS_COMMAND_MAX_PER_DELTA          ( 3U )    /* 一個 delta 可帶的命令種類數 */
+
 /*-----------------------------------------------------------*/
 /* 命令類型定義 - 使用 demo_config.h 中已定義的類型 */
 
@@ -32,15 +38,6 @@
 typedef DMSCommandType_t dms_command_type_t;    // 類型別名，方便使用
 typedef DMSCommand_t dms_command_t;              // 結構別名，方便使用
 
-/*-----------------------------------------------------------*/
-/* BCML 適配器類型定義 */
-
-/**
- * @brief BCML 命令處理器函數類型
- * 對應原始的 bcml_execute_wifi_control 函數簽名
- */
-typedef int (*bcml_command_handler_t)(const char* item, const char* value);
-
 /*-----------------------------------------------------------*/
 /* 公開介面函數 */
 
@@ -60,6 +57,11 @@ dms_result_t dms_command_init(void);
  * 3. resetDesiredState() - 重設 desired 狀態 (委託給 dms_shadow)
  * 4. reportCommandResult() - 回報結果 (委託給 dms_shadow)
  *
+ * delta 中的每個命令各自排入優先佇列，各自回報結果；
+ * 可立即執行的命令在返回前執行完畢。
+ * control-config-change 的值可以是 {"control-configs":[...]}，此時直接套用內嵌的配置，
+ * 未內嵌或內嵌不完整時才經 HTTP 取得控制配置列表
+ *
  * @param topic Shadow 主題 (用於日誌記錄)
  * @param payload JSON payload
  * @param payload_len Payload 長度
@@ -69,19 +71,53 @@ dms_result_t dms_command_process_shadow_delta(const char* topic,
                                              const char* payload,
                                              size_t payload_len);
 
+/**
+ * @brief 以已建立的索引處理 Shadow Delta 命令
+ *
+ * 與 dms_command_process_shadow_delta() 相同，但沿用呼叫端（Shadow 訊息處理）
+ * 已建立的索引，每則 delta 只掃描一次
+ *
+ * @param topic Shadow 主題 (用於日誌記錄)
+ * @param index 涵蓋整份 delta 文件的索引，呼叫期間 payload 必須有效
+ * @return DMS_SUCCESS 成功，其他為錯誤碼
+ */
+dms_result_t dms_command_process_shadow_delta_index(const char* topic,
+                                                   const dms_json_index_t* index);
+
 /**
  * @brief 解析 Shadow Delta JSON
  *
- * 封裝原始的 parseShadowDelta() 函數，邏輯完全相同
+ * 取出 delta 中所有可辨識的命令，而非只取第一個
  *
  * @param payload JSON payload
  * @param payload_len Payload 長度
- * @param command 輸出命令結構
+ * @param commands 輸出命令陣列
+ * @param max_commands 陣列容量（建議 DMS_COMMAND_MAX_PER_DELTA）
+ * @param command_count 輸出命令數量，沒有命令時為 0
  * @return DMS_SUCCESS 成功，其他為錯誤碼
  */
 dms_result_t dms_command_parse_shadow_delta(const char* payload,
                                            size_t payload_len,
-                                           dms_command_t* command);
+                                           dms_command_t* commands,
+                                           size_t max_commands,
+                                           size_t* command_count);
+
+/**
+ * @brief 執行排程中的命令並回報已完成的命令
+ *
+ * 在主迴圈中定期調用：
+ * - 依優先權取出佇列中的命令，同類型執行中的數量不超過上限
+ * - 控制類命令直接執行；日誌上傳、韌體更新在背景執行緒執行
+ * - 背景命令完成後在主迴圈中重設 desired 並回報結果
+ */
+void dms_command_process(void);
+
+/**
+ * @brief 獲取佇列中與執行中的命令數量
+ *
+ * @return 尚未回報結果的命令數量
+ */
+uint32_t dms_command_get_pending_count(void);
 
 /**
  * @brief 執行 DMS 命令
@@ -94,14 +130,13 @@ dms_result_t dms_command_parse_shadow_delta(const char* payload,
 dms_result_t dms_command_execute(const dms_command_t* command);
 
 /**
- * @brief 註冊 BCML 命令處理器
+ * @brief 獲取被去重丟棄的 delta 數量
  *
- * 實現依賴注入，避免直接依賴 BCML 模組
- * 在 main() 中調用：dms_command_register_bcml_handler(bcml_execute_wifi_control);
+ * version 小於或等於該命令鍵最後處理版本的 delta 會在執行前被丟棄
  *
- * @param handler BCML 處理函數 (bcml_execute_wifi_control)
+ * @return 累計丟棄數量
  */
-void dms_command_register_bcml_handler(bcml_command_handler_t handler);
+uint32_t dms_command_get_suppressed_count(void);
 
 /**
  * @brief 清理命令處理模組
@@ -0,0 +1,513 @@
+/*
+ * DMS Command Journal Implementation
+ *
+ * 記錄格式（一行一筆）：
+ *   <id> <state> <type> <value> <version> <result> <key> <checksum>
+ * checksum 為該行前段文字的 FNV-1a；缺少換行或校驗不符的行視為斷電時的殘留，重播到此為止。
+ *
+ * 記憶體中只保留未完成的命令（最多 DMS_COMMAND_QUEUE_SIZE 筆），壓縮時直接以此表重寫檔案。
+ * 壓縮失敗時繼續附加到原檔；開啟時先截掉最後一筆有效記錄之後的殘留，
+ * 新記錄才不會接在不完整的行後面而在下次重播時連同之後的記錄一起被捨棄。
+ */
+
+#include "dms_command_journal.h"
+#include "dms_log.h"
+
+/* 系統標頭檔 */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define JOURNAL_LINE_MAX                  ( 192 )
+#define JOURNAL_MAX_OPEN                  ( DMS_COMMAND_QUEUE_SIZE )
+
+/*-----------------------------------------------------------*/
+/* 內部全域變數 */
+
+static const char* const g_state_names[] = {
+    "received",
+    "executing",
+    "applied",
+    "reported"
+};
+
+static pthread_mutex_t g_journal_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char g_journal_path[256];
+static FILE* g_journal_fp = NULL;
+static uint32_t g_next_id = 1;
+static uint32_t g_record_count = 0;     // 目前檔案中的記錄數
+static bool g_dirty = false;            // 有尚未 fsync 的記錄
+
+static dms_command_journal_entry_t g_open_entries[JOURNAL_MAX_OPEN];
+static size_t g_open_count = 0;
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static uint32_t checksum(const char* text, size_t length);
+static bool parse_record(const char* line, dms_command_journal_entry_t* entry);
+static bool write_record(FILE* fp, const dms_command_journal_entry_t* entry);
+static long replay_journal(void);
+static void apply_record(const dms_command_journal_entry_t* record);
+static dms_command_journal_entry_t* find_entry(uint32_t id);
+static void remove_entry(dms_command_journal_entry_t* entry);
+static dms_result_t append_record(const dms_command_journal_entry_t* entry);
+static dms_result_t sync_locked(void);
+static dms_result_t compact_locked(void);
+static dms_result_t reopen_locked(long valid_length);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 開啟日誌並恢復未完成的命令
+ */
+dms_result_t dms_command_journal_open(const char* path,
+                                      dms_command_journal_entry_t* recovered,
+                                      size_t max_recovered,
+                                      size_t* recovered_count)
+{
+    if (recovered_count != NULL) {
+        *recovered_count = 0;
+    }
+
+    if (path == NULL || path[0] == '\0' || strlen(path) >= sizeof(g_journal_path)) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&g_journal_mutex);
+
+    if (g_journal_fp != NULL) {
+        fclose(g_journal_fp);
+        g_journal_fp = NULL;
+    }
+
+    SAFE_STRNCPY(g_journal_path, path, sizeof(g_journal_path));
+    g_open_count = 0;
+    g_next_id = 1;
+    g_record_count = 0;
+    g_dirty = false;
+
+    long valid_length = replay_journal();
+
+    /* 重寫為只含未完成命令的檔案，同時截掉不完整的尾端 */
+    dms_result_t result = compact_locked();
+    if (result != DMS_SUCCESS) {
+        result = reopen_locked(valid_length);
+    }
+
+    size_t count = 0;
+    if (recovered != NULL) {
+        for (size_t i = 0; i < g_open_count && count < max_recovered; i++) {
+            recovered[count++] = g_open_entries[i];
+        }
+    }
+    if (recovered_count != NULL) {
+        *recovered_count = count;
+    }
+
+    pthread_mutex_unlock(&g_journal_mutex);
+
+    if (g_open_count > 0) {
+        DMS_LOG_INFO("📒 Command journal: %u unfinished command(s) to resume", (unsigned)g_open_count);
+    }
+    return result;
+}
+
+/**
+ * @brief 記錄新收到的命令
+ */
+uint32_t dms_command_journal_begin(const DMSCommand_t* command)
+{
+    if (command == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&g_journal_mutex);
+
+    if (g_journal_fp == NULL || g_open_count >= JOURNAL_MAX_OPEN) {
+        pthread_mutex_unlock(&g_journal_mutex);
+        DMS_LOG_WARN("⚠️ Command journal unavailable, not tracking: %s", command->key);
+        return 0;
+    }
+
+    dms_command_journal_entry_t* entry = &g_open_entries[g_open_count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->id = g_next_id++;
+    entry->state = DMS_COMMAND_JOURNAL_RECEIVED;
+    entry->command = *command;
+    entry->result = DMS_SUCCESS;
+
+    uint32_t id = entry->id;
+    if (append_record(entry) != DMS_SUCCESS) {
+        remove_entry(entry);
+        id = 0;
+    }
+
+    pthread_mutex_unlock(&g_journal_mutex);
+    return id;
+}
+
+/**
+ * @brief 記錄命令狀態轉換
+ */
+dms_result_t dms_command_journal_record(uint32_t id,
+                                        dms_command_journal_state_t state,
+                                        const DMSCommand_t* command,
+                                        dms_result_t result)
+{
+    if (id == 0) {
+        return DMS_SUCCESS;
+    }
+
+    if (state > DMS_COMMAND_JOURNAL_REPORTED) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&g_journal_mutex);
+
+    dms_command_journal_entry_t* entry = find_entry(id);
+    if (g_journal_fp == NULL || entry == NULL) {
+        pthread_mutex_unlock(&g_journal_mutex);
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    entry->state = state;
+    if (command != NULL) {
+        entry->command = *command;
+    }
+    if (state == DMS_COMMAND_JOURNAL_APPLIED) {
+        entry->result = result;
+    }
+
+    dms_result_t status = append_record(entry);
+
+    /* 開始執行與執行完成必須落地，重啟時才能判斷要重做還是只回報 */
+    if (status == DMS_SUCCESS &&
+        (state == DMS_COMMAND_JOURNAL_EXECUTING || state == DMS_COMMAND_JOURNAL_APPLIED)) {
+        status = sync_locked();
+    }
+
+    if (state == DMS_COMMAND_JOURNAL_REPORTED) {
+        remove_entry(entry);
+    }
+
+    pthread_mutex_unlock(&g_journal_mutex);
+    return status;
+}
+
+/**
+ * @brief 將緩衝中的記錄寫入儲存裝置，必要時壓縮日誌
+ */
+dms_result_t dms_command_journal_sync(void)
+{
+    pthread_mutex_lock(&g_journal_mutex);
+
+    dms_result_t result = sync_locked();
+    if (result == DMS_SUCCESS && g_record_count >= DMS_COMMAND_JOURNAL_COMPACT_RECORDS) {
+        result = compact_locked();
+    }
+
+    pthread_mutex_unlock(&g_journal_mutex);
+    return result;
+}
+
+/**
+ * @brief 同步並關閉日誌
+ */
+void dms_command_journal_close(void)
+{
+    pthread_mutex_lock(&g_journal_mutex);
+
+    if (g_journal_fp != NULL) {
+        sync_locked();
+        fclose(g_journal_fp);
+        g_journal_fp = NULL;
+    }
+    g_open_count = 0;
+
+    pthread_mutex_unlock(&g_journal_mutex);
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 記錄校驗碼 (FNV-1a)
+ */
+static uint32_t checksum(const char* text, size_t length)
+{
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief 解析一行記錄
+ *
+ * @return 格式、狀態與校驗碼都正確時返回 true
+ */
+static bool parse_record(const char* line, dms_command_journal_entry_t* entry)
+{
+    size_t length = strlen(line);
+    if (length == 0 || line[length - 1] != '\n') {
+        return false;
+    }
+
+    const char* last_space = strrchr(line, ' ');
+    if (last_space == NULL) {
+        return false;
+    }
+
+    unsigned int stored_checksum;
+    if (sscanf(last_space + 1, "%8x", &stored_checksum) != 1 ||
+        stored_checksum != checksum(line, (size_t)(last_space - line))) {
+        return false;
+    }
+
+    unsigned int id, version;
+    int type, value, result;
+    char state_name[16];
+    char key[sizeof(entry->command.key)];
+
+    if (sscanf(line, "%u %15s %d %d %u %d %63s", &id, state_name, &type, &value,
+               &version, &result, key) != 7 || id == 0) {
+        return false;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    entry->state = (dms_command_journal_state_t)ARRAY_SIZE(g_state_names);
+    for (size_t i = 0; i < ARRAY_SIZE(g_state_names); i++) {
+        if (strcmp(state_name, g_state_names[i]) == 0) {
+            entry->state = (dms_command_journal_state_t)i;
+            break;
+        }
+    }
+    if ((size_t)entry->state >= ARRAY_SIZE(g_state_names)) {
+        return false;
+    }
+
+    entry->id = id;
+    entry->result = (dms_result_t)result;
+    entry->command.type = (DMSCommandType_t)type;
+    entry->command.value = value;
+    entry->command.version = version;
+    SAFE_STRNCPY(entry->command.key, key, sizeof(entry->command.key));
+    return true;
+}
+
+/**
+ * @brief 寫入一行記錄
+ */
+static bool write_record(FILE* fp, const dms_command_journal_entry_t* entry)
+{
+    char line[JOURNAL_LINE_MAX];
+
+    int length = snprintf(line, sizeof(line), "%u %s %d %d %u %d %s",
+                          entry->id, g_state_names[entry->state],
+                          (int)entry->command.type, entry->command.value,
+                          entry->command.version, (int)entry->result, entry->command.key);
+    if (length < 0 || (size_t)length >= sizeof(line)) {
+        return false;
+    }
+
+    return fprintf(fp, "%s %08x\n", line, checksum(line, (size_t)length)) > 0;
+}
+
+/**
+ * @brief 重播日誌檔案，重建未完成命令表
+ *
+ * @return 最後一筆有效記錄結尾的位元組位置
+ */
+static long replay_journal(void)
+{
+    FILE* fp = fopen(g_journal_path, "r");
+    if (fp == NULL) {
+        DMS_LOG_DEBUG("No command journal, starting empty");
+        return 0;
+    }
+
+    char line[JOURNAL_LINE_MAX];
+    uint32_t records = 0;
+    long valid_length = 0;
+    dms_command_journal_entry_t record;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (!parse_record(line, &record)) {
+            DMS_LOG_WARN("⚠️ Command journal truncated after %u record(s)", records);
+            break;
+        }
+        apply_record(&record);
+        records++;
+        valid_length = ftell(fp);
+    }
+
+    fclose(fp);
+    g_record_count = records;
+    DMS_LOG_DEBUG("Command journal replayed: %u record(s), %u unfinished",
+                  records, (unsigned)g_open_count);
+    return valid_length;
+}
+
+/**
+ * @brief 將一筆重播的記錄套用到未完成命令表
+ */
+static void apply_record(const dms_command_journal_entry_t* record)
+{
+    if (record->id >= g_next_id) {
+        g_next_id = record->id + 1;
+    }
+
+    dms_command_journal_entry_t* entry = find_entry(record->id);
+
+    if (record->state == DMS_COMMAND_JOURNAL_REPORTED) {
+        if (entry != NULL) {
+            remove_entry(entry);
+        }
+        return;
+    }
+
+    if (entry == NULL) {
+        if (g_open_count >= JOURNAL_MAX_OPEN) {
+            DMS_LOG_WARN("⚠️ Command journal has too many unfinished commands, dropping: %s",
+                         record->command.key);
+            return;
+        }
+        entry = &g_open_entries[g_open_count++];
+    }
+
+    *entry = *record;
+}
+
+/**
+ * @brief 在未完成命令表中尋找 id
+ */
+static dms_command_journal_entry_t* find_entry(uint32_t id)
+{
+    for (size_t i = 0; i < g_open_count; i++) {
+        if (g_open_entries[i].id == id) {
+            return &g_open_entries[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 從未完成命令表移除，保持 id 遞增順序
+ */
+static void remove_entry(dms_command_journal_entry_t* entry)
+{
+    size_t index = (size_t)(entry - g_open_entries);
+
+    memmove(&g_open_entries[index], &g_open_entries[index + 1],
+            (g_open_count - index - 1) * sizeof(g_open_entries[0]));
+    g_open_count--;
+}
+
+/**
+ * @brief 附加一筆記錄（只寫入 stdio 緩衝區）
+ */
+static dms_result_t append_record(const dms_command_journal_entry_t* entry)
+{
+    if (!write_record(g_journal_fp, entry)) {
+        DMS_LOG_WARN("⚠️ Failed to append command journal record for %s", entry->command.key);
+        return DMS_ERROR_SYSTEM_FILE_ACCESS;
+    }
+
+    g_record_count++;
+    g_dirty = true;
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 將緩衝中的記錄 fsync 到儲存裝置
+ */
+static dms_result_t sync_locked(void)
+{
+    if (g_journal_fp == NULL || !g_dirty) {
+        return DMS_SUCCESS;
+    }
+
+    if (fflush(g_journal_fp) != 0 || fsync(fileno(g_journal_fp)) != 0) {
+        DMS_LOG_WARN("⚠️ Failed to sync command journal");
+        return DMS_ERROR_SYSTEM_FILE_ACCESS;
+    }
+
+    g_dirty = false;
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 以未完成命令表重寫日誌
+ *
+ * 先寫暫存檔再 rename，壓縮過程中斷電時舊檔仍然完整；
+ * rename 成功後才換成新檔，失敗時原本的日誌檔案代碼不受影響
+ */
+static dms_result_t compact_locked(void)
+{
+    char tmp_path[sizeof(g_journal_path) + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", g_journal_path);
+
+    FILE* fp = fopen(tmp_path, "w");
+    if (fp == NULL) {
+        DMS_LOG_WARN("⚠️ Failed to open command journal for compaction");
+        return DMS_ERROR_SYSTEM_FILE_ACCESS;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < g_open_count && ok; i++) {
+        ok = write_record(fp, &g_open_entries[i]);
+    }
+
+    ok = ok && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+
+    if (!ok || rename(tmp_path, g_journal_path) != 0) {
+        DMS_LOG_WARN("⚠️ Failed to compact command journal");
+        fclose(fp);
+        unlink(tmp_path);
+        return DMS_ERROR_SYSTEM_FILE_ACCESS;
+    }
+
+    /* 暫存檔已改名為日誌，沿用同一個檔案代碼繼續附加 */
+    if (g_journal_fp != NULL) {
+        fclose(g_journal_fp);
+    }
+    g_journal_fp = fp;
+    g_record_count = (uint32_t)g_open_count;
+    g_dirty = false;
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 開啟時壓縮失敗，改為附加到原檔
+ *
+ * @param valid_length 重播時最後一筆有效記錄的結尾，之後的殘留先截掉
+ */
+static dms_result_t reopen_locked(long valid_length)
+{
+    g_journal_fp = fopen(g_journal_path, "a");
+    if (g_journal_fp == NULL) {
+        DMS_LOG_WARN("⚠️ Failed to open command journal for appending");
+        return DMS_ERROR_SYSTEM_FILE_ACCESS;
+    }
+
+    if (ftruncate(fileno(g_journal_fp), (off_t)valid_length) != 0) {
+        DMS_LOG_WARN("⚠️ Failed to truncate command journal tail");
+        fclose(g_journal_fp);
+        g_journal_fp = NULL;
+        return DMS_ERROR_SYSTEM_FILE_ACCESS;
+    }
+
+    g_dirty = false;
+    return DMS_SUCCESS;
+}
@@ -0,0 +1,104 @@
+
+/*
+ * DMS Command Journal
+ *
+ * 記錄命令狀態轉換的附加式日誌，讓程序崩潰或裝置重開機後可以接續未完成的命令：
+ * - 每筆記錄為一行文字：id、狀態、命令內容、執行結果與校驗碼
+ * - 同一 id 以最後一筆有效記錄為準；校驗碼不符或不完整的行（斷電時寫到一半）結束重播
+ * - fsync 只在必要的時間點批次執行：開始執行前、執行完成後；REPORTED 隨下一次同步寫入
+ * - 記錄數超過門檻且可同步時，以暫存檔 + rename 壓縮為只含未完成命令的新檔
+ *
+ * 狀態流程：RECEIVED → EXECUTING → APPLIED → REPORTED
+ * 重啟後 RECEIVED / EXECUTING 需重新執行，APPLIED 只需回報，REPORTED 已完成
+ */
+
+#ifndef DMS_COMMAND_JOURNAL_H_
+#define DMS_COMMAND_JOURNAL_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "demo_config.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief 命令在日誌中的狀態
+ */
+typedef enum {
+    DMS_COMMAND_JOURNAL_RECEIVED = 0,   /* 已排入佇列 */
+    DMS_COMMAND_JOURNAL_EXECUTING,      /* 已開始執行 */
+    DMS_COMMAND_JOURNAL_APPLIED,        /* 執行完成，結果尚未回報 */
+    DMS_COMMAND_JOURNAL_REPORTED        /* 已重設 desired 並回報結果 */
+} dms_command_journal_state_t;
+
+/**
+ * @brief 未完成的命令（重啟後由日誌恢復）
+ */
+typedef struct {
+    uint32_t id;
+    dms_command_journal_state_t state;
+    DMSCommand_t command;
+    dms_result_t result;                /* APPLIED 時的執行結果 */
+} dms_command_journal_entry_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 開啟日誌並恢復未完成的命令
+ *
+ * 重播既有記錄後立即壓縮，捨棄已完成的命令與不完整的尾端。
+ * 檔案不存在時視為空日誌。
+ *
+ * @param path 日誌檔案路徑
+ * @param recovered 輸出未完成的命令（依 id 排序），可為 NULL
+ * @param max_recovered recovered 容量
+ * @param recovered_count 輸出的命令數量，可為 NULL
+ * @return DMS_SUCCESS 成功，DMS_ERROR_SYSTEM_FILE_ACCESS 無法寫入日誌（命令仍可執行，只是不記錄）
+ */
+dms_result_t dms_command_journal_open(const char* path,
+                                      dms_command_journal_entry_t* recovered,
+                                      size_t max_recovered,
+                                      size_t* recovered_count);
+
+/**
+ * @brief 記錄新收到的命令
+ *
+ * @return 命令的日誌 id，日誌未開啟或已滿時返回 0
+ */
+uint32_t dms_command_journal_begin(const DMSCommand_t* command);
+
+/**
+ * @brief 記錄命令狀態轉換
+ *
+ * EXECUTING 與 APPLIED 會在返回前 fsync；RECEIVED 與 REPORTED 只寫入緩衝區。
+ * 可在背景執行緒調用。
+ *
+ * @param id dms_command_journal_begin() 返回的 id，0 時忽略
+ * @param state 新狀態
+ * @param command 命令內容（RECEIVED 時可用於更新合併後的命令），NULL 表示不變
+ * @param result APPLIED 的執行結果，其他狀態忽略
+ */
+dms_result_t dms_command_journal_record(uint32_t id,
+                                        dms_command_journal_state_t state,
+                                        const DMSCommand_t* command,
+                                        dms_result_t result);
+
+/**
+ * @brief 將緩衝中的記錄寫入儲存裝置，必要時壓縮日誌
+ */
+dms_result_t dms_command_journal_sync(void);
+
+/**
+ * @brief 同步並關閉日誌
+ */
+void dms_command_journal_close(void);
+
+#endif /* DMS_COMMAND_JOURNAL_H_ */
@@ -21,9 +21,13 @@ static bool g_config_initialized = false;
 static void load_default_aws_iot_config(dms_aws_iot_config_t* config);
 static void load_default_api_config(dms_api_config_t* config);
 static void load_default_reconnect_config(dms_reconnect_config_t* config);
+static void load_default_telemetry_config(dms_telemetry_config_t* config);
+static void load_default_report_config(dms_report_config_t* config);
 static dms_result_t validate_aws_iot_config(const dms_aws_iot_config_t* config);
 static dms_result_t validate_api_config(const dms_api_config_t* config);
 static dms_result_t validate_reconnect_config(const dms_reconnect_config_t* config);
+static dms_result_t validate_telemetry_config(const dms_telemetry_config_t* config);
+static dms_result_t validate_report_config(const dms_report_config_t* config);
 
 /*-----------------------------------------------------------*/
 /* 公開介面實作 */
@@ -43,6 +47,8 @@ dms_result_t dms_config_init(void) {
     load_default_aws_iot_config(&g_config.aws_iot);
     load_default_api_config(&g_config.api);
     load_default_reconnect_config(&g_config.reconnect);
+    load_default_telemetry_config(&g_config.telemetry);
+    load_default_report_config(&g_config.report);
 
     // 驗證配置
     dms_result_t result = dms_config_validate();
@@ -94,6 +100,22 @@ const dms_reconnect_config_t* dms_config_get_reconnect(void) {
     return &g_config.reconnect;
 }
 
+const dms_telemetry_config_t* dms_config_get_telemetry(void) {
+    if (!g_config_initialized) {
+        DMS_LOG_ERROR("Configuration not initialized");
+        return NULL;
+    }
+    return &g_config.telemetry;
+}
+
+const dms_report_config_t* dms_config_get_report(void) {
+    if (!g_config_initialized) {
+        DMS_LOG_ERROR("Configuration not initialized");
+        return NULL;
+    }
+    return &g_config.report;
+}
+
 dms_result_t dms_config_validate(void) {
     // 驗證 AWS IoT 配置
     dms_result_t result = validate_aws_iot_config(&g_config.aws_iot);
@@ -113,6 +135,18 @@ dms_result_t dms_config_validate(void) {
         return result;
     }
 
+    // 驗證遙測配置
+    result = validate_telemetry_config(&g_config.telemetry);
+    if (result != DMS_SUCCESS) {
+        return result;
+    }
+
+    // 驗證回報通道配置
+    result = validate_report_config(&g_config.report);
+    if (result != DMS_SUCCESS) {
+        return result;
+    }
+
     return DMS_SUCCESS;
 }
 
@@ -146,6 +180,10 @@ static void load_default_aws_iot_config(dms_aws_iot_config_t* config) {
     config->process_loop_timeout_ms = 1000;
     config->network_buffer_size = 2048;
     config->transport_timeout_ms = 5000;
+    config->dead_link_timeout_seconds = MQTT_DEAD_LINK_TIMEOUT_SECONDS;
+    config->tls_session_resumption = true;
+    strncpy(config->tls_session_cache_path, TLS_SESSION_CACHE_FILE,
+            sizeof(config->tls_session_cache_path) - 1);
 }
 
 static void load_default_api_config(dms_api_config_t* config) {
@@ -172,6 +210,22 @@ static void load_default_reconnect_config(dms_reconnect_config_t* config) {
     config->enable_exponential_backoff = true;
 }
 
+static void load_default_telemetry_config(dms_telemetry_config_t* config) {
+    config->enabled = true;
+    config->sample_interval_ms = TELEMETRY_SAMPLE_INTERVAL_MS;
+    config->bucket_seconds = TELEMETRY_BUCKET_SECONDS;
+    config->publish_interval_seconds = TELEMETRY_PUBLISH_INTERVAL_SECONDS;
+    config->max_buckets_per_publish = TELEMETRY_MAX_BUCKETS_PER_PUBLISH;
+}
+
+static void load_default_report_config(dms_report_config_t* config) {
+    config->mqtt_control_progress = DMS_REPORT_MQTT_CONTROL_PROGRESS;
+    config->mqtt_fw_progress = DMS_REPORT_MQTT_FW_PROGRESS;
+    config->mqtt_device_info = DMS_REPORT_MQTT_DEVICE_INFO;
+    config->batch_window_ms = DMS_REPORT_BATCH_WINDOW_MS;
+    config->max_hold_ms = DMS_REPORT_MAX_HOLD_MS;
+}
+
 static dms_result_t validate_aws_iot_config(const dms_aws_iot_config_t* config) {
     if (!config) {
         return DMS_ERROR_INVALID_PARAMETER;  // ✅ 使用正確的錯誤碼
@@ -192,6 +246,11 @@ static dms_result_t validate_aws_iot_config(const dms_aws_iot_config_t* config)
         return DMS_ERROR_UCI_CONFIG_FAILED;  // ✅ 使用 demo_config.h 中存在的錯誤碼
     }
 
+    if (config->dead_link_timeout_seconds == 0) {
+        DMS_LOG_ERROR("Dead link timeout must be greater than 0");
+        return DMS_ERROR_UCI_CONFIG_FAILED;
+    }
+
     return DMS_SUCCESS;
 }
 
@@ -231,3 +290,47 @@ static dms_result_t validate_reconnect_config(const dms_reconnect_config_t* conf
     return DMS_SUCCESS;
 }
 
+static dms_result_t validate_telemetry_config(const dms_telemetry_config_t* config) {
+    if (!config) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (!config->enabled) {
+        return DMS_SUCCESS;
+    }
+
+    if (config->sample_interval_ms == 0 || config->bucket_seconds == 0) {
+        DMS_LOG_ERROR("Telemetry sample interval and bucket length must be greater than 0");
+        return DMS_ERROR_UCI_CONFIG_FAILED;
+    }
+
+    if (config->sample_interval_ms > SECONDS_TO_MS((uint32_t)config->bucket_seconds)) {
+        DMS_LOG_ERROR("Telemetry sample interval must not exceed bucket length");
+        return DMS_ERROR_UCI_CONFIG_FAILED;
+    }
+
+    if (config->publish_interval_seconds < config->bucket_seconds) {
+        DMS_LOG_ERROR("Telemetry publish interval must not be shorter than bucket length");
+        return DMS_ERROR_UCI_CONFIG_FAILED;
+    }
+
+    if (config->max_buckets_per_publish == 0) {
+        DMS_LOG_ERROR("Telemetry batch size must be greater than 0");
+        return DMS_ERROR_UCI_CONFIG_FAILED;
+    }
+
+    return DMS_SUCCESS;
+}
+
+static dms_result_t validate_report_config(const dms_report_config_t* config) {
+    if (!config) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (config->max_hold_ms < config->batch_window_ms) {
+        DMS_LOG_ERROR("Report hold time must not be shorter than batch window");
+        return DMS_ERROR_UCI_CONFIG_FAILED;
+    }
+
+    return DMS_SUCCESS;
+}
@@ -38,6 +38,9 @@ typedef struct {
     uint32_t process_loop_timeout_ms;    // 處理循環超時
     uint32_t network_buffer_size;        // 網路緩衝區大小
     uint32_t transport_timeout_ms;       // 傳輸超時
+    uint16_t dead_link_timeout_seconds;  // 判定連線中斷的時間上限（TCP keepalive / user timeout / PINGRESP）
+    bool tls_session_resumption;         // 啟用 TLS session 恢復
+    char tls_session_cache_path[256];    // TLS session 快取檔案（空字串表示僅保存在記憶體）
 } dms_aws_iot_config_t;
 
 /**
@@ -63,6 +66,30 @@ typedef struct {
     bool enable_exponential_backoff;     // 啟用指數退避
 } dms_reconnect_config_t;
 
+/**
+ * @brief 遙測配置
+ */
+typedef struct {
+    bool enabled;                        // 啟用遙測取樣與上傳
+    uint32_t sample_interval_ms;         // 取樣間隔
+    uint16_t bucket_seconds;             // 降採樣區間長度
+    uint16_t publish_interval_seconds;   // 上傳間隔
+    uint16_t max_buckets_per_publish;    // 每則訊息最多包含的區間數
+} dms_telemetry_config_t;
+
+/**
+ * @brief 回報通道配置
+ *
+ * 各端點可改由 MQTT 回報通道送出；伺服器尚未支援的端點保持 HTTP
+ */
+typedef struct {
+    bool mqtt_control_progress;          // 控制進度改走 MQTT
+    bool mqtt_fw_progress;               // 韌體進度改走 MQTT
+    bool mqtt_device_info;               // 裝置資訊改走 MQTT
+    uint16_t batch_window_ms;            // 批次等待時間
+    uint32_t max_hold_ms;                // 斷線時最長保留時間，逾時改走 HTTP
+} dms_report_config_t;
+
 /**
  * @brief 完整配置結構
  */
@@ -70,6 +97,8 @@ typedef struct {
     dms_aws_iot_config_t aws_iot;        // AWS IoT 配置
     dms_api_config_t api;                // DMS API 配置
     dms_reconnect_config_t reconnect;    // 重連配置
+    dms_telemetry_config_t telemetry;    // 遙測配置
+    dms_report_config_t report;          // 回報通道配置
     bool initialized;                    // 初始化標記
 } dms_config_t;
 
@@ -106,6 +135,18 @@ const dms_api_config_t* dms_config_get_api(void);
  */
 const dms_reconnect_config_t* dms_config_get_reconnect(void);
 
+/**
+ * @brief 獲取遙測配置
+ * @return 遙測配置指針，如果未初始化則返回 NULL
+ */
+const dms_telemetry_config_t* dms_config_get_telemetry(void);
+
+/**
+ * @brief 獲取回報通道配置
+ * @return 回報通道配置指針，如果未初始化則返回 NULL
+ */
+const dms_report_config_t* dms_config_get_report(void);
+
 /**
  * @brief 驗證配置有效性
  * @return DMS_SUCCESS 配置有效，其他為錯誤碼
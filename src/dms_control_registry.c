@@ -0,0 +1,363 @@
+/*
+ * DMS Control Item Registry Implementation
+ *
+ * 項目以開放定址（線性探測）的雜湊表保存，表內只存描述指標；
+ * 群組數量很少，以陣列線性查詢。
+ *
+ * 套用時每個群組是一個工作，群組內的項目依原順序一次交給套用函數。
+ * 平行群組放入工作佇列，由最多 MAX_WORKERS 個執行緒取出執行；其他群組由調用者
+ * 依序套用，完成後調用者也從佇列取出剩餘的工作。
+ */
+
+#include "dms_control_registry.h"
+#include "dms_log.h"
+
+/* 系統標頭檔 */
+#include <string.h>
+#include <pthread.h>
+
+/*-----------------------------------------------------------*/
+/* 內部類型定義 */
+
+typedef struct {
+    const char* name;
+    dms_control_group_apply_t apply;
+    uint32_t flags;                     // DMS_CONTROL_GROUP_*
+} control_group_t;
+
+/* 一個群組的套用工作 */
+typedef struct {
+    const control_group_t* group;
+    size_t count;
+    const char* items[DMS_CONTROL_REGISTRY_MAX_BATCH];
+    const char* values[DMS_CONTROL_REGISTRY_MAX_BATCH];
+    int results[DMS_CONTROL_REGISTRY_MAX_BATCH];
+    size_t index[DMS_CONTROL_REGISTRY_MAX_BATCH];   // 在原始批次中的位置
+} group_job_t;
+
+typedef struct {
+    group_job_t** jobs;
+    size_t job_count;
+    size_t next_job;
+    pthread_mutex_t mutex;
+} job_queue_t;
+
+/*-----------------------------------------------------------*/
+/* 內部全域變數 */
+
+static const dms_control_item_t* g_item_table[DMS_CONTROL_REGISTRY_CAPACITY];
+static size_t g_item_count = 0;
+
+static control_group_t g_groups[DMS_CONTROL_REGISTRY_MAX_GROUPS];
+static size_t g_group_count = 0;
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static uint32_t hash_name(const char* name);
+static const dms_control_item_t** find_slot(const char* item);
+static const control_group_t* find_group(const char* group);
+static void apply_job(group_job_t* job);
+static void run_jobs(job_queue_t* queue);
+static void* job_worker(void* arg);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 註冊 apply-group
+ */
+dms_result_t dms_control_registry_register_group(const char* group, dms_control_group_apply_t apply,
+                                                 uint32_t flags)
+{
+    if (group == NULL || apply == NULL) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    control_group_t* entry = (control_group_t*)find_group(group);
+    if (entry == NULL) {
+        if (g_group_count >= DMS_CONTROL_REGISTRY_MAX_GROUPS) {
+            DMS_LOG_ERROR("❌ Control registry: too many apply-groups, dropping %s", group);
+            return DMS_ERROR_BUFFER_OVERFLOW;
+        }
+        entry = &g_groups[g_group_count++];
+        entry->name = group;
+    }
+
+    entry->apply = apply;
+    entry->flags = flags;
+    DMS_LOG_DEBUG("Control registry: apply-group %s registered%s", group,
+                  (flags & DMS_CONTROL_GROUP_PARALLEL) ? " (parallel)" : "");
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 註冊控制項目描述表
+ */
+dms_result_t dms_control_registry_register_items(const dms_control_item_t* items, size_t count)
+{
+    if (items == NULL) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (items[i].item == NULL) {
+            return DMS_ERROR_INVALID_PARAMETER;
+        }
+
+        const dms_control_item_t** slot = find_slot(items[i].item);
+        if (*slot == NULL) {
+            if (g_item_count >= DMS_CONTROL_REGISTRY_MAX_ITEMS) {
+                DMS_LOG_ERROR("❌ Control registry full, dropping %s", items[i].item);
+                return DMS_ERROR_BUFFER_OVERFLOW;
+            }
+            g_item_count++;
+        }
+        *slot = &items[i];
+    }
+
+    DMS_LOG_DEBUG("Control registry: %u item(s) registered", (unsigned)g_item_count);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 查詢控制項目
+ */
+const dms_control_item_t* dms_control_registry_find(const char* item)
+{
+    if (item == NULL) {
+        return NULL;
+    }
+    return *find_slot(item);
+}
+
+/**
+ * @brief 獲取已註冊的項目數量
+ */
+size_t dms_control_registry_get_item_count(void)
+{
+    return g_item_count;
+}
+
+/**
+ * @brief 套用一批控制項目
+ */
+int dms_control_registry_apply(const char* const* items, const char* const* values,
+                               int* results, size_t count)
+{
+    if (items == NULL || values == NULL || results == NULL ||
+        count == 0 || count > DMS_CONTROL_REGISTRY_MAX_BATCH) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    const control_group_t* groups[DMS_CONTROL_REGISTRY_MAX_BATCH];
+
+    /* 步驟1：查詢與驗證，找出每個項目的群組 */
+    for (size_t i = 0; i < count; i++) {
+        const dms_control_item_t* entry = dms_control_registry_find(items[i]);
+        groups[i] = NULL;
+
+        if (entry == NULL) {
+            DMS_LOG_WARN("⚠️ Unsupported control item: %s", items[i] ? items[i] : "(null)");
+            results[i] = DMS_ERROR_UNSUPPORTED;
+            continue;
+        }
+
+        if (values[i] == NULL) {
+            DMS_LOG_WARN("⚠️ Missing value for %s", items[i]);
+            results[i] = DMS_ERROR_INVALID_PARAMETER;
+            continue;
+        }
+
+        if (entry->validate != NULL) {
+            results[i] = entry->validate(items[i], values[i]);
+            if (results[i] != 0) {
+                DMS_LOG_WARN("⚠️ Invalid value for %s: %s", items[i], values[i]);
+                continue;
+            }
+        }
+
+        groups[i] = (entry->group != NULL) ? find_group(entry->group) : NULL;
+        if (groups[i] == NULL) {
+            DMS_LOG_WARN("⚠️ No apply-group handler for %s", items[i]);
+            results[i] = DMS_ERROR_UNSUPPORTED;
+            continue;
+        }
+        results[i] = 0;
+    }
+
+    /* 步驟2：每個群組一個工作，群組內保持原順序 */
+    group_job_t jobs[DMS_CONTROL_REGISTRY_MAX_GROUPS];
+    size_t job_count = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (groups[i] == NULL) {
+            continue;
+        }
+
+        group_job_t* job = &jobs[job_count++];
+        job->group = groups[i];
+        job->count = 0;
+
+        for (size_t j = i; j < count; j++) {
+            if (groups[j] == job->group) {
+                job->index[job->count] = j;
+                job->items[job->count] = items[j];
+                job->values[job->count] = values[j];
+                job->results[job->count] = 0;
+                job->count++;
+                groups[j] = NULL;
+            }
+        }
+    }
+
+    /* 步驟3：平行群組交給工作執行緒，其他群組由調用者依序套用 */
+    group_job_t* parallel_jobs[DMS_CONTROL_REGISTRY_MAX_GROUPS];
+    size_t parallel_count = 0;
+    bool has_serial = false;
+
+    for (size_t i = 0; i < job_count; i++) {
+        if (jobs[i].group->flags & DMS_CONTROL_GROUP_PARALLEL) {
+            parallel_jobs[parallel_count++] = &jobs[i];
+        } else {
+            has_serial = true;
+        }
+    }
+
+    /* 沒有依序群組時調用者直接參與取工作，少開一個執行緒 */
+    size_t wanted_workers = has_serial ? parallel_count : (parallel_count > 0 ? parallel_count - 1 : 0);
+    job_queue_t queue = { .jobs = parallel_jobs, .job_count = parallel_count, .next_job = 0 };
+    pthread_t workers[DMS_CONTROL_REGISTRY_MAX_WORKERS];
+    size_t worker_count = 0;
+
+    pthread_mutex_init(&queue.mutex, NULL);
+    while (worker_count < DMS_CONTROL_REGISTRY_MAX_WORKERS && worker_count < wanted_workers) {
+        if (pthread_create(&workers[worker_count], NULL, job_worker, &queue) != 0) {
+            DMS_LOG_WARN("⚠️ Control registry: worker start failed, continuing with %u",
+                         (unsigned)worker_count);
+            break;
+        }
+        worker_count++;
+    }
+
+    for (size_t i = 0; i < job_count; i++) {
+        if (!(jobs[i].group->flags & DMS_CONTROL_GROUP_PARALLEL)) {
+            apply_job(&jobs[i]);
+        }
+    }
+
+    run_jobs(&queue);
+
+    for (size_t i = 0; i < worker_count; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    pthread_mutex_destroy(&queue.mutex);
+
+    for (size_t i = 0; i < job_count; i++) {
+        for (size_t k = 0; k < jobs[i].count; k++) {
+            results[jobs[i].index[k]] = jobs[i].results[k];
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (results[i] != 0) {
+            return results[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 清除所有註冊
+ */
+void dms_control_registry_reset(void)
+{
+    memset(g_item_table, 0, sizeof(g_item_table));
+    g_item_count = 0;
+    memset(g_groups, 0, sizeof(g_groups));
+    g_group_count = 0;
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 項目名稱雜湊 (FNV-1a)
+ */
+static uint32_t hash_name(const char* name)
+{
+    uint32_t hash = 2166136261U;
+
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief 尋找項目所在位置，不存在時返回可插入的空位
+ *
+ * 項目數不超過 MAX_ITEMS，表內一定有空位，探測必定結束
+ */
+static const dms_control_item_t** find_slot(const char* item)
+{
+    uint32_t index = hash_name(item) & (DMS_CONTROL_REGISTRY_CAPACITY - 1U);
+
+    while (g_item_table[index] != NULL && strcmp(g_item_table[index]->item, item) != 0) {
+        index = (index + 1U) & (DMS_CONTROL_REGISTRY_CAPACITY - 1U);
+    }
+
+    return &g_item_table[index];
+}
+
+/**
+ * @brief 套用一個群組的工作
+ */
+static void apply_job(group_job_t* job)
+{
+    DMS_LOG_DEBUG("Applying %u item(s) in group %s", (unsigned)job->count, job->group->name);
+    job->group->apply(job->items, job->values, job->results, job->count);
+}
+
+/**
+ * @brief 從佇列取出工作執行，直到佇列為空
+ */
+static void run_jobs(job_queue_t* queue)
+{
+    for (;;) {
+        pthread_mutex_lock(&queue->mutex);
+        group_job_t* job = (queue->next_job < queue->job_count) ?
+                           queue->jobs[queue->next_job++] : NULL;
+        pthread_mutex_unlock(&queue->mutex);
+
+        if (job == NULL) {
+            return;
+        }
+
+        apply_job(job);
+    }
+}
+
+/**
+ * @brief 工作執行緒
+ */
+static void* job_worker(void* arg)
+{
+    run_jobs((job_queue_t*)arg);
+    return NULL;
+}
+
+/**
+ * @brief 查詢 apply-group
+ */
+static const control_group_t* find_group(const char* group)
+{
+    for (size_t i = 0; i < g_group_count; i++) {
+        if (strcmp(g_groups[i].name, group) == 0) {
+            return &g_groups[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,134 @@
+
+/*
+ * DMS Control Item Registry
+ *
+ * 控制項目名稱到處理方式的對照表，取代各處的 strcmp / strstr 判斷：
+ * - 每個項目描述驗證函數與 apply-group，以 FNV-1a 雜湊表查詢
+ * - 同一 apply-group 的項目合併為一次套用（例如 wireless 只重啟一次無線介面）
+ * - 標記 DMS_CONTROL_GROUP_PARALLEL 的群組在有上限的執行緒池中平行套用，
+ *   其他群組在調用者的執行緒中依批次中第一次出現的順序逐一套用
+ * - 各模組在初始化時註冊自己的項目與群組，新增控制領域不需修改命令模組
+ *
+ * 註冊應在初始化階段完成；查詢與套用只在主迴圈中進行，不做同步保護。
+ * 平行群組的套用函數在工作執行緒中被調用，與其他群組的套用函數同時執行，
+ * 只能使用執行緒安全的共用狀態；同一群組的套用函數不會同時執行。
+ */
+
+#ifndef DMS_CONTROL_REGISTRY_H_
+#define DMS_CONTROL_REGISTRY_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "demo_config.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define DMS_CONTROL_REGISTRY_CAPACITY      ( 64U )   /* 雜湊表大小，必須為 2 的次方 */
+#define DMS_CONTROL_REGISTRY_MAX_ITEMS     ( 48U )   /* 負載因子上限 3/4 */
+#define DMS_CONTROL_REGISTRY_MAX_GROUPS    ( 8U )
+#define DMS_CONTROL_REGISTRY_MAX_BATCH     ( 16U )   /* 一次套用的項目上限 */
+#define DMS_CONTROL_REGISTRY_MAX_WORKERS   ( 3U )    /* 平行套用時額外的執行緒數（調用者也會執行） */
+
+/* apply-group 旗標 */
+#define DMS_CONTROL_GROUP_PARALLEL         ( 1U << 0 )  /* 套用函數執行緒安全，可在工作執行緒中平行套用 */
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief 項目驗證函數
+ * @return 0 表示有效，其他為模組自訂的錯誤碼
+ */
+typedef int (*dms_control_validator_t)(const char* item, const char* value);
+
+/**
+ * @brief apply-group 套用函數
+ *
+ * 一次套用同一群組的多個項目，逐項寫入 results（0 表示成功）
+ *
+ * @return 0 表示全部成功，其他為第一個失敗項目的錯誤碼
+ */
+typedef int (*dms_control_group_apply_t)(const char* const* items, const char* const* values,
+                                         int* results, size_t count);
+
+/**
+ * @brief 控制項目描述
+ *
+ * 註冊時只保存指標，描述表必須為靜態儲存期
+ */
+typedef struct {
+    const char* item;                   // 控制項目名稱（如 "channel2g"）
+    const char* group;                  // apply-group 名稱（如 "wireless"）
+    dms_control_validator_t validate;   // 可為 NULL
+    int id;                             // 模組自訂代碼（如 WiFiControlType_t）
+} dms_control_item_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 註冊 apply-group
+ *
+ * 同名群組再次註冊時取代原本的套用函數與旗標
+ *
+ * @param group 群組名稱（靜態字串）
+ * @param apply 套用函數
+ * @param flags DMS_CONTROL_GROUP_* 旗標，0 表示在調用者的執行緒中依序套用
+ * @return DMS_SUCCESS 成功，DMS_ERROR_BUFFER_OVERFLOW 群組數已達上限
+ */
+dms_result_t dms_control_registry_register_group(const char* group, dms_control_group_apply_t apply,
+                                                 uint32_t flags);
+
+/**
+ * @brief 註冊控制項目描述表
+ *
+ * 同名項目再次註冊時取代原本的描述
+ *
+ * @param items 描述表（靜態儲存期）
+ * @param count 項目數量
+ * @return DMS_SUCCESS 成功，DMS_ERROR_BUFFER_OVERFLOW 項目數已達上限（之前的項目仍然有效）
+ */
+dms_result_t dms_control_registry_register_items(const dms_control_item_t* items, size_t count);
+
+/**
+ * @brief 查詢控制項目
+ * @return 項目描述，未註冊時返回 NULL
+ */
+const dms_control_item_t* dms_control_registry_find(const char* item);
+
+/**
+ * @brief 獲取已註冊的項目數量
+ */
+size_t dms_control_registry_get_item_count(void);
+
+/**
+ * @brief 套用一批控制項目
+ *
+ * 逐項查詢並驗證，再依 apply-group 分組，每個群組只調用一次套用函數。
+ * 平行群組交給執行緒池，同時調用者依序套用其他群組，總延遲約為最慢的一條路徑
+ * 而非全部相加；所有群組完成後才返回。
+ * 未註冊、驗證失敗或群組沒有套用函數的項目不會送出，各自在 results 中回報：
+ * 未註冊或沒有套用函數為 DMS_ERROR_UNSUPPORTED，驗證失敗為驗證函數的錯誤碼。
+ *
+ * @param items 控制項目名稱陣列
+ * @param values 控制值陣列
+ * @param results 輸出每個項目的結果（0 表示成功）
+ * @param count 項目數量（不超過 DMS_CONTROL_REGISTRY_MAX_BATCH）
+ * @return 0 表示全部成功，其他為第一個失敗項目的錯誤碼
+ */
+int dms_control_registry_apply(const char* const* items, const char* const* values,
+                               int* results, size_t count);
+
+/**
+ * @brief 清除所有註冊
+ */
+void dms_control_registry_reset(void);
+
+#endif /* DMS_CONTROL_REGISTRY_H_ */
@@ -0,0 +1,191 @@
+
+/*
+ * DMS Credential Manager Module Implementation
+ *
+ * 原本每次 Openssl_Connect() 都重新讀取並解析 rootCA.pem / dms_pem.crt /
+ * dms_private.pem.key，libcurl 也在每個 curl handle 重新載入 CA bundle。
+ * 這裡改為解析一次後共用，減少重連延遲與重複的信任庫記憶體。
+ */
+
+#include "dms_credentials.h"
+
+/* 系統標頭檔 */
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <openssl/err.h>
+
+/*-----------------------------------------------------------*/
+/* 內部全域變數 */
+
+static SSL_CTX* g_mqtt_ssl_ctx = NULL;
+static X509_STORE* g_http_trust_store = NULL;
+static pthread_once_t g_http_trust_store_once = PTHREAD_ONCE_INIT;   // HTTP 請求可能來自背景執行緒
+
+static char g_ca_path[256] = {0};
+static char g_cert_path[256] = {0};
+static char g_key_path[256] = {0};
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static SSL_CTX* load_mqtt_ssl_ctx(const char* ca_path, const char* cert_path, const char* key_path);
+static void load_http_trust_store(void);
+static bool paths_match(const char* ca_path, const char* cert_path, const char* key_path);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 初始化憑證管理模組
+ */
+dms_result_t dms_credentials_init(const dms_aws_iot_config_t* config)
+{
+    if (config == NULL) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    SSL_CTX* ctx = dms_credentials_acquire_ssl_ctx(config->ca_cert_path,
+                                                   config->client_cert_path,
+                                                   config->private_key_path);
+    if (ctx == NULL) {
+        return DMS_ERROR_TLS_FAILURE;
+    }
+
+    SSL_CTX_free(ctx);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 取得 MQTT 用的共用 SSL_CTX
+ */
+SSL_CTX* dms_credentials_acquire_ssl_ctx(const char* ca_path,
+                                         const char* cert_path,
+                                         const char* key_path)
+{
+    if (ca_path == NULL || cert_path == NULL || key_path == NULL) {
+        return NULL;
+    }
+
+    if (g_mqtt_ssl_ctx == NULL || !paths_match(ca_path, cert_path, key_path)) {
+        SSL_CTX* ctx = load_mqtt_ssl_ctx(ca_path, cert_path, key_path);
+        if (ctx == NULL) {
+            return NULL;
+        }
+
+        if (g_mqtt_ssl_ctx != NULL) {
+            SSL_CTX_free(g_mqtt_ssl_ctx);
+        }
+        g_mqtt_ssl_ctx = ctx;
+        SAFE_STRNCPY(g_ca_path, ca_path, sizeof(g_ca_path));
+        SAFE_STRNCPY(g_cert_path, cert_path, sizeof(g_cert_path));
+        SAFE_STRNCPY(g_key_path, key_path, sizeof(g_key_path));
+    }
+
+    SSL_CTX_up_ref(g_mqtt_ssl_ctx);
+    return g_mqtt_ssl_ctx;
+}
+
+/**
+ * @brief 取得 HTTP 用的共用 X509_STORE
+ */
+X509_STORE* dms_credentials_get_http_trust_store(void)
+{
+    pthread_once(&g_http_trust_store_once, load_http_trust_store);
+    return g_http_trust_store;
+}
+
+/**
+ * @brief 清理憑證管理模組
+ */
+void dms_credentials_cleanup(void)
+{
+    if (g_mqtt_ssl_ctx != NULL) {
+        SSL_CTX_free(g_mqtt_ssl_ctx);
+        g_mqtt_ssl_ctx = NULL;
+    }
+
+    if (g_http_trust_store != NULL) {
+        X509_STORE_free(g_http_trust_store);
+        g_http_trust_store = NULL;
+    }
+
+    g_ca_path[0] = '\0';
+    g_cert_path[0] = '\0';
+    g_key_path[0] = '\0';
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 解析 MQTT 憑證並建立 SSL_CTX - 憑證設定與 Openssl_Connect() 相同
+ */
+static SSL_CTX* load_mqtt_ssl_ctx(const char* ca_path, const char* cert_path, const char* key_path)
+{
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    if (ctx == NULL) {
+        DMS_LOG_ERROR("❌ SSL_CTX_new failed");
+        return NULL;
+    }
+
+    SSL_CTX_set_mode(ctx, SSL_MODE_AUTO_RETRY);
+
+    if (SSL_CTX_load_verify_locations(ctx, ca_path, NULL) != 1) {
+        DMS_LOG_ERROR("❌ Failed to load root CA: %s", ca_path);
+        goto error;
+    }
+
+    if (SSL_CTX_use_certificate_chain_file(ctx, cert_path) != 1) {
+        DMS_LOG_ERROR("❌ Failed to load client certificate: %s", cert_path);
+        goto error;
+    }
+
+    if (SSL_CTX_use_PrivateKey_file(ctx, key_path, SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(ctx) != 1) {
+        DMS_LOG_ERROR("❌ Failed to load private key: %s", key_path);
+        goto error;
+    }
+
+    DMS_LOG_TLS("✅ MQTT credentials loaded (CA: %s)", ca_path);
+    return ctx;
+
+error:
+    ERR_clear_error();
+    SSL_CTX_free(ctx);
+    return NULL;
+}
+
+/**
+ * @brief 載入 HTTP 用的系統 CA bundle，由 pthread_once() 調用一次
+ *
+ * 載入失敗時 g_http_trust_store 維持 NULL
+ */
+static void load_http_trust_store(void)
+{
+    X509_STORE* store = X509_STORE_new();
+    if (store == NULL) {
+        return;
+    }
+
+    if (X509_STORE_load_locations(store, DMS_HTTP_CA_BUNDLE_PATH, NULL) != 1) {
+        DMS_LOG_WARN("⚠️ Failed to load HTTP CA bundle: %s", DMS_HTTP_CA_BUNDLE_PATH);
+        ERR_clear_error();
+        X509_STORE_free(store);
+        return;
+    }
+
+    DMS_LOG_TLS("✅ HTTP trust store loaded (%s)", DMS_HTTP_CA_BUNDLE_PATH);
+    g_http_trust_store = store;
+}
+
+/**
+ * @brief 檢查路徑是否與已載入的憑證相同
+ */
+static bool paths_match(const char* ca_path, const char* cert_path, const char* key_path)
+{
+    return strcmp(g_ca_path, ca_path) == 0 &&
+           strcmp(g_cert_path, cert_path) == 0 &&
+           strcmp(g_key_path, key_path) == 0;
+}
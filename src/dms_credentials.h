@@ -0,0 +1,71 @@
+
+/*
+ * DMS Credential Manager Module
+ *
+ * 集中管理 TLS 憑證，只在啟動（或憑證路徑變更）時解析一次：
+ * - MQTT：Root CA、客戶端憑證與私鑰載入共用的 SSL_CTX，每次重連直接引用
+ * - HTTP：系統 CA bundle 載入共用的 X509_STORE，由 libcurl 的
+ *   CURLOPT_SSL_CTX_FUNCTION 回調套用到每個 curl handle
+ */
+
+#ifndef DMS_CREDENTIALS_H_
+#define DMS_CREDENTIALS_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "dms_log.h"
+
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 初始化憑證管理模組
+ *
+ * 記錄憑證路徑並立即解析 MQTT 憑證，錯誤會在啟動時就回報
+ *
+ * @param config AWS IoT 配置 (從 dms_config_get_aws_iot() 獲得)
+ * @return DMS_SUCCESS 成功，其他為錯誤碼
+ */
+dms_result_t dms_credentials_init(const dms_aws_iot_config_t* config);
+
+/**
+ * @brief 取得 MQTT 用的共用 SSL_CTX
+ *
+ * 路徑與已載入的不同（或尚未載入）時才重新解析憑證
+ * 回傳值已增加參考計數，呼叫者使用完畢須呼叫 SSL_CTX_free()
+ *
+ * @param ca_path Root CA 路徑
+ * @param cert_path 客戶端憑證路徑
+ * @param key_path 私鑰路徑
+ * @return SSL_CTX 指針，失敗返回 NULL
+ */
+SSL_CTX* dms_credentials_acquire_ssl_ctx(const char* ca_path,
+                                         const char* cert_path,
+                                         const char* key_path);
+
+/**
+ * @brief 取得 HTTP 用的共用 X509_STORE
+ *
+ * 第一次呼叫時載入 DMS_HTTP_CA_BUNDLE_PATH，之後直接回傳；可從多個執行緒同時呼叫
+ * 回傳值由模組持有，呼叫者以 SSL_CTX_set1_cert_store() 引用即可
+ *
+ * @return X509_STORE 指針，載入失敗返回 NULL（呼叫者應退回 libcurl 預設行為）
+ */
+X509_STORE* dms_credentials_get_http_trust_store(void);
+
+/**
+ * @brief 清理憑證管理模組
+ *
+ * HTTP 信任庫只載入一次，清理後 dms_credentials_get_http_trust_store() 返回 NULL
+ */
+void dms_credentials_cleanup(void);
+
+#endif /* DMS_CREDENTIALS_H_ */
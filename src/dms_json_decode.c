@@ -0,0 +1,271 @@
+/*
+ * DMS JSON Schema Decoder Implementation
+ *
+ * decode_object() 走訪物件成員一次：每個鍵與描述表中同一層的路徑片段比對，
+ * 命中葉節點即寫入結構，命中中間節點則帶著路徑前綴遞迴進入該物件。
+ */
+
+#include "dms_json_decode.h"
+#include "dms_log.h"
+
+/* 系統標頭檔 */
+#include <string.h>
+
+/*-----------------------------------------------------------*/
+/* 內部類型定義 */
+
+typedef struct {
+    const dms_json_index_t* index;
+    const dms_json_field_t* fields;
+    size_t field_count;
+    char* out;
+    uint32_t decoded;               // 已解碼的欄位
+    uint32_t visited;               // 已出現的欄位（含解碼失敗）
+    dms_result_t result;
+} decode_context_t;
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static void decode_object(decode_context_t* context, int32_t object,
+                          const char* prefix, size_t prefix_length);
+static dms_result_t decode_field(decode_context_t* context, const dms_json_field_t* field,
+                                 int32_t value);
+static dms_result_t decode_string(const dms_json_index_t* index, int32_t value,
+                                  const dms_json_field_t* field, char* out);
+static bool parse_integer(const char* text, size_t length, int64_t* value);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 依描述表將物件解碼到結構
+ */
+dms_result_t dms_json_decode(const dms_json_index_t* index, int32_t object,
+                             const dms_json_field_t* fields, size_t field_count,
+                             void* out, uint32_t* decoded)
+{
+    decode_context_t context;
+
+    if (decoded != NULL) {
+        *decoded = 0;
+    }
+
+    if (index == NULL || fields == NULL || out == NULL ||
+        field_count == 0 || field_count > DMS_JSON_DECODE_MAX_FIELDS) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (dms_json_index_type(index, object) != DMS_JSON_TYPE_OBJECT) {
+        return DMS_ERROR_INVALID_JSON;
+    }
+
+    memset(&context, 0, sizeof(context));
+    context.index = index;
+    context.fields = fields;
+    context.field_count = field_count;
+    context.out = (char*)out;
+    context.result = DMS_SUCCESS;
+
+    decode_object(&context, object, "", 0);
+
+    for (size_t i = 0; i < field_count; i++) {
+        if ((fields[i].flags & DMS_JSON_FIELD_REQUIRED) &&
+            !(context.visited & (1U << i))) {
+            DMS_LOG_DEBUG("JSON decode: missing required field %s", fields[i].path);
+            if (context.result == DMS_SUCCESS) {
+                context.result = DMS_ERROR_INVALID_JSON;
+            }
+        }
+    }
+
+    if (decoded != NULL) {
+        *decoded = context.decoded;
+    }
+    return context.result;
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 走訪物件成員，比對路徑前綴為 prefix 的欄位
+ */
+static void decode_object(decode_context_t* context, int32_t object,
+                          const char* prefix, size_t prefix_length)
+{
+    const dms_json_index_t* index = context->index;
+
+    for (int32_t key = dms_json_index_first_child(index, object);
+         key != DMS_JSON_INDEX_NOT_FOUND;
+         key = dms_json_index_next_sibling(index, object, key)) {
+        const char* key_text;
+        size_t key_length;
+        bool descended = false;
+
+        dms_json_index_value(index, key, &key_text, &key_length);
+
+        for (size_t i = 0; i < context->field_count; i++) {
+            const char* path = context->fields[i].path;
+
+            /* 重複的鍵以第一次出現為準，與 JSON_Search() 相同 */
+            if ((context->visited & (1U << i)) || strncmp(path, prefix, prefix_length) != 0) {
+                continue;
+            }
+
+            const char* segment = path + prefix_length;
+            const char* dot = strchr(segment, '.');
+            size_t segment_length = (dot != NULL) ? (size_t)(dot - segment) : strlen(segment);
+
+            if (segment_length != key_length || memcmp(segment, key_text, key_length) != 0) {
+                continue;
+            }
+
+            if (dot == NULL) {
+                /* null 視為不存在 */
+                if (dms_json_index_type(index, key + 1) == DMS_JSON_TYPE_NULL) {
+                    continue;
+                }
+                context->visited |= 1U << i;
+                dms_result_t result = decode_field(context, &context->fields[i], key + 1);
+                if (result == DMS_SUCCESS) {
+                    context->decoded |= 1U << i;
+                } else {
+                    DMS_LOG_DEBUG("JSON decode: field %s rejected (%d)", path, result);
+                    if (context->result == DMS_SUCCESS) {
+                        context->result = result;
+                    }
+                }
+            } else if (!descended &&
+                       dms_json_index_type(index, key + 1) == DMS_JSON_TYPE_OBJECT) {
+                /* 同一物件下的所有欄位在一次遞迴中處理 */
+                descended = true;
+                decode_object(context, key + 1, path, (size_t)(dot - path) + 1);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 依欄位型別寫入結構成員
+ */
+static dms_result_t decode_field(decode_context_t* context, const dms_json_field_t* field,
+                                 int32_t value)
+{
+    const dms_json_index_t* index = context->index;
+    char* member = context->out + field->offset;
+    dms_json_type_t type = dms_json_index_type(index, value);
+    const char* text;
+    size_t length;
+    int64_t number;
+
+    switch (field->type) {
+        case DMS_JSON_FIELD_STRING:
+            return decode_string(index, value, field, member);
+
+        case DMS_JSON_FIELD_INT32:
+        case DMS_JSON_FIELD_UINT32:
+            if ((type != DMS_JSON_TYPE_NUMBER && type != DMS_JSON_TYPE_STRING) ||
+                field->size != sizeof(int32_t) ||
+                !dms_json_index_value(index, value, &text, &length) ||
+                !parse_integer(text, length, &number)) {
+                return DMS_ERROR_INVALID_JSON;
+            }
+            if (field->type == DMS_JSON_FIELD_INT32) {
+                if (number < INT32_MIN || number > INT32_MAX) {
+                    return DMS_ERROR_INVALID_JSON;
+                }
+                int32_t result = (int32_t)number;
+                memcpy(member, &result, sizeof(result));
+            } else {
+                if (number < 0 || number > (int64_t)UINT32_MAX) {
+                    return DMS_ERROR_INVALID_JSON;
+                }
+                uint32_t result = (uint32_t)number;
+                memcpy(member, &result, sizeof(result));
+            }
+            return DMS_SUCCESS;
+
+        case DMS_JSON_FIELD_BOOL:
+            if ((type != DMS_JSON_TYPE_TRUE && type != DMS_JSON_TYPE_FALSE) ||
+                field->size != sizeof(bool)) {
+                return DMS_ERROR_INVALID_JSON;
+            }
+            *(bool*)member = (type == DMS_JSON_TYPE_TRUE);
+            return DMS_SUCCESS;
+
+        default:
+            return DMS_ERROR_INVALID_PARAMETER;
+    }
+}
+
+/**
+ * @brief 解碼字串欄位
+ *
+ * 未設定截斷時，過長的值寫成空字串，避免留下半截內容
+ */
+static dms_result_t decode_string(const dms_json_index_t* index, int32_t value,
+                                  const dms_json_field_t* field, char* out)
+{
+    dms_result_t result;
+
+    if (field->size == 0) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (dms_json_index_type(index, value) == DMS_JSON_TYPE_STRING) {
+        result = dms_json_index_get_string(index, value, out, field->size, NULL);
+    } else {
+        /* 數字、布林、物件、陣列保留原始 JSON 文字 */
+        const char* text;
+        size_t length;
+
+        dms_json_index_value(index, value, &text, &length);
+        result = DMS_SUCCESS;
+        if (length >= field->size) {
+            length = field->size - 1;
+            result = DMS_ERROR_BUFFER_OVERFLOW;
+        }
+        memcpy(out, text, length);
+        out[length] = '\0';
+    }
+
+    if (result == DMS_ERROR_BUFFER_OVERFLOW) {
+        if (field->flags & DMS_JSON_FIELD_TRUNCATE) {
+            return DMS_SUCCESS;
+        }
+        out[0] = '\0';
+    }
+    return result;
+}
+
+/**
+ * @brief 解析十進位整數：-?[0-9]+
+ *
+ * 小數、指數與超過 18 位數的值視為錯誤
+ */
+static bool parse_integer(const char* text, size_t length, int64_t* value)
+{
+    bool negative = false;
+    int64_t result = 0;
+    size_t i = 0;
+
+    if (length > 0 && text[0] == '-') {
+        negative = true;
+        i = 1;
+    }
+
+    if (i == length || length - i > 18) {
+        return false;
+    }
+
+    for (; i < length; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        result = result * 10 + (text[i] - '0');
+    }
+
+    *value = negative ? -result : result;
+    return true;
+}
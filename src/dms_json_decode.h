@@ -0,0 +1,94 @@
+
+/*
+ * DMS JSON Schema Decoder
+ *
+ * 以欄位描述表取代每個回應各自「搜尋鍵、去引號、strncpy、atoi」的解析程式碼：
+ * - 描述表列出路徑、型別、結構成員位移與大小，解碼器據此直接寫入 C 結構
+ * - 走訪 dms_json_index 的 tape 一次，逐一比對成員鍵，巢狀路徑只進入一次對應的物件
+ * - 字串反跳脫（含 \uXXXX），超過緩衝區時依欄位設定截斷或回報錯誤
+ * - 增加欄位只是描述表多一行，不會多一次文件掃描
+ */
+
+#ifndef DMS_JSON_DECODE_H_
+#define DMS_JSON_DECODE_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "dms_json_index.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define DMS_JSON_DECODE_MAX_FIELDS         ( 32U )
+
+/* 欄位旗標 */
+#define DMS_JSON_FIELD_REQUIRED            ( 1U << 0 )   /* 缺少時解碼失敗 */
+#define DMS_JSON_FIELD_TRUNCATE            ( 1U << 1 )   /* 字串過長時截斷，否則視為錯誤 */
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief 欄位型別
+ *
+ * STRING：字串值反跳脫後複製；數字、物件等其他值以原始 JSON 文字複製
+ * INT32 / UINT32：接受數字或內容為整數的字串，超出範圍視為錯誤
+ * BOOL：只接受 true / false
+ * 值為 null 的欄位視為不存在
+ */
+typedef enum {
+    DMS_JSON_FIELD_STRING = 0,
+    DMS_JSON_FIELD_INT32,
+    DMS_JSON_FIELD_UINT32,
+    DMS_JSON_FIELD_BOOL
+} dms_json_field_type_t;
+
+/**
+ * @brief 欄位描述
+ */
+typedef struct {
+    const char* path;               // 相對於起點物件，以 "." 分隔
+    uint8_t type;                   // dms_json_field_type_t
+    uint8_t flags;                  // DMS_JSON_FIELD_*
+    size_t offset;                  // 結構成員位移
+    size_t size;                    // 結構成員大小（字串為緩衝區大小）
+} dms_json_field_t;
+
+/**
+ * @brief 宣告描述表中的一個欄位
+ *
+ * 例：DMS_JSON_FIELD(DMSPincodeResponse_t, pincode, "pincode", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_REQUIRED)
+ */
+#define DMS_JSON_FIELD(struct_type, member, json_path, field_type, field_flags) \
+    { (json_path), (uint8_t)(field_type), (uint8_t)(field_flags),              \
+      offsetof(struct_type, member), sizeof(((struct_type*)0)->member) }
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 依描述表將物件解碼到結構
+ *
+ * 不存在的欄位保持原值，呼叫者應先初始化結構。
+ * 單一欄位錯誤不影響其他欄位，返回值為第一個發生的錯誤。
+ *
+ * @param index 已建立的索引
+ * @param object 起點物件 token，通常為 DMS_JSON_INDEX_ROOT
+ * @param fields 欄位描述表
+ * @param field_count 欄位數量（不超過 DMS_JSON_DECODE_MAX_FIELDS）
+ * @param out 輸出結構
+ * @param decoded 成功解碼的欄位位元遮罩（第 i 位對應 fields[i]），可為 NULL
+ * @return DMS_SUCCESS 成功，DMS_ERROR_INVALID_JSON 型別不符或缺少必要欄位，
+ *         DMS_ERROR_BUFFER_OVERFLOW 字串超過緩衝區（未設定截斷）
+ */
+dms_result_t dms_json_decode(const dms_json_index_t* index, int32_t object,
+                             const dms_json_field_t* fields, size_t field_count,
+                             void* out, uint32_t* decoded);
+
+#endif /* DMS_JSON_DECODE_H_ */
@@ -0,0 +1,749 @@
+/*
+ * DMS JSON Structural Index Implementation
+ *
+ * 以明確的堆疊取代遞迴，單次掃描完成語法驗證並輸出 tape。
+ * JSON 文件的大部分位元組位於字串內，find_string_special() 以 SIMD 跳過
+ * 不需要處理的字元，只有引號、反斜線、控制字元與非 ASCII 位元組交給純量程式碼。
+ */
+
+#include "dms_json_index.h"
+
+/* 系統標頭檔 */
+#include <string.h>
+
+/* 定義 DMS_JSON_INDEX_SCALAR 時一律使用純量版本（單元測試比對各路徑用） */
+#if defined(DMS_JSON_INDEX_SCALAR)
+/* 純量版本 */
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define DMS_JSON_SIMD_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define DMS_JSON_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DMS_JSON_SIMD_NEON
+#endif
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static size_t skip_whitespace(const char* json, size_t length, size_t position);
+static size_t find_string_special(const unsigned char* json, size_t length, size_t position);
+static bool scan_string(const char* json, size_t length, size_t* position);
+static size_t scan_utf8(const unsigned char* json, size_t length, size_t position);
+static bool scan_number(const char* json, size_t length, size_t* position);
+static bool scan_literal(const char* json, size_t length, size_t* position,
+                         const char* literal, size_t literal_length);
+static bool is_hex_digit(char c);
+static uint32_t parse_hex4(const char* text);
+static size_t encode_utf8(uint32_t code_point, char* out);
+static int32_t add_token(dms_json_index_t* index, dms_json_type_t type,
+                         size_t start, size_t length);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 驗證 JSON 並建立索引
+ */
+dms_result_t dms_json_index_build(dms_json_index_t* index,
+                                  const char* json, size_t length,
+                                  dms_json_token_t* tokens, uint32_t capacity)
+{
+    uint32_t stack[DMS_JSON_INDEX_MAX_DEPTH];
+    uint32_t depth = 0;
+    bool expect_key = false;
+
+    if (index == NULL || json == NULL || tokens == NULL || capacity == 0 ||
+        length == 0 || length > UINT32_MAX) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    index->json = json;
+    index->length = length;
+    index->tokens = tokens;
+    index->count = 0;
+    index->capacity = capacity;
+
+    size_t p = skip_whitespace(json, length, 0);
+
+    for (;;) {
+        if (p >= length) {
+            return DMS_ERROR_INVALID_JSON;
+        }
+
+        /* 物件成員的鍵 */
+        if (expect_key) {
+            size_t key_start = p + 1;
+            if (json[p] != '"' || !scan_string(json, length, &p)) {
+                return DMS_ERROR_INVALID_JSON;
+            }
+            if (add_token(index, DMS_JSON_TYPE_STRING, key_start, p - 1 - key_start) < 0) {
+                return DMS_ERROR_BUFFER_OVERFLOW;
+            }
+            p = skip_whitespace(json, length, p);
+            if (p >= length || json[p] != ':') {
+                return DMS_ERROR_INVALID_JSON;
+            }
+            p = skip_whitespace(json, length, p + 1);
+            expect_key = false;
+            continue;
+        }
+
+        /* 值 */
+        char c = json[p];
+        size_t value_start = p;
+        int32_t token;
+
+        if (c == '{' || c == '[') {
+            if (depth >= DMS_JSON_INDEX_MAX_DEPTH) {
+                return DMS_ERROR_INVALID_JSON;
+            }
+            token = add_token(index, (c == '{') ? DMS_JSON_TYPE_OBJECT : DMS_JSON_TYPE_ARRAY, p, 0);
+            if (token < 0) {
+                return DMS_ERROR_BUFFER_OVERFLOW;
+            }
+            stack[depth++] = (uint32_t)token;
+
+            p = skip_whitespace(json, length, p + 1);
+            if (p < length && json[p] == ((c == '{') ? '}' : ']')) {
+                /* 空物件或空陣列，交給下方的結束處理 */
+            } else {
+                expect_key = (c == '{');
+                continue;
+            }
+        } else {
+            dms_json_type_t type;
+            bool ok;
+
+            switch (c) {
+                case '"':
+                    type = DMS_JSON_TYPE_STRING;
+                    ok = scan_string(json, length, &p);
+                    break;
+                case 't':
+                    type = DMS_JSON_TYPE_TRUE;
+                    ok = scan_literal(json, length, &p, "true", 4);
+                    break;
+                case 'f':
+                    type = DMS_JSON_TYPE_FALSE;
+                    ok = scan_literal(json, length, &p, "false", 5);
+                    break;
+                case 'n':
+                    type = DMS_JSON_TYPE_NULL;
+                    ok = scan_literal(json, length, &p, "null", 4);
+                    break;
+                default:
+                    type = DMS_JSON_TYPE_NUMBER;
+                    ok = scan_number(json, length, &p);
+                    break;
+            }
+
+            if (!ok) {
+                return DMS_ERROR_INVALID_JSON;
+            }
+
+            if (type == DMS_JSON_TYPE_STRING) {
+                token = add_token(index, type, value_start + 1, p - value_start - 2);
+            } else {
+                token = add_token(index, type, value_start, p - value_start);
+            }
+            if (token < 0) {
+                return DMS_ERROR_BUFFER_OVERFLOW;
+            }
+            p = skip_whitespace(json, length, p);
+        }
+
+        /* 值之後：逗號、結束括號，或文件結尾 */
+        for (;;) {
+            if (depth == 0) {
+                return (p == length) ? DMS_SUCCESS : DMS_ERROR_INVALID_JSON;
+            }
+            if (p >= length) {
+                return DMS_ERROR_INVALID_JSON;
+            }
+
+            dms_json_token_t* container = &index->tokens[stack[depth - 1]];
+            char close = (container->type == DMS_JSON_TYPE_OBJECT) ? '}' : ']';
+
+            if (json[p] == ',') {
+                p = skip_whitespace(json, length, p + 1);
+                expect_key = (container->type == DMS_JSON_TYPE_OBJECT);
+                break;
+            }
+
+            if (json[p] != close) {
+                return DMS_ERROR_INVALID_JSON;
+            }
+
+            container->length = (uint32_t)(p + 1 - container->start);
+            container->next = index->count;
+            depth--;
+            p = skip_whitespace(json, length, p + 1);
+        }
+    }
+}
+
+/**
+ * @brief 在物件中尋找直接子成員
+ */
+int32_t dms_json_index_child(const dms_json_index_t* index, int32_t object,
+                             const char* key, size_t key_length)
+{
+    if (dms_json_index_type(index, object) != DMS_JSON_TYPE_OBJECT) {
+        return DMS_JSON_INDEX_NOT_FOUND;
+    }
+
+    for (int32_t k = dms_json_index_first_child(index, object);
+         k != DMS_JSON_INDEX_NOT_FOUND;
+         k = dms_json_index_next_sibling(index, object, k)) {
+        const dms_json_token_t* token = &index->tokens[k];
+        if (token->length == key_length &&
+            memcmp(index->json + token->start, key, key_length) == 0) {
+            return k + 1;
+        }
+    }
+
+    return DMS_JSON_INDEX_NOT_FOUND;
+}
+
+/**
+ * @brief 以 "a.b.c" 形式的路徑尋找值
+ */
+int32_t dms_json_index_find(const dms_json_index_t* index, int32_t from, const char* path)
+{
+    int32_t current = from;
+
+    if (path == NULL) {
+        return DMS_JSON_INDEX_NOT_FOUND;
+    }
+
+    while (current != DMS_JSON_INDEX_NOT_FOUND) {
+        const char* dot = strchr(path, '.');
+        size_t segment_length = (dot != NULL) ? (size_t)(dot - path) : strlen(path);
+
+        current = dms_json_index_child(index, current, path, segment_length);
+        if (dot == NULL) {
+            break;
+        }
+        path = dot + 1;
+    }
+
+    return current;
+}
+
+/**
+ * @brief 獲取 token 型別
+ */
+dms_json_type_t dms_json_index_type(const dms_json_index_t* index, int32_t token)
+{
+    if (index == NULL || token < 0 || (uint32_t)token >= index->count) {
+        return DMS_JSON_TYPE_INVALID;
+    }
+    return (dms_json_type_t)index->tokens[token].type;
+}
+
+/**
+ * @brief 獲取 token 對應的原始文字
+ */
+bool dms_json_index_value(const dms_json_index_t* index, int32_t token,
+                          const char** value, size_t* length)
+{
+    if (dms_json_index_type(index, token) == DMS_JSON_TYPE_INVALID) {
+        return false;
+    }
+
+    *value = index->json + index->tokens[token].start;
+    *length = index->tokens[token].length;
+    return true;
+}
+
+/**
+ * @brief 將字串 token 反跳脫後複製到緩衝區
+ */
+dms_result_t dms_json_index_get_string(const dms_json_index_t* index, int32_t token,
+                                       char* buffer, size_t size, size_t* length)
+{
+    const char* text;
+    size_t text_length;
+    size_t out = 0;
+    dms_result_t result = DMS_SUCCESS;
+
+    if (buffer == NULL || size == 0) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+    buffer[0] = '\0';
+
+    if (dms_json_index_type(index, token) != DMS_JSON_TYPE_STRING ||
+        !dms_json_index_value(index, token, &text, &text_length)) {
+        return DMS_ERROR_INVALID_JSON;
+    }
+
+    for (size_t i = 0; i < text_length; ) {
+        char encoded[4];
+        size_t encoded_length = 1;
+
+        if (text[i] != '\\') {
+            encoded[0] = text[i++];
+        } else {
+            /* 建立索引時已驗證跳脫序列格式 */
+            char escape = text[i + 1];
+            i += 2;
+            switch (escape) {
+                case 'b': encoded[0] = '\b'; break;
+                case 'f': encoded[0] = '\f'; break;
+                case 'n': encoded[0] = '\n'; break;
+                case 'r': encoded[0] = '\r'; break;
+                case 't': encoded[0] = '\t'; break;
+                case 'u': {
+                    uint32_t code_point = parse_hex4(text + i);
+                    i += 4;
+
+                    /* 高代理必須緊接低代理 */
+                    if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+                        if (i + 6 > text_length || text[i] != '\\' || text[i + 1] != 'u') {
+                            return DMS_ERROR_INVALID_JSON;
+                        }
+                        uint32_t low = parse_hex4(text + i + 2);
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            return DMS_ERROR_INVALID_JSON;
+                        }
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+                        return DMS_ERROR_INVALID_JSON;
+                    }
+
+                    encoded_length = encode_utf8(code_point, encoded);
+                    break;
+                }
+                default:
+                    encoded[0] = escape;        /* " \ / */
+                    break;
+            }
+        }
+
+        /* 緩衝區不足時只保留完整的字元 */
+        if (out + encoded_length >= size) {
+            result = DMS_ERROR_BUFFER_OVERFLOW;
+            break;
+        }
+        memcpy(buffer + out, encoded, encoded_length);
+        out += encoded_length;
+    }
+
+    /* 未跳脫的多位元組字元逐位元組複製，截斷時退回到字元邊界 */
+    if (result == DMS_ERROR_BUFFER_OVERFLOW) {
+        size_t lead = out;
+        while (lead > 0 && ((unsigned char)buffer[lead - 1] & 0xC0) == 0x80) {
+            lead--;
+        }
+        if (lead > 0 && ((unsigned char)buffer[lead - 1] & 0x80) != 0) {
+            unsigned char c = (unsigned char)buffer[lead - 1];
+            size_t expected = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : 2;
+            if (out - (lead - 1) < expected) {
+                out = lead - 1;
+            }
+        }
+    }
+
+    buffer[out] = '\0';
+    if (length != NULL) {
+        *length = out;
+    }
+    return result;
+}
+
+/**
+ * @brief 將數字 token 解析為無號整數
+ */
+bool dms_json_index_get_uint(const dms_json_index_t* index, int32_t token, uint64_t* value)
+{
+    const char* text;
+    size_t length;
+    uint64_t result = 0;
+
+    if (dms_json_index_type(index, token) != DMS_JSON_TYPE_NUMBER ||
+        !dms_json_index_value(index, token, &text, &length)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;               /* 負數、小數或指數 */
+        }
+        uint64_t digit = (uint64_t)(text[i] - '0');
+        if (result > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+        result = result * 10 + digit;
+    }
+
+    *value = result;
+    return true;
+}
+
+/**
+ * @brief 獲取第一個子節點
+ */
+int32_t dms_json_index_first_child(const dms_json_index_t* index, int32_t container)
+{
+    dms_json_type_t type = dms_json_index_type(index, container);
+
+    if (type != DMS_JSON_TYPE_OBJECT && type != DMS_JSON_TYPE_ARRAY) {
+        return DMS_JSON_INDEX_NOT_FOUND;
+    }
+
+    uint32_t first = (uint32_t)container + 1;
+    return (first < index->tokens[container].next) ? (int32_t)first : DMS_JSON_INDEX_NOT_FOUND;
+}
+
+/**
+ * @brief 獲取下一個兄弟節點
+ */
+int32_t dms_json_index_next_sibling(const dms_json_index_t* index, int32_t container, int32_t token)
+{
+    /* 物件成員跳過鍵與整個值 */
+    uint32_t next = (index->tokens[container].type == DMS_JSON_TYPE_OBJECT) ?
+                    index->tokens[token + 1].next : index->tokens[token].next;
+
+    return (next < index->tokens[container].next) ? (int32_t)next : DMS_JSON_INDEX_NOT_FOUND;
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 跳過空白字元
+ */
+static size_t skip_whitespace(const char* json, size_t length, size_t position)
+{
+    while (position < length &&
+           (json[position] == ' ' || json[position] == '\n' ||
+            json[position] == '\r' || json[position] == '\t')) {
+        position++;
+    }
+    return position;
+}
+
+/**
+ * @brief 尋找字串中下一個需要純量處理的位元組
+ *
+ * 需要處理的位元組：引號、反斜線、控制字元（< 0x20）、非 ASCII（>= 0x80）
+ *
+ * @return 該位元組的位置，沒有時返回 length
+ */
+static size_t find_string_special(const unsigned char* json, size_t length, size_t position)
+{
+#if defined(DMS_JSON_SIMD_AVX2)
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1F);
+
+    while (position + 32 <= length) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(json + position));
+        __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(block, quote),
+                                          _mm256_cmpeq_epi8(block, backslash));
+        special = _mm256_or_si256(special,
+                                  _mm256_cmpeq_epi8(_mm256_min_epu8(block, control), block));
+        /* movemask 取最高位元，非 ASCII 位元組直接出現在 block 的遮罩中 */
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(special) |
+                        (uint32_t)_mm256_movemask_epi8(block);
+        if (mask != 0) {
+            return position + (size_t)__builtin_ctz(mask);
+        }
+        position += 32;
+    }
+#elif defined(DMS_JSON_SIMD_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+
+    while (position + 16 <= length) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(json + position));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(block, quote),
+                                       _mm_cmpeq_epi8(block, backslash));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_min_epu8(block, control), block));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(special) |
+                        (uint32_t)_mm_movemask_epi8(block);
+        if (mask != 0) {
+            return position + (size_t)__builtin_ctz(mask);
+        }
+        position += 16;
+    }
+#elif defined(DMS_JSON_SIMD_NEON)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t control = vdupq_n_u8(0x1F);
+    const uint8x16_t high_bit = vdupq_n_u8(0x80);
+
+    while (position + 16 <= length) {
+        uint8x16_t block = vld1q_u8(json + position);
+        uint8x16_t special = vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, backslash));
+        special = vorrq_u8(special, vcleq_u8(block, control));
+        special = vorrq_u8(special, vtstq_u8(block, high_bit));
+
+        /* 每個位元組壓縮為 4 位元，第一個非零半位元組即為位置 */
+        uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(special), 4);
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+        if (mask != 0) {
+            return position + (size_t)(__builtin_ctzll(mask) >> 2);
+        }
+        position += 16;
+    }
+#endif
+
+    while (position < length) {
+        unsigned char c = json[position];
+        if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) {
+            return position;
+        }
+        position++;
+    }
+    return length;
+}
+
+/**
+ * @brief 掃描字串並驗證跳脫序列與 UTF-8
+ *
+ * @param position 輸入為開頭引號的位置，成功時輸出結尾引號之後的位置
+ */
+static bool scan_string(const char* json, size_t length, size_t* position)
+{
+    const unsigned char* bytes = (const unsigned char*)json;
+    size_t p = *position + 1;
+
+    for (;;) {
+        p = find_string_special(bytes, length, p);
+        if (p >= length) {
+            return false;
+        }
+
+        unsigned char c = bytes[p];
+
+        if (c == '"') {
+            *position = p + 1;
+            return true;
+        }
+
+        if (c == '\\') {
+            if (p + 1 >= length) {
+                return false;
+            }
+            switch (json[p + 1]) {
+                case '"': case '\\': case '/': case 'b':
+                case 'f': case 'n': case 'r': case 't':
+                    p += 2;
+                    break;
+                case 'u':
+                    if (p + 5 >= length ||
+                        !is_hex_digit(json[p + 2]) || !is_hex_digit(json[p + 3]) ||
+                        !is_hex_digit(json[p + 4]) || !is_hex_digit(json[p + 5])) {
+                        return false;
+                    }
+                    p += 6;
+                    break;
+                default:
+                    return false;
+            }
+            continue;
+        }
+
+        if (c < 0x20) {
+            return false;
+        }
+
+        p = scan_utf8(bytes, length, p);
+        if (p == 0) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief 驗證一個多位元組 UTF-8 序列
+ *
+ * 拒絕過長編碼、代理區（U+D800-U+DFFF）與超過 U+10FFFF 的碼位
+ *
+ * @return 序列之後的位置，無效時返回 0
+ */
+static size_t scan_utf8(const unsigned char* json, size_t length, size_t position)
+{
+    unsigned char lead = json[position];
+    size_t count;
+    uint32_t code_point;
+    uint32_t minimum;
+
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        count = 1;
+        code_point = lead & 0x1F;
+        minimum = 0x80;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        count = 2;
+        code_point = lead & 0x0F;
+        minimum = 0x800;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        count = 3;
+        code_point = lead & 0x07;
+        minimum = 0x10000;
+    } else {
+        return 0;
+    }
+
+    if (position + count >= length) {
+        return 0;
+    }
+
+    for (size_t i = 1; i <= count; i++) {
+        unsigned char next = json[position + i];
+        if ((next & 0xC0) != 0x80) {
+            return 0;
+        }
+        code_point = (code_point << 6) | (next & 0x3F);
+    }
+
+    if (code_point < minimum || code_point > 0x10FFFF ||
+        (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+        return 0;
+    }
+
+    return position + count + 1;
+}
+
+/**
+ * @brief 掃描數字：-?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+ */
+static bool scan_number(const char* json, size_t length, size_t* position)
+{
+    size_t p = *position;
+
+    if (p < length && json[p] == '-') {
+        p++;
+    }
+
+    if (p >= length || json[p] < '0' || json[p] > '9') {
+        return false;
+    }
+    if (json[p] == '0') {
+        p++;
+    } else {
+        while (p < length && json[p] >= '0' && json[p] <= '9') {
+            p++;
+        }
+    }
+
+    if (p < length && json[p] == '.') {
+        p++;
+        if (p >= length || json[p] < '0' || json[p] > '9') {
+            return false;
+        }
+        while (p < length && json[p] >= '0' && json[p] <= '9') {
+            p++;
+        }
+    }
+
+    if (p < length && (json[p] == 'e' || json[p] == 'E')) {
+        p++;
+        if (p < length && (json[p] == '+' || json[p] == '-')) {
+            p++;
+        }
+        if (p >= length || json[p] < '0' || json[p] > '9') {
+            return false;
+        }
+        while (p < length && json[p] >= '0' && json[p] <= '9') {
+            p++;
+        }
+    }
+
+    *position = p;
+    return true;
+}
+
+/**
+ * @brief 掃描 true、false、null
+ */
+static bool scan_literal(const char* json, size_t length, size_t* position,
+                         const char* literal, size_t literal_length)
+{
+    if (length - *position < literal_length ||
+        memcmp(json + *position, literal, literal_length) != 0) {
+        return false;
+    }
+
+    *position += literal_length;
+    return true;
+}
+
+static bool is_hex_digit(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static uint32_t parse_hex4(const char* text)
+{
+    uint32_t value = 0;
+
+    for (int i = 0; i < 4; i++) {
+        char c = text[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= (uint32_t)(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value |= (uint32_t)(c - 'a' + 10);
+        } else {
+            value |= (uint32_t)(c - 'A' + 10);
+        }
+    }
+    return value;
+}
+
+/**
+ * @brief 將碼位編碼為 UTF-8
+ *
+ * @return 位元組數
+ */
+static size_t encode_utf8(uint32_t code_point, char* out)
+{
+    if (code_point < 0x80) {
+        out[0] = (char)code_point;
+        return 1;
+    }
+    if (code_point < 0x800) {
+        out[0] = (char)(0xC0 | (code_point >> 6));
+        out[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    }
+    if (code_point < 0x10000) {
+        out[0] = (char)(0xE0 | (code_point >> 12));
+        out[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (code_point >> 18));
+    out[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
+/**
+ * @brief 新增 token
+ *
+ * @return token 索引，容量不足返回 -1
+ */
+static int32_t add_token(dms_json_index_t* index, dms_json_type_t type,
+                         size_t start, size_t length)
+{
+    if (index->count >= index->capacity) {
+        return -1;
+    }
+
+    dms_json_token_t* token = &index->tokens[index->count];
+    token->start = (uint32_t)start;
+    token->length = (uint32_t)length;
+    token->type = (uint8_t)type;
+    token->next = index->count + 1;     /* 物件與陣列在結束時更新 */
+
+    return (int32_t)index->count++;
+}
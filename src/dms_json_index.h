@@ -0,0 +1,164 @@
+
+/*
+ * DMS JSON Structural Index
+ *
+ * 取代 JSON_Validate() 加上多次 JSON_Search() 的解析方式：
+ * - 一次掃描完成驗證，並把每個值的位置記錄到呼叫者提供的 token 陣列（tape）
+ * - 之後的路徑查詢只走訪 tape，不再從文件開頭重新掃描
+ * - 字串內容以 SIMD 一次檢查 16/32 個位元組（NEON、SSE2、AVX2），其他平台使用純量版本
+ * - 不配置記憶體，token 容量不足時回報錯誤
+ *
+ * 物件的子節點依序為「鍵、值、鍵、值…」，陣列的子節點為各個元素；
+ * 每個 token 的 next 指向其整個子樹之後的 token，用來跳過兄弟節點的內容
+ */
+
+#ifndef DMS_JSON_INDEX_H_
+#define DMS_JSON_INDEX_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define DMS_JSON_INDEX_MAX_DEPTH           ( 32U )
+#define DMS_JSON_INDEX_ROOT                ( 0 )
+#define DMS_JSON_INDEX_NOT_FOUND           ( -1 )
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief JSON 值型別
+ */
+typedef enum {
+    DMS_JSON_TYPE_INVALID = 0,
+    DMS_JSON_TYPE_OBJECT,
+    DMS_JSON_TYPE_ARRAY,
+    DMS_JSON_TYPE_STRING,
+    DMS_JSON_TYPE_NUMBER,
+    DMS_JSON_TYPE_TRUE,
+    DMS_JSON_TYPE_FALSE,
+    DMS_JSON_TYPE_NULL
+} dms_json_type_t;
+
+/**
+ * @brief tape 中的一個值
+ */
+typedef struct {
+    uint32_t start;                 // 字串為開頭引號之後的位置，其他為第一個字元
+    uint32_t length;                // 字串不含引號（未反跳脫），物件與陣列包含括號
+    uint32_t next;                  // 此值與其所有子節點之後的 token 索引
+    uint8_t type;                   // dms_json_type_t
+} dms_json_token_t;
+
+/**
+ * @brief 已建立索引的 JSON 文件
+ *
+ * 索引只引用原始文件，文件在索引使用期間必須保持有效
+ */
+typedef struct {
+    const char* json;
+    size_t length;
+    dms_json_token_t* tokens;
+    uint32_t count;
+    uint32_t capacity;
+} dms_json_index_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 驗證 JSON 並建立索引
+ *
+ * @param index 輸出索引
+ * @param json JSON 文件
+ * @param length 文件長度
+ * @param tokens token 陣列
+ * @param capacity token 陣列容量
+ * @return DMS_SUCCESS 成功，DMS_ERROR_INVALID_JSON 格式錯誤，
+ *         DMS_ERROR_BUFFER_OVERFLOW token 容量不足
+ */
+dms_result_t dms_json_index_build(dms_json_index_t* index,
+                                  const char* json, size_t length,
+                                  dms_json_token_t* tokens, uint32_t capacity);
+
+/**
+ * @brief 在物件中尋找直接子成員
+ *
+ * 鍵以原始（未反跳脫）文字比較，與 JSON_Search() 相同
+ *
+ * @param index 索引
+ * @param object 物件 token
+ * @param key 鍵
+ * @param key_length 鍵長度
+ * @return 值的 token 索引，找不到返回 DMS_JSON_INDEX_NOT_FOUND
+ */
+int32_t dms_json_index_child(const dms_json_index_t* index, int32_t object,
+                             const char* key, size_t key_length);
+
+/**
+ * @brief 以 "a.b.c" 形式的路徑尋找值
+ *
+ * @param index 索引
+ * @param from 起點 token，通常為 DMS_JSON_INDEX_ROOT
+ * @param path 以 "." 分隔的路徑
+ * @return 值的 token 索引，找不到返回 DMS_JSON_INDEX_NOT_FOUND
+ */
+int32_t dms_json_index_find(const dms_json_index_t* index, int32_t from, const char* path);
+
+/**
+ * @brief 獲取 token 型別
+ */
+dms_json_type_t dms_json_index_type(const dms_json_index_t* index, int32_t token);
+
+/**
+ * @brief 獲取 token 對應的原始文字
+ *
+ * 字串不含引號；輸出格式與 JSON_Search() 相同
+ *
+ * @return true 成功，false token 無效
+ */
+bool dms_json_index_value(const dms_json_index_t* index, int32_t token,
+                          const char** value, size_t* length);
+
+/**
+ * @brief 將字串 token 反跳脫後複製到緩衝區
+ *
+ * \uXXXX（含代理對）轉為 UTF-8；結果以 '\0' 結尾
+ *
+ * @param index 索引
+ * @param token 字串 token
+ * @param buffer 輸出緩衝區
+ * @param size 緩衝區大小（含結尾 '\0'）
+ * @param length 輸出長度，可為 NULL
+ * @return DMS_SUCCESS 成功，DMS_ERROR_INVALID_JSON 不是字串或跳脫序列無效，
+ *         DMS_ERROR_BUFFER_OVERFLOW 緩衝區不足（已寫入可容納的完整字元）
+ */
+dms_result_t dms_json_index_get_string(const dms_json_index_t* index, int32_t token,
+                                       char* buffer, size_t size, size_t* length);
+
+/**
+ * @brief 將數字 token 解析為無號整數
+ *
+ * @return true 成功，false 不是非負整數或超出範圍
+ */
+bool dms_json_index_get_uint(const dms_json_index_t* index, int32_t token, uint64_t* value);
+
+/**
+ * @brief 走訪物件或陣列的子節點
+ *
+ * 物件的子節點為鍵，對應的值為鍵的下一個 token
+ *
+ * @return 第一個子節點或下一個兄弟節點，沒有時返回 DMS_JSON_INDEX_NOT_FOUND
+ */
+int32_t dms_json_index_first_child(const dms_json_index_t* index, int32_t container);
+int32_t dms_json_index_next_sibling(const dms_json_index_t* index, int32_t container, int32_t token);
+
+#endif /* DMS_JSON_INDEX_H_ */
@@ -0,0 +1,355 @@
+/*
+ * DMS JSON Writer Implementation
+ *
+ * 所有輸出都經過 write_bytes()：緩衝區保留一個位元組給結尾 '\0'，
+ * 寫滿即進入錯誤狀態。
+ */
+
+#include "dms_json_writer.h"
+
+/* 系統標頭檔 */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static void write_bytes(dms_json_writer_t* writer, const char* data, size_t length);
+static void write_char(dms_json_writer_t* writer, char c);
+static void write_escaped(dms_json_writer_t* writer, const char* value, size_t length);
+static void begin_value(dms_json_writer_t* writer);
+static void open_container(dms_json_writer_t* writer, char c);
+static void close_container(dms_json_writer_t* writer, char c);
+static void set_error(dms_json_writer_t* writer, dms_result_t error);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 初始化寫入器，輸出到固定緩衝區
+ */
+void dms_json_writer_init(dms_json_writer_t* writer, char* buffer, size_t size)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->buffer = buffer;
+    writer->size = size;
+    writer->error = DMS_SUCCESS;
+
+    if (buffer == NULL || size < 2) {
+        writer->error = DMS_ERROR_INVALID_PARAMETER;
+        return;
+    }
+    buffer[0] = '\0';
+}
+
+void dms_json_begin_object(dms_json_writer_t* writer)
+{
+    open_container(writer, '{');
+}
+
+void dms_json_end_object(dms_json_writer_t* writer)
+{
+    close_container(writer, '}');
+}
+
+void dms_json_begin_array(dms_json_writer_t* writer)
+{
+    open_container(writer, '[');
+}
+
+void dms_json_end_array(dms_json_writer_t* writer)
+{
+    close_container(writer, ']');
+}
+
+/**
+ * @brief 寫入物件成員的鍵
+ */
+void dms_json_key(dms_json_writer_t* writer, const char* key)
+{
+    begin_value(writer);
+    write_char(writer, '"');
+    write_escaped(writer, key, strlen(key));
+    write_bytes(writer, "\":", 2);
+    writer->after_key = true;
+}
+
+void dms_json_string(dms_json_writer_t* writer, const char* value)
+{
+    if (value == NULL) {
+        dms_json_null(writer);
+        return;
+    }
+    dms_json_string_n(writer, value, strlen(value));
+}
+
+void dms_json_string_n(dms_json_writer_t* writer, const char* value, size_t length)
+{
+    begin_value(writer);
+    write_char(writer, '"');
+    write_escaped(writer, value, length);
+    write_char(writer, '"');
+}
+
+void dms_json_int(dms_json_writer_t* writer, int64_t value)
+{
+    if (value < 0) {
+        begin_value(writer);
+        write_char(writer, '-');
+        /* 以無號數運算避免 INT64_MIN 取負值溢位 */
+        uint64_t magnitude = (uint64_t)(-(value + 1)) + 1;
+        char digits[20];
+        size_t count = 0;
+        do {
+            digits[sizeof(digits) - 1 - count++] = (char)('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
+        write_bytes(writer, digits + sizeof(digits) - count, count);
+        return;
+    }
+    dms_json_uint(writer, (uint64_t)value);
+}
+
+void dms_json_uint(dms_json_writer_t* writer, uint64_t value)
+{
+    char digits[20];
+    size_t count = 0;
+
+    begin_value(writer);
+    do {
+        digits[sizeof(digits) - 1 - count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    write_bytes(writer, digits + sizeof(digits) - count, count);
+}
+
+void dms_json_double(dms_json_writer_t* writer, double value, int precision)
+{
+    char number[64];
+
+    if (!isfinite(value)) {
+        dms_json_null(writer);
+        return;
+    }
+
+    int length = snprintf(number, sizeof(number), "%.*f", precision, value);
+    if (length < 0 || (size_t)length >= sizeof(number)) {
+        set_error(writer, DMS_ERROR_BUFFER_OVERFLOW);
+        return;
+    }
+
+    begin_value(writer);
+    write_bytes(writer, number, (size_t)length);
+}
+
+void dms_json_bool(dms_json_writer_t* writer, bool value)
+{
+    begin_value(writer);
+    if (value) {
+        write_bytes(writer, "true", 4);
+    } else {
+        write_bytes(writer, "false", 5);
+    }
+}
+
+void dms_json_null(dms_json_writer_t* writer)
+{
+    begin_value(writer);
+    write_bytes(writer, "null", 4);
+}
+
+void dms_json_raw(dms_json_writer_t* writer, const char* json, size_t length)
+{
+    begin_value(writer);
+    write_bytes(writer, json, length);
+}
+
+void dms_json_kv_string(dms_json_writer_t* writer, const char* key, const char* value)
+{
+    dms_json_key(writer, key);
+    dms_json_string(writer, value);
+}
+
+void dms_json_kv_int(dms_json_writer_t* writer, const char* key, int64_t value)
+{
+    dms_json_key(writer, key);
+    dms_json_int(writer, value);
+}
+
+void dms_json_kv_uint(dms_json_writer_t* writer, const char* key, uint64_t value)
+{
+    dms_json_key(writer, key);
+    dms_json_uint(writer, value);
+}
+
+void dms_json_kv_double(dms_json_writer_t* writer, const char* key, double value, int precision)
+{
+    dms_json_key(writer, key);
+    dms_json_double(writer, value, precision);
+}
+
+void dms_json_kv_bool(dms_json_writer_t* writer, const char* key, bool value)
+{
+    dms_json_key(writer, key);
+    dms_json_bool(writer, value);
+}
+
+void dms_json_kv_null(dms_json_writer_t* writer, const char* key)
+{
+    dms_json_key(writer, key);
+    dms_json_null(writer);
+}
+
+/**
+ * @brief 完成寫入
+ */
+dms_result_t dms_json_writer_finish(dms_json_writer_t* writer)
+{
+    if (writer->error == DMS_SUCCESS && (writer->depth != 0 || writer->after_key)) {
+        writer->error = DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (writer->buffer != NULL && writer->size > 0) {
+        writer->buffer[writer->length] = '\0';
+    }
+
+    return writer->error;
+}
+
+/**
+ * @brief 獲取已寫入的總長度
+ */
+size_t dms_json_writer_length(const dms_json_writer_t* writer)
+{
+    return writer->length;
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 寫入原始位元組
+ *
+ * 緩衝區永遠保留一個位元組給結尾 '\0'
+ */
+static void write_bytes(dms_json_writer_t* writer, const char* data, size_t length)
+{
+    if (writer->error != DMS_SUCCESS) {
+        return;
+    }
+
+    if (length > writer->size - 1 - writer->length) {
+        set_error(writer, DMS_ERROR_BUFFER_OVERFLOW);
+        return;
+    }
+
+    memcpy(writer->buffer + writer->length, data, length);
+    writer->length += length;
+}
+
+static void write_char(dms_json_writer_t* writer, char c)
+{
+    write_bytes(writer, &c, 1);
+}
+
+/**
+ * @brief 寫入跳脫後的字串內容（不含引號）
+ *
+ * 不需要跳脫的連續字元一次寫入；非 ASCII 的 UTF-8 位元組原樣輸出
+ */
+static void write_escaped(dms_json_writer_t* writer, const char* value, size_t length)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t run_start = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)value[i];
+        char escape[6];
+        size_t escape_length = 2;
+
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        write_bytes(writer, value + run_start, i - run_start);
+        run_start = i + 1;
+
+        escape[0] = '\\';
+        switch (c) {
+            case '"':  escape[1] = '"';  break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b';  break;
+            case '\f': escape[1] = 'f';  break;
+            case '\n': escape[1] = 'n';  break;
+            case '\r': escape[1] = 'r';  break;
+            case '\t': escape[1] = 't';  break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = hex[c >> 4];
+                escape[5] = hex[c & 0x0F];
+                escape_length = 6;
+                break;
+        }
+        write_bytes(writer, escape, escape_length);
+    }
+
+    write_bytes(writer, value + run_start, length - run_start);
+}
+
+/**
+ * @brief 值或鍵之前的逗號處理
+ */
+static void begin_value(dms_json_writer_t* writer)
+{
+    if (writer->after_key) {
+        writer->after_key = false;
+        return;
+    }
+
+    if (writer->depth == 0) {
+        return;
+    }
+
+    uint32_t bit = 1U << (writer->depth - 1);
+    if (writer->has_member & bit) {
+        write_char(writer, ',');
+    }
+    writer->has_member |= bit;
+}
+
+static void open_container(dms_json_writer_t* writer, char c)
+{
+    if (writer->depth >= DMS_JSON_MAX_DEPTH) {
+        set_error(writer, DMS_ERROR_INVALID_PARAMETER);
+        return;
+    }
+
+    begin_value(writer);
+    write_char(writer, c);
+    writer->depth++;
+    writer->has_member &= ~(1U << (writer->depth - 1));
+}
+
+static void close_container(dms_json_writer_t* writer, char c)
+{
+    if (writer->depth == 0 || writer->after_key) {
+        set_error(writer, DMS_ERROR_INVALID_PARAMETER);
+        return;
+    }
+
+    write_char(writer, c);
+    writer->depth--;
+}
+
+/**
+ * @brief 記錄第一個錯誤，之後的寫入全部忽略
+ */
+static void set_error(dms_json_writer_t* writer, dms_result_t error)
+{
+    if (writer->error == DMS_SUCCESS) {
+        writer->error = error;
+    }
+}
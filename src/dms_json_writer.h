@@ -0,0 +1,123 @@
+
+/*
+ * DMS JSON Writer
+ *
+ * 取代以 snprintf 模板組合 JSON 的作法：
+ * - 直接寫入呼叫者提供的緩衝區，不配置記憶體，不重新解析格式字串
+ * - 字串值與鍵一律跳脫（引號、反斜線、控制字元）
+ * - 逗號與巢狀層級由寫入器維護，呼叫端只描述結構
+ * - 緩衝區不足時標記錯誤並停止寫入，dms_json_writer_finish() 回報錯誤而非靜默截斷
+ */
+
+#ifndef DMS_JSON_WRITER_H_
+#define DMS_JSON_WRITER_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define DMS_JSON_MAX_DEPTH                 ( 16U )
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief JSON 寫入器狀態
+ *
+ * 內容由 dms_json_* 函數維護，呼叫端不應直接修改。
+ * 結構可以整個複製保存，寫入失敗時還原即可撤回之後寫入的內容
+ */
+typedef struct {
+    char* buffer;
+    size_t size;
+    size_t length;                  // 目前緩衝區內的位元組數
+    uint32_t has_member;            // 每層一個位元：該層已有成員，下一個成員前需要逗號
+    uint8_t depth;
+    bool after_key;                 // 剛寫入鍵，下一個值不需要逗號
+    dms_result_t error;             // 第一個發生的錯誤
+} dms_json_writer_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 初始化寫入器，輸出到固定緩衝區
+ *
+ * 完成後緩衝區內容以 '\0' 結尾，可直接作為 MQTT payload 或 HTTP body
+ *
+ * @param writer 寫入器
+ * @param buffer 輸出緩衝區
+ * @param size 緩衝區大小（含結尾 '\0'）
+ */
+void dms_json_writer_init(dms_json_writer_t* writer, char* buffer, size_t size);
+
+/**
+ * @brief 開始與結束物件、陣列
+ */
+void dms_json_begin_object(dms_json_writer_t* writer);
+void dms_json_end_object(dms_json_writer_t* writer);
+void dms_json_begin_array(dms_json_writer_t* writer);
+void dms_json_end_array(dms_json_writer_t* writer);
+
+/**
+ * @brief 寫入物件成員的鍵，下一個寫入的值即為其值
+ *
+ * @param writer 寫入器
+ * @param key 鍵（會被跳脫）
+ */
+void dms_json_key(dms_json_writer_t* writer, const char* key);
+
+/**
+ * @brief 寫入值
+ *
+ * dms_json_string() 的 value 為 NULL 時寫入 null；
+ * dms_json_double() 遇到 NaN 或無限大時寫入 null；
+ * dms_json_raw() 原樣寫入已經是合法 JSON 的片段
+ */
+void dms_json_string(dms_json_writer_t* writer, const char* value);
+void dms_json_string_n(dms_json_writer_t* writer, const char* value, size_t length);
+void dms_json_int(dms_json_writer_t* writer, int64_t value);
+void dms_json_uint(dms_json_writer_t* writer, uint64_t value);
+void dms_json_double(dms_json_writer_t* writer, double value, int precision);
+void dms_json_bool(dms_json_writer_t* writer, bool value);
+void dms_json_null(dms_json_writer_t* writer);
+void dms_json_raw(dms_json_writer_t* writer, const char* json, size_t length);
+
+/**
+ * @brief 寫入物件成員（鍵加值）的便利函數
+ */
+void dms_json_kv_string(dms_json_writer_t* writer, const char* key, const char* value);
+void dms_json_kv_int(dms_json_writer_t* writer, const char* key, int64_t value);
+void dms_json_kv_uint(dms_json_writer_t* writer, const char* key, uint64_t value);
+void dms_json_kv_double(dms_json_writer_t* writer, const char* key, double value, int precision);
+void dms_json_kv_bool(dms_json_writer_t* writer, const char* key, bool value);
+void dms_json_kv_null(dms_json_writer_t* writer, const char* key);
+
+/**
+ * @brief 完成寫入
+ *
+ * 固定緩衝區模式補上結尾 '\0'；分段模式交出剩餘資料
+ *
+ * @param writer 寫入器
+ * @return DMS_SUCCESS 成功，DMS_ERROR_BUFFER_OVERFLOW 緩衝區不足，
+ *         DMS_ERROR_INVALID_PARAMETER 物件或陣列未正確結束，其他為輸出函數的錯誤碼
+ */
+dms_result_t dms_json_writer_finish(dms_json_writer_t* writer);
+
+/**
+ * @brief 獲取已寫入的總長度（不含結尾 '\0'）
+ *
+ * @param writer 寫入器
+ * @return 位元組數
+ */
+size_t dms_json_writer_length(const dms_json_writer_t* writer);
+
+#endif /* DMS_JSON_WRITER_H_ */
@@ -6,6 +6,11 @@
  *
  * 重連策略模組 - 基於現有 demo_config.h 定義
  * 提取自 dms_client.c 的 attemptReconnection() 邏輯
+ *
+ * 退避等待以主迴圈中的計時器實作，不在任何調用中阻塞：
+ * 斷線時調用 dms_reconnect_request()，主迴圈每輪調用 dms_reconnect_process()，
+ * 到期時才執行重連嘗試；失敗後依 jitter 延遲重新排程。
+ * 上行網路恢復時 dms_reconnect_uplink_restored() 將等待縮短為小範圍的隨機延遲。
  */
 
 #ifndef DMS_RECONNECT_H_
@@ -75,14 +80,78 @@ dms_result_t dms_reconnect_init(const dms_reconnect_config_t* config);
 void dms_reconnect_register_interface(const dms_reconnect_interface_t* interface);
 
 /**
- * @brief 執行重連嘗試
+ * @brief 立即執行重連嘗試
  *
- * 封裝原始的 attemptReconnection() 函數邏輯
+ * 封裝原始的 attemptReconnection() 函數邏輯，不等待退避計時器；
+ * 失敗時排程下一次嘗試
  *
  * @return DMS_SUCCESS 成功，其他為錯誤碼
  */
 dms_result_t dms_reconnect_attempt(void);
 
+/**
+ * @brief 通知連線中斷
+ *
+ * 尚未排程時安排立即嘗試；已在退避等待中則維持原本的時間
+ */
+void dms_reconnect_request(void);
+
+/**
+ * @brief 驅動重連計時器
+ *
+ * 由主迴圈每輪調用，計時器到期時執行一次 dms_reconnect_attempt()
+ *
+ * @return true 本次調用完成重連，false 尚未到期、未排程或嘗試失敗
+ */
+bool dms_reconnect_process(void);
+
+/**
+ * @brief 檢查是否有排程中的重連嘗試
+ */
+bool dms_reconnect_is_pending(void);
+
+/**
+ * @brief 獲取下次重連嘗試的時間
+ *
+ * @param deadline_ms 輸出 Clock_GetTimeMs() 時間（可以為 NULL）
+ * @return true 已排程，false 沒有排程中的嘗試
+ */
+bool dms_reconnect_get_deadline(uint32_t* deadline_ms);
+
+/**
+ * @brief 獲取距離下次重連嘗試的毫秒數
+ *
+ * 供主迴圈決定等待時間
+ *
+ * @return 剩餘毫秒數，已到期返回 0，沒有排程返回 UINT32_MAX
+ */
+uint32_t dms_reconnect_get_wait_ms(void);
+
+/**
+ * @brief 提前下次重連嘗試
+ *
+ * 下次嘗試改為不晚於 delay_ms 之後；沒有排程時直接排程
+ *
+ * @param delay_ms 從現在起的最長等待時間
+ */
+void dms_reconnect_bring_forward(uint32_t delay_ms);
+
+/**
+ * @brief 上行網路恢復通知
+ *
+ * 作為 dms_uplink_init() 的回調。退避等待中時將延遲重設為基礎延遲，
+ * 並在 0 到 DMS_RECONNECT_UPLINK_JITTER_MS 之間的隨機時間內嘗試，避免同一區域的裝置同時連線；
+ * 沒有排程中的嘗試（已連線）時不處理
+ */
+void dms_reconnect_uplink_restored(void);
+
+/**
+ * @brief 取消排程中的重連嘗試
+ *
+ * 重試計數與退避狀態保留，之後的 dms_reconnect_request() 會重新排程
+ */
+void dms_reconnect_cancel(void);
+
 /**
  * @brief 檢查是否應該重連
  *
@@ -109,7 +178,7 @@ void dms_reconnect_reset_state(void);
 /**
  * @brief 更新重連失敗狀態
  *
- * 重連失敗後調用，更新重試計數和延遲時間
+ * 重連失敗後調用，更新重試計數和延遲時間，並排程下一次嘗試
  */
 void dms_reconnect_update_failure(void);
 
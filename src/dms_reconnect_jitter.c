@@ -0,0 +1,138 @@
+/*
+ * DMS Reconnect Jitter Implementation
+ *
+ * 種子：FNV-1a 後以 murmur3 fmix32 打散，使只差最後幾位的 MAC 也落在不相關的位置。
+ * 亂數：xorshift32，週期 2^32-1，狀態只有一個 uint32_t。
+ */
+
+#include "dms_reconnect_jitter.h"
+
+#include <stddef.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define JITTER_FNV_OFFSET_BASIS        ( 2166136261U )
+#define JITTER_FNV_PRIME               ( 16777619U )
+#define JITTER_DEFAULT_SEED            ( 0x9E3779B9U )
+#define JITTER_GROWTH_FACTOR           ( 3U )
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static uint32_t mix32(uint32_t value);
+static uint32_t xorshift32(uint32_t* state);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 由裝置識別字串計算種子
+ */
+uint32_t dms_reconnect_jitter_seed(const char* device_id)
+{
+    if (device_id == NULL || device_id[0] == '\0') {
+        return JITTER_DEFAULT_SEED;
+    }
+
+    uint32_t hash = JITTER_FNV_OFFSET_BASIS;
+    for (const unsigned char* p = (const unsigned char*)device_id; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= JITTER_FNV_PRIME;
+    }
+
+    hash = mix32(hash);
+    return hash != 0 ? hash : JITTER_DEFAULT_SEED;
+}
+
+/**
+ * @brief 初始化延遲產生器
+ */
+void dms_reconnect_jitter_init(dms_reconnect_jitter_t* jitter, uint32_t seed,
+                               uint32_t base_ms, uint32_t cap_ms)
+{
+    if (jitter == NULL) {
+        return;
+    }
+
+    jitter->rng = seed != 0 ? seed : JITTER_DEFAULT_SEED;
+    jitter->base_ms = base_ms > 0 ? base_ms : 1;
+    jitter->cap_ms = cap_ms > jitter->base_ms ? cap_ms : jitter->base_ms;
+    jitter->prev_ms = jitter->base_ms;
+}
+
+/**
+ * @brief 產生下一次重連延遲
+ */
+uint32_t dms_reconnect_jitter_next(dms_reconnect_jitter_t* jitter)
+{
+    if (jitter == NULL) {
+        return 0;
+    }
+
+    /* 以 64 位元計算上限，避免 prev * 3 溢位 */
+    uint64_t upper = (uint64_t)jitter->prev_ms * JITTER_GROWTH_FACTOR;
+    if (upper > jitter->cap_ms) {
+        upper = jitter->cap_ms;
+    }
+
+    uint32_t delay = jitter->base_ms;
+    if (upper > jitter->base_ms) {
+        uint32_t span = (uint32_t)upper - jitter->base_ms + 1;
+        delay += xorshift32(&jitter->rng) % span;
+    }
+
+    jitter->prev_ms = delay;
+    return delay;
+}
+
+/**
+ * @brief 產生 0 到 max_ms 之間的隨機延遲
+ */
+uint32_t dms_reconnect_jitter_spread(dms_reconnect_jitter_t* jitter, uint32_t max_ms)
+{
+    if (jitter == NULL || max_ms == 0) {
+        return 0;
+    }
+
+    return (uint32_t)(xorshift32(&jitter->rng) % ((uint64_t)max_ms + 1));
+}
+
+/**
+ * @brief 連線成功或上行網路恢復後重設延遲
+ */
+void dms_reconnect_jitter_reset(dms_reconnect_jitter_t* jitter)
+{
+    if (jitter != NULL) {
+        jitter->prev_ms = jitter->base_ms;
+    }
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief murmur3 fmix32
+ */
+static uint32_t mix32(uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x85EBCA6BU;
+    value ^= value >> 13;
+    value *= 0xC2B2AE35U;
+    value ^= value >> 16;
+    return value;
+}
+
+/**
+ * @brief xorshift32（Marsaglia 13/17/5）
+ */
+static uint32_t xorshift32(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
@@ -0,0 +1,82 @@
+
+/*
+ * DMS Reconnect Jitter
+ *
+ * 重連延遲產生器（decorrelated jitter），取代每次失敗都重新計算的多層 MAC 雜湊與時間戳 jitter：
+ * - 裝置種子在初始化時由 MAC 計算一次，之後每次失敗只需一次 xorshift32
+ * - 下次延遲 = min(cap, random(base, prev * 3))，延遲隨失敗次數成長，但相鄰裝置的序列互不相關
+ * - 相同種子產生相同序列，離線模擬工具（tools/dms_reconnect_sim.c）與裝置使用同一份程式碼
+ *
+ * 不依賴日誌、時鐘或其他 DMS 模組，狀態由呼叫者保存。
+ */
+
+#ifndef DMS_RECONNECT_JITTER_H_
+#define DMS_RECONNECT_JITTER_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include <stdint.h>
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief 重連延遲產生器狀態
+ */
+typedef struct {
+    uint32_t rng;                       // xorshift32 狀態（不為 0）
+    uint32_t base_ms;                   // 最小延遲
+    uint32_t cap_ms;                    // 最大延遲
+    uint32_t prev_ms;                   // 上次延遲
+} dms_reconnect_jitter_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 由裝置識別字串計算種子
+ *
+ * @param device_id MAC 地址或 client ID（NULL 或空字串時使用固定種子）
+ * @return 非 0 的種子
+ */
+uint32_t dms_reconnect_jitter_seed(const char* device_id);
+
+/**
+ * @brief 初始化延遲產生器
+ *
+ * @param jitter 產生器狀態
+ * @param seed dms_reconnect_jitter_seed() 的結果
+ * @param base_ms 最小延遲（0 視為 1）
+ * @param cap_ms 最大延遲（小於 base_ms 時視為 base_ms）
+ */
+void dms_reconnect_jitter_init(dms_reconnect_jitter_t* jitter, uint32_t seed,
+                               uint32_t base_ms, uint32_t cap_ms);
+
+/**
+ * @brief 產生下一次重連延遲
+ *
+ * @param jitter 產生器狀態
+ * @return 延遲毫秒數，介於 base_ms 與 cap_ms 之間
+ */
+uint32_t dms_reconnect_jitter_next(dms_reconnect_jitter_t* jitter);
+
+/**
+ * @brief 產生 0 到 max_ms 之間的隨機延遲
+ *
+ * 用於需要立即重連但仍要錯開裝置的情況（例如上行網路恢復），不影響退避狀態
+ *
+ * @param jitter 產生器狀態
+ * @param max_ms 上限
+ * @return 延遲毫秒數
+ */
+uint32_t dms_reconnect_jitter_spread(dms_reconnect_jitter_t* jitter, uint32_t max_ms);
+
+/**
+ * @brief 連線成功或上行網路恢復後重設延遲
+ *
+ * 只將上次延遲設回 base_ms，亂數序列繼續往下走
+ */
+void dms_reconnect_jitter_reset(dms_reconnect_jitter_t* jitter);
+
+#endif /* DMS_RECONNECT_JITTER_H_ */
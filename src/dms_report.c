@@ -0,0 +1,437 @@
+/*
+ * DMS Report Channel Implementation
+ *
+ * 排入的回報依序存放在固定大小的緩衝區（內容以 '\0' 分隔），
+ * 發布時整批搬到發布用的副本後釋放鎖，副本保留到收到 PUBACK 才釋放：
+ * - 發布失敗的回報從副本交給各自的 HTTP 回退函數
+ * - 等待 PUBACK 時斷線（clean session 不會補送）或逾時，以同一個 seq 重新發布，
+ *   斷線超過保留時間則改走 HTTP
+ * - 同一時間只有一批等待確認，之後的回報留在等待中的批次
+ *
+ * 訊息格式：{"device_id":"...","type":"report","seq":N,
+ *            "reports":[["control_progress",{...}],["fw_progress",{...}],...]}
+ */
+
+#include "dms_report.h"
+#include "dms_json_writer.h"
+#include "clock.h"
+
+/* 系統標頭檔 */
+#include <string.h>
+#include <pthread.h>
+
+/*-----------------------------------------------------------*/
+/* 內部類型與常數 */
+
+typedef struct {
+    dms_report_endpoint_t endpoint;
+    dms_report_fallback_t fallback;
+    uint16_t offset;                    // 內容在 bytes 中的位置
+    uint16_t length;                    // 不含結尾 '\0'
+} report_record_t;
+
+/* 一批排入的回報 */
+typedef struct {
+    report_record_t records[DMS_REPORT_MAX_RECORDS];
+    uint32_t count;
+    size_t used;
+    uint32_t first_queued_ms;
+    uint32_t seq;                       // 第一次發布時指定，重新發布沿用
+    char bytes[DMS_REPORT_BATCH_BYTES];
+} report_batch_t;
+
+static const char* const g_endpoint_names[DMS_REPORT_ENDPOINT_COUNT] = {
+    [DMS_REPORT_CONTROL_PROGRESS] = "control_progress",
+    [DMS_REPORT_FW_PROGRESS]      = "fw_progress",
+    [DMS_REPORT_DEVICE_INFO]      = "device_info"
+};
+
+/*-----------------------------------------------------------*/
+/* 內部全域變數 */
+
+static mqtt_interface_t g_mqtt_interface = {0};
+static dms_report_config_t g_config = {0};
+static bool g_initialized = false;
+
+static pthread_mutex_t g_batch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static report_batch_t g_pending;        // 受 g_batch_mutex 保護
+static report_batch_t g_sending;        // 等待 PUBACK 的批次，只在主迴圈中使用
+static uint16_t g_inflight_packet_id = 0;  // 0 表示尚未發布或需要重新發布
+static uint32_t g_inflight_sent_ms = 0;
+static uint32_t g_sequence = 0;
+
+static char g_payload[DMS_REPORT_PAYLOAD_SIZE];
+static dms_report_stats_t g_stats = {0};
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static void take_pending_batch(void);
+static void process_sending_batch(void);
+static bool publish_batch(report_batch_t* batch);
+static size_t build_payload(const report_batch_t* batch);
+static void fallback_batch(const report_batch_t* batch);
+static void release_sending_batch(void);
+static void on_puback(uint16_t packet_id);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 初始化回報通道
+ */
+dms_result_t dms_report_init(const mqtt_interface_t* mqtt_if)
+{
+    if (mqtt_if == NULL || mqtt_if->publish_tracked == NULL || mqtt_if->register_puback == NULL ||
+        mqtt_if->is_connected == NULL) {
+        DMS_LOG_ERROR("❌ Invalid MQTT interface for report channel");
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    const dms_report_config_t* config = dms_config_get_report();
+    if (config == NULL) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&g_batch_mutex);
+    memset(&g_pending, 0, sizeof(g_pending));
+    pthread_mutex_unlock(&g_batch_mutex);
+    memset(&g_stats, 0, sizeof(g_stats));
+    memset(&g_sending, 0, sizeof(g_sending));
+    g_inflight_packet_id = 0;
+
+    g_mqtt_interface = *mqtt_if;
+    g_config = *config;
+    g_sequence = 0;
+    g_mqtt_interface.register_puback(on_puback);
+    g_initialized = true;
+
+    DMS_LOG_INFO("✅ Report channel initialized (control %s, fw %s, device info %s, batch %u ms)",
+                 g_config.mqtt_control_progress ? "MQTT" : "HTTP",
+                 g_config.mqtt_fw_progress ? "MQTT" : "HTTP",
+                 g_config.mqtt_device_info ? "MQTT" : "HTTP",
+                 (unsigned)g_config.batch_window_ms);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 檢查端點是否經由 MQTT 回報
+ */
+bool dms_report_uses_mqtt(dms_report_endpoint_t endpoint)
+{
+    if (!g_initialized) {
+        return false;
+    }
+
+    switch (endpoint) {
+        case DMS_REPORT_CONTROL_PROGRESS:
+            return g_config.mqtt_control_progress;
+        case DMS_REPORT_FW_PROGRESS:
+            return g_config.mqtt_fw_progress;
+        case DMS_REPORT_DEVICE_INFO:
+            return g_config.mqtt_device_info;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief 將回報排入 MQTT 批次
+ */
+dms_result_t dms_report_submit(dms_report_endpoint_t endpoint,
+                               const char* body,
+                               size_t length,
+                               dms_report_fallback_t fallback)
+{
+    if (body == NULL || length == 0 || fallback == NULL || !dms_report_uses_mqtt(endpoint)) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    /* 斷線時不等待重連，HTTP 可能仍然可用 */
+    if (!g_mqtt_interface.is_connected()) {
+        return DMS_ERROR_MQTT_FAILURE;
+    }
+
+    pthread_mutex_lock(&g_batch_mutex);
+
+    if (g_pending.count >= DMS_REPORT_MAX_RECORDS ||
+        g_pending.used + length + 1 > sizeof(g_pending.bytes)) {
+        pthread_mutex_unlock(&g_batch_mutex);
+        DMS_LOG_DEBUG("Report batch full, %s goes over HTTP", g_endpoint_names[endpoint]);
+        return DMS_ERROR_BUFFER_OVERFLOW;
+    }
+
+    if (g_pending.count == 0) {
+        g_pending.first_queued_ms = Clock_GetTimeMs();
+    }
+
+    report_record_t* record = &g_pending.records[g_pending.count++];
+    record->endpoint = endpoint;
+    record->fallback = fallback;
+    record->offset = (uint16_t)g_pending.used;
+    record->length = (uint16_t)length;
+    memcpy(&g_pending.bytes[g_pending.used], body, length);
+    g_pending.bytes[g_pending.used + length] = '\0';
+    g_pending.used += length + 1;
+    g_stats.reports_queued++;
+
+    pthread_mutex_unlock(&g_batch_mutex);
+
+    DMS_LOG_DEBUG("Queued %s report for MQTT (%zu bytes)", g_endpoint_names[endpoint], length);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 發布到期的批次
+ */
+void dms_report_process(void)
+{
+    if (!g_initialized) {
+        return;
+    }
+
+    /* 上一批尚未確認時不取出新的批次 */
+    if (g_sending.count > 0) {
+        process_sending_batch();
+        return;
+    }
+
+    pthread_mutex_lock(&g_batch_mutex);
+    uint32_t count = g_pending.count;
+    uint32_t age_ms = Clock_GetTimeMs() - g_pending.first_queued_ms;
+    pthread_mutex_unlock(&g_batch_mutex);
+
+    if (count == 0 || age_ms < g_config.batch_window_ms) {
+        return;
+    }
+
+    if (!g_mqtt_interface.is_connected()) {
+        if (age_ms >= g_config.max_hold_ms) {
+            DMS_LOG_WARN("⚠️ MQTT down for %u ms, sending %u report(s) over HTTP", age_ms, count);
+            take_pending_batch();
+            fallback_batch(&g_sending);
+            release_sending_batch();
+        }
+        return;                         /* 保留到重新連線 */
+    }
+
+    take_pending_batch();
+    if (!publish_batch(&g_sending)) {
+        fallback_batch(&g_sending);
+        release_sending_batch();
+    }
+}
+
+/**
+ * @brief 獲取回報通道統計資訊
+ */
+void dms_report_get_stats(dms_report_stats_t* stats)
+{
+    if (stats != NULL) {
+        pthread_mutex_lock(&g_batch_mutex);
+        *stats = g_stats;
+        pthread_mutex_unlock(&g_batch_mutex);
+    }
+}
+
+/**
+ * @brief 清理回報通道
+ */
+void dms_report_cleanup(void)
+{
+    if (!g_initialized) {
+        return;
+    }
+
+    /* 結束前無法再等待 PUBACK，未確認與未發布的回報都改走 HTTP */
+    if (g_sending.count > 0) {
+        fallback_batch(&g_sending);
+        release_sending_batch();
+    }
+    take_pending_batch();
+    if (g_sending.count > 0) {
+        fallback_batch(&g_sending);
+        release_sending_batch();
+    }
+
+    g_mqtt_interface.register_puback(NULL);
+    g_initialized = false;
+    DMS_LOG_INFO("Report channel cleanup completed (%u published, %u over HTTP)",
+                 g_stats.reports_published, g_stats.reports_fallback);
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 取出等待中的批次，之後的回報排入新的批次
+ */
+static void take_pending_batch(void)
+{
+    pthread_mutex_lock(&g_batch_mutex);
+    memcpy(&g_sending, &g_pending, sizeof(g_sending));
+    g_pending.count = 0;
+    g_pending.used = 0;
+    pthread_mutex_unlock(&g_batch_mutex);
+}
+
+/**
+ * @brief 處理等待 PUBACK 的批次
+ *
+ * 斷線後 PUBACK 不會再到達：重新連線後重新發布，斷線超過保留時間改走 HTTP。
+ * 連線中但逾時未確認時也重新發布，伺服器以 seq 去除重複。
+ */
+static void process_sending_batch(void)
+{
+    uint32_t now_ms = Clock_GetTimeMs();
+    bool connected = g_mqtt_interface.is_connected();
+
+    if (g_inflight_packet_id != 0) {
+        if (connected && now_ms - g_inflight_sent_ms < DMS_REPORT_ACK_TIMEOUT_MS) {
+            return;
+        }
+        DMS_LOG_WARN("⚠️ No PUBACK for report seq %u (%s), will republish",
+                     g_sending.seq, connected ? "timeout" : "disconnected");
+        g_inflight_packet_id = 0;
+    }
+
+    if (!connected) {
+        uint32_t age_ms = now_ms - g_sending.first_queued_ms;
+        if (age_ms >= g_config.max_hold_ms) {
+            DMS_LOG_WARN("⚠️ MQTT down for %u ms, sending %u report(s) over HTTP", age_ms, g_sending.count);
+            fallback_batch(&g_sending);
+            release_sending_batch();
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&g_batch_mutex);
+    g_stats.republish_count++;
+    pthread_mutex_unlock(&g_batch_mutex);
+
+    if (!publish_batch(&g_sending)) {
+        fallback_batch(&g_sending);
+        release_sending_batch();
+    }
+}
+
+/**
+ * @brief 將批次發布為一則 QoS1 訊息
+ *
+ * 成功時批次保留到收到 PUBACK
+ *
+ * @return true 發布成功，false 失敗（呼叫者改走 HTTP）
+ */
+static bool publish_batch(report_batch_t* batch)
+{
+    if (batch->seq == 0) {
+        batch->seq = ++g_sequence;
+    }
+
+    size_t length = build_payload(batch);
+    uint16_t packet_id = 0;
+    bool published = false;
+
+    if (length == 0) {
+        DMS_LOG_ERROR("❌ Failed to build report payload");
+    } else if (g_mqtt_interface.publish_tracked(DMS_REPORT_TOPIC, g_payload, length,
+                                                &packet_id) != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ Failed to publish %u report(s), falling back to HTTP", batch->count);
+    } else {
+        published = true;
+    }
+
+    if (!published) {
+        pthread_mutex_lock(&g_batch_mutex);
+        g_stats.publish_failures++;
+        pthread_mutex_unlock(&g_batch_mutex);
+        return false;
+    }
+
+    g_inflight_packet_id = packet_id;
+    g_inflight_sent_ms = Clock_GetTimeMs();
+    DMS_LOG_DEBUG("Report batch published: seq %u, packet %u, %u report(s), %zu bytes",
+                  batch->seq, packet_id, batch->count, length);
+    return true;
+}
+
+/**
+ * @brief 將批次編碼為一則訊息
+ *
+ * @return 訊息長度，失敗返回 0
+ */
+static size_t build_payload(const report_batch_t* batch)
+{
+    dms_json_writer_t writer;
+
+    dms_json_writer_init(&writer, g_payload, sizeof(g_payload));
+    dms_json_begin_object(&writer);
+    dms_json_kv_string(&writer, "device_id", CLIENT_IDENTIFIER);
+    dms_json_kv_string(&writer, "type", "report");
+    dms_json_kv_uint(&writer, "seq", batch->seq);
+    dms_json_key(&writer, "reports");
+    dms_json_begin_array(&writer);
+    for (uint32_t i = 0; i < batch->count; i++) {
+        const report_record_t* record = &batch->records[i];
+        dms_json_begin_array(&writer);
+        dms_json_string(&writer, g_endpoint_names[record->endpoint]);
+        dms_json_raw(&writer, &batch->bytes[record->offset], record->length);
+        dms_json_end_array(&writer);
+    }
+    dms_json_end_array(&writer);
+    dms_json_end_object(&writer);
+
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        return 0;
+    }
+    return dms_json_writer_length(&writer);
+}
+
+/**
+ * @brief 將批次中的回報逐一交給 HTTP 回退函數
+ */
+static void fallback_batch(const report_batch_t* batch)
+{
+    for (uint32_t i = 0; i < batch->count; i++) {
+        const report_record_t* record = &batch->records[i];
+
+        if (record->fallback(record->endpoint, &batch->bytes[record->offset]) != DMS_SUCCESS) {
+            DMS_LOG_ERROR("❌ %s report lost: HTTP fallback failed", g_endpoint_names[record->endpoint]);
+        }
+    }
+
+    pthread_mutex_lock(&g_batch_mutex);
+    g_stats.reports_fallback += batch->count;
+    pthread_mutex_unlock(&g_batch_mutex);
+}
+
+/**
+ * @brief 釋放已確認或已改走 HTTP 的批次
+ */
+static void release_sending_batch(void)
+{
+    g_sending.count = 0;
+    g_sending.used = 0;
+    g_sending.seq = 0;
+    g_inflight_packet_id = 0;
+}
+
+/**
+ * @brief PUBACK 回調：確認等待中的批次已送達
+ *
+ * 在 dms_aws_iot_process_loop() 中調用，與 dms_report_process() 同屬主迴圈
+ */
+static void on_puback(uint16_t packet_id)
+{
+    if (packet_id == 0 || packet_id != g_inflight_packet_id) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_batch_mutex);
+    g_stats.reports_published += g_sending.count;
+    g_stats.messages_published++;
+    pthread_mutex_unlock(&g_batch_mutex);
+
+    DMS_LOG_DEBUG("Report batch seq %u confirmed", g_sending.seq);
+    release_sending_batch();
+}
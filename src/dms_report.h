@@ -0,0 +1,122 @@
+
+/*
+ * DMS Report Channel
+ *
+ * 以現有的 MQTT/TLS 連線回報進度與裝置資訊，取代每次回報各開一條 HTTPS 連線：
+ * - 各端點的回報內容與 HTTP API 的 JSON body 相同，伺服器可沿用同一套解析
+ * - 短時間內的回報合併為一則 QoS1 訊息發布到 DMS_REPORT_TOPIC
+ * - 每則訊息帶遞增的 seq，QoS1 重送造成的重複由伺服器去除
+ * - 端點未開啟 MQTT、目前斷線或批次已滿時 dms_report_submit() 返回錯誤，由呼叫者直接走 HTTP
+ * - 已排入的回報保留到收到 PUBACK；斷線或逾時未確認時重新發布，
+ *   發布失敗或斷線超過保留時間時，交給排入時提供的 HTTP 回退函數送出
+ *
+ * dms_report_submit() 可在任何執行緒調用；發布與回退只在主迴圈的 dms_report_process() 中進行。
+ */
+
+#ifndef DMS_REPORT_H_
+#define DMS_REPORT_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "dms_log.h"
+#include "dms_aws_iot.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+/* 訊息外框與每筆回報的額外長度 */
+#define DMS_REPORT_PAYLOAD_SIZE            ( DMS_REPORT_BATCH_BYTES + DMS_REPORT_MAX_RECORDS * 32U + 128U )
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief 回報端點
+ */
+typedef enum {
+    DMS_REPORT_CONTROL_PROGRESS = 0,    // v1/device/control/progress/update
+    DMS_REPORT_FW_PROGRESS,             // v1/device/fw/progress/update
+    DMS_REPORT_DEVICE_INFO,             // v1/device/info/update
+    DMS_REPORT_ENDPOINT_COUNT
+} dms_report_endpoint_t;
+
+/**
+ * @brief HTTP 回退函數
+ *
+ * @param endpoint 回報端點
+ * @param body 回報內容（以 '\0' 結尾的 JSON）
+ * @return DMS_SUCCESS 成功，其他為錯誤碼
+ */
+typedef dms_result_t (*dms_report_fallback_t)(dms_report_endpoint_t endpoint, const char* body);
+
+/**
+ * @brief 回報通道統計資訊
+ */
+typedef struct {
+    uint32_t reports_queued;            // 排入 MQTT 批次的回報數
+    uint32_t reports_published;         // 經 MQTT 送出並收到 PUBACK 的回報數
+    uint32_t reports_fallback;          // 已排入但改走 HTTP 的回報數
+    uint32_t messages_published;        // 已收到 PUBACK 的訊息數
+    uint32_t publish_failures;          // 發布失敗次數
+    uint32_t republish_count;           // 未收到 PUBACK 而重新發布的次數
+} dms_report_stats_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 初始化回報通道
+ *
+ * @param mqtt_if MQTT 介面，需提供 publish_tracked 與 register_puback
+ * @return DMS_SUCCESS 成功，其他為錯誤碼（所有回報走 HTTP）
+ */
+dms_result_t dms_report_init(const mqtt_interface_t* mqtt_if);
+
+/**
+ * @brief 檢查端點是否經由 MQTT 回報
+ */
+bool dms_report_uses_mqtt(dms_report_endpoint_t endpoint);
+
+/**
+ * @brief 將回報排入 MQTT 批次
+ *
+ * @param endpoint 回報端點
+ * @param body 回報內容（JSON 物件）
+ * @param length 內容長度
+ * @param fallback 發布失敗時使用的 HTTP 回退函數
+ * @return DMS_SUCCESS 已排入；其他為錯誤碼，此時呼叫者應直接使用 HTTP
+ */
+dms_result_t dms_report_submit(dms_report_endpoint_t endpoint,
+                               const char* body,
+                               size_t length,
+                               dms_report_fallback_t fallback);
+
+/**
+ * @brief 發布到期的批次
+ *
+ * 由主迴圈定期調用；上一批尚未收到 PUBACK 時不發布新的批次，
+ * 斷線超過保留時間的回報改走 HTTP
+ */
+void dms_report_process(void);
+
+/**
+ * @brief 獲取回報通道統計資訊
+ *
+ * @param stats 輸出統計資訊
+ */
+void dms_report_get_stats(dms_report_stats_t* stats);
+
+/**
+ * @brief 清理回報通道
+ *
+ * 尚未發布或尚未收到 PUBACK 的回報改走 HTTP
+ */
+void dms_report_cleanup(void);
+
+#endif /* DMS_REPORT_H_ */
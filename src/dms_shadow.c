@@ -7,16 +7,21 @@
  */
 
 #include "dms_shadow.h"
+#include "dms_shadow_mirror.h"
+#include "dms_sysstat.h"
+#include "dms_json_writer.h"
+#include "dms_json_index.h"
 #include "dms_command.h"
 
 /* AWS IoT SDK includes - 與原始程式碼相同 */
 #include "core_mqtt.h"
-#include "core_json.h"
+#include "clock.h"
 
 /* System includes - 與原始程式碼相同 */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <unistd.h>
 #include <time.h>
 #include <sys/sysinfo.h>
@@ -39,14 +44,68 @@ static const char* g_shadow_topics[SHADOW_MAX_TOPICS] = {
     SHADOW_GET_REJECTED_TOPIC
 };
 
+/* reported 欄位描述 - 差異更新時逐欄位比對序列化後的 JSON 值 */
+typedef void (*reported_field_write_t)(dms_json_writer_t* writer,
+                                       const shadow_reported_state_t* state);
+
+typedef struct {
+    const char* name;
+    reported_field_write_t write;
+} reported_field_t;
+
+static void write_connected(dms_json_writer_t* w, const shadow_reported_state_t* s);
+static void write_status(dms_json_writer_t* w, const shadow_reported_state_t* s);
+static void write_uptime(dms_json_writer_t* w, const shadow_reported_state_t* s);
+static void write_timestamp(dms_json_writer_t* w, const shadow_reported_state_t* s);
+static void write_firmware(dms_json_writer_t* w, const shadow_reported_state_t* s);
+static void write_device_type(dms_json_writer_t* w, const shadow_reported_state_t* s);
+static void write_cpu_usage(dms_json_writer_t* w, const shadow_reported_state_t* s);
+static void write_memory_usage(dms_json_writer_t* w, const shadow_reported_state_t* s);
+static void write_network_sent(dms_json_writer_t* w, const shadow_reported_state_t* s);
+static void write_network_received(dms_json_writer_t* w, const shadow_reported_state_t* s);
+
+/* 欄位順序與原始 reported 文件相同 */
+static const reported_field_t g_reported_fields[] = {
+    { "connected",        write_connected },
+    { "status",           write_status },
+    { "uptime",           write_uptime },
+    { "timestamp",        write_timestamp },
+    { "firmware",         write_firmware },
+    { "device_type",      write_device_type },
+    { "cpu_usage",        write_cpu_usage },
+    { "memory_usage",     write_memory_usage },
+    { "network_sent",     write_network_sent },
+    { "network_received", write_network_received }
+};
+
 /*-----------------------------------------------------------*/
 /* 內部函數宣告 */
 
 static void shadow_message_handler(const char* topic, const char* payload, size_t payload_length);
-static dms_result_t parse_device_bind_info(const char* payload, size_t payload_length, device_bind_info_t* bind_info);
+static void read_bind_info_from_mirror(device_bind_info_t* bind_info);
+static void on_bind_info_changed(const char* path, shadow_value_type_t type, const char* value);
 static bool is_device_bound(const device_bind_info_t* bind_info);
 static void update_system_stats(shadow_reported_state_t* state);
-static uint32_t get_system_uptime(void);
+static void load_shadow_snapshot(void);
+static void save_shadow_snapshot(const char* payload, size_t payload_length);
+static void reconcile_shadow_document(const char* payload, size_t payload_length,
+                                      const dms_json_index_t* index);
+static dms_result_t publish_pending_batch(bool ignore_window);
+static dms_result_t send_batch(shadow_write_batch_t* batch, uint32_t now_ms);
+static shadow_write_batch_t* begin_batch_write(void);
+static bool is_batch_empty(const shadow_write_batch_t* batch);
+static void apply_throttle_backoff(void);
+static int build_update_document(const shadow_write_batch_t* batch,
+                                 const shadow_reported_state_t* base,
+                                 uint32_t token, char* payload, size_t size);
+static void write_reported_key(dms_json_writer_t* writer, const char* key, bool* reported_open);
+static size_t render_reported_field(const reported_field_t* field,
+                                    const shadow_reported_state_t* state,
+                                    char* buffer, size_t size);
+static uint32_t parse_client_token(const dms_json_index_t* index);
+static uint32_t scan_client_token(const char* payload, size_t payload_length);
+static uint32_t client_token_sequence(const char* value, size_t value_length);
+static int parse_reject_code(const dms_json_index_t* index);
 
 /*-----------------------------------------------------------*/
 /* 公開介面函數實作 */
@@ -73,6 +132,30 @@ dms_result_t dms_shadow_init(const mqtt_interface_t* mqtt_if)
     g_shadow_context.get_received = false;
     g_shadow_context.last_update_time = 0;
     g_shadow_context.message_callback = NULL;
+    g_shadow_context.acked_valid = false;
+    g_shadow_context.pending_token = 0;
+    g_shadow_context.next_token = 1;
+    memset(&g_shadow_context.pending_batch, 0, sizeof(g_shadow_context.pending_batch));
+    memset(&g_shadow_context.inflight_batch, 0, sizeof(g_shadow_context.inflight_batch));
+    g_shadow_context.inflight_sent_ms = 0;
+    memset(&g_shadow_context.write_stats, 0, sizeof(g_shadow_context.write_stats));
+    g_shadow_context.throttle_backoff_ms = 0;
+    g_shadow_context.throttle_until_ms = 0;
+
+    /* /proc 取樣器 - 失敗時 update_system_stats() 退回 sysinfo() */
+    if (dms_sysstat_init() != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ System statistics sampler unavailable, using sysinfo()");
+    }
+
+    /* 文件鏡像 - reported.info 變更時自動更新綁定資訊 */
+    dms_shadow_mirror_init();
+    dms_shadow_mirror_watch(SHADOW_BIND_INFO_PATH, on_bind_info_changed);
+
+    /* 先從本地快照取得綁定資訊，不必等待 Shadow Get */
+    g_shadow_context.document_version = 0;
+    g_shadow_context.snapshot_loaded = false;
+    g_shadow_context.bind_info_confirmed = false;
+    load_shadow_snapshot();
 
     /* 註冊訊息處理器到 AWS IoT 模組 */
     dms_aws_iot_register_message_callback(shadow_message_handler);
@@ -99,6 +182,10 @@ dms_result_t dms_shadow_start(void)
         return DMS_ERROR_INVALID_PARAMETER;  // 使用正確的錯誤碼
     }
 
+    /* 重連後無法確定 AWS 端狀態，下次 reported 更新送出完整狀態 */
+    dms_shadow_request_full_resync();
+    g_shadow_context.bind_info_confirmed = false;
+
     /* 訂閱 Shadow 主題 - 與原始邏輯完全相同 */
     dms_result_t result = dms_shadow_subscribe_topics();
     if (result != DMS_SUCCESS) {
@@ -201,6 +288,13 @@ dms_result_t dms_shadow_wait_get_response(uint32_t timeout_ms)
         return DMS_ERROR_INVALID_PARAMETER;  // 使用正確的錯誤碼
     }
 
+    /* 已有本地快照時不阻塞，get/accepted 由主循環的 process loop 在背景對帳 */
+    if (g_shadow_context.snapshot_loaded && !g_shadow_context.get_received) {
+        DMS_LOG_SHADOW("📂 Using Shadow snapshot (version %u), reconciling in background",
+                       g_shadow_context.document_version);
+        return DMS_SUCCESS;
+    }
+
     uint32_t start_time = (uint32_t)time(NULL);
     uint32_t current_time;
     uint32_t elapsed_seconds = 0;
@@ -259,7 +353,6 @@ dms_result_t dms_shadow_update_reported(const shadow_reported_state_t* state)
         return DMS_ERROR_INVALID_PARAMETER;  // 使用正確的錯誤碼
     }
 
-    char payload[512];
     const shadow_reported_state_t* update_state;
 
     /* 如果沒有提供狀態，則更新並使用內部狀態 */
@@ -270,38 +363,59 @@ dms_result_t dms_shadow_update_reported(const shadow_reported_state_t* state)
         update_state = state;
     }
 
-    /* 準備 Shadow JSON 訊息 - 與原始程式碼格式完全相同 */
-    snprintf(payload, sizeof(payload),
-             SHADOW_REPORTED_JSON_TEMPLATE,
-             update_state->connected ? "true" : "false",
-             update_state->status,
-             update_state->uptime,
-             update_state->lastHeartbeat,
-             update_state->firmwareVersion,
-             update_state->deviceType,
-             update_state->cpuUsage,
-             update_state->memoryUsage,
-             update_state->networkBytesSent,
-             update_state->networkBytesReceived);
-
-    DMS_LOG_SHADOW("📤 Publishing Shadow update...");
-    DMS_LOG_DEBUG("Payload: %s", payload);
+    /* 放入合併批次 - 視窗內多次更新只保留最新狀態 */
+    shadow_write_batch_t* batch = begin_batch_write();
+    batch->reported = *update_state;
+    batch->has_reported = true;
 
-    /* 發布訊息 - 與原始程式碼邏輯完全相同 */
-    dms_result_t result = g_shadow_context.mqtt_interface.publish(
-        SHADOW_UPDATE_TOPIC,
-        payload,
-        strlen(payload)
-    );
+    DMS_LOG_DEBUG("📤 Shadow reported state queued for next update");
+    return DMS_SUCCESS;
+}
 
-    if (result != DMS_SUCCESS) {
-        DMS_LOG_ERROR("❌ Failed to publish Shadow update");
-        return result;
+/**
+ * @brief 處理合併寫入批次
+ */
+dms_result_t dms_shadow_process(void)
+{
+    if (!g_shadow_context.initialized) {
+        return DMS_ERROR_INVALID_PARAMETER;
     }
 
-    g_shadow_context.last_update_time = (uint32_t)time(NULL);
-    DMS_LOG_SHADOW("✅ Shadow update published successfully");
-    return DMS_SUCCESS;
+    return publish_pending_batch(false);
+}
+
+/**
+ * @brief 立即發布合併寫入批次
+ */
+dms_result_t dms_shadow_flush(void)
+{
+    if (!g_shadow_context.initialized) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    return publish_pending_batch(true);
+}
+
+/**
+ * @brief 獲取 Shadow 寫入統計資訊
+ */
+void dms_shadow_get_write_stats(shadow_write_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    *stats = g_shadow_context.write_stats;
+    stats->current_backoff_ms = g_shadow_context.throttle_backoff_ms;
+}
+
+/**
+ * @brief 要求下一次 reported 更新送出完整狀態
+ */
+void dms_shadow_request_full_resync(void)
+{
+    g_shadow_context.acked_valid = false;
+    g_shadow_context.pending_token = 0;
 }
 
 /**
@@ -311,39 +425,35 @@ dms_result_t dms_shadow_update_reported(const shadow_reported_state_t* state)
  */
 dms_result_t dms_shadow_reset_desired(const char* key)
 {
-    if (!g_shadow_context.initialized || key == NULL) {
+    if (!g_shadow_context.initialized || key == NULL ||
+        strlen(key) >= SHADOW_COMMAND_KEY_MAX_LENGTH) {
         return DMS_ERROR_INVALID_PARAMETER;
     }
 
-    char payload[256];
-
-    /* 準備重設 JSON 訊息 - 與原始程式碼格式完全相同 */
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"state\": {"
-             "\"desired\": {"
-             "\"%s\": null"
-             "}"
-             "}"
-             "}",
-             key);
-
-    DMS_LOG_DEBUG("🔄 Resetting desired state for key: %s", key);
-    DMS_LOG_DEBUG("Reset payload: %s", payload);
+    shadow_write_batch_t* batch = &g_shadow_context.pending_batch;
 
-    /* 發布重設訊息 - 與原始程式碼邏輯完全相同 */
-    dms_result_t result = g_shadow_context.mqtt_interface.publish(
-        SHADOW_UPDATE_TOPIC,
-        payload,
-        strlen(payload)
-    );
+    /* 同一批次中相同的鍵只需重設一次 */
+    for (uint32_t i = 0; i < batch->desired_reset_count; i++) {
+        if (strcmp(batch->desired_resets[i], key) == 0) {
+            return DMS_SUCCESS;
+        }
+    }
 
-    if (result != DMS_SUCCESS) {
-        DMS_LOG_ERROR("❌ Failed to reset desired state for key: %s", key);
-        return result;
+    /* 批次已滿時先發布，節流中無法發布則回報失敗 */
+    if (batch->desired_reset_count >= SHADOW_COALESCE_MAX_ITEMS) {
+        dms_result_t result = dms_shadow_flush();
+        if (result != DMS_SUCCESS || batch->desired_reset_count >= SHADOW_COALESCE_MAX_ITEMS) {
+            DMS_LOG_ERROR("❌ Failed to reset desired state for key: %s (write batch full)", key);
+            return (result != DMS_SUCCESS) ? result : DMS_ERROR_SHADOW_FAILURE;
+        }
     }
 
-    DMS_LOG_DEBUG("✅ Desired state reset successfully for key: %s", key);
+    begin_batch_write();
+    SAFE_STRNCPY(batch->desired_resets[batch->desired_reset_count], key,
+                 SHADOW_COMMAND_KEY_MAX_LENGTH);
+    batch->desired_reset_count++;
+
+    DMS_LOG_DEBUG("🔄 Desired state reset queued for key: %s", key);
     return DMS_SUCCESS;
 }
 
@@ -354,41 +464,40 @@ dms_result_t dms_shadow_reset_desired(const char* key)
  */
 dms_result_t dms_shadow_report_command_result(const char* command_key, bool result)
 {
-    if (!g_shadow_context.initialized || command_key == NULL) {
+    if (!g_shadow_context.initialized || command_key == NULL ||
+        strlen(command_key) >= SHADOW_COMMAND_KEY_MAX_LENGTH) {
         return DMS_ERROR_INVALID_PARAMETER;
     }
 
-    char payload[256];
+    shadow_write_batch_t* batch = &g_shadow_context.pending_batch;
     const char* result_str = result ? "success" : "failed";
+    shadow_command_result_t* entry = NULL;
 
-    /* 準備結果報告 JSON 訊息 - 與原始程式碼格式完全相同 */
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"state\": {"
-             "\"reported\": {"
-             "\"%s_result\": \"%s\","
-             "\"%s_timestamp\": %u"
-             "}"
-             "}"
-             "}",
-             command_key, result_str,
-             command_key, (uint32_t)time(NULL));
-
-    DMS_LOG_DEBUG("📊 Reporting command result: %s = %s", command_key, result_str);
-
-    /* 發布結果報告 - 與原始程式碼邏輯完全相同 */
-    dms_result_t publish_result = g_shadow_context.mqtt_interface.publish(
-        SHADOW_UPDATE_TOPIC,
-        payload,
-        strlen(payload)
-    );
+    /* 同一批次中相同命令只保留最新結果 */
+    for (uint32_t i = 0; i < batch->result_count; i++) {
+        if (strcmp(batch->results[i].key, command_key) == 0) {
+            entry = &batch->results[i];
+            break;
+        }
+    }
 
-    if (publish_result != DMS_SUCCESS) {
-        DMS_LOG_ERROR("❌ Failed to report command result for: %s", command_key);
-        return publish_result;
+    if (entry == NULL) {
+        if (batch->result_count >= SHADOW_COALESCE_MAX_ITEMS) {
+            dms_result_t flush_result = dms_shadow_flush();
+            if (flush_result != DMS_SUCCESS || batch->result_count >= SHADOW_COALESCE_MAX_ITEMS) {
+                DMS_LOG_ERROR("❌ Failed to report command result for: %s (write batch full)", command_key);
+                return (flush_result != DMS_SUCCESS) ? flush_result : DMS_ERROR_SHADOW_FAILURE;
+            }
+        }
+        entry = &batch->results[batch->result_count++];
+        SAFE_STRNCPY(entry->key, command_key, sizeof(entry->key));
     }
 
-    DMS_LOG_DEBUG("✅ Command result reported successfully: %s = %s", command_key, result_str);
+    begin_batch_write();
+    entry->success = result;
+    entry->timestamp = (uint32_t)time(NULL);
+
+    DMS_LOG_DEBUG("📊 Command result queued: %s = %s", command_key, result_str);
     return DMS_SUCCESS;
 }
 
@@ -417,6 +526,22 @@ const device_bind_info_t* dms_shadow_get_bind_info(void)
     return &g_shadow_context.bind_info;
 }
 
+/**
+ * @brief 檢查綁定資訊是否已由 AWS 的 Shadow 文件確認
+ */
+bool dms_shadow_is_bind_info_confirmed(void)
+{
+    return g_shadow_context.bind_info_confirmed;
+}
+
+/**
+ * @brief 獲取綁定資訊對應的 Shadow 文件版本
+ */
+uint32_t dms_shadow_get_document_version(void)
+{
+    return g_shadow_context.document_version;
+}
+
 /**
  * @brief 獲取當前報告狀態
  */
@@ -446,6 +571,21 @@ void dms_shadow_update_system_stats(void)
  */
 void dms_shadow_cleanup(void)
 {
+    /* 送出待重送與尚未發布的寫入，不等待節流退避與 accepted，避免遺失命令結果 */
+    if (g_shadow_context.initialized &&
+        g_shadow_context.mqtt_interface.is_connected != NULL &&
+        g_shadow_context.mqtt_interface.is_connected()) {
+        uint32_t now_ms = Clock_GetTimeMs();
+        if (g_shadow_context.pending_token == 0 && !is_batch_empty(&g_shadow_context.inflight_batch)) {
+            send_batch(&g_shadow_context.inflight_batch, now_ms);
+        }
+        if (!is_batch_empty(&g_shadow_context.pending_batch)) {
+            send_batch(&g_shadow_context.pending_batch, now_ms);
+        }
+    }
+
+    dms_shadow_mirror_cleanup();
+    dms_sysstat_cleanup();
     memset(&g_shadow_context, 0, sizeof(g_shadow_context));
     DMS_LOG_INFO("✅ Shadow module cleaned up");
 }
@@ -481,19 +621,78 @@ static void shadow_message_handler(const char* topic, const char* payload, size_
     DMS_LOG_DEBUG("   get/accepted: %s", isGetAccepted ? "✅ MATCH" : "❌ no match");
     DMS_LOG_DEBUG("   get/rejected: %s", isGetRejected ? "✅ MATCH" : "❌ no match");
 
+    /* 每則訊息只掃描一次：鏡像與各欄位查詢共用同一份索引 */
+    static dms_json_token_t tokens[SHADOW_DOCUMENT_MAX_TOKENS];
+    dms_json_index_t index;
+    dms_result_t indexResult = dms_json_index_build(&index, payload, payload_length,
+                                                    tokens, SHADOW_DOCUMENT_MAX_TOKENS);
+    bool indexed = (indexResult == DMS_SUCCESS);
+    if (!indexed) {
+        DMS_LOG_WARN("⚠️ Unable to index Shadow message (%d)", indexResult);
+    }
+
     /* 處理不同類型的 Shadow 訊息 - 與原始程式碼邏輯完全相同 */
     if (isUpdateAccepted) {
         DMS_LOG_SHADOW("🔄 Shadow update accepted");
+
+        /* 套用到文件鏡像 */
+        if (indexed) {
+            dms_shadow_mirror_apply_index(SHADOW_MIRROR_DOC_UPDATE, &index);
+        }
+
+        /* 我們送出的更新被接受，reported 狀態成為下一次差異的基準 */
+        uint32_t token = indexed ? parse_client_token(&index) :
+                                   scan_client_token(payload, payload_length);
+        if (token != 0 && token == g_shadow_context.pending_token) {
+            if (g_shadow_context.inflight_batch.has_reported) {
+                g_shadow_context.acked_state = g_shadow_context.inflight_batch.reported;
+                g_shadow_context.acked_valid = true;
+            }
+            memset(&g_shadow_context.inflight_batch, 0, sizeof(g_shadow_context.inflight_batch));
+            g_shadow_context.pending_token = 0;
+            g_shadow_context.throttle_backoff_ms = 0;
+        }
     }
     else if (isUpdateRejected) {
-        DMS_LOG_ERROR("❌ Shadow update rejected");
+        int code = indexed ? parse_reject_code(&index) : 0;
+        uint32_t token = indexed ? parse_client_token(&index) :
+                                   scan_client_token(payload, payload_length);
+
+        DMS_LOG_ERROR("❌ Shadow update rejected (code: %d)", code);
+
+        /* 429 節流與 5xx 暫時性錯誤：保留批次，退避後重新發布；其他錯誤重送也不會成功 */
+        if (code == SHADOW_REJECT_CODE_THROTTLED) {
+            apply_throttle_backoff();
+        }
+        if (token != 0 && token == g_shadow_context.pending_token) {
+            if (code == SHADOW_REJECT_CODE_THROTTLED || code >= SHADOW_REJECT_CODE_SERVER_ERROR) {
+                DMS_LOG_WARN("⚠️ Shadow update %u will be republished", token);
+            } else {
+                DMS_LOG_WARN("⚠️ Dropping rejected Shadow update %u", token);
+                memset(&g_shadow_context.inflight_batch, 0, sizeof(g_shadow_context.inflight_batch));
+            }
+            g_shadow_context.pending_token = 0;
+        }
+
+        /* AWS 端狀態不確定，下一次改送完整狀態 */
+        if (token != 0) {
+            DMS_LOG_WARN("⚠️ Reported update %u rejected, scheduling full resync", token);
+            g_shadow_context.acked_valid = false;
+        }
     }
  
     else if (isUpdateDelta) {
     	DMS_LOG_SHADOW("🔃 Shadow delta received - processing command directly...");
 
-    	/* 🔥 新方式：直接調用命令處理模組 */
-    	dms_result_t cmd_result = dms_command_process_shadow_delta(topic, payload, payload_length);
+    	/* 套用到文件鏡像，讓其他模組可直接查詢最新的 desired 值 */
+    	if (indexed) {
+    	    dms_shadow_mirror_apply_index(SHADOW_MIRROR_DOC_DELTA, &index);
+    	}
+
+    	/* 🔥 新方式：直接調用命令處理模組，沿用同一份索引 */
+    	dms_result_t cmd_result = indexed ?
+    	    dms_command_process_shadow_delta_index(topic, &index) :
+    	    dms_command_process_shadow_delta(topic, payload, payload_length);
     
     	if (cmd_result == DMS_SUCCESS) {
         	DMS_LOG_SHADOW("✅ Shadow delta command processed successfully");
@@ -506,12 +705,12 @@ static void shadow_message_handler(const char* topic, const char* payload, size_
     else if (isGetAccepted) {
         DMS_LOG_SHADOW("✅ Shadow get accepted - processing device binding info");
 
-        /* 解析 Shadow 文檔並檢查綁定狀態 - 與原始程式碼邏輯完全相同 */
-        dms_result_t parseResult = parse_device_bind_info(
-            payload,
-            payload_length,
-            &g_shadow_context.bind_info
-        );
+        /* 與本地快照對帳，更新綁定資訊，綁定資訊變更時才寫回快照 */
+        if (indexed) {
+            reconcile_shadow_document(payload, payload_length, &index);
+        }
+        dms_result_t parseResult = g_shadow_context.bind_info_confirmed ?
+                                   DMS_SUCCESS : DMS_ERROR_SHADOW_FAILURE;
 
         if (parseResult == DMS_SUCCESS) {
             if (is_device_bound(&g_shadow_context.bind_info)) {
@@ -551,111 +750,51 @@ static void shadow_message_handler(const char* topic, const char* payload, size_
 }
 
 /**
- * @brief 解析設備綁定資訊
+ * @brief 從 Shadow 鏡像讀取設備綁定資訊
  *
- * 這個函數完全複製原始的 parseDeviceBindInfo() 邏輯
+ * 取代原始 parseDeviceBindInfo() 對 state.reported.info 的逐層搜尋
+ * 欄位規則與原始程式碼相同：超過緩衝區長度的欄位視為空值
  */
-static dms_result_t parse_device_bind_info(const char* payload, size_t payload_length, device_bind_info_t* bind_info)
+static void read_bind_info_from_mirror(device_bind_info_t* bind_info)
 {
-    if (payload == NULL || bind_info == NULL || payload_length == 0) {
-        return DMS_ERROR_INVALID_PARAMETER;
-    }
-
-    /* 初始化綁定資訊 */
     memset(bind_info, 0, sizeof(device_bind_info_t));
-    bind_info->bound = false;
-
-    /* 驗證 JSON 格式 - 與原始程式碼相同 */
-    JSONStatus_t jsonResult = JSON_Validate(payload, payload_length);
-    if (jsonResult != JSONSuccess) {
-        DMS_LOG_ERROR("❌ Invalid JSON format in bind info. Error: %d", jsonResult);
-        return DMS_ERROR_SHADOW_FAILURE;
-    }
-
-    DMS_LOG_DEBUG("📋 Parsing device bind info JSON...");
-
-    /* 尋找 state.reported.info 路徑 - 與原始程式碼邏輯完全相同 */
-    char* valueStart;
-    size_t valueLength;
-
-    /* 查找 "state" */
-    jsonResult = JSON_Search((char*)payload, payload_length, "state", 5, &valueStart, &valueLength);
-    if (jsonResult != JSONSuccess) {
-        DMS_LOG_DEBUG("No 'state' found in JSON, device not bound");
-        return DMS_SUCCESS;  /* 不算錯誤，只是沒有綁定資訊 */
-    }
-
-    /* 在 state 中查找 "reported" */
-    jsonResult = JSON_Search(valueStart, valueLength, "reported", 8, &valueStart, &valueLength);
-    if (jsonResult != JSONSuccess) {
-        DMS_LOG_DEBUG("No 'reported' found in state, device not bound");
-        return DMS_SUCCESS;
-    }
-
-    /* 在 reported 中查找 "info" */
-    jsonResult = JSON_Search(valueStart, valueLength, "info", 4, &valueStart, &valueLength);
-    if (jsonResult != JSONSuccess) {
-        DMS_LOG_DEBUG("No 'info' found in reported, device not bound");
-        return DMS_SUCCESS;
-    }
 
-    /* 解析 info 中的各個欄位 - 與原始程式碼邏輯完全相同 */
-    char* fieldStart;
-    size_t fieldLength;
-
-    /* 解析 company_name */
-    jsonResult = JSON_Search(valueStart, valueLength, "company_name", 12, &fieldStart, &fieldLength);
-    if (jsonResult == JSONSuccess && fieldLength > 0 && fieldLength < sizeof(bind_info->companyName)) {
-        /* 移除引號並複製 */
-        if (fieldStart[0] == '"' && fieldStart[fieldLength-1] == '"') {
-            fieldStart++;
-            fieldLength -= 2;
-        }
-        strncpy(bind_info->companyName, fieldStart, fieldLength);
-        bind_info->companyName[fieldLength] = '\0';
-    }
-
-    /* 解析 added_by */
-    jsonResult = JSON_Search(valueStart, valueLength, "added_by", 8, &fieldStart, &fieldLength);
-    if (jsonResult == JSONSuccess && fieldLength > 0 && fieldLength < sizeof(bind_info->addedBy)) {
-        if (fieldStart[0] == '"' && fieldStart[fieldLength-1] == '"') {
-            fieldStart++;
-            fieldLength -= 2;
-        }
-        strncpy(bind_info->addedBy, fieldStart, fieldLength);
-        bind_info->addedBy[fieldLength] = '\0';
-    }
-
-    /* 解析 device_name */
-    jsonResult = JSON_Search(valueStart, valueLength, "device_name", 11, &fieldStart, &fieldLength);
-    if (jsonResult == JSONSuccess && fieldLength > 0 && fieldLength < sizeof(bind_info->deviceName)) {
-        if (fieldStart[0] == '"' && fieldStart[fieldLength-1] == '"') {
-            fieldStart++;
-            fieldLength -= 2;
-        }
-        strncpy(bind_info->deviceName, fieldStart, fieldLength);
-        bind_info->deviceName[fieldLength] = '\0';
-    }
-
-    /* 解析 company_id */
-    jsonResult = JSON_Search(valueStart, valueLength, "company_id", 10, &fieldStart, &fieldLength);
-    if (jsonResult == JSONSuccess && fieldLength > 0 && fieldLength < sizeof(bind_info->companyId)) {
-        if (fieldStart[0] == '"' && fieldStart[fieldLength-1] == '"') {
-            fieldStart++;
-            fieldLength -= 2;
-        }
-        strncpy(bind_info->companyId, fieldStart, fieldLength);
-        bind_info->companyId[fieldLength] = '\0';
-    }
+    dms_shadow_mirror_get_string(SHADOW_BIND_INFO_PATH ".company_name",
+                                 bind_info->companyName, sizeof(bind_info->companyName));
+    dms_shadow_mirror_get_string(SHADOW_BIND_INFO_PATH ".added_by",
+                                 bind_info->addedBy, sizeof(bind_info->addedBy));
+    dms_shadow_mirror_get_string(SHADOW_BIND_INFO_PATH ".device_name",
+                                 bind_info->deviceName, sizeof(bind_info->deviceName));
+    dms_shadow_mirror_get_string(SHADOW_BIND_INFO_PATH ".company_id",
+                                 bind_info->companyId, sizeof(bind_info->companyId));
 
     /* 檢查是否所有必要欄位都存在 */
     bind_info->bound = (strlen(bind_info->companyName) > 0 &&
                        strlen(bind_info->companyId) > 0 &&
                        strlen(bind_info->deviceName) > 0 &&
                        strlen(bind_info->addedBy) > 0);
+}
 
-    DMS_LOG_DEBUG("📋 Bind info parsing completed: bound=%s", bind_info->bound ? "true" : "false");
-    return DMS_SUCCESS;
+/**
+ * @brief 綁定資訊路徑變更時更新綁定資訊
+ *
+ * get/accepted 與 update/accepted 都可能改變 reported.info
+ */
+static void on_bind_info_changed(const char* path, shadow_value_type_t type, const char* value)
+{
+    /* 綁定資訊由多個欄位組成，整組從鏡像重新讀取 */
+    (void)path;
+    (void)type;
+    (void)value;
+
+    bool was_bound = is_device_bound(&g_shadow_context.bind_info);
+
+    read_bind_info_from_mirror(&g_shadow_context.bind_info);
+
+    if (was_bound != is_device_bound(&g_shadow_context.bind_info)) {
+        DMS_LOG_INFO("🔗 Device bind state changed: %s",
+                     was_bound ? "bound -> unbound" : "unbound -> bound");
+    }
 }
 
 /**
@@ -704,36 +843,578 @@ static void update_system_stats(shadow_reported_state_t* state)
     strncpy(state->status, "online", sizeof(state->status) - 1);
     state->status[sizeof(state->status) - 1] = '\0';
 
-    state->uptime = get_system_uptime();
     state->lastHeartbeat = (uint32_t)time(NULL);
 
-    /* 獲取系統資訊 - 與原始程式碼邏輯完全相同 */
+    /* 從 /proc 取樣 CPU、記憶體、網路與運行時間，CPU 為與上次取樣（心跳或遙測）間的使用率 */
+    dms_sysstat_sample_t sample;
+    if (dms_sysstat_sample(&sample) == DMS_SUCCESS) {
+        state->uptime = sample.uptime_seconds;
+        state->cpuUsage = sample.cpu_usage;
+        state->memoryUsage = sample.memory_usage;
+        state->networkBytesSent = sample.net_tx_bytes;
+        state->networkBytesReceived = sample.net_rx_bytes;
+        return;
+    }
+
+    /* 取樣器無法使用時退回原始的 sysinfo() 邏輯 */
     if (sysinfo(&info) == 0) {
-        /* CPU 使用率 (簡化版本) */
-        state->cpuUsage = 0.0; // TODO: 實現真實的 CPU 使用率計算
+        state->uptime = (uint32_t)info.uptime;
+        state->cpuUsage = 0.0;
 
         /* 記憶體使用率 */
         if (info.totalram > 0) {
             state->memoryUsage = (float)(info.totalram - info.freeram) / info.totalram * 100.0;
         }
     }
-
-    /* 網路統計 (簡化版本) - 與原始程式碼相同 */
-    state->networkBytesSent = 0;    // TODO: 從 /proc/net/dev 讀取
+    state->networkBytesSent = 0;
     state->networkBytesReceived = 0;
 }
 
 /**
- * @brief 獲取系統運行時間
+ * @brief 從本地快照載入 Shadow 文件並解析綁定資訊
  *
- * 這個函數完全複製原始的 getSystemUptime() 邏輯
+ * 快照不存在或無法解析時維持空的綁定資訊，等待 get/accepted
  */
-static uint32_t get_system_uptime(void)
+static void load_shadow_snapshot(void)
 {
-    struct sysinfo info;
-    if (sysinfo(&info) == 0) {
-        return (uint32_t)info.uptime;
+    FILE* fp = fopen(SHADOW_SNAPSHOT_FILE, "r");
+    if (fp == NULL) {
+        DMS_LOG_DEBUG("No Shadow snapshot, waiting for Shadow Get");
+        return;
+    }
+
+    char* buffer = malloc(SHADOW_SNAPSHOT_MAX_SIZE);
+    if (buffer == NULL) {
+        fclose(fp);
+        return;
+    }
+
+    size_t length = fread(buffer, 1, SHADOW_SNAPSHOT_MAX_SIZE, fp);
+    fclose(fp);
+
+    if (length == 0 || length >= SHADOW_SNAPSHOT_MAX_SIZE) {
+        DMS_LOG_WARN("⚠️ Ignoring invalid Shadow snapshot (%zu bytes)", length);
+        free(buffer);
+        return;
+    }
+
+    if (dms_shadow_mirror_apply(SHADOW_MIRROR_DOC_FULL, buffer, length) == DMS_SUCCESS) {
+        read_bind_info_from_mirror(&g_shadow_context.bind_info);
+        g_shadow_context.document_version = dms_shadow_mirror_get_version();
+        g_shadow_context.snapshot_loaded = true;
+        DMS_LOG_SHADOW("📂 Shadow snapshot loaded (version %u, bound: %s)",
+                       g_shadow_context.document_version,
+                       is_device_bound(&g_shadow_context.bind_info) ? "yes" : "no");
+    } else {
+        DMS_LOG_WARN("⚠️ Failed to parse Shadow snapshot, waiting for Shadow Get");
+    }
+
+    free(buffer);
+}
+
+/**
+ * @brief 將 get/accepted 的完整文件寫入本地快照
+ *
+ * 先寫暫存檔再 rename，避免斷電時留下不完整的檔案
+ */
+static void save_shadow_snapshot(const char* payload, size_t payload_length)
+{
+    const char* tmp_path = SHADOW_SNAPSHOT_FILE ".tmp";
+
+    if (payload_length >= SHADOW_SNAPSHOT_MAX_SIZE) {
+        DMS_LOG_WARN("⚠️ Shadow document too large for snapshot (%zu bytes)", payload_length);
+        return;
+    }
+
+    FILE* fp = fopen(tmp_path, "w");
+    if (fp == NULL) {
+        DMS_LOG_WARN("⚠️ Failed to open Shadow snapshot for writing");
+        return;
+    }
+
+    size_t written = fwrite(payload, 1, payload_length, fp);
+    fflush(fp);
+    fsync(fileno(fp));
+    fclose(fp);
+
+    if (written != payload_length || rename(tmp_path, SHADOW_SNAPSHOT_FILE) != 0) {
+        DMS_LOG_WARN("⚠️ Failed to commit Shadow snapshot");
+        unlink(tmp_path);
+        return;
+    }
+
+    DMS_LOG_DEBUG("💾 Shadow snapshot saved (%zu bytes)", payload_length);
+}
+
+/**
+ * @brief 以 get/accepted 的文件與目前綁定資訊對帳
+ *
+ * 快照只用於重啟後還原綁定資訊。每次回報都會讓文件版本增加，
+ * 因此只有綁定資訊與快照不同時才重寫快照，以減少 flash 寫入
+ */
+static void reconcile_shadow_document(const char* payload, size_t payload_length,
+                                      const dms_json_index_t* index)
+{
+    device_bind_info_t previous = g_shadow_context.bind_info;
+
+    /* 完整文件取代鏡像，綁定資訊的變更由 on_bind_info_changed() 套用 */
+    if (dms_shadow_mirror_apply_index(SHADOW_MIRROR_DOC_FULL, index) != DMS_SUCCESS) {
+        return;  /* 保留快照中的綁定資訊 */
+    }
+
+    uint32_t version = dms_shadow_mirror_get_version();
+    read_bind_info_from_mirror(&g_shadow_context.bind_info);
+    g_shadow_context.bind_info_confirmed = true;
+
+    if (version > g_shadow_context.document_version) {
+        g_shadow_context.document_version = version;
+    }
+
+    if (g_shadow_context.snapshot_loaded &&
+        memcmp(&previous, &g_shadow_context.bind_info, sizeof(previous)) == 0) {
+        DMS_LOG_SHADOW("✅ Shadow snapshot is up to date (version %u)", version);
+        return;
+    }
+
+    g_shadow_context.document_version = version;
+    save_shadow_snapshot(payload, payload_length);
+    g_shadow_context.snapshot_loaded = true;
+}
+
+/**
+ * @brief 發布合併寫入批次
+ *
+ * 一次只有一份更新等待 accepted；被節流拒絕或等待逾時的批次先重送，保持寫入順序。
+ * 依序檢查合併視窗、節流退避與最小發布間隔，條件不符時保留批次待下次處理
+ *
+ * @param ignore_window 是否忽略合併視窗（批次已滿時）
+ * @return DMS_SUCCESS 成功（包含延後發布），其他為錯誤碼
+ */
+static dms_result_t publish_pending_batch(bool ignore_window)
+{
+    shadow_write_batch_t* batch = &g_shadow_context.pending_batch;
+    uint32_t now_ms = Clock_GetTimeMs();
+
+    if (g_shadow_context.pending_token != 0) {
+        if ((now_ms - g_shadow_context.inflight_sent_ms) < SHADOW_UPDATE_ACK_TIMEOUT_MS) {
+            return DMS_SUCCESS;
+        }
+        DMS_LOG_WARN("⚠️ No response for Shadow update %u, republishing",
+                     g_shadow_context.pending_token);
+        dms_shadow_request_full_resync();
+    }
+
+    if (!is_batch_empty(&g_shadow_context.inflight_batch)) {
+        batch = &g_shadow_context.inflight_batch;
+    } else if (is_batch_empty(batch) ||
+               (!ignore_window && (now_ms - batch->first_queued_ms) < SHADOW_COALESCE_WINDOW_MS)) {
+        return DMS_SUCCESS;
+    }
+
+    if (g_shadow_context.throttle_backoff_ms != 0 &&
+        (int32_t)(now_ms - g_shadow_context.throttle_until_ms) < 0) {
+        return DMS_SUCCESS;
+    }
+
+    if (g_shadow_context.write_stats.updates_published > 0 &&
+        (now_ms - g_shadow_context.last_publish_ms) < SHADOW_UPDATE_MIN_INTERVAL_MS) {
+        return DMS_SUCCESS;
+    }
+
+    if (g_shadow_context.mqtt_interface.is_connected != NULL &&
+        !g_shadow_context.mqtt_interface.is_connected()) {
+        return DMS_SUCCESS;  /* 斷線期間保留批次，重連後發布 */
+    }
+
+    return send_batch(batch, now_ms);
+}
+
+/**
+ * @brief 組出並發布一個批次，成功後該批次成為等待 accepted 的 inflight 批次
+ *
+ * @param batch 待發布批次或待重送的 inflight 批次
+ * @param now_ms 發布時間
+ * @return DMS_SUCCESS 成功（包含無變更而略過），其他為錯誤碼
+ */
+static dms_result_t send_batch(shadow_write_batch_t* batch, uint32_t now_ms)
+{
+    /* 準備 Shadow JSON 訊息 - 有已確認的基準時只送出變更欄位 */
+    char payload[SHADOW_UPDATE_PAYLOAD_SIZE];
+    const shadow_reported_state_t* base =
+        g_shadow_context.acked_valid ? &g_shadow_context.acked_state : NULL;
+    uint32_t token = g_shadow_context.next_token;
+
+    int entry_count = build_update_document(batch, base, token, payload, sizeof(payload));
+    if (entry_count < 0) {
+        DMS_LOG_ERROR("❌ Shadow update payload exceeds buffer size, dropping batch");
+        memset(batch, 0, sizeof(*batch));
+        return DMS_ERROR_SHADOW_FAILURE;
+    }
+
+    if (entry_count == 0) {
+        DMS_LOG_DEBUG("Shadow reported state unchanged, update skipped");
+        memset(batch, 0, sizeof(*batch));
+        return DMS_SUCCESS;
+    }
+
+    DMS_LOG_SHADOW("📤 Publishing Shadow update (%d entries, %u resets, %u results, %s)...",
+                   entry_count, batch->desired_reset_count, batch->result_count,
+                   !batch->has_reported ? "no state" : (base != NULL ? "patch" : "full"));
+    DMS_LOG_DEBUG("Payload: %s", payload);
+
+    /* 發布訊息 - 與原始程式碼邏輯完全相同 */
+    dms_result_t result = g_shadow_context.mqtt_interface.publish(
+        SHADOW_UPDATE_TOPIC,
+        payload,
+        strlen(payload)
+    );
+
+    if (result != DMS_SUCCESS) {
+        DMS_LOG_ERROR("❌ Failed to publish Shadow update");
+        return result;  /* 保留批次，下次重試 */
+    }
+
+    /* 等待 update/accepted 後 reported 狀態才成為新的差異基準 */
+    if (batch->has_reported) {
+        if (base != NULL) {
+            g_shadow_context.write_stats.patch_updates++;
+        } else {
+            g_shadow_context.write_stats.full_updates++;
+        }
+    }
+    if (batch != &g_shadow_context.inflight_batch) {
+        g_shadow_context.inflight_batch = *batch;
+        memset(batch, 0, sizeof(*batch));
+    }
+
+    g_shadow_context.pending_token = token;
+    g_shadow_context.inflight_sent_ms = now_ms;
+    g_shadow_context.next_token = (token == UINT32_MAX) ? 1 : token + 1;
+    g_shadow_context.last_publish_ms = now_ms;
+    g_shadow_context.write_stats.updates_published++;
+
+    g_shadow_context.last_update_time = (uint32_t)time(NULL);
+    DMS_LOG_SHADOW("✅ Shadow update published successfully");
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 記錄一次寫入並返回合併批次，批次為空時開始新的合併視窗
+ */
+static shadow_write_batch_t* begin_batch_write(void)
+{
+    shadow_write_batch_t* batch = &g_shadow_context.pending_batch;
+
+    if (is_batch_empty(batch)) {
+        batch->first_queued_ms = Clock_GetTimeMs();
+    }
+    g_shadow_context.write_stats.writes_queued++;
+
+    return batch;
+}
+
+/**
+ * @brief 檢查批次是否沒有任何寫入
+ */
+static bool is_batch_empty(const shadow_write_batch_t* batch)
+{
+    return !batch->has_reported &&
+           batch->desired_reset_count == 0 &&
+           batch->result_count == 0;
+}
+
+/**
+ * @brief 收到 429 節流時加倍退避時間
+ */
+static void apply_throttle_backoff(void)
+{
+    uint32_t backoff_ms = (g_shadow_context.throttle_backoff_ms == 0) ?
+                          SHADOW_THROTTLE_BACKOFF_BASE_MS :
+                          g_shadow_context.throttle_backoff_ms * 2;
+    if (backoff_ms > SHADOW_THROTTLE_BACKOFF_MAX_MS) {
+        backoff_ms = SHADOW_THROTTLE_BACKOFF_MAX_MS;
+    }
+
+    g_shadow_context.throttle_backoff_ms = backoff_ms;
+    g_shadow_context.throttle_until_ms = Clock_GetTimeMs() + backoff_ms;
+    g_shadow_context.write_stats.throttled_count++;
+
+    DMS_LOG_WARN("⚠️ Shadow update throttled by AWS IoT, backing off %u ms", backoff_ms);
+}
+
+/**
+ * @brief 組出合併的 shadow/update JSON
+ *
+ * desired 區段放入要重設為 null 的鍵；reported 區段放入狀態欄位與命令結果
+ * base 為 NULL 時輸出所有狀態欄位，否則只輸出格式化後與 base 不同的欄位
+ * 附帶 clientToken，用來對應 update/accepted 與 update/rejected
+ *
+ * @return 輸出的項目數，緩衝區不足時返回 -1
+ */
+static int build_update_document(const shadow_write_batch_t* batch,
+                                 const shadow_reported_state_t* base,
+                                 uint32_t token, char* payload, size_t size)
+{
+    char value[80];
+    char base_value[80];
+    char key[SHADOW_COMMAND_KEY_MAX_LENGTH + 16];
+    char client_token[SHADOW_CLIENT_TOKEN_MAX_LENGTH];
+    int entry_count = 0;
+    bool reported_open = false;
+    dms_json_writer_t writer;
+
+    dms_json_writer_init(&writer, payload, size);
+    dms_json_begin_object(&writer);
+    dms_json_key(&writer, "state");
+    dms_json_begin_object(&writer);
+
+    if (batch->desired_reset_count > 0) {
+        dms_json_key(&writer, "desired");
+        dms_json_begin_object(&writer);
+        for (uint32_t i = 0; i < batch->desired_reset_count; i++) {
+            dms_json_kv_null(&writer, batch->desired_resets[i]);
+            entry_count++;
+        }
+        dms_json_end_object(&writer);
+    }
+
+    if (batch->has_reported) {
+        for (size_t i = 0; i < ARRAY_SIZE(g_reported_fields); i++) {
+            size_t length = render_reported_field(&g_reported_fields[i], &batch->reported,
+                                                  value, sizeof(value));
+
+            if (base != NULL) {
+                render_reported_field(&g_reported_fields[i], base, base_value, sizeof(base_value));
+                if (strcmp(value, base_value) == 0) {
+                    continue;
+                }
+            }
+
+            write_reported_key(&writer, g_reported_fields[i].name, &reported_open);
+            dms_json_raw(&writer, value, length);
+            entry_count++;
+        }
+    }
+
+    for (uint32_t i = 0; i < batch->result_count; i++) {
+        const shadow_command_result_t* result = &batch->results[i];
+
+        /* 命令結果格式與原始 reportCommandResult() 相同 */
+        snprintf(key, sizeof(key), "%s_result", result->key);
+        write_reported_key(&writer, key, &reported_open);
+        dms_json_string(&writer, result->success ? "success" : "failed");
+
+        snprintf(key, sizeof(key), "%s_timestamp", result->key);
+        dms_json_kv_uint(&writer, key, result->timestamp);
+        entry_count++;
+    }
+
+    if (entry_count == 0) {
+        return 0;
+    }
+
+    if (reported_open) {
+        dms_json_end_object(&writer);
+    }
+    dms_json_end_object(&writer);
+
+    snprintf(client_token, sizeof(client_token), SHADOW_CLIENT_TOKEN_PREFIX "%u", token);
+    dms_json_kv_string(&writer, "clientToken", client_token);
+    dms_json_end_object(&writer);
+
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        return -1;
+    }
+
+    return entry_count;
+}
+
+/**
+ * @brief 寫入 reported 成員的鍵
+ *
+ * reported 區段在第一個成員出現時才開啟
+ */
+static void write_reported_key(dms_json_writer_t* writer, const char* key, bool* reported_open)
+{
+    if (!*reported_open) {
+        dms_json_key(writer, "reported");
+        dms_json_begin_object(writer);
+        *reported_open = true;
+    }
+    dms_json_key(writer, key);
+}
+
+/**
+ * @brief 將單一 reported 欄位序列化到暫存緩衝區，供差異比對與原樣輸出
+ *
+ * @return 序列化後的長度，緩衝區不足時內容為空字串並返回 0
+ */
+static size_t render_reported_field(const reported_field_t* field,
+                                    const shadow_reported_state_t* state,
+                                    char* buffer, size_t size)
+{
+    dms_json_writer_t writer;
+
+    dms_json_writer_init(&writer, buffer, size);
+    field->write(&writer, state);
+    if (dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return dms_json_writer_length(&writer);
+}
+
+/**
+ * @brief 解析 update/accepted、update/rejected 中的 clientToken
+ *
+ * @return clientToken 序號，不是本模組送出的 token 時返回 0
+ */
+static uint32_t parse_client_token(const dms_json_index_t* index)
+{
+    const char* valueStart;
+    size_t valueLength;
+
+    if (!dms_json_index_value(index,
+                              dms_json_index_child(index, DMS_JSON_INDEX_ROOT, "clientToken", 11),
+                              &valueStart, &valueLength)) {
+        return 0;
+    }
+
+    return client_token_sequence(valueStart, valueLength);
+}
+
+/**
+ * @brief 無法建立索引時（例如文件超過 SHADOW_DOCUMENT_MAX_TOKENS）直接掃描 clientToken
+ *
+ * AWS 將 clientToken 放在文件頂層的最後，取最後一個 "clientToken": "..." 成員
+ *
+ * @return clientToken 序號，找不到或不是本模組送出的 token 時返回 0
+ */
+static uint32_t scan_client_token(const char* payload, size_t payload_length)
+{
+    static const char key[] = "\"clientToken\"";
+    const size_t key_length = sizeof(key) - 1;
+    uint32_t token = 0;
+
+    for (size_t p = 0; p + key_length <= payload_length; p++) {
+        if (payload[p] != '"' || memcmp(payload + p, key, key_length) != 0) {
+            continue;
+        }
+
+        size_t q = p + key_length;
+        while (q < payload_length && isspace((unsigned char)payload[q])) {
+            q++;
+        }
+        if (q >= payload_length || payload[q] != ':') {
+            continue;
+        }
+        q++;
+        while (q < payload_length && isspace((unsigned char)payload[q])) {
+            q++;
+        }
+        if (q >= payload_length || payload[q] != '"') {
+            continue;
+        }
+
+        const char* value = payload + q + 1;
+        const char* end = memchr(value, '"', payload_length - q - 1);
+        if (end != NULL) {
+            token = client_token_sequence(value, (size_t)(end - value));
+        }
+    }
+
+    return token;
+}
+
+/**
+ * @brief 由 clientToken 字串取出序號
+ *
+ * @return 序號，不是本模組的前綴時返回 0
+ */
+static uint32_t client_token_sequence(const char* value, size_t value_length)
+{
+    const size_t prefix_length = strlen(SHADOW_CLIENT_TOKEN_PREFIX);
+
+    if (value_length <= prefix_length || value_length >= SHADOW_CLIENT_TOKEN_MAX_LENGTH ||
+        strncmp(value, SHADOW_CLIENT_TOKEN_PREFIX, prefix_length) != 0) {
+        return 0;
     }
-    return 0;
+
+    char buffer[SHADOW_CLIENT_TOKEN_MAX_LENGTH];
+    memcpy(buffer, value + prefix_length, value_length - prefix_length);
+    buffer[value_length - prefix_length] = '\0';
+    return (uint32_t)strtoul(buffer, NULL, 10);
+}
+
+/**
+ * @brief 解析 update/rejected 中的錯誤碼
+ *
+ * @return 錯誤碼（例如 400、429），無法解析時返回 0
+ */
+static int parse_reject_code(const dms_json_index_t* index)
+{
+    uint64_t code;
+
+    if (!dms_json_index_get_uint(index,
+                                 dms_json_index_child(index, DMS_JSON_INDEX_ROOT, "code", 4),
+                                 &code) ||
+        code > INT32_MAX) {
+        return 0;
+    }
+
+    return (int)code;
+}
+
+/*-----------------------------------------------------------*/
+/* reported 欄位序列化 - 輸出格式與原始 reported 文件相同 */
+
+static void write_connected(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_bool(w, s->connected);
+}
+
+static void write_status(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_string(w, s->status);
+}
+
+static void write_uptime(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_uint(w, s->uptime);
+}
+
+static void write_timestamp(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_uint(w, s->lastHeartbeat);
+}
+
+static void write_firmware(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_string(w, s->firmwareVersion);
+}
+
+static void write_device_type(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_string(w, s->deviceType);
+}
+
+static void write_cpu_usage(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_double(w, s->cpuUsage, 2);
+}
+
+static void write_memory_usage(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_double(w, s->memoryUsage, 2);
+}
+
+static void write_network_sent(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_uint(w, s->networkBytesSent);
+}
+
+static void write_network_received(dms_json_writer_t* w, const shadow_reported_state_t* s)
+{
+    dms_json_uint(w, s->networkBytesReceived);
 }
 
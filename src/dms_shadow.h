@@ -11,7 +11,7 @@
  * - publishShadowUpdate()      → dms_shadow_update_reported()
  * - waitForShadowGetResponse() → dms_shadow_wait_get_response()
  * - parseShadowDelta()         → 將移到 dms_command 模組
- * - parseDeviceBindInfo()      → 內部函數
+ * - parseDeviceBindInfo()      → 內部函數（改由 dms_shadow_mirror 鏡像讀取）
  * - eventCallback() Shadow 處理部分 → shadow_message_handler()
  */
 
@@ -42,12 +42,19 @@
  * - SHADOW_GET_ACCEPTED_TOPIC
  * - SHADOW_GET_REJECTED_TOPIC
  * - SHADOW_GET_TIMEOUT_MS
- * - SHADOW_REPORTED_JSON_TEMPLATE
  */
 
 /* Shadow 模組專用常數 */
 #define SHADOW_MAX_TOPICS                  ( 5U )
 #define SHADOW_GET_REQUEST_PAYLOAD         "{}"
+#define SHADOW_CLIENT_TOKEN_PREFIX         "dms-rpt-"
+#define SHADOW_CLIENT_TOKEN_MAX_LENGTH     ( 32U )
+#define SHADOW_COALESCE_MAX_ITEMS          ( 8U )
+#define SHADOW_COMMAND_KEY_MAX_LENGTH      ( 64U )
+#define SHADOW_UPDATE_PAYLOAD_SIZE         ( 2048U )
+#define SHADOW_REJECT_CODE_THROTTLED       ( 429 )
+#define SHADOW_REJECT_CODE_SERVER_ERROR    ( 500 )       /* 5xx 為暫時性錯誤，重新發布 */
+#define SHADOW_BIND_INFO_PATH              "reported.info"   /* 文件鏡像中的綁定資訊路徑 */
 
 /*-----------------------------------------------------------*/
 /* 類型定義 - 從 dms_client.c 提取現有結構 */
@@ -90,6 +97,40 @@ typedef struct {
     bool bound;
 } device_bind_info_t;
 
+/**
+ * @brief 待回報的命令執行結果
+ */
+typedef struct {
+    char key[SHADOW_COMMAND_KEY_MAX_LENGTH];
+    bool success;
+    uint32_t timestamp;
+} shadow_command_result_t;
+
+/**
+ * @brief 合併寫入批次 - 一個批次發布為一份 shadow/update 文件
+ */
+typedef struct {
+    char desired_resets[SHADOW_COALESCE_MAX_ITEMS][SHADOW_COMMAND_KEY_MAX_LENGTH];
+    uint32_t desired_reset_count;
+    shadow_command_result_t results[SHADOW_COALESCE_MAX_ITEMS];
+    uint32_t result_count;
+    shadow_reported_state_t reported;   // 最新的 reported 狀態
+    bool has_reported;
+    uint32_t first_queued_ms;           // 批次第一筆寫入的時間
+} shadow_write_batch_t;
+
+/**
+ * @brief Shadow 寫入統計資訊
+ */
+typedef struct {
+    uint32_t writes_queued;             // 呼叫端提交的寫入次數
+    uint32_t updates_published;         // 實際發布的 shadow/update 次數
+    uint32_t full_updates;              // 完整 reported 更新次數
+    uint32_t patch_updates;             // 差異 reported 更新次數
+    uint32_t throttled_count;           // 被 AWS 以 429 拒絕的次數
+    uint32_t current_backoff_ms;        // 目前的節流退避時間，0 表示未節流
+} shadow_write_stats_t;
+
 /**
  * @brief Shadow 模組內部狀態
  */
@@ -102,6 +143,26 @@ typedef struct {
     bool get_received;                  // Shadow Get 回應已接收
     uint32_t last_update_time;          // 最後更新時間
     shadow_message_callback_t message_callback;  // 外部訊息回調
+
+    /* 本地快照 - 啟動時先用快照提供綁定資訊，get/accepted 到達後對帳 */
+    uint32_t document_version;          // 目前綁定資訊對應的 Shadow 文件版本
+    bool snapshot_loaded;               // 綁定資訊是否來自本地快照
+    bool bind_info_confirmed;           // 綁定資訊是否已由 get/accepted 確認
+
+    /* reported 差異更新 - 只送出與已確認狀態不同的欄位 */
+    shadow_reported_state_t acked_state;     // AWS 已接受的 reported 狀態
+    bool acked_valid;                        // acked_state 是否可作為差異基準
+    uint32_t pending_token;                  // 等待中的 clientToken 序號，0 表示無
+    uint32_t next_token;                     // 下一個 clientToken 序號
+
+    /* 合併寫入 - 視窗內的 desired 重設、命令結果與狀態合併為一次發布 */
+    shadow_write_batch_t pending_batch;      // 尚未發布的寫入
+    shadow_write_batch_t inflight_batch;     // 已發布、等待 accepted 的寫入（pending_token 為 0 時待重送）
+    uint32_t inflight_sent_ms;               // inflight 批次的發布時間
+    uint32_t last_publish_ms;                // 最後一次發布時間
+    uint32_t throttle_until_ms;              // 節流退避結束時間
+    uint32_t throttle_backoff_ms;            // 目前的節流退避時間
+    shadow_write_stats_t write_stats;        // 寫入統計
 } shadow_context_t;
 
 /*-----------------------------------------------------------*/
@@ -156,6 +217,7 @@ dms_result_t dms_shadow_get_document(void);
  *
  * 封裝原始的 waitForShadowGetResponse() 函數
  * 等待並處理 Shadow Get 回應，包含超時處理
+ * 已從本地快照載入綁定資訊時立即返回，get/accepted 由主循環在背景處理並對帳
  *
  * @param timeout_ms 超時時間（毫秒）
  * @return DMS_SUCCESS 成功，其他為錯誤碼
@@ -167,17 +229,54 @@ dms_result_t dms_shadow_wait_get_response(uint32_t timeout_ms);
  *
  * 封裝原始的 publishShadowUpdate() 函數
  * 發送系統狀態更新到 AWS IoT Device Shadow
+ * 只送出與 AWS 最後接受狀態不同的欄位；沒有可用基準時送出完整狀態
+ * 狀態先放入合併批次，由 dms_shadow_process() 在合併視窗結束後發布
  *
  * @param state 要更新的狀態結構，如果為 NULL 則使用內部狀態
  * @return DMS_SUCCESS 成功，其他為錯誤碼
  */
 dms_result_t dms_shadow_update_reported(const shadow_reported_state_t* state);
 
+/**
+ * @brief 要求下一次 reported 更新送出完整狀態
+ *
+ * 重連（dms_shadow_start）及 update/rejected 時會自動觸發；
+ * 尚未確認的 inflight 批次在下一次處理時重新發布
+ */
+void dms_shadow_request_full_resync(void);
+
+/**
+ * @brief 處理合併寫入批次
+ *
+ * 在主循環中每次 dms_aws_iot_process_loop() 之後調用
+ * 合併視窗結束、且未超過 AWS 更新速率與節流退避時，發布一份合併的 shadow/update
+ *
+ * @return DMS_SUCCESS 成功（包含無需發布），其他為錯誤碼
+ */
+dms_result_t dms_shadow_process(void);
+
+/**
+ * @brief 立即發布合併寫入批次
+ *
+ * 忽略合併視窗，但仍遵守節流退避與一次一份等待中的更新；用於批次已滿時
+ *
+ * @return DMS_SUCCESS 成功（包含無需發布），其他為錯誤碼
+ */
+dms_result_t dms_shadow_flush(void);
+
+/**
+ * @brief 獲取 Shadow 寫入統計資訊
+ *
+ * @param stats 輸出統計資訊
+ */
+void dms_shadow_get_write_stats(shadow_write_stats_t* stats);
+
 /**
  * @brief 重設 Shadow desired 狀態中的指定鍵
  *
  * 封裝原始的 resetDesiredState() 函數
  * 將 desired 狀態中的指定鍵設為 null，避免重複處理命令
+ * 重設會放入合併批次，與同一視窗內的其他寫入一起發布
  *
  * @param key 要重設的鍵名
  * @return DMS_SUCCESS 成功，其他為錯誤碼
@@ -189,6 +288,7 @@ dms_result_t dms_shadow_reset_desired(const char* key);
  *
  * 封裝原始的 reportCommandResult() 函數
  * 將命令執行結果更新到 Shadow reported 狀態
+ * 結果會放入合併批次，與同一視窗內的其他寫入一起發布
  *
  * @param command_key 命令鍵名
  * @param result 執行結果（成功/失敗）
@@ -231,6 +331,20 @@ bool dms_shadow_is_device_bound(void);
  */
 const device_bind_info_t* dms_shadow_get_bind_info(void);
 
+/**
+ * @brief 檢查綁定資訊是否已由 AWS 的 Shadow 文件確認
+ *
+ * @return true 已由 get/accepted 確認，false 仍為本地快照或尚未取得
+ */
+bool dms_shadow_is_bind_info_confirmed(void);
+
+/**
+ * @brief 獲取綁定資訊對應的 Shadow 文件版本
+ *
+ * @return Shadow 文件版本，未知時返回 0
+ */
+uint32_t dms_shadow_get_document_version(void);
+
 /**
  * @brief 獲取當前報告狀態
  *
@@ -248,7 +362,7 @@ bool dms_shadow_is_get_completed(void);
 /**
  * @brief 清理 Shadow 模組
  *
- * 清理資源並重設狀態
+ * 仍連線時先送出尚未確認與尚未發布的寫入（不等待節流退避），再清理資源並重設狀態
  */
 void dms_shadow_cleanup(void);
 
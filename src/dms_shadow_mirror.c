@@ -0,0 +1,661 @@
+
+/*
+ * DMS Shadow Mirror Module Implementation
+ *
+ * 值以固定大小的陣列保存，另以開放定址的雜湊索引（uint8_t 槽位）查詢，
+ * 刪除留下的墓碑過多時只需重建索引，不必搬移值。
+ */
+
+#include "dms_shadow_mirror.h"
+
+#include "dms_json_index.h"
+
+/* System includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*-----------------------------------------------------------*/
+/* 內部類型與常數 */
+
+#define MIRROR_INDEX_EMPTY      ( 0U )
+#define MIRROR_INDEX_TOMBSTONE  ( 0xFFU )
+
+/**
+ * @brief 鏡像中的一個值
+ */
+typedef struct {
+    char path[SHADOW_MIRROR_PATH_MAX_LENGTH];
+    char value[SHADOW_MIRROR_VALUE_MAX_LENGTH];
+    shadow_value_type_t type;
+    uint32_t version;           // 最後設定此值的文件版本
+    uint32_t generation;        // 完整文件套用時用來找出被移除的值
+    bool used;
+} mirror_entry_t;
+
+/**
+ * @brief 路徑監看者
+ */
+typedef struct {
+    char path[SHADOW_MIRROR_PATH_MAX_LENGTH];
+    shadow_mirror_watch_callback_t callback;
+} mirror_watcher_t;
+
+/*-----------------------------------------------------------*/
+/* 內部全域變數 */
+
+static mirror_entry_t g_entries[SHADOW_MIRROR_MAX_LIVE_ENTRIES];
+static uint8_t g_index[SHADOW_MIRROR_MAX_ENTRIES];     // 值索引 + 1，0 為空槽
+static uint32_t g_tombstone_count = 0;
+
+static mirror_watcher_t g_watchers[SHADOW_MIRROR_MAX_WATCHERS];
+
+static uint32_t g_mirror_version = 0;
+static uint32_t g_generation = 0;
+static shadow_mirror_stats_t g_stats = {0};
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static uint32_t hash_path(const char* path);
+static int find_entry(const char* path);
+static mirror_entry_t* insert_entry(const char* path);
+static void remove_entry(int entry_index);
+static void remove_subtree(const char* path, bool include_self);
+static void rebuild_index(void);
+static void set_value(const char* path, shadow_value_type_t type,
+                      const char* value, size_t value_length, uint32_t version);
+static void apply_object(const char* prefix, const dms_json_index_t* index, int32_t object,
+                         uint32_t depth, uint32_t version);
+static void sweep_section(const char* section);
+static void notify_watchers(const char* path, shadow_value_type_t type, const char* value);
+static bool path_has_prefix(const char* path, const char* prefix);
+static uint32_t parse_version(const dms_json_index_t* index);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 初始化 Shadow 鏡像模組
+ */
+dms_result_t dms_shadow_mirror_init(void)
+{
+    memset(g_entries, 0, sizeof(g_entries));
+    memset(g_index, 0, sizeof(g_index));
+    memset(g_watchers, 0, sizeof(g_watchers));
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_tombstone_count = 0;
+    g_mirror_version = 0;
+    g_generation = 0;
+
+    DMS_LOG_DEBUG("✅ Shadow mirror initialized (%u entries)", SHADOW_MIRROR_MAX_LIVE_ENTRIES);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 套用 Shadow 文件到鏡像
+ */
+dms_result_t dms_shadow_mirror_apply(shadow_mirror_doc_type_t type,
+                                     const char* payload,
+                                     size_t payload_length)
+{
+    static dms_json_token_t tokens[SHADOW_DOCUMENT_MAX_TOKENS];
+    dms_json_index_t index;
+
+    if (payload == NULL || payload_length == 0) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    dms_result_t result = dms_json_index_build(&index, payload, payload_length,
+                                               tokens, SHADOW_DOCUMENT_MAX_TOKENS);
+    if (result != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ Shadow mirror ignoring invalid JSON document (%d)", result);
+        return DMS_ERROR_SHADOW_FAILURE;
+    }
+
+    return dms_shadow_mirror_apply_index(type, &index);
+}
+
+/**
+ * @brief 套用已建立索引的 Shadow 文件到鏡像
+ */
+dms_result_t dms_shadow_mirror_apply_index(shadow_mirror_doc_type_t type,
+                                           const dms_json_index_t* index)
+{
+    if (index == NULL || index->count == 0) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    uint32_t version = parse_version(index);
+
+    /* 局部更新可能亂序到達，比鏡像舊的版本直接忽略 */
+    if (type != SHADOW_MIRROR_DOC_FULL && version != 0 && version < g_mirror_version) {
+        DMS_LOG_DEBUG("Shadow mirror ignoring stale document (version %u < %u)",
+                      version, g_mirror_version);
+        g_stats.documents_stale++;
+        return DMS_SUCCESS;
+    }
+
+    int32_t state = dms_json_index_child(index, DMS_JSON_INDEX_ROOT, "state", 5);
+    bool has_state = (dms_json_index_type(index, state) == DMS_JSON_TYPE_OBJECT);
+
+    g_generation++;
+
+    if (type == SHADOW_MIRROR_DOC_DELTA) {
+        if (has_state) {
+            apply_object("desired", index, state, 1, version);
+        }
+    } else {
+        static const char* const sections[] = { "desired", "reported" };
+
+        for (size_t i = 0; i < ARRAY_SIZE(sections); i++) {
+            int32_t section = has_state ?
+                              dms_json_index_child(index, state, sections[i], strlen(sections[i])) :
+                              DMS_JSON_INDEX_NOT_FOUND;
+
+            if (dms_json_index_type(index, section) == DMS_JSON_TYPE_OBJECT) {
+                apply_object(sections[i], index, section, 1, version);
+            }
+
+            /* 完整文件中沒有出現的值已在 AWS 端被刪除 */
+            if (type == SHADOW_MIRROR_DOC_FULL) {
+                sweep_section(sections[i]);
+            }
+        }
+    }
+
+    if (type == SHADOW_MIRROR_DOC_FULL || version > g_mirror_version) {
+        g_mirror_version = version;
+    }
+    g_stats.documents_applied++;
+
+    DMS_LOG_DEBUG("Shadow mirror applied document (version %u, %u entries)",
+                  g_mirror_version, g_stats.entry_count);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 獲取路徑的值型別
+ */
+shadow_value_type_t dms_shadow_mirror_get_type(const char* path)
+{
+    if (path == NULL) {
+        return SHADOW_VALUE_NONE;
+    }
+
+    int entry_index = find_entry(path);
+    return (entry_index < 0) ? SHADOW_VALUE_NONE : g_entries[entry_index].type;
+}
+
+/**
+ * @brief 讀取字串值
+ */
+bool dms_shadow_mirror_get_string(const char* path, char* buffer, size_t size)
+{
+    if (path == NULL || buffer == NULL || size == 0) {
+        return false;
+    }
+
+    int entry_index = find_entry(path);
+    if (entry_index < 0 || g_entries[entry_index].type != SHADOW_VALUE_STRING) {
+        return false;
+    }
+
+    size_t length = strlen(g_entries[entry_index].value);
+    if (length >= size) {
+        return false;
+    }
+
+    memcpy(buffer, g_entries[entry_index].value, length + 1);
+    return true;
+}
+
+/**
+ * @brief 讀取整數值
+ */
+bool dms_shadow_mirror_get_int(const char* path, int64_t* value)
+{
+    if (path == NULL || value == NULL) {
+        return false;
+    }
+
+    int entry_index = find_entry(path);
+    if (entry_index < 0 || g_entries[entry_index].type != SHADOW_VALUE_NUMBER) {
+        return false;
+    }
+
+    *value = (int64_t)strtoll(g_entries[entry_index].value, NULL, 10);
+    return true;
+}
+
+/**
+ * @brief 讀取布林值
+ */
+bool dms_shadow_mirror_get_bool(const char* path, bool* value)
+{
+    if (path == NULL || value == NULL) {
+        return false;
+    }
+
+    int entry_index = find_entry(path);
+    if (entry_index < 0 || g_entries[entry_index].type != SHADOW_VALUE_BOOL) {
+        return false;
+    }
+
+    *value = (g_entries[entry_index].value[0] == 't');
+    return true;
+}
+
+/**
+ * @brief 獲取鏡像對應的 Shadow 文件版本
+ */
+uint32_t dms_shadow_mirror_get_version(void)
+{
+    return g_mirror_version;
+}
+
+/**
+ * @brief 監看路徑變更
+ */
+dms_result_t dms_shadow_mirror_watch(const char* path, shadow_mirror_watch_callback_t callback)
+{
+    if (path == NULL || callback == NULL || strlen(path) >= SHADOW_MIRROR_PATH_MAX_LENGTH) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    for (uint32_t i = 0; i < SHADOW_MIRROR_MAX_WATCHERS; i++) {
+        if (g_watchers[i].callback == NULL) {
+            SAFE_STRNCPY(g_watchers[i].path, path, sizeof(g_watchers[i].path));
+            g_watchers[i].callback = callback;
+            DMS_LOG_DEBUG("Shadow mirror watching: %s", path);
+            return DMS_SUCCESS;
+        }
+    }
+
+    DMS_LOG_ERROR("❌ Shadow mirror watcher table full, cannot watch: %s", path);
+    return DMS_ERROR_MEMORY_ALLOCATION;
+}
+
+/**
+ * @brief 取消監看
+ */
+void dms_shadow_mirror_unwatch(const char* path, shadow_mirror_watch_callback_t callback)
+{
+    if (path == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < SHADOW_MIRROR_MAX_WATCHERS; i++) {
+        if (g_watchers[i].callback == callback && strcmp(g_watchers[i].path, path) == 0) {
+            memset(&g_watchers[i], 0, sizeof(g_watchers[i]));
+        }
+    }
+}
+
+/**
+ * @brief 獲取鏡像統計資訊
+ */
+void dms_shadow_mirror_get_stats(shadow_mirror_stats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = g_stats;
+    }
+}
+
+/**
+ * @brief 清理 Shadow 鏡像模組
+ */
+void dms_shadow_mirror_cleanup(void)
+{
+    dms_shadow_mirror_init();
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 路徑雜湊 (FNV-1a)
+ */
+static uint32_t hash_path(const char* path)
+{
+    uint32_t hash = 2166136261U;
+
+    while (*path != '\0') {
+        hash ^= (uint8_t)*path++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief 查詢路徑對應的值索引
+ *
+ * @return 值索引，不存在時返回 -1
+ */
+static int find_entry(const char* path)
+{
+    uint32_t slot = hash_path(path) & (SHADOW_MIRROR_MAX_ENTRIES - 1);
+
+    for (uint32_t probe = 0; probe < SHADOW_MIRROR_MAX_ENTRIES; probe++) {
+        uint8_t marker = g_index[slot];
+
+        if (marker == MIRROR_INDEX_EMPTY) {
+            return -1;
+        }
+
+        if (marker != MIRROR_INDEX_TOMBSTONE &&
+            strcmp(g_entries[marker - 1].path, path) == 0) {
+            return marker - 1;
+        }
+
+        slot = (slot + 1) & (SHADOW_MIRROR_MAX_ENTRIES - 1);
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 新增一個值並加入索引
+ *
+ * @return 新值指針，容量不足時返回 NULL
+ */
+static mirror_entry_t* insert_entry(const char* path)
+{
+    int entry_index = -1;
+
+    for (uint32_t i = 0; i < SHADOW_MIRROR_MAX_LIVE_ENTRIES; i++) {
+        if (!g_entries[i].used) {
+            entry_index = (int)i;
+            break;
+        }
+    }
+
+    if (entry_index < 0) {
+        return NULL;
+    }
+
+    /* 值數量小於槽數，一定找得到空槽或墓碑 */
+    uint32_t slot = hash_path(path) & (SHADOW_MIRROR_MAX_ENTRIES - 1);
+    while (g_index[slot] != MIRROR_INDEX_EMPTY && g_index[slot] != MIRROR_INDEX_TOMBSTONE) {
+        slot = (slot + 1) & (SHADOW_MIRROR_MAX_ENTRIES - 1);
+    }
+
+    if (g_index[slot] == MIRROR_INDEX_TOMBSTONE) {
+        g_tombstone_count--;
+    }
+    g_index[slot] = (uint8_t)(entry_index + 1);
+
+    mirror_entry_t* entry = &g_entries[entry_index];
+    memset(entry, 0, sizeof(*entry));
+    SAFE_STRNCPY(entry->path, path, sizeof(entry->path));
+    entry->used = true;
+    g_stats.entry_count++;
+
+    return entry;
+}
+
+/**
+ * @brief 移除一個值並通知監看者
+ */
+static void remove_entry(int entry_index)
+{
+    char path[SHADOW_MIRROR_PATH_MAX_LENGTH];
+    uint32_t slot = hash_path(g_entries[entry_index].path) & (SHADOW_MIRROR_MAX_ENTRIES - 1);
+
+    while (g_index[slot] != MIRROR_INDEX_EMPTY) {
+        if (g_index[slot] == (uint8_t)(entry_index + 1)) {
+            g_index[slot] = MIRROR_INDEX_TOMBSTONE;
+            g_tombstone_count++;
+            break;
+        }
+        slot = (slot + 1) & (SHADOW_MIRROR_MAX_ENTRIES - 1);
+    }
+
+    SAFE_STRNCPY(path, g_entries[entry_index].path, sizeof(path));
+    memset(&g_entries[entry_index], 0, sizeof(g_entries[entry_index]));
+    g_stats.entry_count--;
+
+    /* 墓碑太多會拉長查詢距離，重建索引 */
+    if (g_tombstone_count > SHADOW_MIRROR_MAX_ENTRIES / 4) {
+        rebuild_index();
+    }
+
+    notify_watchers(path, SHADOW_VALUE_NONE, NULL);
+}
+
+/**
+ * @brief 移除路徑下的所有值
+ *
+ * @param path 路徑
+ * @param include_self 是否一併移除路徑本身的值
+ */
+static void remove_subtree(const char* path, bool include_self)
+{
+    size_t length = strlen(path);
+
+    for (uint32_t i = 0; i < SHADOW_MIRROR_MAX_LIVE_ENTRIES; i++) {
+        if (!g_entries[i].used) {
+            continue;
+        }
+
+        const char* entry_path = g_entries[i].path;
+        if (strncmp(entry_path, path, length) == 0 &&
+            ((include_self && entry_path[length] == '\0') || entry_path[length] == '.')) {
+            remove_entry((int)i);
+        }
+    }
+}
+
+/**
+ * @brief 清除墓碑並重建雜湊索引
+ */
+static void rebuild_index(void)
+{
+    memset(g_index, 0, sizeof(g_index));
+    g_tombstone_count = 0;
+
+    for (uint32_t i = 0; i < SHADOW_MIRROR_MAX_LIVE_ENTRIES; i++) {
+        if (!g_entries[i].used) {
+            continue;
+        }
+
+        uint32_t slot = hash_path(g_entries[i].path) & (SHADOW_MIRROR_MAX_ENTRIES - 1);
+        while (g_index[slot] != MIRROR_INDEX_EMPTY) {
+            slot = (slot + 1) & (SHADOW_MIRROR_MAX_ENTRIES - 1);
+        }
+        g_index[slot] = (uint8_t)(i + 1);
+    }
+}
+
+/**
+ * @brief 設定一個值，內容或型別改變時通知監看者
+ */
+static void set_value(const char* path, shadow_value_type_t type,
+                      const char* value, size_t value_length, uint32_t version)
+{
+    int entry_index = find_entry(path);
+
+    /* 純量取代物件時，先移除原本的子路徑 */
+    remove_subtree(path, false);
+
+    if (value_length >= SHADOW_MIRROR_VALUE_MAX_LENGTH) {
+        DMS_LOG_DEBUG("Shadow mirror value too large, dropped: %s", path);
+        g_stats.values_dropped++;
+        if (entry_index >= 0) {
+            remove_entry(entry_index);
+        }
+        return;
+    }
+
+    mirror_entry_t* entry;
+    if (entry_index >= 0) {
+        entry = &g_entries[entry_index];
+        entry->generation = g_generation;
+        entry->version = version;
+
+        if (entry->type == type &&
+            strlen(entry->value) == value_length &&
+            memcmp(entry->value, value, value_length) == 0) {
+            return;  /* 值未變更 */
+        }
+    } else {
+        entry = insert_entry(path);
+        if (entry == NULL) {
+            DMS_LOG_WARN("⚠️ Shadow mirror full, dropped: %s", path);
+            g_stats.values_dropped++;
+            return;
+        }
+        entry->generation = g_generation;
+        entry->version = version;
+    }
+
+    memcpy(entry->value, value, value_length);
+    entry->value[value_length] = '\0';
+    entry->type = type;
+
+    notify_watchers(entry->path, entry->type, entry->value);
+}
+
+/**
+ * @brief 遞迴套用 JSON 物件，巢狀鍵以 "." 串接為路徑
+ */
+static void apply_object(const char* prefix, const dms_json_index_t* index, int32_t object,
+                         uint32_t depth, uint32_t version)
+{
+    char path[SHADOW_MIRROR_PATH_MAX_LENGTH];
+
+    for (int32_t key = dms_json_index_first_child(index, object);
+         key != DMS_JSON_INDEX_NOT_FOUND;
+         key = dms_json_index_next_sibling(index, object, key)) {
+        const char* key_text;
+        size_t key_length;
+        const char* value;
+        size_t value_length;
+
+        dms_json_index_value(index, key, &key_text, &key_length);
+        dms_json_index_value(index, key + 1, &value, &value_length);
+
+        int written = snprintf(path, sizeof(path), "%s.%.*s",
+                               prefix, (int)key_length, key_text);
+        if (written < 0 || (size_t)written >= sizeof(path)) {
+            g_stats.values_dropped++;
+            continue;
+        }
+
+        switch (dms_json_index_type(index, key + 1)) {
+            case DMS_JSON_TYPE_OBJECT: {
+                /* 物件取代純量時，先移除原本的值 */
+                int entry_index = find_entry(path);
+                if (entry_index >= 0) {
+                    remove_entry(entry_index);
+                }
+
+                if (depth + 1 < SHADOW_MIRROR_MAX_DEPTH) {
+                    apply_object(path, index, key + 1, depth + 1, version);
+                } else {
+                    g_stats.values_dropped++;
+                }
+                break;
+            }
+
+            case DMS_JSON_TYPE_NULL:
+                /* Shadow 中 null 表示刪除該鍵及其下所有值 */
+                remove_subtree(path, true);
+                break;
+
+            case DMS_JSON_TYPE_STRING: {
+                /* 鏡像保存反跳脫後的字串，讀取端不需要再處理跳脫字元 */
+                char text[SHADOW_MIRROR_VALUE_MAX_LENGTH];
+                size_t text_length;
+                dms_result_t result = dms_json_index_get_string(index, key + 1, text,
+                                                                sizeof(text), &text_length);
+                if (result == DMS_ERROR_BUFFER_OVERFLOW) {
+                    text_length = sizeof(text);     /* 交給 set_value() 以過長處理 */
+                } else if (result != DMS_SUCCESS) {
+                    g_stats.values_dropped++;
+                    break;
+                }
+                set_value(path, SHADOW_VALUE_STRING, text, text_length, version);
+                break;
+            }
+
+            case DMS_JSON_TYPE_NUMBER:
+                set_value(path, SHADOW_VALUE_NUMBER, value, value_length, version);
+                break;
+
+            case DMS_JSON_TYPE_TRUE:
+            case DMS_JSON_TYPE_FALSE:
+                set_value(path, SHADOW_VALUE_BOOL, value, value_length, version);
+                break;
+
+            case DMS_JSON_TYPE_ARRAY:
+                set_value(path, SHADOW_VALUE_ARRAY, value, value_length, version);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief 移除完整文件中沒有出現的值
+ */
+static void sweep_section(const char* section)
+{
+    size_t length = strlen(section);
+
+    for (uint32_t i = 0; i < SHADOW_MIRROR_MAX_LIVE_ENTRIES; i++) {
+        if (g_entries[i].used &&
+            g_entries[i].generation != g_generation &&
+            strncmp(g_entries[i].path, section, length) == 0 &&
+            g_entries[i].path[length] == '.') {
+            remove_entry((int)i);
+        }
+    }
+}
+
+/**
+ * @brief 通知監看該路徑或其上層路徑的監看者
+ */
+static void notify_watchers(const char* path, shadow_value_type_t type, const char* value)
+{
+    for (uint32_t i = 0; i < SHADOW_MIRROR_MAX_WATCHERS; i++) {
+        if (g_watchers[i].callback != NULL && path_has_prefix(path, g_watchers[i].path)) {
+            g_watchers[i].callback(path, type, value);
+        }
+    }
+}
+
+/**
+ * @brief 檢查 path 是否等於 prefix 或位於 prefix 之下
+ */
+static bool path_has_prefix(const char* path, const char* prefix)
+{
+    size_t length = strlen(prefix);
+
+    return strncmp(path, prefix, length) == 0 &&
+           (path[length] == '\0' || path[length] == '.');
+}
+
+/**
+ * @brief 解析文件頂層的 version 欄位
+ *
+ * @return Shadow 文件版本，缺少或格式錯誤時返回 0
+ */
+static uint32_t parse_version(const dms_json_index_t* index)
+{
+    uint64_t version;
+
+    if (!dms_json_index_get_uint(index,
+                                 dms_json_index_child(index, DMS_JSON_INDEX_ROOT,
+                                                      JSON_QUERY_SHADOW_VERSION,
+                                                      strlen(JSON_QUERY_SHADOW_VERSION)),
+                                 &version) ||
+        version > UINT32_MAX) {
+        return 0;
+    }
+
+    return (uint32_t)version;
+}
@@ -0,0 +1,192 @@
+
+/*
+ * DMS Shadow Mirror Module
+ *
+ * 在記憶體中維護 Shadow 文件的 desired / reported 樹，避免每則訊息都重新搜尋 JSON：
+ * - get/accepted 以完整文件取代鏡像，update/accepted 與 update/delta 以局部更新套用
+ * - 巢狀物件攤平為 "desired.xxx"、"reported.info.company_name" 形式的路徑
+ * - 以路徑雜湊查詢，提供型別化的 O(1) 讀取
+ * - 指定路徑（或其子路徑）變更時通知註冊的監看者
+ */
+
+#ifndef DMS_SHADOW_MIRROR_H_
+#define DMS_SHADOW_MIRROR_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "dms_log.h"
+#include "dms_json_index.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define SHADOW_MIRROR_MAX_ENTRIES          ( 128U )   /* 雜湊槽數量，必須為 2 的次方 */
+#define SHADOW_MIRROR_MAX_LIVE_ENTRIES     ( 96U )    /* 最多保存的值，保留空槽維持查詢效率 */
+#define SHADOW_MIRROR_PATH_MAX_LENGTH      ( 96U )
+#define SHADOW_MIRROR_VALUE_MAX_LENGTH     ( 128U )
+#define SHADOW_MIRROR_MAX_WATCHERS         ( 8U )
+#define SHADOW_MIRROR_MAX_DEPTH            ( 6U )
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief Shadow 文件種類 - 決定套用方式
+ */
+typedef enum {
+    SHADOW_MIRROR_DOC_FULL = 0,     // get/accepted：取代整份 desired 與 reported
+    SHADOW_MIRROR_DOC_UPDATE,       // update/accepted：state.desired / state.reported 局部更新
+    SHADOW_MIRROR_DOC_DELTA         // update/delta：state 為 desired 的局部更新
+} shadow_mirror_doc_type_t;
+
+/**
+ * @brief 鏡像中值的型別
+ */
+typedef enum {
+    SHADOW_VALUE_NONE = 0,          // 路徑不存在
+    SHADOW_VALUE_STRING,
+    SHADOW_VALUE_NUMBER,
+    SHADOW_VALUE_BOOL,
+    SHADOW_VALUE_ARRAY              // 以原始 JSON 文字保存
+} shadow_value_type_t;
+
+/**
+ * @brief 路徑變更回調函數類型
+ *
+ * 在套用文件的過程中同步調用（MQTT 訊息回調的上下文），不可在回調中再套用文件
+ *
+ * @param path 變更的完整路徑
+ * @param type 新值的型別，SHADOW_VALUE_NONE 表示已刪除
+ * @param value 新值的文字（字串不含引號），刪除時為 NULL
+ */
+typedef void (*shadow_mirror_watch_callback_t)(const char* path,
+                                               shadow_value_type_t type,
+                                               const char* value);
+
+/**
+ * @brief 鏡像統計資訊
+ */
+typedef struct {
+    uint32_t entry_count;           // 目前保存的值數量
+    uint32_t documents_applied;     // 已套用的文件數
+    uint32_t documents_stale;       // 因版本過舊而忽略的文件數
+    uint32_t values_dropped;        // 因路徑過長、值過大或容量不足而未保存的值
+} shadow_mirror_stats_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 初始化 Shadow 鏡像模組
+ *
+ * @return DMS_SUCCESS 成功，其他為錯誤碼
+ */
+dms_result_t dms_shadow_mirror_init(void);
+
+/**
+ * @brief 套用 Shadow 文件到鏡像
+ *
+ * 版本比鏡像舊的局部更新會被忽略；完整文件一律套用
+ *
+ * @param type 文件種類
+ * @param payload JSON 文件
+ * @param payload_length 文件長度
+ * @return DMS_SUCCESS 成功（包含忽略過舊文件），其他為錯誤碼
+ */
+dms_result_t dms_shadow_mirror_apply(shadow_mirror_doc_type_t type,
+                                     const char* payload,
+                                     size_t payload_length);
+
+/**
+ * @brief 套用已建立索引的 Shadow 文件到鏡像
+ *
+ * 呼叫端已為其他查詢建立索引時使用，避免重新掃描文件
+ *
+ * @param type 文件種類
+ * @param index 文件索引
+ * @return DMS_SUCCESS 成功（包含忽略過舊文件），其他為錯誤碼
+ */
+dms_result_t dms_shadow_mirror_apply_index(shadow_mirror_doc_type_t type,
+                                           const dms_json_index_t* index);
+
+/**
+ * @brief 獲取路徑的值型別
+ *
+ * @param path 完整路徑，例如 "reported.info.company_id"
+ * @return 值型別，不存在時返回 SHADOW_VALUE_NONE
+ */
+shadow_value_type_t dms_shadow_mirror_get_type(const char* path);
+
+/**
+ * @brief 讀取字串值
+ *
+ * @param path 完整路徑
+ * @param buffer 輸出緩衝區
+ * @param size 緩衝區大小
+ * @return true 成功，false 不存在、不是字串或緩衝區不足
+ */
+bool dms_shadow_mirror_get_string(const char* path, char* buffer, size_t size);
+
+/**
+ * @brief 讀取整數值
+ *
+ * @param path 完整路徑
+ * @param value 輸出值
+ * @return true 成功，false 不存在或不是數字
+ */
+bool dms_shadow_mirror_get_int(const char* path, int64_t* value);
+
+/**
+ * @brief 讀取布林值
+ *
+ * @param path 完整路徑
+ * @param value 輸出值
+ * @return true 成功，false 不存在或不是布林
+ */
+bool dms_shadow_mirror_get_bool(const char* path, bool* value);
+
+/**
+ * @brief 獲取鏡像對應的 Shadow 文件版本
+ *
+ * @return 最後套用的文件版本，未知時返回 0
+ */
+uint32_t dms_shadow_mirror_get_version(void);
+
+/**
+ * @brief 監看路徑變更
+ *
+ * path 本身或其子路徑（path + "."）變更時調用回調
+ *
+ * @param path 監看的路徑，例如 "reported.info"
+ * @param callback 回調函數
+ * @return DMS_SUCCESS 成功，其他為錯誤碼
+ */
+dms_result_t dms_shadow_mirror_watch(const char* path, shadow_mirror_watch_callback_t callback);
+
+/**
+ * @brief 取消監看
+ *
+ * @param path 監看的路徑
+ * @param callback 回調函數
+ */
+void dms_shadow_mirror_unwatch(const char* path, shadow_mirror_watch_callback_t callback);
+
+/**
+ * @brief 獲取鏡像統計資訊
+ *
+ * @param stats 輸出統計資訊
+ */
+void dms_shadow_mirror_get_stats(shadow_mirror_stats_t* stats);
+
+/**
+ * @brief 清理 Shadow 鏡像模組
+ */
+void dms_shadow_mirror_cleanup(void);
+
+#endif /* DMS_SHADOW_MIRROR_H_ */
@@ -0,0 +1,767 @@
+
+/*
+ * DMS System Statistics Sampler Implementation
+ *
+ * /proc 檔案支援在 offset 0 重新 pread() 取得最新內容，因此檔案只開啟一次。
+ * 所有解析都在固定緩衝區上逐字元進行，取樣路徑上沒有 malloc 或 stdio。
+ */
+
+#include "dms_sysstat.h"
+
+/* 系統標頭檔 */
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*-----------------------------------------------------------*/
+/* 內部類型與常數 */
+
+#define SYSSTAT_STAT_BUFFER_SIZE      ( 256U )    /* 只需要第一行 "cpu ..." */
+#define SYSSTAT_MEMINFO_BUFFER_SIZE   ( 1024U )   /* MemTotal/MemFree/MemAvailable 在前幾行 */
+#define SYSSTAT_NET_DEV_BUFFER_SIZE   ( 4096U )
+#define SYSSTAT_UPTIME_BUFFER_SIZE    ( 64U )
+#define SYSSTAT_WIRELESS_BUFFER_SIZE  ( 512U )
+#define SYSSTAT_ROUTE_BUFFER_SIZE     ( 2048U )   /* 每條路由一行 128 位元組 */
+#define SYSSTAT_ROUTE_FIELDS          ( 8U )      /* Iface ... Mask */
+#define SYSSTAT_RTF_UP                ( 0x0001U ) /* <net/route.h> RTF_UP */
+
+/**
+ * @brief 單一網路介面的計數器狀態
+ */
+typedef struct {
+    char name[SYSSTAT_INTERFACE_NAME_LENGTH];
+    uint64_t last_rx;               // 上次讀到的原始計數器
+    uint64_t last_tx;
+    bool seen;                      // 本次取樣是否出現
+    bool used;
+} sysstat_interface_t;
+
+/*-----------------------------------------------------------*/
+/* 內部全域變數 */
+
+static int g_stat_fd = -1;
+static int g_meminfo_fd = -1;
+static int g_net_dev_fd = -1;
+static int g_uptime_fd = -1;
+static int g_wireless_fd = -1;
+static int g_route_fd = -1;
+
+static char g_stat_buffer[SYSSTAT_STAT_BUFFER_SIZE];
+static char g_meminfo_buffer[SYSSTAT_MEMINFO_BUFFER_SIZE];
+static char g_net_dev_buffer[SYSSTAT_NET_DEV_BUFFER_SIZE];
+static char g_uptime_buffer[SYSSTAT_UPTIME_BUFFER_SIZE];
+static char g_wireless_buffer[SYSSTAT_WIRELESS_BUFFER_SIZE];
+static char g_route_buffer[SYSSTAT_ROUTE_BUFFER_SIZE];
+
+static sysstat_interface_t g_interfaces[SYSSTAT_MAX_INTERFACES];
+static bool g_interface_limit_logged = false;
+
+/* 自動選擇時的 WAN 介面，沒有預設路由時保留上次的結果 */
+static char g_uplink_name[SYSSTAT_INTERFACE_NAME_LENGTH];
+
+/* 差值基準 */
+static uint64_t g_prev_cpu_total = 0;
+static uint64_t g_prev_cpu_idle = 0;
+static uint64_t g_prev_sample_ms = 0;
+
+static dms_sysstat_sample_t g_last_sample = {0};
+static bool g_has_sample = false;
+static dms_sysstat_cost_t g_cost = {0};
+static uint64_t g_total_sample_us = 0;
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static ssize_t read_proc_file(int fd, char* buffer, size_t size);
+static uint64_t monotonic_us(void);
+static const char* parse_u64(const char* p, const char* end, uint64_t* value);
+static const char* skip_line(const char* p, const char* end);
+static bool read_cpu_times(uint64_t* total, uint64_t* idle);
+static bool read_memory_usage(float* usage);
+static bool read_network_totals(uint64_t* rx_total, uint64_t* tx_total);
+static bool read_uptime(uint32_t* uptime);
+static bool read_wifi_rssi(int32_t* rssi_dbm);
+static void read_uplink_interface(void);
+static bool parse_hex32(const char* text, size_t length, uint32_t* value);
+static uint64_t counter_delta(uint64_t previous, uint64_t current);
+static sysstat_interface_t* find_interface(const char* name, size_t length);
+static bool is_interface_selected(const char* name, size_t length);
+static void close_fd(int* fd);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 初始化系統統計取樣器
+ */
+dms_result_t dms_sysstat_init(void)
+{
+    dms_sysstat_cleanup();
+
+    g_stat_fd = open(SYSSTAT_PROC_STAT_PATH, O_RDONLY | O_CLOEXEC);
+    g_meminfo_fd = open(SYSSTAT_PROC_MEMINFO_PATH, O_RDONLY | O_CLOEXEC);
+    g_net_dev_fd = open(SYSSTAT_PROC_NET_DEV_PATH, O_RDONLY | O_CLOEXEC);
+    g_uptime_fd = open(SYSSTAT_PROC_UPTIME_PATH, O_RDONLY | O_CLOEXEC);
+
+    /* 沒有無線介面或核心未啟用 wireless extensions 時檔案不存在，不視為錯誤 */
+    g_wireless_fd = open(SYSSTAT_PROC_WIRELESS_PATH, O_RDONLY | O_CLOEXEC);
+
+    /* 未指定介面時依預設路由選擇 WAN 介面 */
+    if (SYSSTAT_NET_INTERFACE[0] == '\0') {
+        g_route_fd = open(SYSSTAT_PROC_NET_ROUTE_PATH, O_RDONLY | O_CLOEXEC);
+        if (g_route_fd < 0) {
+            DMS_LOG_WARN("⚠️ Cannot open %s, network traffic will not be counted",
+                         SYSSTAT_PROC_NET_ROUTE_PATH);
+        }
+    }
+
+    if (g_stat_fd < 0 || g_meminfo_fd < 0 || g_net_dev_fd < 0 || g_uptime_fd < 0) {
+        DMS_LOG_ERROR("❌ Failed to open /proc statistics files");
+        dms_sysstat_cleanup();
+        return DMS_ERROR_SYSTEM_FILE_ACCESS;
+    }
+
+    /* 第一次取樣作為差值基準 */
+    dms_sysstat_sample_t sample;
+    dms_result_t result = dms_sysstat_sample(&sample);
+    if (result != DMS_SUCCESS) {
+        return result;
+    }
+
+    DMS_LOG_INFO("✅ System statistics sampler initialized (%u us per sample)",
+                 g_cost.last_sample_us);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 進行一次取樣
+ */
+dms_result_t dms_sysstat_sample(dms_sysstat_sample_t* sample)
+{
+    if (sample == NULL) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (g_stat_fd < 0) {
+        return DMS_ERROR_SYSTEM_FILE_ACCESS;
+    }
+
+    uint64_t start_us = monotonic_us();
+    uint64_t now_ms = start_us / 1000;
+
+    uint64_t cpu_total = 0;
+    uint64_t cpu_idle = 0;
+    uint64_t rx_total = 0;
+    uint64_t tx_total = 0;
+    dms_sysstat_sample_t current = g_last_sample;
+
+    bool ok = read_cpu_times(&cpu_total, &cpu_idle) &&
+              read_memory_usage(&current.memory_usage) &&
+              read_network_totals(&rx_total, &tx_total) &&
+              read_uptime(&current.uptime_seconds);
+
+    if (!ok) {
+        g_cost.read_errors++;
+        DMS_LOG_WARN("⚠️ Failed to read /proc statistics");
+        return DMS_ERROR_SYSTEM_FILE_ACCESS;
+    }
+
+    /* CPU 使用率 - 第一次取樣以開機以來的累計值計算 */
+    uint64_t total_delta = cpu_total - g_prev_cpu_total;
+    uint64_t idle_delta = cpu_idle - g_prev_cpu_idle;
+    if (cpu_total >= g_prev_cpu_total && cpu_idle >= g_prev_cpu_idle &&
+        total_delta > 0 && idle_delta <= total_delta) {
+        current.cpu_usage = (float)(total_delta - idle_delta) * 100.0f / (float)total_delta;
+    }
+    g_prev_cpu_total = cpu_total;
+    g_prev_cpu_idle = cpu_idle;
+
+    /* 網路速率 */
+    current.interval_ms = g_has_sample ? (uint32_t)(now_ms - g_prev_sample_ms) : 0;
+    if (current.interval_ms > 0) {
+        current.net_rx_bytes_per_sec = rx_total * 1000 / current.interval_ms;
+        current.net_tx_bytes_per_sec = tx_total * 1000 / current.interval_ms;
+    } else {
+        current.net_rx_bytes_per_sec = 0;
+        current.net_tx_bytes_per_sec = 0;
+    }
+    current.net_rx_bytes += rx_total;
+    current.net_tx_bytes += tx_total;
+    g_prev_sample_ms = now_ms;
+
+    /* 無線訊號強度 - 讀取失敗不影響其他統計 */
+    current.wifi_rssi_valid = (g_wireless_fd >= 0) && read_wifi_rssi(&current.wifi_rssi_dbm);
+
+    g_last_sample = current;
+    g_has_sample = true;
+    *sample = current;
+
+    /* 取樣成本 */
+    uint32_t elapsed_us = (uint32_t)(monotonic_us() - start_us);
+    g_cost.sample_count++;
+    g_cost.last_sample_us = elapsed_us;
+    if (elapsed_us > g_cost.max_sample_us) {
+        g_cost.max_sample_us = elapsed_us;
+    }
+    g_total_sample_us += elapsed_us;
+    g_cost.avg_sample_us = (uint32_t)(g_total_sample_us / g_cost.sample_count);
+
+    DMS_LOG_DEBUG("System stats: cpu=%.2f%% mem=%.2f%% rx=%llu tx=%llu (%u us)",
+                  current.cpu_usage, current.memory_usage,
+                  (unsigned long long)current.net_rx_bytes,
+                  (unsigned long long)current.net_tx_bytes, elapsed_us);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 獲取最近一次取樣結果
+ */
+bool dms_sysstat_get_last(dms_sysstat_sample_t* sample)
+{
+    if (sample == NULL || !g_has_sample) {
+        return false;
+    }
+
+    *sample = g_last_sample;
+    return true;
+}
+
+/**
+ * @brief 獲取取樣成本統計
+ */
+void dms_sysstat_get_cost(dms_sysstat_cost_t* cost)
+{
+    if (cost != NULL) {
+        *cost = g_cost;
+    }
+}
+
+/**
+ * @brief 清理系統統計取樣器
+ */
+void dms_sysstat_cleanup(void)
+{
+    close_fd(&g_stat_fd);
+    close_fd(&g_meminfo_fd);
+    close_fd(&g_net_dev_fd);
+    close_fd(&g_uptime_fd);
+    close_fd(&g_wireless_fd);
+    close_fd(&g_route_fd);
+
+    memset(g_interfaces, 0, sizeof(g_interfaces));
+    g_interface_limit_logged = false;
+    g_uplink_name[0] = '\0';
+    memset(&g_last_sample, 0, sizeof(g_last_sample));
+    memset(&g_cost, 0, sizeof(g_cost));
+    g_prev_cpu_total = 0;
+    g_prev_cpu_idle = 0;
+    g_prev_sample_ms = 0;
+    g_total_sample_us = 0;
+    g_has_sample = false;
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 從 offset 0 重新讀取 /proc 檔案
+ *
+ * @return 讀取的位元組數（緩衝區以 '\0' 結尾），失敗返回 -1
+ */
+static ssize_t read_proc_file(int fd, char* buffer, size_t size)
+{
+    ssize_t length = pread(fd, buffer, size - 1, 0);
+    if (length <= 0) {
+        return -1;
+    }
+
+    buffer[length] = '\0';
+    return length;
+}
+
+/**
+ * @brief 獲取單調時鐘（微秒）
+ */
+static uint64_t monotonic_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/**
+ * @brief 跳過空白後解析一個十進位整數
+ *
+ * @return 數字之後的位置，沒有數字時返回 NULL
+ */
+static const char* parse_u64(const char* p, const char* end, uint64_t* value)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+
+    if (p >= end || *p < '0' || *p > '9') {
+        return NULL;
+    }
+
+    uint64_t result = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = result * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+
+    *value = result;
+    return p;
+}
+
+/**
+ * @brief 移到下一行開頭
+ */
+static const char* skip_line(const char* p, const char* end)
+{
+    while (p < end && *p != '\n') {
+        p++;
+    }
+    return (p < end) ? p + 1 : end;
+}
+
+/**
+ * @brief 讀取 /proc/stat 第一行的 CPU 累計時間
+ *
+ * total = user + nice + system + idle + iowait + irq + softirq + steal
+ * idle  = idle + iowait
+ */
+static bool read_cpu_times(uint64_t* total, uint64_t* idle)
+{
+    ssize_t length = read_proc_file(g_stat_fd, g_stat_buffer, sizeof(g_stat_buffer));
+    if (length < 0 || strncmp(g_stat_buffer, "cpu ", 4) != 0) {
+        return false;
+    }
+
+    const char* p = g_stat_buffer + 4;
+    const char* end = g_stat_buffer + length;
+    uint64_t fields[8] = {0};
+
+    /* 舊核心可能沒有 iowait/irq/softirq/steal，缺少的欄位視為 0 */
+    for (size_t i = 0; i < ARRAY_SIZE(fields); i++) {
+        const char* next = parse_u64(p, end, &fields[i]);
+        if (next == NULL) {
+            if (i < 4) {
+                return false;
+            }
+            break;
+        }
+        p = next;
+    }
+
+    *total = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(fields); i++) {
+        *total += fields[i];
+    }
+    *idle = fields[3] + fields[4];
+    return true;
+}
+
+/**
+ * @brief 讀取 /proc/meminfo 計算記憶體使用率
+ *
+ * 沒有 MemAvailable 的舊核心以 MemFree + Buffers + Cached 估算
+ */
+static bool read_memory_usage(float* usage)
+{
+    ssize_t length = read_proc_file(g_meminfo_fd, g_meminfo_buffer, sizeof(g_meminfo_buffer));
+    if (length < 0) {
+        return false;
+    }
+
+    const char* p = g_meminfo_buffer;
+    const char* end = g_meminfo_buffer + length;
+    uint64_t mem_total = 0;
+    uint64_t mem_free = 0;
+    uint64_t mem_available = 0;
+    uint64_t buffers = 0;
+    uint64_t cached = 0;
+    bool has_available = false;
+
+    while (p < end) {
+        uint64_t* target = NULL;
+        size_t key_length = 0;
+
+        if (strncmp(p, "MemTotal:", 9) == 0) {
+            target = &mem_total; key_length = 9;
+        } else if (strncmp(p, "MemFree:", 8) == 0) {
+            target = &mem_free; key_length = 8;
+        } else if (strncmp(p, "MemAvailable:", 13) == 0) {
+            target = &mem_available; key_length = 13; has_available = true;
+        } else if (strncmp(p, "Buffers:", 8) == 0) {
+            target = &buffers; key_length = 8;
+        } else if (strncmp(p, "Cached:", 7) == 0) {
+            target = &cached; key_length = 7;
+        }
+
+        if (target != NULL) {
+            parse_u64(p + key_length, end, target);
+            if (target == &cached) {
+                break;  /* Cached 在這些欄位中最後出現 */
+            }
+        }
+
+        p = skip_line(p, end);
+    }
+
+    if (mem_total == 0) {
+        return false;
+    }
+
+    if (!has_available) {
+        mem_available = mem_free + buffers + cached;
+    }
+    if (mem_available > mem_total) {
+        mem_available = mem_total;
+    }
+
+    *usage = (float)(mem_total - mem_available) * 100.0f / (float)mem_total;
+    return true;
+}
+
+/**
+ * @brief 讀取 /proc/net/dev，返回與上次取樣間的流量增量
+ *
+ * 介面消失後重新出現時，以重新出現時的計數器為新基準
+ */
+static bool read_network_totals(uint64_t* rx_total, uint64_t* tx_total)
+{
+    ssize_t length = read_proc_file(g_net_dev_fd, g_net_dev_buffer, sizeof(g_net_dev_buffer));
+    if (length < 0) {
+        return false;
+    }
+
+    const char* end = g_net_dev_buffer + length;
+    const char* p = skip_line(skip_line(g_net_dev_buffer, end), end);  /* 跳過兩行標題 */
+
+    if (g_route_fd >= 0) {
+        read_uplink_interface();
+    }
+
+    /* 未選擇的介面不會標記為 seen，切換 WAN 介面時舊介面的基準隨之釋放 */
+    for (uint32_t i = 0; i < SYSSTAT_MAX_INTERFACES; i++) {
+        g_interfaces[i].seen = false;
+    }
+
+    *rx_total = 0;
+    *tx_total = 0;
+
+    while (p < end) {
+        const char* line_end = skip_line(p, end);
+
+        while (p < line_end && *p == ' ') {
+            p++;
+        }
+        const char* name = p;
+        while (p < line_end && *p != ':') {
+            p++;
+        }
+        if (p >= line_end) {
+            p = line_end;
+            continue;
+        }
+        size_t name_length = (size_t)(p - name);
+        p++;
+
+        /* 欄位順序：rx bytes packets errs drop fifo frame compressed multicast，tx bytes ... */
+        uint64_t fields[9] = {0};
+        bool parsed = true;
+        for (size_t i = 0; i < ARRAY_SIZE(fields); i++) {
+            const char* next = parse_u64(p, line_end, &fields[i]);
+            if (next == NULL) {
+                parsed = false;
+                break;
+            }
+            p = next;
+        }
+
+        if (parsed && is_interface_selected(name, name_length)) {
+            sysstat_interface_t* iface = find_interface(name, name_length);
+            if (iface == NULL) {
+                if (!g_interface_limit_logged) {
+                    DMS_LOG_WARN("⚠️ Interface %.*s not counted: more than %u interfaces or name too long",
+                                 (int)name_length, name, (unsigned)SYSSTAT_MAX_INTERFACES);
+                    g_interface_limit_logged = true;
+                }
+            } else {
+                if (iface->used) {
+                    *rx_total += counter_delta(iface->last_rx, fields[0]);
+                    *tx_total += counter_delta(iface->last_tx, fields[8]);
+                } else {
+                    /* 第一次取樣計入開機以來的流量，之後新出現的介面以目前計數器為起點 */
+                    if (!g_has_sample) {
+                        *rx_total += fields[0];
+                        *tx_total += fields[8];
+                    }
+                    iface->used = true;
+                }
+                iface->last_rx = fields[0];
+                iface->last_tx = fields[8];
+                iface->seen = true;
+            }
+        }
+
+        p = line_end;
+    }
+
+    /* 已消失的介面釋放槽位 */
+    for (uint32_t i = 0; i < SYSSTAT_MAX_INTERFACES; i++) {
+        if (g_interfaces[i].used && !g_interfaces[i].seen) {
+            memset(&g_interfaces[i], 0, sizeof(g_interfaces[i]));
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 讀取 /proc/uptime 的整數秒
+ */
+static bool read_uptime(uint32_t* uptime)
+{
+    ssize_t length = read_proc_file(g_uptime_fd, g_uptime_buffer, sizeof(g_uptime_buffer));
+    if (length < 0) {
+        return false;
+    }
+
+    uint64_t seconds;
+    if (parse_u64(g_uptime_buffer, g_uptime_buffer + length, &seconds) == NULL) {
+        return false;
+    }
+
+    *uptime = (uint32_t)seconds;
+    return true;
+}
+
+/**
+ * @brief 讀取 /proc/net/wireless 第一個介面的訊號強度
+ *
+ * 每行格式：" wlan0: 0000   70.  -40.  -256 ..."，依序為狀態、連線品質、訊號、雜訊；
+ * 部分驅動以無號 8 位元回報 dBm（例如 216 表示 -40），需轉回負值
+ */
+static bool read_wifi_rssi(int32_t* rssi_dbm)
+{
+    ssize_t length = read_proc_file(g_wireless_fd, g_wireless_buffer, sizeof(g_wireless_buffer));
+    if (length < 0) {
+        return false;
+    }
+
+    const char* end = g_wireless_buffer + length;
+    const char* p = skip_line(skip_line(g_wireless_buffer, end), end);  /* 跳過兩行標題 */
+    const char* line_end = skip_line(p, end);
+
+    while (p < line_end && *p != ':') {
+        p++;
+    }
+    if (p >= line_end) {
+        return false;                   /* 沒有已關聯的無線介面 */
+    }
+    p++;
+
+    /* 跳過狀態（十六進位）與連線品質 */
+    for (int field = 0; field < 2; field++) {
+        while (p < line_end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        while (p < line_end && *p != ' ' && *p != '\t') {
+            p++;
+        }
+    }
+
+    while (p < line_end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    bool negative = (p < line_end && *p == '-');
+    if (negative) {
+        p++;
+    }
+
+    uint64_t level;
+    if (parse_u64(p, line_end, &level) == NULL || level > 255) {
+        return false;
+    }
+
+    int32_t dbm = negative ? -(int32_t)level : (int32_t)level;
+    if (dbm > 63) {
+        dbm -= 256;
+    }
+
+    *rssi_dbm = dbm;
+    return true;
+}
+
+/**
+ * @brief 讀取 /proc/net/route，更新預設路由所在的介面
+ *
+ * 每行以 tab 分隔：Iface Destination Gateway Flags RefCnt Use Metric Mask ...，
+ * 十六進位欄位為網路位元組順序；Destination 與 Mask 皆為 0 且已啟用的路由中取 Metric 最小者
+ */
+static void read_uplink_interface(void)
+{
+    ssize_t length = read_proc_file(g_route_fd, g_route_buffer, sizeof(g_route_buffer));
+    if (length < 0) {
+        return;
+    }
+
+    const char* end = g_route_buffer + length;
+    const char* p = skip_line(g_route_buffer, end);    /* 跳過標題 */
+    const char* best_name = NULL;
+    size_t best_length = 0;
+    uint64_t best_metric = UINT64_MAX;
+
+    while (p < end) {
+        const char* line_end = skip_line(p, end);
+        const char* fields[SYSSTAT_ROUTE_FIELDS];
+        size_t lengths[SYSSTAT_ROUTE_FIELDS];
+        size_t count = 0;
+
+        while (count < SYSSTAT_ROUTE_FIELDS && p < line_end) {
+            fields[count] = p;
+            while (p < line_end && *p != '\t' && *p != '\n') {
+                p++;
+            }
+            lengths[count] = (size_t)(p - fields[count]);
+            count++;
+            if (p < line_end && *p == '\t') {
+                p++;
+            }
+        }
+
+        uint32_t destination;
+        uint32_t flags;
+        uint32_t mask;
+        uint64_t metric;
+
+        if (count == SYSSTAT_ROUTE_FIELDS &&
+            parse_hex32(fields[1], lengths[1], &destination) && destination == 0 &&
+            parse_hex32(fields[3], lengths[3], &flags) && (flags & SYSSTAT_RTF_UP) &&
+            parse_hex32(fields[7], lengths[7], &mask) && mask == 0 &&
+            parse_u64(fields[6], fields[6] + lengths[6], &metric) != NULL &&
+            metric < best_metric &&
+            lengths[0] > 0 && lengths[0] < SYSSTAT_INTERFACE_NAME_LENGTH) {
+            best_name = fields[0];
+            best_length = lengths[0];
+            best_metric = metric;
+        }
+
+        p = line_end;
+    }
+
+    if (best_name == NULL ||
+        (strncmp(g_uplink_name, best_name, best_length) == 0 && g_uplink_name[best_length] == '\0')) {
+        return;
+    }
+
+    memcpy(g_uplink_name, best_name, best_length);
+    g_uplink_name[best_length] = '\0';
+    DMS_LOG_INFO("📶 Network statistics follow default route interface %s", g_uplink_name);
+}
+
+/**
+ * @brief 解析 /proc/net/route 的十六進位欄位
+ */
+static bool parse_hex32(const char* text, size_t length, uint32_t* value)
+{
+    uint32_t result = 0;
+
+    if (length == 0 || length > 8) {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        char c = text[i];
+        uint32_t digit;
+
+        if (c >= '0' && c <= '9') {
+            digit = (uint32_t)(c - '0');
+        } else if (c >= 'A' && c <= 'F') {
+            digit = (uint32_t)(c - 'A' + 10);
+        } else if (c >= 'a' && c <= 'f') {
+            digit = (uint32_t)(c - 'a' + 10);
+        } else {
+            return false;
+        }
+        result = (result << 4) | digit;
+    }
+
+    *value = result;
+    return true;
+}
+
+/**
+ * @brief 計算計數器增量
+ *
+ * 32 位元核心的 /proc/net/dev 計數器會在 4 GiB 回繞；
+ * 其他情況下計數器變小表示介面被重設，以新值作為增量
+ */
+static uint64_t counter_delta(uint64_t previous, uint64_t current)
+{
+    if (current >= previous) {
+        return current - previous;
+    }
+
+    if (previous <= UINT32_MAX) {
+        return (UINT32_MAX - previous) + current + 1;
+    }
+
+    return current;
+}
+
+/**
+ * @brief 尋找或配置網路介面槽位
+ */
+static sysstat_interface_t* find_interface(const char* name, size_t length)
+{
+    sysstat_interface_t* free_slot = NULL;
+
+    if (length == 0 || length >= SYSSTAT_INTERFACE_NAME_LENGTH) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < SYSSTAT_MAX_INTERFACES; i++) {
+        if (g_interfaces[i].used) {
+            if (strncmp(g_interfaces[i].name, name, length) == 0 &&
+                g_interfaces[i].name[length] == '\0') {
+                return &g_interfaces[i];
+            }
+        } else if (free_slot == NULL) {
+            free_slot = &g_interfaces[i];
+        }
+    }
+
+    if (free_slot != NULL) {
+        memcpy(free_slot->name, name, length);
+        free_slot->name[length] = '\0';
+    }
+    return free_slot;
+}
+
+/**
+ * @brief 檢查介面是否列入流量統計
+ *
+ * SYSSTAT_NET_INTERFACE 為空字串時使用預設路由所在的介面；尚未有預設路由時不統計任何介面
+ */
+static bool is_interface_selected(const char* name, size_t length)
+{
+    const char* selected = (SYSSTAT_NET_INTERFACE[0] != '\0') ? SYSSTAT_NET_INTERFACE : g_uplink_name;
+
+    return selected[0] != '\0' && strlen(selected) == length && strncmp(selected, name, length) == 0;
+}
+
+/**
+ * @brief 關閉檔案描述符
+ */
+static void close_fd(int* fd)
+{
+    if (*fd >= 0) {
+        close(*fd);
+        *fd = -1;
+    }
+}
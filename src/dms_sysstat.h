@@ -0,0 +1,112 @@
+
+/*
+ * DMS System Statistics Sampler
+ *
+ * 取代 updateSystemStats() 中的簡化統計（CPU 固定為 0、網路流量固定為 0）：
+ * - /proc/stat、/proc/meminfo、/proc/net/dev、/proc/uptime 在初始化時開啟並保持開啟
+ * - 每次取樣以 pread() 讀入固定緩衝區，解析過程不配置記憶體
+ * - CPU 使用率以兩次取樣間的差值計算，網路計數器處理 32 位元回繞
+ * - 記錄每次取樣的耗時，可用 dms_sysstat_get_cost() 查詢
+ * - /proc/net/wireless 存在時一併讀取無線訊號強度（RSSI）
+ * - 流量只統計單一介面：SYSSTAT_NET_INTERFACE 指定的介面，或 IPv4 預設路由所在的 WAN 介面，
+ *   避免橋接介面與其成員介面重複計算同一份流量
+ */
+
+#ifndef DMS_SYSSTAT_H_
+#define DMS_SYSSTAT_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "dms_log.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define SYSSTAT_PROC_STAT_PATH             "/proc/stat"
+#define SYSSTAT_PROC_MEMINFO_PATH          "/proc/meminfo"
+#define SYSSTAT_PROC_NET_DEV_PATH          "/proc/net/dev"
+#define SYSSTAT_PROC_UPTIME_PATH           "/proc/uptime"
+#define SYSSTAT_PROC_WIRELESS_PATH         "/proc/net/wireless"
+#define SYSSTAT_PROC_NET_ROUTE_PATH        "/proc/net/route"
+
+#define SYSSTAT_MAX_INTERFACES             ( 8U )
+#define SYSSTAT_INTERFACE_NAME_LENGTH      ( 16U )
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief 一次系統取樣結果
+ */
+typedef struct {
+    float cpu_usage;                // 與上次取樣間的 CPU 使用率 (%)
+    float memory_usage;             // (MemTotal - MemAvailable) / MemTotal (%)
+    uint32_t uptime_seconds;        // 系統運行時間
+    uint64_t net_rx_bytes;          // 累計接收位元組（已處理計數器回繞）
+    uint64_t net_tx_bytes;          // 累計傳送位元組（已處理計數器回繞）
+    uint64_t net_rx_bytes_per_sec;  // 與上次取樣間的接收速率
+    uint64_t net_tx_bytes_per_sec;  // 與上次取樣間的傳送速率
+    uint32_t interval_ms;           // 與上次取樣的間隔，第一次取樣為 0
+    int32_t wifi_rssi_dbm;          // 第一個無線介面的訊號強度 (dBm)
+    bool wifi_rssi_valid;           // 沒有無線介面或核心未提供 /proc/net/wireless 時為 false
+} dms_sysstat_sample_t;
+
+/**
+ * @brief 取樣成本統計
+ */
+typedef struct {
+    uint32_t sample_count;          // 取樣次數
+    uint32_t last_sample_us;        // 最近一次取樣耗時
+    uint32_t max_sample_us;         // 最長取樣耗時
+    uint32_t avg_sample_us;         // 平均取樣耗時
+    uint32_t read_errors;           // 讀取或解析失敗次數
+} dms_sysstat_cost_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 初始化系統統計取樣器
+ *
+ * 開啟 /proc 檔案並保存第一次取樣作為差值基準；/proc/net/wireless 為選用
+ *
+ * @return DMS_SUCCESS 成功，DMS_ERROR_SYSTEM_FILE_ACCESS 無法開啟 /proc 檔案
+ */
+dms_result_t dms_sysstat_init(void);
+
+/**
+ * @brief 進行一次取樣
+ *
+ * 差值（CPU 使用率、網路速率）以上一次取樣為基準
+ *
+ * @param sample 輸出取樣結果
+ * @return DMS_SUCCESS 成功，其他為錯誤碼
+ */
+dms_result_t dms_sysstat_sample(dms_sysstat_sample_t* sample);
+
+/**
+ * @brief 獲取最近一次取樣結果，不重新讀取 /proc
+ *
+ * @param sample 輸出取樣結果
+ * @return true 有可用的取樣，false 尚未取樣
+ */
+bool dms_sysstat_get_last(dms_sysstat_sample_t* sample);
+
+/**
+ * @brief 獲取取樣成本統計
+ *
+ * @param cost 輸出統計資訊
+ */
+void dms_sysstat_get_cost(dms_sysstat_cost_t* cost);
+
+/**
+ * @brief 清理系統統計取樣器，關閉 /proc 檔案
+ */
+void dms_sysstat_cleanup(void);
+
+#endif /* DMS_SYSSTAT_H_ */
@@ -0,0 +1,391 @@
+/*
+ * DMS Telemetry Module Implementation
+ *
+ * 所有狀態都是固定大小的靜態陣列：TELEMETRY_RING_CAPACITY 個區間加上一個發布緩衝區，
+ * 斷線期間資料量不會增長，只會覆寫最舊的區間。
+ */
+
+#include "dms_telemetry.h"
+#include "dms_sysstat.h"
+#include "dms_json_writer.h"
+#include "clock.h"
+
+/* 系統標頭檔 */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*-----------------------------------------------------------*/
+/* 內部類型與常數 */
+
+/**
+ * @brief 指標描述 - 訊息中的欄位名稱與小數位數
+ */
+typedef struct {
+    const char* name;
+    int precision;
+} telemetry_metric_desc_t;
+
+static const telemetry_metric_desc_t g_metric_desc[TELEMETRY_METRIC_COUNT] = {
+    [TELEMETRY_METRIC_CPU]     = { "cpu",    1 },
+    [TELEMETRY_METRIC_MEMORY]  = { "mem",    1 },
+    [TELEMETRY_METRIC_RSSI]    = { "rssi",   1 },
+    [TELEMETRY_METRIC_RX_RATE] = { "rx_bps", 0 },
+    [TELEMETRY_METRIC_TX_RATE] = { "tx_bps", 0 }
+};
+
+/*-----------------------------------------------------------*/
+/* 內部全域變數 */
+
+static mqtt_interface_t g_mqtt_interface = {0};
+static dms_telemetry_config_t g_config = {0};
+static bool g_initialized = false;
+
+/* 環形緩衝區：g_ring_head 為下一個寫入位置，最舊的未發布區間在 head - pending */
+static telemetry_bucket_t g_ring[TELEMETRY_RING_CAPACITY];
+static uint32_t g_ring_head = 0;
+static uint32_t g_ring_pending = 0;
+static uint32_t g_dropped_since_publish = 0;
+
+static telemetry_bucket_t g_current = {0};
+static bool g_current_open = false;
+
+static uint32_t g_last_sample_ms = 0;
+static uint32_t g_last_publish_ms = 0;
+static bool g_draining = false;
+
+static char g_payload[TELEMETRY_PAYLOAD_SIZE];
+static telemetry_stats_t g_stats = {0};
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static void take_sample(void);
+static void open_bucket(uint32_t start_time);
+static void close_bucket(void);
+static void aggregate_add(telemetry_aggregate_t* aggregate, float value);
+static bool publish_batch(void);
+static size_t build_batch_payload(uint32_t* bucket_count);
+static void write_bucket(dms_json_writer_t* writer, const telemetry_bucket_t* bucket);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 初始化遙測模組
+ */
+dms_result_t dms_telemetry_init(const mqtt_interface_t* mqtt_if)
+{
+    if (mqtt_if == NULL || mqtt_if->publish == NULL || mqtt_if->is_connected == NULL) {
+        DMS_LOG_ERROR("❌ Invalid MQTT interface for telemetry");
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    const dms_telemetry_config_t* config = dms_config_get_telemetry();
+    if (config == NULL) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    memset(g_ring, 0, sizeof(g_ring));
+    memset(&g_current, 0, sizeof(g_current));
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_ring_head = 0;
+    g_ring_pending = 0;
+    g_dropped_since_publish = 0;
+    g_current_open = false;
+    g_draining = false;
+
+    g_mqtt_interface = *mqtt_if;
+    g_config = *config;
+
+    if (!g_config.enabled) {
+        DMS_LOG_INFO("Telemetry disabled by configuration");
+        return DMS_SUCCESS;
+    }
+
+    g_last_sample_ms = Clock_GetTimeMs() - g_config.sample_interval_ms;
+    g_last_publish_ms = Clock_GetTimeMs();
+    g_initialized = true;
+
+    DMS_LOG_INFO("✅ Telemetry initialized (sample %u ms, bucket %u s, publish every %u s, %u buckets)",
+                 g_config.sample_interval_ms, g_config.bucket_seconds,
+                 g_config.publish_interval_seconds, (unsigned)TELEMETRY_RING_CAPACITY);
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 處理遙測取樣與發布
+ */
+void dms_telemetry_process(void)
+{
+    if (!g_initialized) {
+        return;
+    }
+
+    uint32_t now_ms = Clock_GetTimeMs();
+
+    if (now_ms - g_last_sample_ms >= g_config.sample_interval_ms) {
+        g_last_sample_ms = now_ms;
+        take_sample();
+    }
+
+    if (!g_draining &&
+        now_ms - g_last_publish_ms >= SECONDS_TO_MS((uint32_t)g_config.publish_interval_seconds)) {
+        g_last_publish_ms = now_ms;
+        g_draining = (g_ring_pending > 0);
+    }
+
+    /* 每次調用最多發布一則訊息，積壓的區間分散在後續循環中送出 */
+    if (g_draining) {
+        if (!g_mqtt_interface.is_connected()) {
+            return;                 /* 斷線時保留資料，重新連線後繼續 */
+        }
+
+        if (!publish_batch() || g_ring_pending == 0) {
+            g_draining = false;
+        }
+    }
+}
+
+/**
+ * @brief 獲取遙測統計資訊
+ */
+void dms_telemetry_get_stats(telemetry_stats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = g_stats;
+        stats->buckets_pending = g_ring_pending;
+    }
+}
+
+/**
+ * @brief 清理遙測模組
+ */
+void dms_telemetry_cleanup(void)
+{
+    if (!g_initialized) {
+        return;
+    }
+
+    if (g_mqtt_interface.is_connected()) {
+        if (g_current_open && g_current.sample_count > 0) {
+            close_bucket();
+        }
+        while (g_ring_pending > 0 && publish_batch()) {
+        }
+    }
+
+    if (g_ring_pending > 0) {
+        DMS_LOG_WARN("⚠️ Discarding %u unpublished telemetry buckets", g_ring_pending);
+    }
+
+    g_initialized = false;
+    g_current_open = false;
+    g_ring_pending = 0;
+    DMS_LOG_INFO("Telemetry cleanup completed (%u buckets published, %u dropped)",
+                 g_stats.buckets_published, g_stats.buckets_dropped);
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 取樣一次並累加到目前區間
+ *
+ * 區間以 epoch 時間對齊；時間跳動（例如開機後 NTP 校時）時直接結束目前區間
+ */
+static void take_sample(void)
+{
+    dms_sysstat_sample_t sample;
+    if (dms_sysstat_sample(&sample) != DMS_SUCCESS) {
+        g_stats.sample_errors++;
+        return;
+    }
+    g_stats.samples_taken++;
+
+    uint32_t now = (uint32_t)time(NULL);
+    uint32_t bucket_start = now - (now % g_config.bucket_seconds);
+
+    if (g_current_open && g_current.start_time != bucket_start) {
+        close_bucket();
+    }
+    if (!g_current_open) {
+        open_bucket(bucket_start);
+    }
+
+    g_current.sample_count++;
+    aggregate_add(&g_current.metrics[TELEMETRY_METRIC_CPU], sample.cpu_usage);
+    aggregate_add(&g_current.metrics[TELEMETRY_METRIC_MEMORY], sample.memory_usage);
+    if (sample.wifi_rssi_valid) {
+        aggregate_add(&g_current.metrics[TELEMETRY_METRIC_RSSI], (float)sample.wifi_rssi_dbm);
+    }
+
+    /* 第一次取樣沒有間隔，速率無意義 */
+    if (sample.interval_ms > 0) {
+        aggregate_add(&g_current.metrics[TELEMETRY_METRIC_RX_RATE], (float)sample.net_rx_bytes_per_sec);
+        aggregate_add(&g_current.metrics[TELEMETRY_METRIC_TX_RATE], (float)sample.net_tx_bytes_per_sec);
+    }
+}
+
+/**
+ * @brief 開始新的區間
+ */
+static void open_bucket(uint32_t start_time)
+{
+    memset(&g_current, 0, sizeof(g_current));
+    g_current.start_time = start_time;
+    g_current_open = true;
+}
+
+/**
+ * @brief 結束目前區間並寫入環形緩衝區
+ *
+ * 緩衝區已滿時覆寫最舊的未發布區間
+ */
+static void close_bucket(void)
+{
+    g_ring[g_ring_head] = g_current;
+    g_ring_head = (g_ring_head + 1) % TELEMETRY_RING_CAPACITY;
+
+    if (g_ring_pending == TELEMETRY_RING_CAPACITY) {
+        g_stats.buckets_dropped++;
+        g_dropped_since_publish++;
+    } else {
+        g_ring_pending++;
+    }
+
+    g_stats.buckets_closed++;
+    g_current_open = false;
+}
+
+/**
+ * @brief 累加一個取樣值
+ */
+static void aggregate_add(telemetry_aggregate_t* aggregate, float value)
+{
+    if (aggregate->count == 0 || value < aggregate->min) {
+        aggregate->min = value;
+    }
+    if (aggregate->count == 0 || value > aggregate->max) {
+        aggregate->max = value;
+    }
+    aggregate->sum += value;
+    aggregate->count++;
+}
+
+/**
+ * @brief 發布一批最舊的未發布區間
+ *
+ * @return true 發布成功，false 失敗（資料保留到下一個發布週期）
+ */
+static bool publish_batch(void)
+{
+    uint32_t bucket_count = 0;
+    size_t length = build_batch_payload(&bucket_count);
+
+    if (length == 0 || bucket_count == 0) {
+        DMS_LOG_ERROR("❌ Failed to build telemetry payload");
+        g_stats.publish_failures++;
+        return false;
+    }
+
+    if (g_mqtt_interface.publish(PUBLISH_TOPIC, g_payload, length) != DMS_SUCCESS) {
+        DMS_LOG_WARN("⚠️ Failed to publish telemetry batch (%u buckets pending)", g_ring_pending);
+        g_stats.publish_failures++;
+        return false;
+    }
+
+    g_ring_pending -= bucket_count;
+    g_dropped_since_publish = 0;
+    g_stats.buckets_published += bucket_count;
+    g_stats.messages_published++;
+
+    DMS_LOG_DEBUG("Telemetry batch published: %u buckets, %zu bytes, %u pending",
+                  bucket_count, length, g_ring_pending);
+    return true;
+}
+
+/**
+ * @brief 將最舊的未發布區間編碼為一則訊息
+ *
+ * 格式：{"device_id":"...","type":"telemetry","bucket_s":60,"dropped":0,
+ *        "fields":["cpu",...],"buckets":[[t,n,min,avg,max,...],...]}
+ * 每個指標依序輸出 min、avg、max，沒有取樣時為 null
+ *
+ * @param bucket_count 輸出已編碼的區間數
+ * @return 訊息長度，失敗返回 0
+ */
+static size_t build_batch_payload(uint32_t* bucket_count)
+{
+    dms_json_writer_t writer;
+
+    *bucket_count = 0;
+
+    dms_json_writer_init(&writer, g_payload, sizeof(g_payload));
+    dms_json_begin_object(&writer);
+    dms_json_kv_string(&writer, "device_id", CLIENT_IDENTIFIER);
+    dms_json_kv_string(&writer, "type", "telemetry");
+    dms_json_kv_uint(&writer, "bucket_s", g_config.bucket_seconds);
+    dms_json_kv_uint(&writer, "dropped", g_dropped_since_publish);
+    dms_json_key(&writer, "fields");
+    dms_json_begin_array(&writer);
+    for (size_t i = 0; i < TELEMETRY_METRIC_COUNT; i++) {
+        dms_json_string(&writer, g_metric_desc[i].name);
+    }
+    dms_json_end_array(&writer);
+    dms_json_key(&writer, "buckets");
+    dms_json_begin_array(&writer);
+
+    /* 預留結尾 "]}" 的空間 */
+    const size_t closing_length = 2;
+    uint32_t oldest = (g_ring_head + TELEMETRY_RING_CAPACITY - g_ring_pending) % TELEMETRY_RING_CAPACITY;
+
+    while (*bucket_count < g_ring_pending && *bucket_count < g_config.max_buckets_per_publish) {
+        dms_json_writer_t mark = writer;
+        const telemetry_bucket_t* bucket = &g_ring[(oldest + *bucket_count) % TELEMETRY_RING_CAPACITY];
+
+        write_bucket(&writer, bucket);
+        if (writer.error != DMS_SUCCESS ||
+            dms_json_writer_length(&writer) + closing_length >= sizeof(g_payload)) {
+            writer = mark;          /* 放不下的區間留給下一則訊息 */
+            break;
+        }
+        (*bucket_count)++;
+    }
+
+    dms_json_end_array(&writer);
+    dms_json_end_object(&writer);
+
+    if (*bucket_count == 0 || dms_json_writer_finish(&writer) != DMS_SUCCESS) {
+        return 0;
+    }
+
+    return dms_json_writer_length(&writer);
+}
+
+/**
+ * @brief 將一個區間編碼為陣列
+ */
+static void write_bucket(dms_json_writer_t* writer, const telemetry_bucket_t* bucket)
+{
+    dms_json_begin_array(writer);
+    dms_json_uint(writer, bucket->start_time);
+    dms_json_uint(writer, bucket->sample_count);
+
+    for (size_t i = 0; i < TELEMETRY_METRIC_COUNT; i++) {
+        const telemetry_aggregate_t* aggregate = &bucket->metrics[i];
+        int precision = g_metric_desc[i].precision;
+
+        if (aggregate->count == 0) {
+            dms_json_null(writer);
+            dms_json_null(writer);
+            dms_json_null(writer);
+        } else {
+            dms_json_double(writer, (double)aggregate->min, precision);
+            dms_json_double(writer, (double)(aggregate->sum / (float)aggregate->count), precision);
+            dms_json_double(writer, (double)aggregate->max, precision);
+        }
+    }
+
+    dms_json_end_array(writer);
+}
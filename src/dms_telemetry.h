@@ -0,0 +1,112 @@
+
+/*
+ * DMS Telemetry Module
+ *
+ * 裝置端遙測時間序列：
+ * - 以 dms_sysstat 高頻取樣 CPU、記憶體、RSSI 與網路速率
+ * - 每個區間降採樣為 min/avg/max，存入固定大小的環形緩衝區
+ * - 依配置的間隔將已完成的區間批次發布到 PUBLISH_TOPIC，斷線時保留不發布
+ * - 緩衝區滿時覆寫最舊的未發布區間並計數，下一則訊息會回報遺失數量
+ */
+
+#ifndef DMS_TELEMETRY_H_
+#define DMS_TELEMETRY_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "dms_log.h"
+#include "dms_aws_iot.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define TELEMETRY_METRIC_COUNT             ( 5U )
+#define TELEMETRY_PAYLOAD_SIZE             ( 2048U )
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief 遙測指標索引，順序即訊息中 "fields" 的順序
+ */
+typedef enum {
+    TELEMETRY_METRIC_CPU = 0,       // CPU 使用率 (%)
+    TELEMETRY_METRIC_MEMORY,        // 記憶體使用率 (%)
+    TELEMETRY_METRIC_RSSI,          // 無線訊號強度 (dBm)
+    TELEMETRY_METRIC_RX_RATE,       // 接收速率 (bytes/s)
+    TELEMETRY_METRIC_TX_RATE        // 傳送速率 (bytes/s)
+} telemetry_metric_t;
+
+/**
+ * @brief 單一指標在一個區間內的彙總
+ */
+typedef struct {
+    float min;
+    float max;
+    float sum;
+    uint16_t count;                 // 0 表示此區間沒有有效取樣（例如沒有無線介面）
+} telemetry_aggregate_t;
+
+/**
+ * @brief 降採樣區間
+ */
+typedef struct {
+    uint32_t start_time;            // 區間開始時間 (epoch 秒，對齊區間長度)
+    uint16_t sample_count;
+    telemetry_aggregate_t metrics[TELEMETRY_METRIC_COUNT];
+} telemetry_bucket_t;
+
+/**
+ * @brief 遙測統計資訊
+ */
+typedef struct {
+    uint32_t samples_taken;         // 成功取樣次數
+    uint32_t sample_errors;         // 取樣失敗次數
+    uint32_t buckets_closed;        // 已完成的區間數
+    uint32_t buckets_published;     // 已發布的區間數
+    uint32_t buckets_dropped;       // 未發布即被覆寫的區間數
+    uint32_t buckets_pending;       // 目前等待發布的區間數
+    uint32_t messages_published;    // 已發布的訊息數
+    uint32_t publish_failures;      // 發布失敗次數
+} telemetry_stats_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 初始化遙測模組
+ *
+ * 需要在 dms_shadow_init() 之後調用（系統統計取樣器由 Shadow 模組初始化）
+ *
+ * @param mqtt_if MQTT 介面
+ * @return DMS_SUCCESS 成功（配置停用時不做任何事），其他為錯誤碼
+ */
+dms_result_t dms_telemetry_init(const mqtt_interface_t* mqtt_if);
+
+/**
+ * @brief 處理遙測取樣與發布
+ *
+ * 由主循環定期調用；斷線時仍持續取樣，只有發布會延後
+ */
+void dms_telemetry_process(void);
+
+/**
+ * @brief 獲取遙測統計資訊
+ *
+ * @param stats 輸出統計資訊
+ */
+void dms_telemetry_get_stats(telemetry_stats_t* stats);
+
+/**
+ * @brief 清理遙測模組
+ *
+ * 連線中時先關閉目前區間並盡力發布剩餘資料
+ */
+void dms_telemetry_cleanup(void);
+
+#endif /* DMS_TELEMETRY_H_ */
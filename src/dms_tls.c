@@ -0,0 +1,461 @@
+
+/*
+ * DMS TLS Transport Module Implementation
+ *
+ * 以 Sockets_Connect() + OpenSSL 建立 TLS 連線，流程與 SDK 的 Openssl_Connect()
+ * 相同，額外加入 TLS session 快取：
+ * - SSL_CTX 設定 client session cache，新 session 透過回調取得
+ * - 重連時以 SSL_set_session() 提供快取 session 的副本
+ * - 快取與連線使用不同的 SSL_SESSION 物件：連線異常中斷時 SSL_free() 會把
+ *   所用的 session 標記為不可恢復，使用副本可避免快取被污染
+ * - TLS 1.3 的 session ticket 於握手後才送達，回調在 Openssl_Recv() 期間觸發
+ *
+ * TCP 連線建立後設定 keepalive 與 TCP_USER_TIMEOUT，半開連線會在
+ * dead_link_timeout_seconds 內由核心回報錯誤，不必等到 MQTT keepalive 逾時
+ */
+
+#include "dms_tls.h"
+#include "dms_credentials.h"
+
+/* 系統標頭檔 */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+/* AWS IoT SDK includes */
+#include "clock.h"
+
+#ifdef USE_OPENSSL
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+/*-----------------------------------------------------------*/
+/* 內部常數 */
+
+#define TLS_SESSION_FILE_MAX_SIZE          ( 8192U )
+
+/*-----------------------------------------------------------*/
+/* 內部全域變數 */
+
+static bool g_tls_initialized = false;
+static bool g_resumption_enabled = true;
+static char g_session_cache_path[256] = {0};
+static uint32_t g_dead_link_timeout_s = MQTT_DEAD_LINK_TIMEOUT_SECONDS;
+
+static dms_tls_stats_t g_tls_stats = {0};
+static uint64_t g_full_handshake_ms_total = 0;
+static uint64_t g_resumed_handshake_ms_total = 0;
+
+#ifdef USE_OPENSSL
+static SSL_SESSION* g_cached_session = NULL;
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static SSL_CTX* create_ssl_context(const OpensslCredentials_t* credentials);
+static int on_new_session(SSL* ssl, SSL_SESSION* session);
+static void replace_cached_session(SSL_SESSION* session);
+static void save_session_to_file(SSL_SESSION* session);
+static void load_session_from_file(void);
+static void record_handshake(uint32_t elapsed_ms, bool resumed);
+static void apply_liveness_options(int32_t socket_fd);
+static OpensslStatus_t convert_socket_status(SocketStatus_t status);
+#endif
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 初始化 TLS 傳輸模組
+ */
+dms_result_t dms_tls_init(const dms_aws_iot_config_t* config)
+{
+    if (config == NULL) {
+        return DMS_ERROR_INVALID_PARAMETER;
+    }
+
+    g_resumption_enabled = config->tls_session_resumption;
+    g_dead_link_timeout_s = config->dead_link_timeout_seconds;
+    SAFE_STRNCPY(g_session_cache_path, config->tls_session_cache_path,
+                 sizeof(g_session_cache_path));
+
+#ifdef USE_OPENSSL
+    if (g_resumption_enabled && g_cached_session == NULL && g_session_cache_path[0] != '\0') {
+        load_session_from_file();
+    }
+#endif
+
+    g_tls_initialized = true;
+    DMS_LOG_TLS("✅ TLS transport initialized (session resumption: %s, cache file: %s)",
+                g_resumption_enabled ? "enabled" : "disabled",
+                g_session_cache_path[0] != '\0' ? g_session_cache_path : "none");
+
+    return DMS_SUCCESS;
+}
+
+#ifdef USE_OPENSSL
+/**
+ * @brief 建立 TLS 連線
+ */
+OpensslStatus_t dms_tls_connect(NetworkContext_t* pNetworkContext,
+                                const ServerInfo_t* pServerInfo,
+                                const OpensslCredentials_t* pOpensslCredentials,
+                                uint32_t sendTimeoutMs,
+                                uint32_t recvTimeoutMs)
+{
+    if (pNetworkContext == NULL || pNetworkContext->pParams == NULL ||
+        pServerInfo == NULL || pOpensslCredentials == NULL) {
+        DMS_LOG_ERROR("❌ Invalid parameters for TLS connect");
+        return OPENSSL_INVALID_PARAMETER;
+    }
+
+    OpensslParams_t* pParams = pNetworkContext->pParams;
+
+    /* 步驟1：建立 TCP 連線 - 與 Openssl_Connect() 相同 */
+    SocketStatus_t socketStatus = Sockets_Connect(&pParams->socketDescriptor,
+                                                  pServerInfo,
+                                                  sendTimeoutMs,
+                                                  recvTimeoutMs);
+    if (socketStatus != SOCKETS_SUCCESS) {
+        DMS_LOG_ERROR("❌ TCP connection failed (status: %d)", socketStatus);
+        return convert_socket_status(socketStatus);
+    }
+
+    apply_liveness_options(pParams->socketDescriptor);
+
+    /* 步驟2：建立 SSL 物件 */
+    SSL_CTX* ctx = create_ssl_context(pOpensslCredentials);
+    if (ctx == NULL) {
+        Sockets_Disconnect(pParams->socketDescriptor);
+        return OPENSSL_INVALID_CREDENTIALS;
+    }
+
+    pParams->pSsl = SSL_new(ctx);
+    SSL_CTX_free(ctx);  /* SSL 物件持有共用 SSL_CTX 的參考 */
+
+    if (pParams->pSsl == NULL) {
+        DMS_LOG_ERROR("❌ SSL_new failed");
+        Sockets_Disconnect(pParams->socketDescriptor);
+        return OPENSSL_API_ERROR;
+    }
+
+    SSL_set_verify(pParams->pSsl, SSL_VERIFY_PEER, NULL);
+    SSL_set_fd(pParams->pSsl, pParams->socketDescriptor);
+
+    if (pOpensslCredentials->sniHostName != NULL) {
+        SSL_set_tlsext_host_name(pParams->pSsl, pOpensslCredentials->sniHostName);
+    }
+
+    if (pOpensslCredentials->pAlpnProtos != NULL && pOpensslCredentials->alpnProtosLen > 0) {
+        SSL_set_alpn_protos(pParams->pSsl,
+                            (const unsigned char*)pOpensslCredentials->pAlpnProtos,
+                            (unsigned int)pOpensslCredentials->alpnProtosLen);
+    }
+
+    /* 最大傳送分段與讀取緩衝區 - 與 Openssl_Connect() 相同，設定失敗不影響連線 */
+    if (pOpensslCredentials->maxFragmentLength > 0U) {
+        if (SSL_set_max_send_fragment(pParams->pSsl,
+                                      (long)pOpensslCredentials->maxFragmentLength) != 1) {
+            DMS_LOG_WARN("⚠️ Failed to set max send fragment length %u",
+                         (unsigned int)pOpensslCredentials->maxFragmentLength);
+        } else {
+            SSL_set_default_read_buffer_len(pParams->pSsl,
+                                            (size_t)pOpensslCredentials->maxFragmentLength +
+                                            SSL3_RT_MAX_ENCRYPTED_OVERHEAD);
+        }
+    }
+
+    /* 步驟3：提供快取的 session */
+    bool offered = false;
+    if (g_resumption_enabled && g_cached_session != NULL) {
+        SSL_SESSION* offer = SSL_SESSION_dup(g_cached_session);
+        if (offer != NULL) {
+            offered = (SSL_set_session(pParams->pSsl, offer) == 1);
+            SSL_SESSION_free(offer);  /* SSL 物件持有自己的參考 */
+        }
+    }
+
+    /* 步驟4：TLS 握手並計時 */
+    uint32_t start_ms = Clock_GetTimeMs();
+    int sslStatus = SSL_connect(pParams->pSsl);
+    uint32_t elapsed_ms = Clock_GetTimeMs() - start_ms;
+
+    if (sslStatus != 1 || SSL_get_verify_result(pParams->pSsl) != X509_V_OK) {
+        DMS_LOG_ERROR("❌ TLS handshake failed after %u ms (ssl error: %d)",
+                      elapsed_ms, SSL_get_error(pParams->pSsl, sslStatus));
+        SSL_free(pParams->pSsl);
+        pParams->pSsl = NULL;
+        Sockets_Disconnect(pParams->socketDescriptor);
+        g_tls_stats.failed_count++;
+
+        /* 快取的 session 可能已失效，下次改為完整握手 */
+        if (offered) {
+            replace_cached_session(NULL);
+        }
+        return OPENSSL_HANDSHAKE_FAILED;
+    }
+
+    bool resumed = (SSL_session_reused(pParams->pSsl) == 1);
+    record_handshake(elapsed_ms, resumed);
+
+    DMS_LOG_TLS("🔐 TLS handshake %s in %u ms (resumption rate: %.1f%%)",
+                resumed ? "resumed" : (offered ? "full (session rejected)" : "full"),
+                elapsed_ms, g_tls_stats.resumption_rate * 100.0f);
+
+    return OPENSSL_SUCCESS;
+}
+#endif
+
+/**
+ * @brief 獲取 TLS 握手統計資訊
+ */
+void dms_tls_get_stats(dms_tls_stats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = g_tls_stats;
+    }
+}
+
+/**
+ * @brief 清理 TLS 傳輸模組
+ *
+ * 保留磁碟上的 session 檔案，供下次啟動時恢復
+ */
+void dms_tls_cleanup(void)
+{
+    if (!g_tls_initialized) {
+        return;
+    }
+
+#ifdef USE_OPENSSL
+    replace_cached_session(NULL);
+#endif
+    memset(&g_tls_stats, 0, sizeof(g_tls_stats));
+    g_full_handshake_ms_total = 0;
+    g_resumed_handshake_ms_total = 0;
+    g_tls_initialized = false;
+
+    DMS_LOG_DEBUG("TLS transport cleanup completed");
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+#ifdef USE_OPENSSL
+/**
+ * @brief 取得共用 SSL_CTX 並設定 session 快取
+ *
+ * 憑證由憑證管理模組解析一次後共用，這裡只設定 session 相關選項
+ */
+static SSL_CTX* create_ssl_context(const OpensslCredentials_t* credentials)
+{
+    SSL_CTX* ctx = dms_credentials_acquire_ssl_ctx(credentials->pRootCaPath,
+                                                   credentials->pClientCertPath,
+                                                   credentials->pPrivateKeyPath);
+    if (ctx == NULL) {
+        return NULL;
+    }
+
+    /* 只使用外部快取，由 on_new_session 保存 session */
+    if (g_resumption_enabled) {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT |
+                                            SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(ctx, on_new_session);
+    } else {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+        SSL_CTX_sess_set_new_cb(ctx, NULL);
+    }
+
+    return ctx;
+}
+
+/**
+ * @brief 新 session 回調
+ *
+ * 保存 session 副本，原物件仍由連線使用
+ *
+ * @return 0 表示不取得原 session 的所有權
+ */
+static int on_new_session(SSL* ssl, SSL_SESSION* session)
+{
+    (void)ssl;
+
+    if (!SSL_SESSION_is_resumable(session)) {
+        return 0;
+    }
+
+    SSL_SESSION* copy = SSL_SESSION_dup(session);
+    if (copy == NULL) {
+        return 0;
+    }
+
+    replace_cached_session(copy);
+    save_session_to_file(copy);
+
+    DMS_LOG_DEBUG("TLS session cached (lifetime: %ld s)", (long)SSL_SESSION_get_timeout(copy));
+    return 0;
+}
+
+/**
+ * @brief 替換快取的 session，NULL 表示清除
+ */
+static void replace_cached_session(SSL_SESSION* session)
+{
+    if (g_cached_session != NULL) {
+        SSL_SESSION_free(g_cached_session);
+    }
+    g_cached_session = session;
+}
+
+/**
+ * @brief 將 session 寫入快取檔案
+ *
+ * 檔案內含 session 金鑰材料，僅允許擁有者讀寫
+ */
+static void save_session_to_file(SSL_SESSION* session)
+{
+    if (g_session_cache_path[0] == '\0') {
+        return;
+    }
+
+    int length = i2d_SSL_SESSION(session, NULL);
+    if (length <= 0 || (size_t)length > TLS_SESSION_FILE_MAX_SIZE) {
+        return;
+    }
+
+    unsigned char buffer[TLS_SESSION_FILE_MAX_SIZE];
+    unsigned char* p = buffer;
+    i2d_SSL_SESSION(session, &p);
+
+    char tmp_path[sizeof(g_session_cache_path) + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", g_session_cache_path);
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        DMS_LOG_WARN("⚠️ Failed to open TLS session cache file");
+        return;
+    }
+
+    bool ok = (write(fd, buffer, (size_t)length) == length);
+    close(fd);
+
+    if (!ok || rename(tmp_path, g_session_cache_path) != 0) {
+        DMS_LOG_WARN("⚠️ Failed to write TLS session cache file");
+        unlink(tmp_path);
+    }
+}
+
+/**
+ * @brief 從快取檔案載入 session，過期的 session 直接丟棄
+ */
+static void load_session_from_file(void)
+{
+    FILE* fp = fopen(g_session_cache_path, "rb");
+    if (fp == NULL) {
+        return;
+    }
+
+    unsigned char buffer[TLS_SESSION_FILE_MAX_SIZE];
+    size_t length = fread(buffer, 1, sizeof(buffer), fp);
+    fclose(fp);
+
+    const unsigned char* p = buffer;
+    SSL_SESSION* session = d2i_SSL_SESSION(NULL, &p, (long)length);
+    if (session == NULL) {
+        DMS_LOG_WARN("⚠️ Invalid TLS session cache file, ignoring");
+        return;
+    }
+
+    time_t expires = (time_t)SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session);
+    if (!SSL_SESSION_is_resumable(session) || expires <= time(NULL)) {
+        DMS_LOG_DEBUG("Cached TLS session expired, ignoring");
+        SSL_SESSION_free(session);
+        return;
+    }
+
+    replace_cached_session(session);
+    DMS_LOG_TLS("📋 Loaded cached TLS session from %s", g_session_cache_path);
+}
+
+/**
+ * @brief 更新握手統計
+ */
+static void record_handshake(uint32_t elapsed_ms, bool resumed)
+{
+    g_tls_stats.handshake_count++;
+    g_tls_stats.last_handshake_ms = elapsed_ms;
+
+    if (resumed) {
+        g_tls_stats.resumed_count++;
+        g_resumed_handshake_ms_total += elapsed_ms;
+        g_tls_stats.avg_resumed_handshake_ms =
+            (uint32_t)(g_resumed_handshake_ms_total / g_tls_stats.resumed_count);
+    } else {
+        uint32_t full_count = g_tls_stats.handshake_count - g_tls_stats.resumed_count;
+        g_full_handshake_ms_total += elapsed_ms;
+        g_tls_stats.avg_full_handshake_ms = (uint32_t)(g_full_handshake_ms_total / full_count);
+    }
+
+    g_tls_stats.resumption_rate =
+        (float)g_tls_stats.resumed_count / (float)g_tls_stats.handshake_count;
+}
+
+/**
+ * @brief 設定核心層連線存活偵測
+ *
+ * 閒置 timeout/2 後開始送 keepalive，每 timeout/6 一次、共 3 次無回應即斷線；
+ * TCP_USER_TIMEOUT 限制已送出資料未被確認的最長時間。兩者都以
+ * g_dead_link_timeout_s 為上限，設定失敗只記錄警告
+ */
+static void apply_liveness_options(int32_t socket_fd)
+{
+    int enable = 1;
+    int idle = (int)MAX(1U, g_dead_link_timeout_s / 2U);
+    int interval = (int)MAX(1U, g_dead_link_timeout_s / 6U);
+    int count = 3;
+    unsigned int user_timeout_ms = g_dead_link_timeout_s * 1000U;
+
+    if (setsockopt(socket_fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable)) != 0 ||
+        setsockopt(socket_fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle)) != 0 ||
+        setsockopt(socket_fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval)) != 0 ||
+        setsockopt(socket_fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count)) != 0) {
+        DMS_LOG_WARN("⚠️ Failed to enable TCP keepalive on MQTT socket");
+    }
+
+#ifdef TCP_USER_TIMEOUT
+    if (setsockopt(socket_fd, IPPROTO_TCP, TCP_USER_TIMEOUT,
+                   &user_timeout_ms, sizeof(user_timeout_ms)) != 0) {
+        DMS_LOG_WARN("⚠️ Failed to set TCP_USER_TIMEOUT on MQTT socket");
+    }
+#else
+    (void)user_timeout_ms;
+#endif
+
+    DMS_LOG_DEBUG("TCP liveness: keepidle=%ds keepintvl=%ds keepcnt=%d user_timeout=%ums",
+                  idle, interval, count, user_timeout_ms);
+}
+
+/**
+ * @brief 將 Sockets 狀態轉換為 OpenSSL 傳輸狀態 - 與 Openssl_Connect() 相同
+ */
+static OpensslStatus_t convert_socket_status(SocketStatus_t status)
+{
+    switch (status) {
+        case SOCKETS_INVALID_PARAMETER:
+            return OPENSSL_INVALID_PARAMETER;
+        case SOCKETS_DNS_FAILURE:
+            return OPENSSL_DNS_FAILURE;
+        case SOCKETS_CONNECT_FAILURE:
+            return OPENSSL_CONNECT_FAILURE;
+        default:
+            return OPENSSL_API_ERROR;
+    }
+}
+#endif
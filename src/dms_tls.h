@@ -0,0 +1,99 @@
+
+/*
+ * DMS TLS Transport Module
+ *
+ * 取代 Openssl_Connect() 的 TLS 連線建立，介面與 SDK 完全相容：
+ * - 連線完成後填入 OpensslParams_t，Openssl_Send/Recv/Disconnect 照常使用
+ * - 快取 TLS session（session ticket 或 session ID），重連時優先嘗試恢復
+ * - 可選擇將 session 寫入檔案，程序重啟後仍可恢復
+ * - 統計握手時間與 session 恢復率
+ */
+
+#ifndef DMS_TLS_H_
+#define DMS_TLS_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "dms_log.h"
+
+#ifdef USE_OPENSSL
+#include "openssl_posix.h"
+
+/* NetworkContext 定義 - 與 dms_aws_iot.h 相同 */
+#ifndef NETWORKCONTEXT_DEFINED
+#define NETWORKCONTEXT_DEFINED
+struct NetworkContext
+{
+    OpensslParams_t * pParams;
+};
+#endif /* NETWORKCONTEXT_DEFINED */
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief TLS 握手統計資訊
+ */
+typedef struct {
+    uint32_t handshake_count;           // 成功握手次數
+    uint32_t resumed_count;             // 以 session 恢復完成的握手次數
+    uint32_t failed_count;              // 握手失敗次數
+    uint32_t last_handshake_ms;         // 最近一次握手耗時
+    uint32_t avg_full_handshake_ms;     // 完整握手平均耗時
+    uint32_t avg_resumed_handshake_ms;  // 恢復握手平均耗時
+    float resumption_rate;              // 恢復率 (0.0 ~ 1.0)
+} dms_tls_stats_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 初始化 TLS 傳輸模組
+ *
+ * 若設定了 session 快取檔案，會嘗試從檔案載入先前的 session
+ *
+ * @param config AWS IoT 配置 (從 dms_config_get_aws_iot() 獲得)
+ * @return DMS_SUCCESS 成功，其他為錯誤碼
+ */
+dms_result_t dms_tls_init(const dms_aws_iot_config_t* config);
+
+#ifdef USE_OPENSSL
+/**
+ * @brief 建立 TLS 連線
+ *
+ * 與 Openssl_Connect() 參數及回傳值相同，可直接替換
+ * 有快取的 session 時會先嘗試恢復，伺服器拒絕時自動退回完整握手
+ *
+ * @param pNetworkContext 網路上下文 (pParams 必須指向 OpensslParams_t)
+ * @param pServerInfo 伺服器資訊
+ * @param pOpensslCredentials 憑證資訊
+ * @param sendTimeoutMs 傳送超時
+ * @param recvTimeoutMs 接收超時
+ * @return OPENSSL_SUCCESS 成功，其他為 OpensslStatus_t 錯誤碼
+ */
+OpensslStatus_t dms_tls_connect(NetworkContext_t* pNetworkContext,
+                                const ServerInfo_t* pServerInfo,
+                                const OpensslCredentials_t* pOpensslCredentials,
+                                uint32_t sendTimeoutMs,
+                                uint32_t recvTimeoutMs);
+#endif
+
+/**
+ * @brief 獲取 TLS 握手統計資訊
+ *
+ * @param stats 輸出統計資訊
+ */
+void dms_tls_get_stats(dms_tls_stats_t* stats);
+
+/**
+ * @brief 清理 TLS 傳輸模組
+ */
+void dms_tls_cleanup(void);
+
+#endif /* DMS_TLS_H_ */
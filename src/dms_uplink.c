@@ -0,0 +1,558 @@
+/*
+ * DMS Uplink Monitor Implementation
+ *
+ * 只保存判斷上行網路需要的最小狀態：介面是否 RUNNING、全域位址、main 表中的預設路由。
+ * 初始化時以 RTM_GET* dump 建立狀態，之後由多播事件增量更新；
+ * 沒有 RTA_OIF 的預設路由（多路徑）不列入判斷。
+ */
+
+#include "dms_uplink.h"
+
+/* 系統標頭檔 */
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_addr.h>
+
+/*-----------------------------------------------------------*/
+/* 內部類型與常數 */
+
+#define UPLINK_BUFFER_SIZE             ( 8192U )
+#define UPLINK_DUMP_TIMEOUT_MS         ( 1000 )
+#define UPLINK_ADDRESS_MAX_BYTES       ( 16U )
+
+typedef struct {
+    int ifindex;
+    bool running;                       // IFF_UP 且 IFF_RUNNING
+} uplink_link_t;
+
+typedef struct {
+    int ifindex;
+    uint8_t family;
+    uint8_t prefix_len;
+    uint8_t bytes[UPLINK_ADDRESS_MAX_BYTES];
+} uplink_address_t;
+
+typedef struct {
+    int oif;
+    uint8_t family;
+    uint32_t priority;
+} uplink_route_t;
+
+/*-----------------------------------------------------------*/
+/* 內部全域變數 */
+
+static int g_fd = -1;
+static uint32_t g_sequence = 0;
+static dms_uplink_restored_callback_t g_on_restored = NULL;
+static bool g_uplink_up = true;
+static bool g_resync_pending = false;   // 溢位後重新讀取失敗，下次處理時重試
+static dms_uplink_stats_t g_stats = {0};
+
+static uplink_link_t g_links[DMS_UPLINK_MAX_LINKS];
+static uint32_t g_link_count = 0;
+static uplink_address_t g_addresses[DMS_UPLINK_MAX_ADDRESSES];
+static uint32_t g_address_count = 0;
+static uplink_route_t g_routes[DMS_UPLINK_MAX_DEFAULT_ROUTES];
+static uint32_t g_route_count = 0;
+
+static union {
+    struct nlmsghdr header;             // 確保緩衝區對齊
+    char bytes[UPLINK_BUFFER_SIZE];
+} g_buffer;
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static dms_result_t load_full_state(void);
+static dms_result_t dump_table(uint16_t type);
+static ssize_t receive_from_kernel(int flags);
+static int handle_messages(ssize_t length, uint32_t dump_sequence);
+static void handle_link(const struct nlmsghdr* message);
+static void handle_address(const struct nlmsghdr* message);
+static void handle_route(const struct nlmsghdr* message);
+static bool address_equal(const uplink_address_t* a, const uplink_address_t* b);
+static uplink_link_t* find_link(int ifindex);
+static bool link_has_address(int ifindex);
+static bool evaluate_uplink(void);
+static void update_uplink_state(void);
+static void clear_state(void);
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數實作 */
+
+/**
+ * @brief 初始化上行網路監控
+ */
+dms_result_t dms_uplink_init(dms_uplink_restored_callback_t on_restored)
+{
+    if (g_fd >= 0) {
+        dms_uplink_cleanup();
+    }
+
+    g_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+    if (g_fd < 0) {
+        DMS_LOG_ERROR("❌ Failed to open rtnetlink socket: %s", strerror(errno));
+        return DMS_ERROR_NETWORK_FAILURE;
+    }
+
+    struct sockaddr_nl local = {
+        .nl_family = AF_NETLINK,
+        .nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR |
+                     RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE
+    };
+    if (bind(g_fd, (struct sockaddr*)&local, sizeof(local)) != 0) {
+        DMS_LOG_ERROR("❌ Failed to subscribe to rtnetlink events: %s", strerror(errno));
+        close(g_fd);
+        g_fd = -1;
+        return DMS_ERROR_NETWORK_FAILURE;
+    }
+
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_on_restored = on_restored;
+    g_resync_pending = false;
+
+    if (load_full_state() != DMS_SUCCESS) {
+        close(g_fd);
+        g_fd = -1;
+        return DMS_ERROR_NETWORK_FAILURE;
+    }
+    g_uplink_up = evaluate_uplink();
+
+    DMS_LOG_INFO("✅ Uplink monitor initialized (%u links, %u default routes, uplink %s)",
+                 g_link_count, g_route_count, g_uplink_up ? "up" : "down");
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 處理待讀取的 rtnetlink 事件
+ */
+void dms_uplink_process(void)
+{
+    if (g_fd < 0) {
+        return;
+    }
+
+    if (g_resync_pending) {
+        g_resync_pending = (load_full_state() != DMS_SUCCESS);
+    }
+
+    while (!g_resync_pending) {
+        ssize_t length = receive_from_kernel(MSG_DONTWAIT);
+
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOBUFS) {
+                /* 核心丟棄了事件，增量狀態不再可信 */
+                DMS_LOG_WARN("⚠️ rtnetlink overrun, reloading uplink state");
+                g_stats.resyncs++;
+                g_resync_pending = (load_full_state() != DMS_SUCCESS);
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                DMS_LOG_WARN("⚠️ rtnetlink receive failed: %s", strerror(errno));
+            }
+            break;
+        }
+
+        handle_messages(length, 0);
+    }
+
+    /* 狀態不完整時不判斷，避免誤報中斷 */
+    if (!g_resync_pending) {
+        update_uplink_state();
+    }
+}
+
+/**
+ * @brief 檢查上行網路是否可用
+ */
+bool dms_uplink_is_up(void)
+{
+    return g_fd < 0 || g_uplink_up;
+}
+
+/**
+ * @brief 獲取 rtnetlink socket
+ */
+int dms_uplink_get_fd(void)
+{
+    return g_fd;
+}
+
+/**
+ * @brief 獲取上行網路監控統計資訊
+ */
+void dms_uplink_get_stats(dms_uplink_stats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = g_stats;
+    }
+}
+
+/**
+ * @brief 清理上行網路監控
+ */
+void dms_uplink_cleanup(void)
+{
+    if (g_fd < 0) {
+        return;
+    }
+
+    close(g_fd);
+    g_fd = -1;
+    g_on_restored = NULL;
+    g_uplink_up = true;
+    clear_state();
+
+    DMS_LOG_INFO("Uplink monitor cleanup completed (%u lost, %u restored)",
+                 g_stats.uplink_lost, g_stats.uplink_restored);
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 清除狀態後依序讀取介面、位址與路由
+ */
+static dms_result_t load_full_state(void)
+{
+    static const uint16_t tables[] = { RTM_GETLINK, RTM_GETADDR, RTM_GETROUTE };
+
+    clear_state();
+    for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++) {
+        if (dump_table(tables[i]) != DMS_SUCCESS) {
+            DMS_LOG_ERROR("❌ Failed to load rtnetlink table %u", (unsigned)tables[i]);
+            return DMS_ERROR_NETWORK_FAILURE;
+        }
+    }
+    return DMS_SUCCESS;
+}
+
+/**
+ * @brief 送出 dump 請求並處理回應直到 NLMSG_DONE
+ *
+ * 期間收到的多播事件一併套用
+ */
+static dms_result_t dump_table(uint16_t type)
+{
+    struct {
+        struct nlmsghdr header;
+        struct rtgenmsg body;
+    } request = {
+        .header = {
+            .nlmsg_len = NLMSG_LENGTH(sizeof(struct rtgenmsg)),
+            .nlmsg_type = type,
+            .nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP,
+            .nlmsg_seq = ++g_sequence
+        },
+        .body = { .rtgen_family = AF_UNSPEC }
+    };
+    struct sockaddr_nl kernel = { .nl_family = AF_NETLINK };
+
+    if (sendto(g_fd, &request, request.header.nlmsg_len, 0,
+               (struct sockaddr*)&kernel, sizeof(kernel)) < 0) {
+        return DMS_ERROR_NETWORK_FAILURE;
+    }
+
+    for (;;) {
+        struct pollfd pfd = { .fd = g_fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, UPLINK_DUMP_TIMEOUT_MS);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            return DMS_ERROR_TIMEOUT;
+        }
+
+        ssize_t length = receive_from_kernel(0);
+        if (length < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            return DMS_ERROR_NETWORK_FAILURE;   /* 包含 ENOBUFS，由呼叫者重試 */
+        }
+
+        int status = handle_messages(length, request.header.nlmsg_seq);
+        if (status != 0) {
+            return status > 0 ? DMS_SUCCESS : DMS_ERROR_NETWORK_FAILURE;
+        }
+    }
+}
+
+/**
+ * @brief 接收一個封包，只接受來自核心的訊息
+ *
+ * @return 長度；其他來源的封包返回 0
+ */
+static ssize_t receive_from_kernel(int flags)
+{
+    struct sockaddr_nl sender;
+    socklen_t sender_len = sizeof(sender);
+
+    ssize_t length = recvfrom(g_fd, g_buffer.bytes, sizeof(g_buffer.bytes), flags,
+                              (struct sockaddr*)&sender, &sender_len);
+    if (length > 0 && (sender_len != sizeof(sender) || sender.nl_pid != 0)) {
+        return 0;
+    }
+    return length;
+}
+
+/**
+ * @brief 處理緩衝區中的所有訊息
+ *
+ * @param dump_sequence 等待中的 dump 序號（0 表示不在 dump 中）
+ * @return 1 該 dump 完成，-1 該 dump 失敗，0 尚未結束
+ */
+static int handle_messages(ssize_t length, uint32_t dump_sequence)
+{
+    size_t remaining = (size_t)length;
+
+    for (const struct nlmsghdr* message = &g_buffer.header;
+         NLMSG_OK(message, remaining);
+         message = NLMSG_NEXT(message, remaining)) {
+        bool dump_reply = dump_sequence != 0 && message->nlmsg_seq == dump_sequence;
+
+        g_stats.messages++;
+        switch (message->nlmsg_type) {
+            case NLMSG_DONE:
+                if (dump_reply) {
+                    return 1;
+                }
+                break;
+            case NLMSG_ERROR:
+                if (dump_reply) {
+                    return -1;
+                }
+                break;
+            case RTM_NEWLINK:
+            case RTM_DELLINK:
+                handle_link(message);
+                break;
+            case RTM_NEWADDR:
+            case RTM_DELADDR:
+                handle_address(message);
+                break;
+            case RTM_NEWROUTE:
+            case RTM_DELROUTE:
+                handle_route(message);
+                break;
+            default:
+                break;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 更新介面狀態
+ */
+static void handle_link(const struct nlmsghdr* message)
+{
+    if (message->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifinfomsg))) {
+        return;
+    }
+
+    const struct ifinfomsg* info = NLMSG_DATA(message);
+    uplink_link_t* link = find_link(info->ifi_index);
+
+    if (message->nlmsg_type == RTM_DELLINK) {
+        if (link != NULL) {
+            *link = g_links[--g_link_count];
+        }
+        return;
+    }
+
+    if (link == NULL) {
+        if (g_link_count >= DMS_UPLINK_MAX_LINKS) {
+            DMS_LOG_DEBUG("Uplink link table full, ignoring ifindex %d", info->ifi_index);
+            return;
+        }
+        link = &g_links[g_link_count++];
+        link->ifindex = info->ifi_index;
+    }
+    link->running = (info->ifi_flags & IFF_UP) && (info->ifi_flags & IFF_RUNNING);
+}
+
+/**
+ * @brief 更新全域位址（link-local 與 host scope 不列入）
+ */
+static void handle_address(const struct nlmsghdr* message)
+{
+    if (message->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifaddrmsg))) {
+        return;
+    }
+
+    const struct ifaddrmsg* info = NLMSG_DATA(message);
+    if (info->ifa_scope != RT_SCOPE_UNIVERSE) {
+        return;
+    }
+
+    uplink_address_t address = {
+        .ifindex = (int)info->ifa_index,
+        .family = info->ifa_family,
+        .prefix_len = info->ifa_prefixlen
+    };
+
+    /* 點對點介面的 IFA_ADDRESS 是對端位址，以 IFA_LOCAL 為準 */
+    const struct rtattr* local = NULL;
+    const struct rtattr* fallback = NULL;
+    int attr_len = (int)IFA_PAYLOAD(message);
+    for (const struct rtattr* attr = IFA_RTA(info); RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len)) {
+        if (attr->rta_type == IFA_LOCAL) {
+            local = attr;
+        } else if (attr->rta_type == IFA_ADDRESS) {
+            fallback = attr;
+        }
+    }
+    const struct rtattr* chosen = local != NULL ? local : fallback;
+    if (chosen == NULL) {
+        return;
+    }
+    size_t bytes = RTA_PAYLOAD(chosen);
+    memcpy(address.bytes, RTA_DATA(chosen), bytes < sizeof(address.bytes) ? bytes : sizeof(address.bytes));
+
+    for (uint32_t i = 0; i < g_address_count; i++) {
+        if (address_equal(&g_addresses[i], &address)) {
+            if (message->nlmsg_type == RTM_DELADDR) {
+                g_addresses[i] = g_addresses[--g_address_count];
+            }
+            return;                     /* 已存在的位址更新（例如 IPv6 lifetime） */
+        }
+    }
+
+    if (message->nlmsg_type == RTM_NEWADDR) {
+        if (g_address_count >= DMS_UPLINK_MAX_ADDRESSES) {
+            DMS_LOG_DEBUG("Uplink address table full, ignoring address on ifindex %d", address.ifindex);
+            return;
+        }
+        g_addresses[g_address_count++] = address;
+    }
+}
+
+/**
+ * @brief 更新 main 表中的預設路由
+ */
+static void handle_route(const struct nlmsghdr* message)
+{
+    if (message->nlmsg_len < NLMSG_LENGTH(sizeof(struct rtmsg))) {
+        return;
+    }
+
+    const struct rtmsg* info = NLMSG_DATA(message);
+    if (info->rtm_dst_len != 0 || info->rtm_type != RTN_UNICAST) {
+        return;
+    }
+
+    uint32_t table = info->rtm_table;
+    uplink_route_t route = { .oif = 0, .family = info->rtm_family, .priority = 0 };
+    int attr_len = (int)RTM_PAYLOAD(message);
+    for (const struct rtattr* attr = RTM_RTA(info); RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len)) {
+        if (attr->rta_type == RTA_OIF && RTA_PAYLOAD(attr) >= sizeof(int)) {
+            memcpy(&route.oif, RTA_DATA(attr), sizeof(int));
+        } else if (attr->rta_type == RTA_PRIORITY && RTA_PAYLOAD(attr) >= sizeof(uint32_t)) {
+            memcpy(&route.priority, RTA_DATA(attr), sizeof(uint32_t));
+        } else if (attr->rta_type == RTA_TABLE && RTA_PAYLOAD(attr) >= sizeof(uint32_t)) {
+            memcpy(&table, RTA_DATA(attr), sizeof(uint32_t));
+        }
+    }
+    if (table != RT_TABLE_MAIN || route.oif == 0) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < g_route_count; i++) {
+        if (g_routes[i].oif == route.oif && g_routes[i].family == route.family &&
+            g_routes[i].priority == route.priority) {
+            if (message->nlmsg_type == RTM_DELROUTE) {
+                g_routes[i] = g_routes[--g_route_count];
+            }
+            return;
+        }
+    }
+
+    if (message->nlmsg_type == RTM_NEWROUTE) {
+        if (g_route_count >= DMS_UPLINK_MAX_DEFAULT_ROUTES) {
+            DMS_LOG_DEBUG("Uplink route table full, ignoring default route via ifindex %d", route.oif);
+            return;
+        }
+        g_routes[g_route_count++] = route;
+    }
+}
+
+static bool address_equal(const uplink_address_t* a, const uplink_address_t* b)
+{
+    return a->ifindex == b->ifindex && a->family == b->family &&
+           a->prefix_len == b->prefix_len && memcmp(a->bytes, b->bytes, sizeof(a->bytes)) == 0;
+}
+
+static uplink_link_t* find_link(int ifindex)
+{
+    for (uint32_t i = 0; i < g_link_count; i++) {
+        if (g_links[i].ifindex == ifindex) {
+            return &g_links[i];
+        }
+    }
+    return NULL;
+}
+
+static bool link_has_address(int ifindex)
+{
+    for (uint32_t i = 0; i < g_address_count; i++) {
+        if (g_addresses[i].ifindex == ifindex) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 上行可用：任一預設路由的輸出介面 RUNNING 且有全域位址
+ */
+static bool evaluate_uplink(void)
+{
+    for (uint32_t i = 0; i < g_route_count; i++) {
+        const uplink_link_t* link = find_link(g_routes[i].oif);
+        if (link != NULL && link->running && link_has_address(link->ifindex)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 比較前後狀態，恢復時調用回調
+ */
+static void update_uplink_state(void)
+{
+    bool up = evaluate_uplink();
+    if (up == g_uplink_up) {
+        return;
+    }
+
+    g_uplink_up = up;
+    if (!up) {
+        g_stats.uplink_lost++;
+        DMS_LOG_WARN("⚠️ Uplink lost (no usable default route)");
+        return;
+    }
+
+    g_stats.uplink_restored++;
+    DMS_LOG_INFO("🌐 Uplink restored");
+    if (g_on_restored != NULL) {
+        g_on_restored();
+    }
+}
+
+static void clear_state(void)
+{
+    g_link_count = 0;
+    g_address_count = 0;
+    g_route_count = 0;
+}
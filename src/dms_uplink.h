@@ -0,0 +1,91 @@
+
+/*
+ * DMS Uplink Monitor
+ *
+ * 以 rtnetlink 追蹤上行網路狀態，WAN 恢復時通知重連模組，不必等完退避延遲：
+ * - 訂閱 link、address 與 route 事件（IPv4 / IPv6）
+ * - 上行可用：存在預設路由，且其輸出介面為 UP/RUNNING 並有全域位址
+ * - 由不可用變為可用時調用初始化時註冊的回調
+ * - socket 為非阻塞，由主迴圈調用 dms_uplink_process()；dms_uplink_get_fd() 可用於 poll() 等待
+ *
+ * 訊息緩衝區溢位（ENOBUFS）時重新讀取完整狀態。只在主迴圈中使用，不做同步保護。
+ */
+
+#ifndef DMS_UPLINK_H_
+#define DMS_UPLINK_H_
+
+/*-----------------------------------------------------------*/
+/* 包含必要的標頭檔 */
+
+#include "dms_config.h"
+#include "dms_log.h"
+#include "demo_config.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+/**
+ * @brief 上行網路恢復回調
+ */
+typedef void (*dms_uplink_restored_callback_t)(void);
+
+/**
+ * @brief 上行網路監控統計資訊
+ */
+typedef struct {
+    uint32_t messages;                  // 處理的 rtnetlink 訊息數
+    uint32_t uplink_lost;               // 上行網路中斷次數
+    uint32_t uplink_restored;           // 上行網路恢復次數
+    uint32_t resyncs;                   // 溢位後重新讀取狀態的次數
+} dms_uplink_stats_t;
+
+/*-----------------------------------------------------------*/
+/* 公開介面函數 */
+
+/**
+ * @brief 初始化上行網路監控
+ *
+ * 開啟 rtnetlink socket 並讀取目前的介面、位址與路由
+ *
+ * @param on_restored 上行網路恢復時的回調（可以為 NULL）
+ * @return DMS_SUCCESS 成功，DMS_ERROR_NETWORK_FAILURE 無法開啟 rtnetlink
+ */
+dms_result_t dms_uplink_init(dms_uplink_restored_callback_t on_restored);
+
+/**
+ * @brief 處理待讀取的 rtnetlink 事件
+ *
+ * 由主迴圈每輪調用，不阻塞
+ */
+void dms_uplink_process(void);
+
+/**
+ * @brief 檢查上行網路是否可用
+ *
+ * 未初始化時返回 true，避免阻擋重連
+ */
+bool dms_uplink_is_up(void);
+
+/**
+ * @brief 獲取 rtnetlink socket
+ *
+ * @return 檔案描述符，未初始化時返回 -1
+ */
+int dms_uplink_get_fd(void);
+
+/**
+ * @brief 獲取上行網路監控統計資訊
+ *
+ * @param stats 輸出統計資訊
+ */
+void dms_uplink_get_stats(dms_uplink_stats_t* stats);
+
+/**
+ * @brief 清理上行網路監控
+ */
+void dms_uplink_cleanup(void);
+
+#endif /* DMS_UPLINK_H_ */
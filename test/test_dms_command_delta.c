@@ -0,0 +1,474 @@
+/*
+ * Unit Tests for DMS Command Delta Processing
+ *
+ * Tests cover:
+ * - Extracting every command in a delta, running control changes before log uploads
+ * - Per-type inflight limits, each command reset and reported on its own
+ * - Dropping deltas whose version is the same as or older than the last handled one
+ * - Coalescing a burst of control-config-change deltas into one fetch, capped at DEBOUNCE_MAX
+ * - Applying control configs carried in the delta without an HTTP fetch, merging coalesced deltas
+ * - Falling back to the HTTP fetch when the inline configs are missing or unusable
+ */
+
+#include "unity.h"
+#include "dms_command.h"
+#include "dms_json_index.h"
+#include "dms_json_decode.h"
+#include "dms_control_registry.h"
+#include "mock_dms_command_journal.h"
+#include "mock_dms_api_client.h"
+#include "mock_dms_log.h"
+#include "mock_clock.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define TEST_MAX_EVENTS    ( 8 )
+#define TEST_WAIT_ROUNDS   ( 2000 )
+
+/* 以假的時鐘、HTTP API 與 Shadow 介面驅動命令模組，命令日誌以 mock 取代 */
+static uint32_t g_now_ms;
+static DMSAPIResult_t g_list_result;
+static int g_fetch_count;
+static int g_progress_count;
+static int g_progress_items;
+static DMSControlResult_t g_progress[DMS_COMMAND_CONTROL_CONFIG_MAX];
+static int g_report_count;
+static bool g_last_report_success;
+static char g_applied_value[DMS_COMMAND_CONTROL_CONFIG_MAX][256];
+
+/* 命令執行與回報順序；日誌 id 為命令類型，背景命令的 APPLIED 在工作執行緒中記錄 */
+static const char* const g_journal_keys[] = {
+    "", DMS_COMMAND_KEY_CONTROL_CONFIG, DMS_COMMAND_KEY_UPLOAD_LOGS, DMS_COMMAND_KEY_FW_UPGRADE
+};
+static const char* g_executed[TEST_MAX_EVENTS];
+static int g_executed_count;
+static int g_reset_count;
+static char g_reported_keys[TEST_MAX_EVENTS][64];   // 命令槽回報後即清除，保存副本
+static const char* g_fail_reset_key;
+static pthread_mutex_t g_hold_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool g_hold_background;
+
+static uint32_t fake_clock(int num_calls) {
+    (void)num_calls;
+    return g_now_ms;
+}
+
+static DMSAPIResult_t fake_config_list(const char* uniqueId, DMSControlConfig_t* configs,
+                                       int maxConfigs, int* configCount, int num_calls) {
+    (void)uniqueId;
+    (void)maxConfigs;
+    (void)num_calls;
+    g_fetch_count++;
+    if (g_list_result != DMS_API_SUCCESS) {
+        return g_list_result;
+    }
+    memset(&configs[0], 0, sizeof(configs[0]));
+    configs[0].statusProgressId = 99;
+    strcpy(configs[0].item, "channel2g");
+    strcpy(configs[0].value, "6");
+    *configCount = 1;
+    return DMS_API_SUCCESS;
+}
+
+static DMSAPIResult_t fake_progress_update(const char* uniqueId, const DMSControlResult_t* results,
+                                           int resultCount, int num_calls) {
+    (void)uniqueId;
+    (void)num_calls;
+    g_progress_count++;
+    g_progress_items = resultCount;
+    memcpy(g_progress, results, (size_t)resultCount * sizeof(results[0]));
+    return DMS_API_SUCCESS;
+}
+
+static uint32_t fake_journal_begin(const DMSCommand_t* command, int num_calls) {
+    (void)num_calls;
+    return (uint32_t)command->type;
+}
+
+static bool background_held(void) {
+    pthread_mutex_lock(&g_hold_mutex);
+    bool held = g_hold_background;
+    pthread_mutex_unlock(&g_hold_mutex);
+    return held;
+}
+
+static void hold_background(bool hold) {
+    pthread_mutex_lock(&g_hold_mutex);
+    g_hold_background = hold;
+    pthread_mutex_unlock(&g_hold_mutex);
+}
+
+static dms_result_t fake_journal_record(uint32_t id, dms_command_journal_state_t state,
+                                        const DMSCommand_t* command, dms_result_t result, int num_calls) {
+    (void)command;
+    (void)result;
+    (void)num_calls;
+    if (state == DMS_COMMAND_JOURNAL_EXECUTING && g_executed_count < TEST_MAX_EVENTS) {
+        g_executed[g_executed_count++] = g_journal_keys[id];
+    }
+    /* 背景命令停在執行完成前，模擬長時間的上傳 */
+    while (state == DMS_COMMAND_JOURNAL_APPLIED && background_held()) {
+        usleep(1000);
+    }
+    return DMS_SUCCESS;
+}
+
+static int apply_radio(const char* const* items, const char* const* values, int* results, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const dms_control_item_t* item = dms_control_registry_find(items[i]);
+        snprintf(g_applied_value[item->id], sizeof(g_applied_value[0]), "%s", values[i]);
+        results[i] = DMS_SUCCESS;
+    }
+    return DMS_SUCCESS;
+}
+
+static const dms_control_item_t g_items[] = {
+    { "channel2g", "radio", NULL, 0 },
+    { "channel5g", "radio", NULL, 1 },
+};
+
+static dms_result_t fake_reset_desired(const char* key) {
+    g_reset_count++;
+    if (g_fail_reset_key != NULL && strcmp(key, g_fail_reset_key) == 0) {
+        return DMS_ERROR_SHADOW_FAILURE;
+    }
+    return DMS_SUCCESS;
+}
+
+static dms_result_t fake_report_result(const char* key, bool success) {
+    if (g_report_count < TEST_MAX_EVENTS) {
+        snprintf(g_reported_keys[g_report_count], sizeof(g_reported_keys[0]), "%s", key);
+    }
+    g_report_count++;
+    g_last_report_success = success;
+    return DMS_SUCCESS;
+}
+
+static dms_result_t send_state_delta(const char* state, unsigned int version) {
+    char payload[2048];
+    int length = snprintf(payload, sizeof(payload), "{\"version\":%u,\"state\":%s}", version, state);
+    TEST_ASSERT_TRUE(length > 0 && (size_t)length < sizeof(payload));
+    return dms_command_process_shadow_delta("$aws/things/test/shadow/update/delta",
+                                            payload, (size_t)length);
+}
+
+static dms_result_t send_delta(const char* control_config, unsigned int version) {
+    char state[1900];
+    int length = snprintf(state, sizeof(state), "{\"control-config-change\":%s}", control_config);
+    TEST_ASSERT_TRUE(length > 0 && (size_t)length < sizeof(state));
+    return send_state_delta(state, version);
+}
+
+/* 背景命令由主迴圈回報，處理到計數達到預期為止 */
+static void wait_for(const int* counter, int expected) {
+    for (int i = 0; i < TEST_WAIT_ROUNDS && *counter < expected; i++) {
+        usleep(1000);
+        dms_command_process();
+    }
+    TEST_ASSERT_EQUAL(expected, *counter);
+}
+
+/* 推進時鐘後處理一次 */
+static void advance_and_process(uint32_t ms) {
+    g_now_ms += ms;
+    dms_command_process();
+}
+
+/* 等過 debounce 讓佇列中的 control 命令執行 */
+static void flush_debounce(void) {
+    advance_and_process(DMS_COMMAND_DEBOUNCE_MAX_MS);
+}
+
+void setUp(void) {
+    dms_log_printf_Ignore();
+    Clock_GetTimeMs_StubWithCallback(fake_clock);
+    dms_command_journal_open_IgnoreAndReturn(DMS_SUCCESS);
+    dms_command_journal_begin_IgnoreAndReturn(1);
+    dms_command_journal_record_IgnoreAndReturn(DMS_SUCCESS);
+    dms_command_journal_begin_StubWithCallback(fake_journal_begin);
+    dms_command_journal_record_StubWithCallback(fake_journal_record);
+    dms_command_journal_sync_IgnoreAndReturn(DMS_SUCCESS);
+    dms_command_journal_close_Ignore();
+    dms_api_control_config_list_StubWithCallback(fake_config_list);
+    dms_api_control_progress_update_StubWithCallback(fake_progress_update);
+
+    g_now_ms = 1000;
+    g_list_result = DMS_API_SUCCESS;
+    g_fetch_count = 0;
+    g_progress_count = 0;
+    g_progress_items = 0;
+    g_report_count = 0;
+    g_last_report_success = false;
+    memset(g_applied_value, 0, sizeof(g_applied_value));
+    g_executed_count = 0;
+    g_reset_count = 0;
+    g_fail_reset_key = NULL;
+    hold_background(false);
+
+    dms_control_registry_reset();
+    dms_control_registry_register_group("radio", apply_radio, 0);
+    dms_control_registry_register_items(g_items, sizeof(g_items) / sizeof(g_items[0]));
+
+    /* 版本表寫在固定路徑，避免上一次執行留下的版本影響去重 */
+    remove(DMS_COMMAND_VERSION_FILE);
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, dms_command_init());
+    dms_command_register_shadow_interface(fake_reset_desired, fake_report_result);
+}
+
+void tearDown(void) {
+    dms_command_cleanup();
+    dms_control_registry_reset();
+    remove(DMS_COMMAND_VERSION_FILE);
+}
+
+void test_parse_shadow_delta_should_extract_every_command(void) {
+    /* Arrange */
+    const char* payload = "{\"version\":7,\"state\":{\"fw_upgrade\":1,\"upload_logs\":1,"
+                          "\"control-config-change\":1}}";
+    dms_command_t commands[DMS_COMMAND_QUEUE_SIZE];
+    dms_command_t limited[2];
+    size_t count = 0;
+    size_t limited_count = 0;
+
+    /* Act */
+    dms_result_t result = dms_command_parse_shadow_delta(payload, strlen(payload), commands,
+                                                         DMS_COMMAND_QUEUE_SIZE, &count);
+    dms_command_parse_shadow_delta(payload, strlen(payload), limited, 2, &limited_count);
+
+    /* Assert - 不在第一個命中時返回，超過容量的命令不寫入 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, result);
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_EQUAL(DMS_CMD_CONTROL_CONFIG_CHANGE, commands[0].type);
+    TEST_ASSERT_EQUAL(DMS_CMD_UPLOAD_LOGS, commands[1].type);
+    TEST_ASSERT_EQUAL(DMS_CMD_FW_UPGRADE, commands[2].type);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL(1, commands[i].value);
+        TEST_ASSERT_EQUAL_UINT32(7, commands[i].version);
+    }
+    TEST_ASSERT_EQUAL_STRING(DMS_COMMAND_KEY_FW_UPGRADE, commands[2].key);
+    TEST_ASSERT_EQUAL(2, limited_count);
+}
+
+void test_delta_with_control_and_upload_logs_should_run_control_first(void) {
+    /* Act - 日誌上傳不需 debounce，但要等同一 delta 中的控制變更先執行 */
+    send_state_delta("{\"upload_logs\":1,\"control-config-change\":1}", 10);
+    int executed_during_debounce = g_executed_count;
+    flush_debounce();
+    wait_for(&g_report_count, 2);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(0, executed_during_debounce);
+    TEST_ASSERT_EQUAL(2, g_executed_count);
+    TEST_ASSERT_EQUAL_STRING(DMS_COMMAND_KEY_CONTROL_CONFIG, g_executed[0]);
+    TEST_ASSERT_EQUAL_STRING(DMS_COMMAND_KEY_UPLOAD_LOGS, g_executed[1]);
+    TEST_ASSERT_EQUAL(1, g_fetch_count);
+    TEST_ASSERT_EQUAL(0, dms_command_get_pending_count());
+}
+
+void test_commands_should_respect_per_type_inflight_limit(void) {
+    /* Arrange - 日誌上傳停在背景執行中 */
+    hold_background(true);
+    send_state_delta("{\"upload_logs\":1}", 10);
+
+    /* Act - 同類型的新 delta 併入執行中的命令，其他類型照常開始 */
+    send_state_delta("{\"upload_logs\":1}", 11);
+    send_state_delta("{\"fw_upgrade\":1}", 12);
+    int executed_while_running = g_executed_count;
+    uint32_t pending_while_running = dms_command_get_pending_count();
+    hold_background(false);
+    wait_for(&g_report_count, 2);
+    send_state_delta("{\"upload_logs\":1}", 11);
+
+    /* Assert - 併入的版本已由該次執行涵蓋，重送時被丟棄 */
+    TEST_ASSERT_EQUAL(2, executed_while_running);
+    TEST_ASSERT_EQUAL_STRING(DMS_COMMAND_KEY_UPLOAD_LOGS, g_executed[0]);
+    TEST_ASSERT_EQUAL_STRING(DMS_COMMAND_KEY_FW_UPGRADE, g_executed[1]);
+    TEST_ASSERT_EQUAL(2, pending_while_running);
+    TEST_ASSERT_EQUAL(2, g_executed_count);
+    TEST_ASSERT_EQUAL(1, dms_command_get_suppressed_count());
+}
+
+void test_each_command_should_be_reset_and_reported_on_its_own(void) {
+    /* Arrange - 日誌上傳的 desired 重設失敗 */
+    g_fail_reset_key = DMS_COMMAND_KEY_UPLOAD_LOGS;
+
+    /* Act */
+    send_state_delta("{\"control-config-change\":1,\"upload_logs\":1}", 10);
+    flush_debounce();
+    wait_for(&g_reset_count, 2);
+    int reported_before_retry = g_report_count;
+    uint32_t pending_before_retry = dms_command_get_pending_count();
+    g_fail_reset_key = NULL;
+    advance_and_process(DMS_COMMAND_REPORT_RETRY_MS);
+
+    /* Assert - 控制變更照常回報；日誌上傳稍後只重試回報，不重新執行 */
+    TEST_ASSERT_EQUAL(1, reported_before_retry);
+    TEST_ASSERT_EQUAL(1, pending_before_retry);
+    TEST_ASSERT_EQUAL(2, g_report_count);
+    TEST_ASSERT_EQUAL_STRING(DMS_COMMAND_KEY_CONTROL_CONFIG, g_reported_keys[0]);
+    TEST_ASSERT_EQUAL_STRING(DMS_COMMAND_KEY_UPLOAD_LOGS, g_reported_keys[1]);
+    TEST_ASSERT_EQUAL(2, g_executed_count);
+    TEST_ASSERT_EQUAL(0, dms_command_get_pending_count());
+}
+
+void test_delta_should_suppress_same_or_older_version(void) {
+    /* Arrange */
+    send_delta("1", 10);
+    flush_debounce();
+
+    /* Act */
+    send_delta("1", 10);
+    send_delta("1", 9);
+    flush_debounce();
+    int after_stale = g_fetch_count;
+    send_delta("1", 11);
+    flush_debounce();
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, after_stale);
+    TEST_ASSERT_EQUAL(2, dms_command_get_suppressed_count());
+    TEST_ASSERT_EQUAL(2, g_fetch_count);
+    TEST_ASSERT_EQUAL(2, g_report_count);
+}
+
+void test_delta_should_rerun_version_of_failed_command(void) {
+    /* Arrange */
+    g_list_result = DMS_API_ERROR_NETWORK;
+    send_delta("1", 10);
+    flush_debounce();
+
+    /* Act - 失敗的命令不記錄版本，AWS 重送相同版本時再執行一次 */
+    g_list_result = DMS_API_SUCCESS;
+    send_delta("1", 10);
+    flush_debounce();
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(2, g_fetch_count);
+    TEST_ASSERT_EQUAL(0, dms_command_get_suppressed_count());
+    TEST_ASSERT_TRUE(g_last_report_success);
+}
+
+void test_delta_burst_should_coalesce_into_one_fetch(void) {
+    /* Arrange */
+    send_delta("1", 10);
+    g_now_ms += 200;
+    send_delta("1", 11);
+    g_now_ms += 300;
+    send_delta("1", 12);
+
+    /* Act - 每個 delta 重新計時 */
+    advance_and_process(DMS_COMMAND_DEBOUNCE_CONTROL_CONFIG_MS - 1);
+    int before_quiet = g_fetch_count;
+    advance_and_process(1);
+    send_delta("1", 12);
+    flush_debounce();
+
+    /* Assert - 合併的版本一併記錄，之後重送最新版本時被丟棄 */
+    TEST_ASSERT_EQUAL(0, before_quiet);
+    TEST_ASSERT_EQUAL(1, g_fetch_count);
+    TEST_ASSERT_EQUAL(1, g_report_count);
+    TEST_ASSERT_EQUAL(1, dms_command_get_suppressed_count());
+    TEST_ASSERT_EQUAL(0, dms_command_get_pending_count());
+}
+
+void test_continuous_deltas_should_run_within_max_debounce(void) {
+    /* Arrange */
+    uint32_t first_ms = g_now_ms;
+    unsigned int version = 10;
+
+    /* Act - 間隔短於 debounce 的 delta 持續送達 */
+    while (g_fetch_count == 0 && g_now_ms - first_ms < 2 * DMS_COMMAND_DEBOUNCE_MAX_MS) {
+        send_delta("1", version++);
+        advance_and_process(DMS_COMMAND_DEBOUNCE_CONTROL_CONFIG_MS / 3);
+    }
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, g_fetch_count);
+    TEST_ASSERT_TRUE(g_now_ms - first_ms <= DMS_COMMAND_DEBOUNCE_MAX_MS);
+}
+
+void test_inline_configs_should_apply_without_fetch(void) {
+    /* Act */
+    send_delta("{\"control-configs\":["
+               "{\"status_progress_id\":1,\"item\":\"channel2g\",\"type\":1,\"value\":\"11\"},"
+               "{\"status_progress_id\":2,\"item\":\"channel5g\",\"type\":2,\"value\":{\"width\":80}}]}", 10);
+    flush_debounce();
+
+    /* Assert - 物件值以原始 JSON 文字交給套用函數 */
+    TEST_ASSERT_EQUAL(0, g_fetch_count);
+    TEST_ASSERT_EQUAL(1, g_progress_count);
+    TEST_ASSERT_EQUAL(2, g_progress_items);
+    TEST_ASSERT_EQUAL(1, g_progress[0].statusProgressId);
+    TEST_ASSERT_EQUAL(2, g_progress[1].statusProgressId);
+    TEST_ASSERT_EQUAL(1, g_progress[1].status);
+    TEST_ASSERT_EQUAL_STRING("11", g_applied_value[0]);
+    TEST_ASSERT_EQUAL_STRING("{\"width\":80}", g_applied_value[1]);
+}
+
+void test_inline_configs_from_coalesced_deltas_should_merge(void) {
+    /* Act - 同名項目以較新的 delta 為準 */
+    send_delta("{\"control-configs\":[{\"status_progress_id\":3,\"item\":\"channel2g\",\"value\":\"1\"}]}", 10);
+    send_delta("{\"control-configs\":[{\"status_progress_id\":4,\"item\":\"channel2g\",\"value\":\"6\"},"
+               "{\"status_progress_id\":5,\"item\":\"channel5g\",\"value\":\"36\"}]}", 11);
+    flush_debounce();
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(0, g_fetch_count);
+    TEST_ASSERT_EQUAL(2, g_progress_items);
+    TEST_ASSERT_EQUAL(4, g_progress[0].statusProgressId);
+    TEST_ASSERT_EQUAL(5, g_progress[1].statusProgressId);
+    TEST_ASSERT_EQUAL_STRING("6", g_applied_value[0]);
+    TEST_ASSERT_EQUAL_STRING("36", g_applied_value[1]);
+}
+
+void test_delta_should_fetch_when_inline_configs_are_unusable(void) {
+    /* Arrange */
+    char long_value[300];
+    char too_long[400];
+    char too_many[1024];
+    size_t used;
+
+    memset(long_value, 'a', sizeof(long_value) - 1);
+    long_value[sizeof(long_value) - 1] = '\0';
+    snprintf(too_long, sizeof(too_long),
+             "{\"control-configs\":[{\"item\":\"channel2g\",\"value\":\"%s\"}]}", long_value);
+
+    used = (size_t)snprintf(too_many, sizeof(too_many), "{\"control-configs\":[");
+    for (int i = 0; i <= DMS_COMMAND_CONTROL_CONFIG_MAX; i++) {
+        used += (size_t)snprintf(too_many + used, sizeof(too_many) - used,
+                                 "%s{\"item\":\"channel2g\",\"value\":\"%d\"}", (i > 0) ? "," : "", i);
+    }
+    snprintf(too_many + used, sizeof(too_many) - used, "]}");
+
+    /* Act - 沒有配置、缺少陣列、值過長、超過上限、缺少必要欄位 */
+    send_delta("1", 10);
+    flush_debounce();
+    send_delta("{}", 11);
+    flush_debounce();
+    send_delta(too_long, 12);
+    flush_debounce();
+    send_delta(too_many, 13);
+    flush_debounce();
+    send_delta("{\"control-configs\":[{\"item\":\"channel2g\"}]}", 14);
+    flush_debounce();
+
+    /* Assert - 不只套用部分項目，一律改由 HTTP 取得完整列表 */
+    TEST_ASSERT_EQUAL(5, g_fetch_count);
+    TEST_ASSERT_EQUAL(1, g_progress_items);
+    TEST_ASSERT_EQUAL(99, g_progress[0].statusProgressId);
+    TEST_ASSERT_EQUAL_STRING("6", g_applied_value[0]);
+}
+
+void test_inline_configs_merged_with_plain_delta_should_fetch(void) {
+    /* Act - 合併的 delta 之一沒有內嵌配置時，內嵌部分不完整 */
+    send_delta("{\"control-configs\":[{\"status_progress_id\":3,\"item\":\"channel5g\",\"value\":\"36\"}]}", 10);
+    send_delta("1", 11);
+    flush_debounce();
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, g_fetch_count);
+    TEST_ASSERT_EQUAL(99, g_progress[0].statusProgressId);
+    TEST_ASSERT_EQUAL_STRING("", g_applied_value[1]);
+}
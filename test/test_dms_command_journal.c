@@ -0,0 +1,251 @@
+/*
+ * Unit Tests for DMS Command Journal
+ *
+ * Tests cover:
+ * - Replaying RECEIVED / EXECUTING / APPLIED records into recovered commands
+ * - REPORTED commands dropped on replay
+ * - A torn or bad-checksum record ending the replay
+ * - Ids continuing after a reopen
+ * - Compaction keeping only unfinished commands
+ * - Records appended after a failed compaction surviving the next replay
+ */
+
+#include "unity.h"
+#include "dms_command_journal.h"
+#include "mock_dms_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define TEST_JOURNAL_PATH        "/tmp/test_dms_command_journal"
+#define TEST_JOURNAL_TMP_PATH    TEST_JOURNAL_PATH ".tmp"
+
+static dms_command_journal_entry_t g_recovered[DMS_COMMAND_QUEUE_SIZE];
+static size_t g_recovered_count;
+
+static DMSCommand_t make_command(DMSCommandType_t type, const char* key, uint32_t version) {
+    DMSCommand_t command;
+    memset(&command, 0, sizeof(command));
+    command.type = type;
+    command.value = 1;
+    command.version = version;
+    SAFE_STRNCPY(command.key, key, sizeof(command.key));
+    return command;
+}
+
+static dms_result_t reopen(void) {
+    dms_command_journal_close();
+    return dms_command_journal_open(TEST_JOURNAL_PATH, g_recovered,
+                                    DMS_COMMAND_QUEUE_SIZE, &g_recovered_count);
+}
+
+static int count_lines(void) {
+    FILE* fp = fopen(TEST_JOURNAL_PATH, "r");
+    TEST_ASSERT_NOT_NULL(fp);
+
+    int lines = 0;
+    int c;
+    while ((c = fgetc(fp)) != EOF) {
+        if (c == '\n') {
+            lines++;
+        }
+    }
+    fclose(fp);
+    return lines;
+}
+
+/* 日誌檔案大小，用於截斷出斷電時的殘留 */
+static long file_size(void) {
+    struct stat st;
+    TEST_ASSERT_EQUAL(0, stat(TEST_JOURNAL_PATH, &st));
+    return (long)st.st_size;
+}
+
+void setUp(void) {
+    dms_log_printf_Ignore();
+    remove(TEST_JOURNAL_PATH);
+    rmdir(TEST_JOURNAL_TMP_PATH);
+    memset(g_recovered, 0, sizeof(g_recovered));
+    g_recovered_count = 0;
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, reopen());
+}
+
+void tearDown(void) {
+    dms_command_journal_close();
+    remove(TEST_JOURNAL_PATH);
+    rmdir(TEST_JOURNAL_TMP_PATH);
+}
+
+void test_journal_should_recover_unfinished_commands_in_their_last_state(void) {
+    /* Arrange */
+    DMSCommand_t control = make_command(DMS_CMD_CONTROL_CONFIG_CHANGE, "control-config-change", 10);
+    DMSCommand_t logs = make_command(DMS_CMD_UPLOAD_LOGS, "upload_logs", 11);
+    DMSCommand_t fw = make_command(DMS_CMD_FW_UPGRADE, "fw_upgrade", 12);
+    uint32_t control_id = dms_command_journal_begin(&control);
+    uint32_t logs_id = dms_command_journal_begin(&logs);
+    uint32_t fw_id = dms_command_journal_begin(&fw);
+    dms_command_journal_record(logs_id, DMS_COMMAND_JOURNAL_EXECUTING, NULL, DMS_SUCCESS);
+    dms_command_journal_record(fw_id, DMS_COMMAND_JOURNAL_EXECUTING, NULL, DMS_SUCCESS);
+    dms_command_journal_record(fw_id, DMS_COMMAND_JOURNAL_APPLIED, NULL, DMS_ERROR_UNKNOWN);
+
+    /* Act */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, reopen());
+
+    /* Assert - 依 id 排序，保留最後一筆記錄的狀態與結果 */
+    TEST_ASSERT_EQUAL(3, g_recovered_count);
+    TEST_ASSERT_EQUAL_UINT32(control_id, g_recovered[0].id);
+    TEST_ASSERT_EQUAL(DMS_COMMAND_JOURNAL_RECEIVED, g_recovered[0].state);
+    TEST_ASSERT_EQUAL(DMS_CMD_CONTROL_CONFIG_CHANGE, g_recovered[0].command.type);
+    TEST_ASSERT_EQUAL_UINT32(10, g_recovered[0].command.version);
+    TEST_ASSERT_EQUAL_STRING("control-config-change", g_recovered[0].command.key);
+    TEST_ASSERT_EQUAL_UINT32(logs_id, g_recovered[1].id);
+    TEST_ASSERT_EQUAL(DMS_COMMAND_JOURNAL_EXECUTING, g_recovered[1].state);
+    TEST_ASSERT_EQUAL_UINT32(fw_id, g_recovered[2].id);
+    TEST_ASSERT_EQUAL(DMS_COMMAND_JOURNAL_APPLIED, g_recovered[2].state);
+    TEST_ASSERT_EQUAL(DMS_ERROR_UNKNOWN, g_recovered[2].result);
+}
+
+void test_journal_should_drop_reported_commands(void) {
+    /* Arrange */
+    DMSCommand_t logs = make_command(DMS_CMD_UPLOAD_LOGS, "upload_logs", 1);
+    DMSCommand_t fw = make_command(DMS_CMD_FW_UPGRADE, "fw_upgrade", 2);
+    uint32_t logs_id = dms_command_journal_begin(&logs);
+    uint32_t fw_id = dms_command_journal_begin(&fw);
+    dms_command_journal_record(logs_id, DMS_COMMAND_JOURNAL_APPLIED, NULL, DMS_SUCCESS);
+    dms_command_journal_record(logs_id, DMS_COMMAND_JOURNAL_REPORTED, NULL, DMS_SUCCESS);
+
+    /* Act */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, reopen());
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, g_recovered_count);
+    TEST_ASSERT_EQUAL_UINT32(fw_id, g_recovered[0].id);
+    TEST_ASSERT_EQUAL(1, count_lines());
+}
+
+void test_journal_replay_should_stop_at_torn_record(void) {
+    /* Arrange - 最後一筆記錄寫到一半 */
+    DMSCommand_t logs = make_command(DMS_CMD_UPLOAD_LOGS, "upload_logs", 1);
+    DMSCommand_t fw = make_command(DMS_CMD_FW_UPGRADE, "fw_upgrade", 2);
+    dms_command_journal_begin(&logs);
+    dms_command_journal_sync();
+    long first_record_end = file_size();
+    dms_command_journal_begin(&fw);
+    dms_command_journal_close();
+    TEST_ASSERT_EQUAL(0, truncate(TEST_JOURNAL_PATH, file_size() - 4));
+
+    /* Act */
+    dms_result_t result = reopen();
+
+    /* Assert - 殘留在開啟時被截掉 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, result);
+    TEST_ASSERT_EQUAL(1, g_recovered_count);
+    TEST_ASSERT_EQUAL_STRING("upload_logs", g_recovered[0].command.key);
+    TEST_ASSERT_EQUAL(first_record_end, file_size());
+}
+
+void test_journal_replay_should_stop_at_bad_checksum(void) {
+    /* Arrange - 竄改第二筆記錄的內容，校驗碼不再相符 */
+    DMSCommand_t logs = make_command(DMS_CMD_UPLOAD_LOGS, "upload_logs", 1);
+    DMSCommand_t fw = make_command(DMS_CMD_FW_UPGRADE, "fw_upgrade", 2);
+    DMSCommand_t control = make_command(DMS_CMD_CONTROL_CONFIG_CHANGE, "control-config-change", 3);
+    dms_command_journal_begin(&logs);
+    dms_command_journal_sync();
+    long second_record = file_size();
+    dms_command_journal_begin(&fw);
+    dms_command_journal_begin(&control);
+    dms_command_journal_close();
+
+    FILE* fp = fopen(TEST_JOURNAL_PATH, "r+");
+    TEST_ASSERT_NOT_NULL(fp);
+    fseek(fp, second_record, SEEK_SET);
+    fputc('9', fp);
+    fclose(fp);
+
+    /* Act */
+    reopen();
+
+    /* Assert - 損壞記錄之後的記錄一併捨棄 */
+    TEST_ASSERT_EQUAL(1, g_recovered_count);
+    TEST_ASSERT_EQUAL_STRING("upload_logs", g_recovered[0].command.key);
+}
+
+void test_journal_ids_should_continue_after_reopen(void) {
+    /* Arrange */
+    DMSCommand_t logs = make_command(DMS_CMD_UPLOAD_LOGS, "upload_logs", 1);
+    DMSCommand_t fw = make_command(DMS_CMD_FW_UPGRADE, "fw_upgrade", 2);
+    uint32_t first = dms_command_journal_begin(&logs);
+    uint32_t second = dms_command_journal_begin(&fw);
+    dms_command_journal_record(second, DMS_COMMAND_JOURNAL_REPORTED, NULL, DMS_SUCCESS);
+
+    /* Act */
+    reopen();
+    uint32_t third = dms_command_journal_begin(&fw);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL_UINT32(1, first);
+    TEST_ASSERT_EQUAL_UINT32(2, second);
+    TEST_ASSERT_EQUAL_UINT32(3, third);
+}
+
+void test_journal_compaction_should_keep_only_unfinished_commands(void) {
+    /* Arrange - 一個命令未完成，其他命令完成並回報，記錄數超過門檻 */
+    DMSCommand_t fw = make_command(DMS_CMD_FW_UPGRADE, "fw_upgrade", 1);
+    DMSCommand_t logs = make_command(DMS_CMD_UPLOAD_LOGS, "upload_logs", 2);
+    uint32_t open_id = dms_command_journal_begin(&fw);
+    dms_command_journal_record(open_id, DMS_COMMAND_JOURNAL_EXECUTING, NULL, DMS_SUCCESS);
+
+    /* Act - 每輪新增三筆記錄，直到 sync 觸發壓縮使檔案變短 */
+    int lines_before = 0;
+    int lines = count_lines();
+    for (int i = 0; i < DMS_COMMAND_JOURNAL_COMPACT_RECORDS && lines >= lines_before; i++) {
+        uint32_t id = dms_command_journal_begin(&logs);
+        dms_command_journal_record(id, DMS_COMMAND_JOURNAL_APPLIED, NULL, DMS_SUCCESS);
+        dms_command_journal_record(id, DMS_COMMAND_JOURNAL_REPORTED, NULL, DMS_SUCCESS);
+        dms_command_journal_sync();
+        lines_before = lines;
+        lines = count_lines();
+    }
+
+    /* Assert - 壓縮後仍可繼續附加 */
+    TEST_ASSERT_TRUE(lines_before >= DMS_COMMAND_JOURNAL_COMPACT_RECORDS - 3);
+    TEST_ASSERT_EQUAL(1, lines);
+    uint32_t next_id = dms_command_journal_begin(&logs);
+    TEST_ASSERT_NOT_EQUAL(0, next_id);
+    reopen();
+    TEST_ASSERT_EQUAL(2, g_recovered_count);
+    TEST_ASSERT_EQUAL_UINT32(open_id, g_recovered[0].id);
+    TEST_ASSERT_EQUAL(DMS_COMMAND_JOURNAL_EXECUTING, g_recovered[0].state);
+    TEST_ASSERT_EQUAL_UINT32(next_id, g_recovered[1].id);
+}
+
+void test_journal_should_keep_appending_after_failed_compaction(void) {
+    /* Arrange - 尾端殘留，且暫存檔路徑被目錄佔用使壓縮失敗 */
+    DMSCommand_t logs = make_command(DMS_CMD_UPLOAD_LOGS, "upload_logs", 1);
+    DMSCommand_t fw = make_command(DMS_CMD_FW_UPGRADE, "fw_upgrade", 2);
+    dms_command_journal_begin(&logs);
+    dms_command_journal_begin(&fw);
+    dms_command_journal_close();
+    TEST_ASSERT_EQUAL(0, truncate(TEST_JOURNAL_PATH, file_size() - 4));
+    TEST_ASSERT_EQUAL(0, mkdir(TEST_JOURNAL_TMP_PATH, 0700));
+
+    /* Act */
+    dms_result_t opened = reopen();
+    DMSCommand_t control = make_command(DMS_CMD_CONTROL_CONFIG_CHANGE, "control-config-change", 3);
+    uint32_t control_id = dms_command_journal_begin(&control);
+    dms_result_t synced = dms_command_journal_sync();
+    uint32_t logs_id = g_recovered[0].id;
+    dms_command_journal_record(logs_id, DMS_COMMAND_JOURNAL_EXECUTING, NULL, DMS_SUCCESS);
+    rmdir(TEST_JOURNAL_TMP_PATH);
+    reopen();
+
+    /* Assert - 新記錄不會接在殘留後面而被捨棄 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, opened);
+    TEST_ASSERT_NOT_EQUAL(0, control_id);
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, synced);
+    TEST_ASSERT_EQUAL(2, g_recovered_count);
+    TEST_ASSERT_EQUAL(DMS_COMMAND_JOURNAL_EXECUTING, g_recovered[0].state);
+    TEST_ASSERT_EQUAL_UINT32(control_id, g_recovered[1].id);
+    TEST_ASSERT_EQUAL_STRING("control-config-change", g_recovered[1].command.key);
+}
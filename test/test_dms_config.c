@@ -134,3 +134,69 @@ void test_dms_config_cleanup_should_reset_initialization_flag(void) {
     /* Assert */
     TEST_ASSERT_NULL(dms_config_get());
 }
+
+void test_dms_config_tls_session_cache_should_default_to_tmpfs(void) {
+    /* Arrange */
+    dms_log_cleanup_Ignore();
+    dms_config_init();
+
+    /* Act */
+    const dms_aws_iot_config_t* aws_config = dms_config_get_aws_iot();
+
+    /* Assert */
+    TEST_ASSERT_NOT_NULL(aws_config);
+    TEST_ASSERT_TRUE(aws_config->tls_session_resumption);
+    TEST_ASSERT_EQUAL_STRING(TLS_SESSION_CACHE_FILE, aws_config->tls_session_cache_path);
+}
+
+void test_dms_config_dead_link_timeout_should_be_shorter_than_keepalive(void) {
+    /* Arrange */
+    dms_log_cleanup_Ignore();
+    dms_config_init();
+
+    /* Act */
+    const dms_aws_iot_config_t* aws_config = dms_config_get_aws_iot();
+
+    /* Assert - 半開連線必須比 MQTT keepalive 更早被發現 */
+    TEST_ASSERT_NOT_NULL(aws_config);
+    TEST_ASSERT_EQUAL(MQTT_DEAD_LINK_TIMEOUT_SECONDS, aws_config->dead_link_timeout_seconds);
+    TEST_ASSERT_TRUE(aws_config->dead_link_timeout_seconds < aws_config->keep_alive_seconds);
+    TEST_ASSERT_TRUE(aws_config->dead_link_timeout_seconds * 1000U >= MQTT_PING_MIN_TIMEOUT_MS);
+    TEST_ASSERT_TRUE(MQTT_PING_MIN_TIMEOUT_MS >= 5000);
+}
+
+void test_dms_config_telemetry_should_default_to_consistent_cadence(void) {
+    /* Arrange */
+    dms_log_cleanup_Ignore();
+    dms_config_init();
+
+    /* Act */
+    const dms_telemetry_config_t* telemetry_config = dms_config_get_telemetry();
+
+    /* Assert - 取樣比區間密、區間比上傳密，斷線保留量至少涵蓋一個上傳週期 */
+    TEST_ASSERT_NOT_NULL(telemetry_config);
+    TEST_ASSERT_TRUE(telemetry_config->enabled);
+    TEST_ASSERT_EQUAL(TELEMETRY_SAMPLE_INTERVAL_MS, telemetry_config->sample_interval_ms);
+    TEST_ASSERT_TRUE(telemetry_config->sample_interval_ms < telemetry_config->bucket_seconds * 1000U);
+    TEST_ASSERT_TRUE(telemetry_config->bucket_seconds <= telemetry_config->publish_interval_seconds);
+    TEST_ASSERT_TRUE(TELEMETRY_RING_CAPACITY * telemetry_config->bucket_seconds >=
+                     telemetry_config->publish_interval_seconds);
+    TEST_ASSERT_TRUE(telemetry_config->max_buckets_per_publish > 0);
+}
+
+void test_dms_config_report_channel_should_default_to_http(void) {
+    /* Arrange */
+    dms_log_cleanup_Ignore();
+    dms_config_init();
+
+    /* Act */
+    const dms_report_config_t* report_config = dms_config_get_report();
+
+    /* Assert - 伺服器支援前所有端點走 HTTP；斷線保留時間不短於批次等待時間 */
+    TEST_ASSERT_NOT_NULL(report_config);
+    TEST_ASSERT_FALSE(report_config->mqtt_control_progress);
+    TEST_ASSERT_FALSE(report_config->mqtt_fw_progress);
+    TEST_ASSERT_FALSE(report_config->mqtt_device_info);
+    TEST_ASSERT_EQUAL(DMS_REPORT_BATCH_WINDOW_MS, report_config->batch_window_ms);
+    TEST_ASSERT_TRUE(report_config->batch_window_ms <= report_config->max_hold_ms);
+}
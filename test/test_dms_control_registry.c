@@ -0,0 +1,248 @@
+/*
+ * Unit Tests for DMS Control Item Registry
+ *
+ * Tests cover:
+ * - Registration up to the table limit and lookup after collisions
+ * - Re-registration replacing an existing item
+ * - Unknown items, missing values and validation failures
+ * - One apply call per group, items kept in batch order
+ * - Parallel groups overlapping in time, serial groups staying on the caller's thread
+ */
+
+#include "unity.h"
+#include "dms_control_registry.h"
+#include "mock_dms_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define TEST_INVALID_VALUE    ( 7 )
+#define TEST_SLOW_APPLY_US    ( 100000U )
+
+/* 每個群組各自記錄呼叫 */
+typedef struct {
+    int calls;
+    size_t count;
+    const char* items[DMS_CONTROL_REGISTRY_MAX_BATCH];
+} group_calls_t;
+
+static group_calls_t g_radio_calls;
+static group_calls_t g_led_calls;
+
+static void record_calls(group_calls_t* calls, const char* const* items, int* results, size_t count) {
+    calls->calls++;
+    calls->count = count;
+    for (size_t i = 0; i < count; i++) {
+        calls->items[i] = items[i];
+        results[i] = DMS_SUCCESS;
+    }
+}
+
+static int apply_radio(const char* const* items, const char* const* values, int* results, size_t count) {
+    (void)values;
+    record_calls(&g_radio_calls, items, results, count);
+    return DMS_SUCCESS;
+}
+
+static int apply_led(const char* const* items, const char* const* values, int* results, size_t count) {
+    (void)values;
+    record_calls(&g_led_calls, items, results, count);
+    return DMS_SUCCESS;
+}
+
+/* 慢速群組記錄同時執行的數量與執行緒 */
+static pthread_mutex_t g_slow_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int g_slow_running;
+static int g_slow_max_running;
+static pthread_t g_led_thread;
+
+static int apply_slow(const char* const* items, const char* const* values, int* results, size_t count) {
+    (void)items;
+    (void)values;
+    pthread_mutex_lock(&g_slow_mutex);
+    if (++g_slow_running > g_slow_max_running) {
+        g_slow_max_running = g_slow_running;
+    }
+    pthread_mutex_unlock(&g_slow_mutex);
+
+    usleep(TEST_SLOW_APPLY_US);
+
+    pthread_mutex_lock(&g_slow_mutex);
+    g_slow_running--;
+    pthread_mutex_unlock(&g_slow_mutex);
+
+    for (size_t i = 0; i < count; i++) {
+        results[i] = DMS_SUCCESS;
+    }
+    return DMS_SUCCESS;
+}
+
+static int apply_led_on_thread(const char* const* items, const char* const* values, int* results, size_t count) {
+    g_led_thread = pthread_self();
+    return apply_led(items, values, results, count);
+}
+
+static int validate_digits(const char* item, const char* value) {
+    (void)item;
+    return (value[0] >= '0' && value[0] <= '9') ? DMS_SUCCESS : TEST_INVALID_VALUE;
+}
+
+static const dms_control_item_t g_items[] = {
+    { "channel2g", "radio", validate_digits, 1 },
+    { "channel5g", "radio", validate_digits, 2 },
+    { "brightness", "led", NULL, 3 },
+    { "orphan", "no-such-group", NULL, 4 },
+    { "fan", "slow-a", NULL, 5 },
+    { "display", "slow-b", NULL, 6 },
+};
+
+void setUp(void) {
+    dms_log_printf_Ignore();
+    dms_control_registry_reset();
+    memset(&g_radio_calls, 0, sizeof(g_radio_calls));
+    memset(&g_led_calls, 0, sizeof(g_led_calls));
+    g_slow_running = 0;
+    g_slow_max_running = 0;
+
+    dms_control_registry_register_group("radio", apply_radio, 0);
+    dms_control_registry_register_group("led", apply_led, 0);
+    dms_control_registry_register_group("slow-a", apply_slow, DMS_CONTROL_GROUP_PARALLEL);
+    dms_control_registry_register_group("slow-b", apply_slow, DMS_CONTROL_GROUP_PARALLEL);
+    dms_control_registry_register_items(g_items, sizeof(g_items) / sizeof(g_items[0]));
+}
+
+void tearDown(void) {
+    dms_control_registry_reset();
+}
+
+void test_registry_should_find_every_item_up_to_capacity(void) {
+    /* Arrange - 填滿表格，名稱相近的項目必然發生探測碰撞 */
+    static char names[DMS_CONTROL_REGISTRY_MAX_ITEMS + 1][16];
+    static dms_control_item_t items[DMS_CONTROL_REGISTRY_MAX_ITEMS + 1];
+    dms_control_registry_reset();
+
+    for (size_t i = 0; i <= DMS_CONTROL_REGISTRY_MAX_ITEMS; i++) {
+        snprintf(names[i], sizeof(names[i]), "item%u", (unsigned)i);
+        items[i].item = names[i];
+        items[i].group = "radio";
+        items[i].id = (int)i;
+    }
+
+    /* Act */
+    dms_result_t filled = dms_control_registry_register_items(items, DMS_CONTROL_REGISTRY_MAX_ITEMS);
+    dms_result_t overflow = dms_control_registry_register_items(&items[DMS_CONTROL_REGISTRY_MAX_ITEMS], 1);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, filled);
+    TEST_ASSERT_EQUAL(DMS_ERROR_BUFFER_OVERFLOW, overflow);
+    TEST_ASSERT_EQUAL(DMS_CONTROL_REGISTRY_MAX_ITEMS, dms_control_registry_get_item_count());
+    for (size_t i = 0; i < DMS_CONTROL_REGISTRY_MAX_ITEMS; i++) {
+        TEST_ASSERT_EQUAL_PTR(&items[i], dms_control_registry_find(names[i]));
+    }
+    TEST_ASSERT_NULL(dms_control_registry_find(names[DMS_CONTROL_REGISTRY_MAX_ITEMS]));
+}
+
+void test_registry_should_replace_item_registered_twice(void) {
+    /* Arrange */
+    static const dms_control_item_t replacement = { "brightness", "radio", NULL, 9 };
+    size_t before = dms_control_registry_get_item_count();
+
+    /* Act */
+    dms_result_t result = dms_control_registry_register_items(&replacement, 1);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, result);
+    TEST_ASSERT_EQUAL(before, dms_control_registry_get_item_count());
+    TEST_ASSERT_EQUAL_PTR(&replacement, dms_control_registry_find("brightness"));
+}
+
+void test_registry_apply_should_report_unsupported_items(void) {
+    /* Arrange */
+    const char* items[] = { "unknown", "orphan", "channel2g" };
+    const char* values[] = { "1", "1", "6" };
+    int results[3];
+
+    /* Act */
+    int result = dms_control_registry_apply(items, values, results, 3);
+
+    /* Assert - 未註冊與沒有套用函數的項目不送出，其他項目照常套用 */
+    TEST_ASSERT_EQUAL(DMS_ERROR_UNSUPPORTED, result);
+    TEST_ASSERT_EQUAL(DMS_ERROR_UNSUPPORTED, results[0]);
+    TEST_ASSERT_EQUAL(DMS_ERROR_UNSUPPORTED, results[1]);
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, results[2]);
+    TEST_ASSERT_EQUAL(1, g_radio_calls.calls);
+    TEST_ASSERT_EQUAL(1, g_radio_calls.count);
+}
+
+void test_registry_apply_should_not_send_invalid_values(void) {
+    /* Arrange */
+    const char* items[] = { "channel2g", "channel5g" };
+    const char* values[] = { "auto", NULL };
+    int results[2];
+
+    /* Act */
+    int result = dms_control_registry_apply(items, values, results, 2);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(TEST_INVALID_VALUE, result);
+    TEST_ASSERT_EQUAL(TEST_INVALID_VALUE, results[0]);
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_PARAMETER, results[1]);
+    TEST_ASSERT_EQUAL(0, g_radio_calls.calls);
+}
+
+void test_registry_apply_should_call_each_group_once_in_order(void) {
+    /* Arrange */
+    const char* items[] = { "channel5g", "brightness", "channel2g" };
+    const char* values[] = { "36", "80", "6" };
+    int results[3];
+
+    /* Act */
+    int result = dms_control_registry_apply(items, values, results, 3);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, result);
+    TEST_ASSERT_EQUAL(1, g_radio_calls.calls);
+    TEST_ASSERT_EQUAL(2, g_radio_calls.count);
+    TEST_ASSERT_EQUAL_STRING("channel5g", g_radio_calls.items[0]);
+    TEST_ASSERT_EQUAL_STRING("channel2g", g_radio_calls.items[1]);
+    TEST_ASSERT_EQUAL(1, g_led_calls.calls);
+    TEST_ASSERT_EQUAL_STRING("brightness", g_led_calls.items[0]);
+}
+
+void test_registry_apply_should_overlap_parallel_groups(void) {
+    /* Arrange */
+    const char* items[] = { "fan", "display" };
+    const char* values[] = { "on", "dim" };
+    int results[2];
+
+    /* Act */
+    int result = dms_control_registry_apply(items, values, results, 2);
+
+    /* Assert - 兩個慢速群組同時執行，而非逐一等待 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, result);
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, results[0]);
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, results[1]);
+    TEST_ASSERT_EQUAL(2, g_slow_max_running);
+    TEST_ASSERT_EQUAL(0, g_slow_running);
+}
+
+void test_registry_apply_should_keep_serial_groups_on_caller_thread(void) {
+    /* Arrange */
+    const char* items[] = { "fan", "channel5g", "display", "brightness", "channel2g" };
+    const char* values[] = { "on", "36", "dim", "80", "6" };
+    int results[5];
+    dms_control_registry_register_group("led", apply_led_on_thread, 0);
+
+    /* Act */
+    int result = dms_control_registry_apply(items, values, results, 5);
+
+    /* Assert - 平行群組重疊執行，依序群組在調用者的執行緒中且保持項目順序 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, result);
+    TEST_ASSERT_EQUAL(2, g_slow_max_running);
+    TEST_ASSERT_TRUE(pthread_equal(pthread_self(), g_led_thread));
+    TEST_ASSERT_EQUAL(1, g_radio_calls.calls);
+    TEST_ASSERT_EQUAL_STRING("channel5g", g_radio_calls.items[0]);
+    TEST_ASSERT_EQUAL_STRING("channel2g", g_radio_calls.items[1]);
+    TEST_ASSERT_EQUAL(1, g_led_calls.calls);
+}
@@ -0,0 +1,140 @@
+/*
+ * Unit Tests for DMS JSON Schema Decoder
+ *
+ * Tests cover:
+ * - Nested paths, integer and boolean fields, raw JSON text for non-string values
+ * - Required fields: missing or null values fail the decode
+ * - Strings longer than the member: truncated when allowed, otherwise cleared and reported
+ * - Integer range checks
+ */
+
+#include "unity.h"
+#include "dms_json_decode.h"
+#include "mock_dms_log.h"
+#include <string.h>
+
+#define TEST_MAX_TOKENS    ( 64U )
+
+typedef struct {
+    char name[8];
+    char note[8];
+    char raw[16];
+    int32_t count;
+    uint32_t id;
+    bool enabled;
+} test_record_t;
+
+enum {
+    FIELD_NAME = 0,
+    FIELD_NOTE,
+    FIELD_RAW,
+    FIELD_COUNT,
+    FIELD_ID,
+    FIELD_ENABLED
+};
+
+static const dms_json_field_t g_fields[] = {
+    DMS_JSON_FIELD(test_record_t, name, "name", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_REQUIRED),
+    DMS_JSON_FIELD(test_record_t, note, "info.note", DMS_JSON_FIELD_STRING, DMS_JSON_FIELD_TRUNCATE),
+    DMS_JSON_FIELD(test_record_t, raw, "info.raw", DMS_JSON_FIELD_STRING, 0),
+    DMS_JSON_FIELD(test_record_t, count, "count", DMS_JSON_FIELD_INT32, 0),
+    DMS_JSON_FIELD(test_record_t, id, "info.id", DMS_JSON_FIELD_UINT32, 0),
+    DMS_JSON_FIELD(test_record_t, enabled, "enabled", DMS_JSON_FIELD_BOOL, 0),
+};
+
+static dms_json_token_t g_tokens[TEST_MAX_TOKENS];
+static dms_json_index_t g_index;
+static test_record_t g_record;
+static uint32_t g_decoded;
+
+static dms_result_t decode(const char* json) {
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, dms_json_index_build(&g_index, json, strlen(json),
+                                                        g_tokens, TEST_MAX_TOKENS));
+    return dms_json_decode(&g_index, DMS_JSON_INDEX_ROOT, g_fields,
+                           sizeof(g_fields) / sizeof(g_fields[0]), &g_record, &g_decoded);
+}
+
+void setUp(void) {
+    dms_log_printf_Ignore();
+    memset(&g_record, 0, sizeof(g_record));
+    g_decoded = 0;
+}
+
+void tearDown(void) {
+}
+
+void test_decode_should_fill_nested_and_typed_fields(void) {
+    /* Act */
+    dms_result_t result = decode("{\"count\":-3,\"info\":{\"id\":\"42\",\"note\":\"a\\/b\","
+                                 "\"raw\":[1,2]},\"name\":\"ap\",\"enabled\":true}");
+
+    /* Assert - 字串形式的整數也接受，非字串值保留原始 JSON 文字 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, result);
+    TEST_ASSERT_EQUAL_STRING("ap", g_record.name);
+    TEST_ASSERT_EQUAL_STRING("a/b", g_record.note);
+    TEST_ASSERT_EQUAL_STRING("[1,2]", g_record.raw);
+    TEST_ASSERT_EQUAL(-3, g_record.count);
+    TEST_ASSERT_EQUAL(42, g_record.id);
+    TEST_ASSERT_TRUE(g_record.enabled);
+    TEST_ASSERT_EQUAL(0x3F, g_decoded);
+}
+
+void test_decode_should_fail_when_required_field_is_missing_or_null(void) {
+    /* Act */
+    dms_result_t missing = decode("{\"count\":1}");
+    uint32_t missing_decoded = g_decoded;
+    dms_result_t null_value = decode("{\"name\":null,\"count\":2}");
+
+    /* Assert - 其他欄位照常解碼 */
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, missing);
+    TEST_ASSERT_EQUAL(1U << FIELD_COUNT, missing_decoded);
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, null_value);
+    TEST_ASSERT_EQUAL(2, g_record.count);
+    TEST_ASSERT_EQUAL_STRING("", g_record.name);
+}
+
+void test_decode_should_truncate_long_strings_when_allowed(void) {
+    /* Act - note 容量 8 位元組，多位元組字元不可被切開 */
+    dms_result_t plain = decode("{\"name\":\"ap\",\"info\":{\"note\":\"0123456789\"}}");
+    char plain_note[sizeof(g_record.note)];
+    memcpy(plain_note, g_record.note, sizeof(plain_note));
+    dms_result_t utf8 = decode("{\"name\":\"ap\",\"info\":{\"note\":\"abcdef\\u00e9\"}}");
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, plain);
+    TEST_ASSERT_EQUAL_STRING("0123456", plain_note);
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, utf8);
+    TEST_ASSERT_EQUAL_STRING("abcdef", g_record.note);
+    TEST_ASSERT_TRUE(g_decoded & (1U << FIELD_NOTE));
+}
+
+void test_decode_should_clear_and_report_overflow_without_truncate(void) {
+    /* Arrange */
+    strcpy(g_record.raw, "old");
+
+    /* Act - name 為必要欄位但已出現，錯誤為容量不足而非缺少欄位 */
+    dms_result_t string_overflow = decode("{\"name\":\"too-long-name\",\"count\":5}");
+    char name[sizeof(g_record.name)];
+    memcpy(name, g_record.name, sizeof(name));
+    uint32_t string_decoded = g_decoded;
+    dms_result_t raw_overflow = decode("{\"name\":\"ap\",\"info\":{\"raw\":[1,2,3,4,5,6,7,8]}}");
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(DMS_ERROR_BUFFER_OVERFLOW, string_overflow);
+    TEST_ASSERT_EQUAL_STRING("", name);
+    TEST_ASSERT_EQUAL(1U << FIELD_COUNT, string_decoded);
+    TEST_ASSERT_EQUAL(5, g_record.count);
+    TEST_ASSERT_EQUAL(DMS_ERROR_BUFFER_OVERFLOW, raw_overflow);
+    TEST_ASSERT_EQUAL_STRING("", g_record.raw);
+}
+
+void test_decode_should_reject_integers_out_of_range(void) {
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, decode("{\"name\":\"ap\",\"count\":-2147483648,\"info\":{\"id\":4294967295}}"));
+    TEST_ASSERT_EQUAL(INT32_MIN, g_record.count);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, g_record.id);
+
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, decode("{\"name\":\"ap\",\"count\":2147483648}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, decode("{\"name\":\"ap\",\"info\":{\"id\":-1}}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, decode("{\"name\":\"ap\",\"count\":1.5}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, decode("{\"name\":\"ap\",\"enabled\":1}"));
+}
@@ -0,0 +1,242 @@
+/*
+ * Unit Tests for DMS JSON Structural Index
+ *
+ * Tests cover:
+ * - Index layout and path lookup
+ * - String escapes, \u surrogate pairs and invalid UTF-8
+ * - Number grammar
+ * - Nesting depth and token capacity limits
+ * - Special bytes at every position across the 16/32-byte SIMD blocks and the scalar tail
+ *
+ * 字串掃描路徑由編譯選項決定：x86-64 預設為 SSE2，-mavx2 為 AVX2，ARM 為 NEON，
+ * 定義 DMS_JSON_INDEX_SCALAR 時為純量版本。各路徑執行同一組測試，結果必須一致。
+ */
+
+#include "unity.h"
+#include "dms_json_index.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_MAX_TOKENS    ( 64U )
+#define TEST_SWEEP_LENGTH  ( 80U )
+
+static dms_json_token_t g_tokens[TEST_MAX_TOKENS];
+static dms_json_index_t g_index;
+
+static dms_result_t build(const char* json) {
+    return dms_json_index_build(&g_index, json, strlen(json), g_tokens, TEST_MAX_TOKENS);
+}
+
+/* 在長字串值的第 offset 個位元組放入 special，其餘填入一般字元 */
+static dms_result_t build_with_special_at(size_t offset, const char* special) {
+    static char json[TEST_SWEEP_LENGTH * 2];
+    char value[TEST_SWEEP_LENGTH + 8];
+
+    memset(value, 'a', offset);
+    value[offset] = '\0';
+    strcat(value, special);
+    size_t used = strlen(value);
+    memset(value + used, 'b', TEST_SWEEP_LENGTH - offset);
+    value[used + TEST_SWEEP_LENGTH - offset] = '\0';
+
+    snprintf(json, sizeof(json), "{\"k\":\"%s\"}", value);
+    return build(json);
+}
+
+void setUp(void) {
+    memset(&g_index, 0, sizeof(g_index));
+}
+
+void tearDown(void) {
+}
+
+void test_json_index_should_build_tape_and_find_paths(void) {
+    /* Arrange */
+    const char* json = "{\"state\":{\"a\":[1,{\"b\":true}],\"c\":\"x\"},\"version\":42}";
+    uint64_t version;
+
+    /* Act */
+    dms_result_t result = build(json);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, result);
+    TEST_ASSERT_EQUAL(DMS_JSON_TYPE_OBJECT, dms_json_index_type(&g_index, DMS_JSON_INDEX_ROOT));
+    TEST_ASSERT_EQUAL(DMS_JSON_TYPE_ARRAY,
+                      dms_json_index_type(&g_index, dms_json_index_find(&g_index, DMS_JSON_INDEX_ROOT, "state.a")));
+    TEST_ASSERT_EQUAL(DMS_JSON_TYPE_STRING,
+                      dms_json_index_type(&g_index, dms_json_index_find(&g_index, DMS_JSON_INDEX_ROOT, "state.c")));
+    TEST_ASSERT_TRUE(dms_json_index_get_uint(&g_index,
+                                             dms_json_index_find(&g_index, DMS_JSON_INDEX_ROOT, "version"),
+                                             &version));
+    TEST_ASSERT_EQUAL(42, version);
+    TEST_ASSERT_EQUAL(DMS_JSON_INDEX_NOT_FOUND, dms_json_index_find(&g_index, DMS_JSON_INDEX_ROOT, "state.b"));
+}
+
+void test_json_index_should_decode_escapes(void) {
+    /* Arrange */
+    char buffer[64];
+    size_t length;
+
+    /* Act */
+    dms_result_t result = build("{\"s\":\"q\\\"b\\\\s\\/n\\nt\\tu\\u00e9\\ud83d\\ude00\"}");
+    dms_result_t decoded = dms_json_index_get_string(&g_index,
+                                                     dms_json_index_child(&g_index, DMS_JSON_INDEX_ROOT, "s", 1),
+                                                     buffer, sizeof(buffer), &length);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, result);
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, decoded);
+    TEST_ASSERT_EQUAL_STRING("q\"b\\s/n\nt\tu\xC3\xA9\xF0\x9F\x98\x80", buffer);
+    TEST_ASSERT_EQUAL(strlen(buffer), length);
+}
+
+void test_json_index_should_reject_invalid_escapes(void) {
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("{\"s\":\"\\x\"}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("{\"s\":\"\\u12G4\"}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("{\"s\":\"\\u12\"}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("{\"s\":\"\\"));
+}
+
+void test_json_index_should_reject_unpaired_surrogates_when_decoding(void) {
+    /* Arrange */
+    char buffer[16];
+
+    /* Act & Assert - 格式正確的 \u 可以建立索引，反跳脫時才檢查代理對 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, build("[\"\\ud83d\",\"\\ude00\",\"\\ud83d\\u0041\"]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, dms_json_index_get_string(&g_index, 1, buffer, sizeof(buffer), NULL));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, dms_json_index_get_string(&g_index, 2, buffer, sizeof(buffer), NULL));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, dms_json_index_get_string(&g_index, 3, buffer, sizeof(buffer), NULL));
+}
+
+void test_json_index_should_validate_utf8(void) {
+    /* 有效：2、3、4 位元組序列 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, build("[\"\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80\"]"));
+
+    /* 過長編碼 */
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[\"\xC0\xAF\"]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[\"\xE0\x80\xAF\"]"));
+    /* 代理區與超過 U+10FFFF */
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[\"\xED\xA0\x80\"]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[\"\xF4\x90\x80\x80\"]"));
+    /* 缺少延續位元組、單獨的延續位元組 */
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[\"\xE4\xB8\"]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[\"\x80\"]"));
+    /* 未跳脫的控制字元 */
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[\"a\tb\"]"));
+}
+
+void test_json_index_should_follow_number_grammar(void) {
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, build("[0,-0,12,-3.25,1e9,2E+3,4.5e-6]"));
+    TEST_ASSERT_EQUAL(7, g_index.count - 1);
+
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[01]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[-]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[1.]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[.5]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[1e]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[1e+]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[+1]"));
+}
+
+void test_json_index_get_uint_should_reject_non_integers_and_overflow(void) {
+    /* Arrange */
+    uint64_t value;
+
+    /* Act */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, build("[18446744073709551615,18446744073709551616,-1,1.0]"));
+
+    /* Assert */
+    TEST_ASSERT_TRUE(dms_json_index_get_uint(&g_index, 1, &value));
+    TEST_ASSERT_TRUE(value == UINT64_MAX);
+    TEST_ASSERT_FALSE(dms_json_index_get_uint(&g_index, 2, &value));
+    TEST_ASSERT_FALSE(dms_json_index_get_uint(&g_index, 3, &value));
+    TEST_ASSERT_FALSE(dms_json_index_get_uint(&g_index, 4, &value));
+}
+
+void test_json_index_should_limit_nesting_depth(void) {
+    /* Arrange */
+    char json[2 * DMS_JSON_INDEX_MAX_DEPTH + 4];
+
+    memset(json, '[', DMS_JSON_INDEX_MAX_DEPTH);
+    memset(json + DMS_JSON_INDEX_MAX_DEPTH, ']', DMS_JSON_INDEX_MAX_DEPTH);
+    json[2 * DMS_JSON_INDEX_MAX_DEPTH] = '\0';
+
+    /* Act & Assert - 剛好達到上限可以接受，多一層則拒絕 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, build(json));
+
+    memset(json, '[', DMS_JSON_INDEX_MAX_DEPTH + 1);
+    memset(json + DMS_JSON_INDEX_MAX_DEPTH + 1, ']', DMS_JSON_INDEX_MAX_DEPTH + 1);
+    json[2 * DMS_JSON_INDEX_MAX_DEPTH + 2] = '\0';
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build(json));
+}
+
+void test_json_index_should_report_token_overflow(void) {
+    /* Arrange - 陣列本身加上 n 個元素共需 n + 1 個 token */
+    char json[TEST_MAX_TOKENS * 2 + 4];
+    size_t length = 0;
+
+    json[length++] = '[';
+    for (uint32_t i = 0; i < TEST_MAX_TOKENS - 1; i++) {
+        if (i != 0) {
+            json[length++] = ',';
+        }
+        json[length++] = '0';
+    }
+    json[length++] = ']';
+    json[length] = '\0';
+
+    /* Act & Assert - 剛好填滿容量可以接受，多一個元素則回報容量不足 */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, build(json));
+    TEST_ASSERT_EQUAL(TEST_MAX_TOKENS, g_index.count);
+
+    memcpy(json + length - 1, ",0]", 4);
+    TEST_ASSERT_EQUAL(DMS_ERROR_BUFFER_OVERFLOW, build(json));
+}
+
+void test_json_index_should_reject_malformed_structure(void) {
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("{\"a\":1,}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[1,]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("{\"a\" 1}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("{1:1}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[1] [2]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("[tru]"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_JSON, build("{\"a\":[1}"));
+    TEST_ASSERT_EQUAL(DMS_ERROR_INVALID_PARAMETER,
+                      dms_json_index_build(&g_index, "", 0, g_tokens, TEST_MAX_TOKENS));
+}
+
+void test_json_index_should_find_special_bytes_at_every_block_position(void) {
+    /* 逐一移動特殊位元組，涵蓋 SIMD 區塊內每個位置、區塊邊界與尾端的純量迴圈 */
+    for (size_t offset = 0; offset < TEST_SWEEP_LENGTH; offset++) {
+        char message[32];
+        snprintf(message, sizeof(message), "offset %u", (unsigned)offset);
+
+        TEST_ASSERT_EQUAL_MESSAGE(DMS_SUCCESS, build_with_special_at(offset, ""), message);
+        TEST_ASSERT_EQUAL_MESSAGE(TEST_SWEEP_LENGTH, g_tokens[2].length, message);
+
+        TEST_ASSERT_EQUAL_MESSAGE(DMS_SUCCESS, build_with_special_at(offset, "\\n"), message);
+        TEST_ASSERT_EQUAL_MESSAGE(DMS_SUCCESS, build_with_special_at(offset, "\xC3\xA9"), message);
+        TEST_ASSERT_EQUAL_MESSAGE(DMS_ERROR_INVALID_JSON, build_with_special_at(offset, "\x01"), message);
+        TEST_ASSERT_EQUAL_MESSAGE(DMS_ERROR_INVALID_JSON, build_with_special_at(offset, "\x1F"), message);
+        TEST_ASSERT_EQUAL_MESSAGE(DMS_ERROR_INVALID_JSON, build_with_special_at(offset, "\xFF"), message);
+        TEST_ASSERT_EQUAL_MESSAGE(DMS_ERROR_INVALID_JSON, build_with_special_at(offset, "\\q"), message);
+
+        /* 提前出現的引號結束字串，後續字元使文件無效 */
+        TEST_ASSERT_EQUAL_MESSAGE(DMS_ERROR_INVALID_JSON, build_with_special_at(offset, "\""), message);
+    }
+}
+
+void test_json_index_should_accept_space_and_tilde_bytes(void) {
+    /* 0x20 與 0x7E 位於控制字元與非 ASCII 的比較邊界，不可誤判 */
+    char json[TEST_SWEEP_LENGTH + 16];
+    char value[TEST_SWEEP_LENGTH + 1];
+
+    for (size_t i = 0; i < TEST_SWEEP_LENGTH; i++) {
+        value[i] = (i % 2 == 0) ? ' ' : '~';
+    }
+    value[TEST_SWEEP_LENGTH] = '\0';
+    snprintf(json, sizeof(json), "[\"%s\"]", value);
+
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, build(json));
+    TEST_ASSERT_EQUAL(TEST_SWEEP_LENGTH, g_tokens[1].length);
+}
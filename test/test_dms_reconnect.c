@@ -12,13 +12,15 @@
  * 4. 依賴注入介面 (3個測試)
  * 5. 重連邏輯 (4個測試)
  * 6. 錯誤處理 (2個測試)
+ * 7. 重連延遲產生器 (2個測試)
  *
- * 總計：20個測試案例，目標覆蓋率 90%
+ * 總計：22個測試案例，目標覆蓋率 90%
  */
 
 #include "unity.h"
 // #include "dms_reconnect.h"  // 暫時註解，避免AWS IoT依賴
 #include "dms_config.h"
+#include "dms_reconnect_jitter.h"
 // #include "demo_config.h"     // 暫時註解，包含 core_mqtt.h
 #include "mock_dms_log.h"
 // #include "mock_dms_aws_iot.h"  // 暫時註解，避免編譯錯誤
@@ -561,6 +563,47 @@ void test_invalid_parameter_handling(void) {
     TEST_ASSERT_TRUE(true);  /* 測試通過表示沒有崩潰 */
 }
 
+/*-----------------------------------------------------------*/
+/* 7. 重連延遲產生器測試 (2個測試) */
+/*-----------------------------------------------------------*/
+
+void test_reconnect_jitter_should_stay_within_base_and_cap(void) {
+    /* Arrange */
+    dms_reconnect_jitter_t jitter;
+    dms_reconnect_jitter_init(&jitter, dms_reconnect_jitter_seed("ABA1AE692AAE"), 2000, 300000);
+
+    /* Act & Assert - 延遲不超過上次的 3 倍，且長時間失敗後仍在上限內 */
+    uint32_t prev = 2000;
+    for (int i = 0; i < 200; i++) {
+        uint32_t delay = dms_reconnect_jitter_next(&jitter);
+        TEST_ASSERT_GREATER_OR_EQUAL(2000, delay);
+        TEST_ASSERT_LESS_OR_EQUAL(300000, delay);
+        TEST_ASSERT_LESS_OR_EQUAL(prev * 3, delay);
+        prev = delay;
+    }
+}
+
+void test_reconnect_jitter_should_be_deterministic_per_device(void) {
+    /* Arrange - 相同 MAC 的兩個產生器與相鄰 MAC 的產生器 */
+    dms_reconnect_jitter_t a, b, neighbour;
+    dms_reconnect_jitter_init(&a, dms_reconnect_jitter_seed("ABA1AE692AAE"), 2000, 300000);
+    dms_reconnect_jitter_init(&b, dms_reconnect_jitter_seed("ABA1AE692AAE"), 2000, 300000);
+    dms_reconnect_jitter_init(&neighbour, dms_reconnect_jitter_seed("ABA1AE692AAF"), 2000, 300000);
+
+    /* Act */
+    int same = 0, differ = 0;
+    for (int i = 0; i < 8; i++) {
+        uint32_t delay = dms_reconnect_jitter_next(&a);
+        same += (delay == dms_reconnect_jitter_next(&b));
+        differ += (delay != dms_reconnect_jitter_next(&neighbour));
+    }
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(8, same);
+    TEST_ASSERT_GREATER_THAN(0, differ);
+    TEST_ASSERT_NOT_EQUAL(0, dms_reconnect_jitter_seed(NULL));
+}
+
 /*-----------------------------------------------------------*/
 /* 主測試執行函數 */
 /*-----------------------------------------------------------*/
@@ -573,5 +616,5 @@ void test_invalid_parameter_handling(void) {
  * 1. setUp() -> test_xxx() -> tearDown()
  * 2. 重複上述過程，直到所有測試完成
  *
- * 預期結果：20/20 測試通過，覆蓋率 >90%
+ * 預期結果：22/22 測試通過，覆蓋率 >90%
  */
@@ -0,0 +1,223 @@
+/*
+ * Unit Tests for DMS Reconnect Scheduling
+ *
+ * test_dms_reconnect.c 以測試內的替身實作 dms_reconnect_*，這裡直接測試 dms_reconnect.c
+ *
+ * Tests cover:
+ * - First attempt right after a disconnect, retries only after the backoff deadline
+ * - Repeated disconnect notifications keeping the scheduled deadline
+ * - Bringing an attempt forward, never pushing it back
+ * - Cancel keeping the retry count, uplink restored while an attempt is pending
+ * - Deadlines across a Clock_GetTimeMs() wrap
+ */
+
+#include "unity.h"
+#include "dms_reconnect.h"
+#include "dms_reconnect_jitter.h"
+#include "mock_dms_log.h"
+#include "mock_clock.h"
+#include <string.h>
+
+#define TEST_BASE_DELAY_SECONDS    ( 5U )
+#define TEST_MAX_DELAY_SECONDS     ( 300U )
+
+/* 以假的時鐘與連線介面驅動重連計時器 */
+static uint32_t g_now_ms;
+static dms_result_t g_connect_result;
+static int g_connect_count;
+
+static uint32_t fake_clock(int num_calls) {
+    (void)num_calls;
+    return g_now_ms;
+}
+
+static dms_result_t fake_connect(void) {
+    g_connect_count++;
+    return g_connect_result;
+}
+
+static dms_result_t fake_disconnect(void) {
+    return DMS_SUCCESS;
+}
+
+/* 讓第一次嘗試失敗，之後處於退避等待中 */
+static void fail_first_attempt(void) {
+    g_connect_result = DMS_ERROR_MQTT_FAILURE;
+    dms_reconnect_request();
+    TEST_ASSERT_FALSE(dms_reconnect_process());
+    g_connect_result = DMS_SUCCESS;
+}
+
+void setUp(void) {
+    dms_log_printf_Ignore();
+    Clock_GetTimeMs_StubWithCallback(fake_clock);
+
+    g_now_ms = 1000;
+    g_connect_result = DMS_SUCCESS;
+    g_connect_count = 0;
+
+    dms_reconnect_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.max_retry_attempts = 10;
+    config.base_delay_seconds = TEST_BASE_DELAY_SECONDS;
+    config.max_delay_seconds = TEST_MAX_DELAY_SECONDS;
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, dms_reconnect_init(&config));
+
+    dms_reconnect_interface_t interface = { fake_connect, fake_disconnect, NULL };
+    dms_reconnect_register_interface(&interface);
+}
+
+void tearDown(void) {
+    dms_reconnect_cleanup();
+}
+
+void test_reconnect_should_attempt_right_after_disconnect(void) {
+    /* Arrange */
+    TEST_ASSERT_FALSE(dms_reconnect_is_pending());
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, dms_reconnect_get_wait_ms());
+
+    /* Act */
+    dms_reconnect_request();
+    uint32_t wait_ms = dms_reconnect_get_wait_ms();
+    bool connected = dms_reconnect_process();
+
+    /* Assert */
+    TEST_ASSERT_EQUAL_UINT32(0, wait_ms);
+    TEST_ASSERT_TRUE(connected);
+    TEST_ASSERT_EQUAL(1, g_connect_count);
+    TEST_ASSERT_FALSE(dms_reconnect_is_pending());
+    TEST_ASSERT_EQUAL(CONNECTION_STATE_CONNECTED, dms_reconnect_get_state());
+}
+
+void test_reconnect_should_retry_only_after_backoff_deadline(void) {
+    /* Arrange */
+    fail_first_attempt();
+    uint32_t deadline_ms = 0;
+    TEST_ASSERT_TRUE(dms_reconnect_get_deadline(&deadline_ms));
+    uint32_t delay_ms = deadline_ms - g_now_ms;
+
+    /* Act */
+    g_now_ms = deadline_ms - 1;
+    bool early = dms_reconnect_process();
+    int attempts_before_deadline = g_connect_count;
+    g_now_ms = deadline_ms;
+    bool on_time = dms_reconnect_process();
+
+    /* Assert - 退避不少於基礎延遲、不超過上限 */
+    TEST_ASSERT_TRUE(delay_ms >= TEST_BASE_DELAY_SECONDS * 1000U);
+    TEST_ASSERT_TRUE(delay_ms <= TEST_MAX_DELAY_SECONDS * 1000U);
+    TEST_ASSERT_FALSE(early);
+    TEST_ASSERT_EQUAL(1, attempts_before_deadline);
+    TEST_ASSERT_TRUE(on_time);
+    TEST_ASSERT_EQUAL(2, g_connect_count);
+}
+
+void test_reconnect_request_while_pending_should_keep_deadline(void) {
+    /* Arrange */
+    fail_first_attempt();
+    uint32_t deadline_ms = 0;
+    dms_reconnect_get_deadline(&deadline_ms);
+
+    /* Act - 等待中再次收到斷線通知 */
+    g_now_ms += 1000;
+    dms_reconnect_request();
+
+    /* Assert */
+    uint32_t after_ms = 0;
+    TEST_ASSERT_TRUE(dms_reconnect_get_deadline(&after_ms));
+    TEST_ASSERT_EQUAL_UINT32(deadline_ms, after_ms);
+}
+
+void test_reconnect_bring_forward_should_never_delay_attempt(void) {
+    /* Arrange */
+    fail_first_attempt();
+    uint32_t deadline_ms = 0;
+    dms_reconnect_get_deadline(&deadline_ms);
+    uint32_t delay_ms = deadline_ms - g_now_ms;
+
+    /* Act */
+    dms_reconnect_bring_forward(delay_ms + 1000);
+    uint32_t after_later = dms_reconnect_get_wait_ms();
+    dms_reconnect_bring_forward(100);
+    uint32_t after_sooner = dms_reconnect_get_wait_ms();
+
+    /* Assert */
+    TEST_ASSERT_EQUAL_UINT32(delay_ms, after_later);
+    TEST_ASSERT_EQUAL_UINT32(100, after_sooner);
+}
+
+void test_reconnect_bring_forward_should_schedule_when_idle(void) {
+    /* Act */
+    dms_reconnect_bring_forward(200);
+
+    /* Assert */
+    TEST_ASSERT_TRUE(dms_reconnect_is_pending());
+    TEST_ASSERT_EQUAL_UINT32(200, dms_reconnect_get_wait_ms());
+}
+
+void test_reconnect_cancel_should_keep_retry_count(void) {
+    /* Arrange */
+    fail_first_attempt();
+
+    /* Act */
+    dms_reconnect_cancel();
+    g_now_ms += TEST_MAX_DELAY_SECONDS * 1000U;
+    bool attempted = dms_reconnect_process();
+    dms_reconnect_request();
+
+    /* Assert - 重新排程時沿用退避延遲，不會立即嘗試 */
+    uint32_t retry_count = 0;
+    dms_reconnect_get_stats(&retry_count, NULL);
+    TEST_ASSERT_FALSE(attempted);
+    TEST_ASSERT_EQUAL(1, g_connect_count);
+    TEST_ASSERT_EQUAL_UINT32(1, retry_count);
+    TEST_ASSERT_TRUE(dms_reconnect_get_wait_ms() >= TEST_BASE_DELAY_SECONDS * 1000U);
+}
+
+void test_uplink_restored_should_shorten_pending_attempt(void) {
+    /* Arrange - 多次失敗讓退避變長 */
+    fail_first_attempt();
+    g_connect_result = DMS_ERROR_MQTT_FAILURE;
+    for (int i = 0; i < 5; i++) {
+        g_now_ms += dms_reconnect_get_wait_ms();
+        dms_reconnect_process();
+    }
+    g_connect_result = DMS_SUCCESS;
+
+    /* Act */
+    dms_reconnect_uplink_restored();
+    uint32_t wait_ms = dms_reconnect_get_wait_ms();
+    g_now_ms += wait_ms;
+    bool connected = dms_reconnect_process();
+
+    /* Assert */
+    TEST_ASSERT_TRUE(wait_ms <= DMS_RECONNECT_UPLINK_JITTER_MS);
+    TEST_ASSERT_TRUE(connected);
+}
+
+void test_uplink_restored_while_connected_should_not_schedule(void) {
+    /* Act */
+    dms_reconnect_uplink_restored();
+
+    /* Assert */
+    TEST_ASSERT_FALSE(dms_reconnect_is_pending());
+    TEST_ASSERT_EQUAL(0, g_connect_count);
+}
+
+void test_reconnect_deadline_should_survive_clock_wrap(void) {
+    /* Arrange */
+    g_now_ms = UINT32_MAX - 100;
+    dms_reconnect_bring_forward(500);
+
+    /* Act */
+    g_now_ms += 300;    /* 回繞到 199 */
+    uint32_t wait_ms = dms_reconnect_get_wait_ms();
+    bool early = dms_reconnect_process();
+    g_now_ms += wait_ms;
+    bool on_time = dms_reconnect_process();
+
+    /* Assert */
+    TEST_ASSERT_EQUAL_UINT32(200, wait_ms);
+    TEST_ASSERT_FALSE(early);
+    TEST_ASSERT_TRUE(on_time);
+}
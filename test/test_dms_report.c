@@ -0,0 +1,251 @@
+/*
+ * Unit Tests for DMS Report Channel
+ *
+ * Tests cover:
+ * - Submitting reports and batching them into one message
+ * - Keeping a batch until PUBACK, one batch in flight at a time
+ * - HTTP fallback on publish failure, long disconnect and cleanup
+ * - Republishing with the same seq after a disconnect or a PUBACK timeout
+ */
+
+#include "unity.h"
+#include "dms_report.h"
+#include "dms_json_writer.h"
+#include "mock_dms_config.h"
+#include "mock_dms_log.h"
+#include "mock_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 以假的 MQTT 介面與時鐘驅動回報通道，PUBACK 回調經由 register_puback 取得 */
+static dms_report_config_t g_report_config;
+static mqtt_puback_callback_t g_puback;
+static uint32_t g_now_ms;
+static bool g_connected;
+static dms_result_t g_publish_result;
+static int g_publish_count;
+static uint16_t g_last_packet_id;
+static char g_last_payload[DMS_REPORT_PAYLOAD_SIZE];
+static int g_fallback_count;
+
+static uint32_t fake_clock(int num_calls) {
+    (void)num_calls;
+    return g_now_ms;
+}
+
+static dms_result_t fake_publish_tracked(const char* topic, const char* payload, size_t len,
+                                         uint16_t* packet_id) {
+    (void)topic;
+    g_publish_count++;
+    if (g_publish_result != DMS_SUCCESS) {
+        return g_publish_result;
+    }
+    snprintf(g_last_payload, sizeof(g_last_payload), "%.*s", (int)len, payload);
+    *packet_id = ++g_last_packet_id;
+    return DMS_SUCCESS;
+}
+
+static void fake_register_puback(mqtt_puback_callback_t callback) {
+    g_puback = callback;
+}
+
+static bool fake_is_connected(void) {
+    return g_connected;
+}
+
+static dms_result_t fake_fallback(dms_report_endpoint_t endpoint, const char* body) {
+    (void)endpoint;
+    (void)body;
+    g_fallback_count++;
+    return DMS_SUCCESS;
+}
+
+static unsigned long last_seq(void) {
+    const char* seq = strstr(g_last_payload, "\"seq\":");
+    return (seq != NULL) ? strtoul(seq + 6, NULL, 10) : 0;
+}
+
+static dms_result_t submit(const char* body) {
+    return dms_report_submit(DMS_REPORT_CONTROL_PROGRESS, body, strlen(body), fake_fallback);
+}
+
+/* 推進時鐘後處理一次 */
+static void advance_and_process(uint32_t ms) {
+    g_now_ms += ms;
+    dms_report_process();
+}
+
+void setUp(void) {
+    dms_log_printf_Ignore();
+    Clock_GetTimeMs_StubWithCallback(fake_clock);
+
+    memset(&g_report_config, 0, sizeof(g_report_config));
+    g_report_config.mqtt_control_progress = true;
+    g_report_config.batch_window_ms = 250;
+    g_report_config.max_hold_ms = 60000;
+    dms_config_get_report_IgnoreAndReturn(&g_report_config);
+
+    g_puback = NULL;
+    g_now_ms = 1000;
+    g_connected = true;
+    g_publish_result = DMS_SUCCESS;
+    g_publish_count = 0;
+    g_last_packet_id = 0;
+    g_last_payload[0] = '\0';
+    g_fallback_count = 0;
+
+    mqtt_interface_t mqtt_if = { 0 };
+    mqtt_if.publish_tracked = fake_publish_tracked;
+    mqtt_if.register_puback = fake_register_puback;
+    mqtt_if.is_connected = fake_is_connected;
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, dms_report_init(&mqtt_if));
+}
+
+void tearDown(void) {
+    dms_report_cleanup();
+}
+
+void test_report_should_batch_submissions_and_count_them_after_puback(void) {
+    /* Arrange */
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, submit("{\"id\":1}"));
+    TEST_ASSERT_EQUAL(DMS_SUCCESS, submit("{\"id\":2}"));
+
+    /* Act */
+    advance_and_process(g_report_config.batch_window_ms / 2);
+    int before_window = g_publish_count;
+    advance_and_process(g_report_config.batch_window_ms);
+    dms_report_stats_t before_ack;
+    dms_report_get_stats(&before_ack);
+    g_puback(g_last_packet_id);
+
+    /* Assert */
+    dms_report_stats_t stats;
+    dms_report_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, before_window);
+    TEST_ASSERT_EQUAL(1, g_publish_count);
+    TEST_ASSERT_NOT_NULL(strstr(g_last_payload, "[\"control_progress\",{\"id\":1}]"));
+    TEST_ASSERT_NOT_NULL(strstr(g_last_payload, "[\"control_progress\",{\"id\":2}]"));
+    TEST_ASSERT_EQUAL(0, before_ack.reports_published);
+    TEST_ASSERT_EQUAL(2, stats.reports_published);
+    TEST_ASSERT_EQUAL(1, stats.messages_published);
+    TEST_ASSERT_EQUAL(0, g_fallback_count);
+}
+
+void test_report_submit_should_fail_while_disconnected(void) {
+    /* Arrange */
+    g_connected = false;
+
+    /* Act & Assert - 呼叫者直接走 HTTP */
+    TEST_ASSERT_EQUAL(DMS_ERROR_MQTT_FAILURE, submit("{\"id\":1}"));
+}
+
+void test_report_publish_failure_should_fall_back_to_http(void) {
+    /* Arrange */
+    submit("{\"id\":1}");
+    submit("{\"id\":2}");
+    g_publish_result = DMS_ERROR_MQTT_FAILURE;
+
+    /* Act */
+    advance_and_process(g_report_config.batch_window_ms);
+
+    /* Assert */
+    dms_report_stats_t stats;
+    dms_report_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, g_fallback_count);
+    TEST_ASSERT_EQUAL(2, stats.reports_fallback);
+    TEST_ASSERT_EQUAL(1, stats.publish_failures);
+}
+
+void test_report_should_hold_next_batch_until_puback(void) {
+    /* Arrange */
+    submit("{\"id\":1}");
+    advance_and_process(g_report_config.batch_window_ms);
+    submit("{\"id\":2}");
+
+    /* Act */
+    advance_and_process(g_report_config.batch_window_ms);
+    int while_inflight = g_publish_count;
+    g_puback(g_last_packet_id);
+    advance_and_process(0);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, while_inflight);
+    TEST_ASSERT_EQUAL(2, g_publish_count);
+    TEST_ASSERT_NOT_NULL(strstr(g_last_payload, "{\"id\":2}"));
+}
+
+void test_report_should_republish_same_seq_after_reconnect(void) {
+    /* Arrange */
+    submit("{\"id\":1}");
+    advance_and_process(g_report_config.batch_window_ms);
+    unsigned long seq = last_seq();
+    uint16_t lost_packet = g_last_packet_id;
+
+    /* Act - PUBACK 到達前斷線，重新連線後重新發布 */
+    g_connected = false;
+    advance_and_process(1000);
+    int while_down = g_publish_count;
+    g_connected = true;
+    advance_and_process(1000);
+    g_puback(lost_packet);      /* 舊封包的確認不算數 */
+    dms_report_stats_t before_ack;
+    dms_report_get_stats(&before_ack);
+    g_puback(g_last_packet_id);
+
+    /* Assert */
+    dms_report_stats_t stats;
+    dms_report_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, while_down);
+    TEST_ASSERT_EQUAL(2, g_publish_count);
+    TEST_ASSERT_EQUAL(seq, last_seq());
+    TEST_ASSERT_EQUAL(0, before_ack.reports_published);
+    TEST_ASSERT_EQUAL(1, stats.reports_published);
+    TEST_ASSERT_EQUAL(1, stats.republish_count);
+    TEST_ASSERT_EQUAL(0, g_fallback_count);
+}
+
+void test_report_should_republish_when_puback_times_out(void) {
+    /* Arrange */
+    submit("{\"id\":1}");
+    advance_and_process(g_report_config.batch_window_ms);
+    unsigned long seq = last_seq();
+
+    /* Act */
+    advance_and_process(DMS_REPORT_ACK_TIMEOUT_MS - 1);
+    int before_timeout = g_publish_count;
+    advance_and_process(1);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, before_timeout);
+    TEST_ASSERT_EQUAL(2, g_publish_count);
+    TEST_ASSERT_EQUAL(seq, last_seq());
+}
+
+void test_report_should_fall_back_when_disconnected_past_hold_time(void) {
+    /* Arrange */
+    submit("{\"id\":1}");
+    advance_and_process(g_report_config.batch_window_ms);
+    g_connected = false;
+
+    /* Act */
+    advance_and_process(g_report_config.max_hold_ms);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, g_publish_count);
+    TEST_ASSERT_EQUAL(1, g_fallback_count);
+}
+
+void test_report_cleanup_should_fall_back_unconfirmed_reports(void) {
+    /* Arrange - 一批等待 PUBACK，一筆尚未發布 */
+    submit("{\"id\":1}");
+    advance_and_process(g_report_config.batch_window_ms);
+    submit("{\"id\":2}");
+
+    /* Act */
+    dms_report_cleanup();
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, g_publish_count);
+    TEST_ASSERT_EQUAL(2, g_fallback_count);
+}
@@ -9,17 +9,114 @@
  * - System state updates
  * - Device binding detection
  * - Error handling
+ * - Write batching: one pending update, 429 backoff and republish, flush on cleanup
+ * - clientToken matching for documents too large to index
  */
 
 #include "unity.h"
 #include "dms_config.h" 
+#include "dms_shadow.h"
+#include "dms_json_writer.h"
+#include "dms_json_index.h"
 #include "mock_dms_log.h"
+#include "mock_dms_aws_iot.h"
+#include "mock_dms_command.h"
+#include "mock_dms_shadow_mirror.h"
+#include "mock_dms_sysstat.h"
+#include "mock_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 以假的 MQTT 介面與時鐘驅動 Shadow 模組，shadow_message_handler 經由註冊回調取得 */
+static mqtt_message_callback_t g_handler;
+static uint32_t g_now_ms;
+static bool g_connected;
+static int g_publish_count;
+static char g_last_payload[SHADOW_UPDATE_PAYLOAD_SIZE];
+
+static uint32_t fake_clock(int num_calls) {
+    (void)num_calls;
+    return g_now_ms;
+}
+
+static void capture_handler(mqtt_message_callback_t callback, int num_calls) {
+    (void)num_calls;
+    g_handler = callback;
+}
+
+static dms_result_t fake_publish(const char* topic, const char* payload, size_t len) {
+    (void)topic;
+    g_publish_count++;
+    snprintf(g_last_payload, sizeof(g_last_payload), "%.*s", (int)len, payload);
+    return DMS_SUCCESS;
+}
+
+static bool fake_is_connected(void) {
+    return g_connected;
+}
+
+static uint32_t last_token(void) {
+    const char* token = strstr(g_last_payload, SHADOW_CLIENT_TOKEN_PREFIX);
+    return (token != NULL) ? (uint32_t)strtoul(token + strlen(SHADOW_CLIENT_TOKEN_PREFIX), NULL, 10) : 0;
+}
+
+static void deliver(const char* topic, const char* format, int code, uint32_t token) {
+    char payload[128];
+    int length = snprintf(payload, sizeof(payload), format, code, token);
+    g_handler(topic, payload, (size_t)length);
+}
+
+static void reject_update(int code, uint32_t token) {
+    deliver(SHADOW_UPDATE_REJECTED_TOPIC,
+            "{\"code\":%d,\"message\":\"x\",\"clientToken\":\"" SHADOW_CLIENT_TOKEN_PREFIX "%u\"}",
+            code, token);
+}
+
+static void accept_update(uint32_t token) {
+    deliver(SHADOW_UPDATE_ACCEPTED_TOPIC,
+            "{\"state\":{},\"version\":%d,\"clientToken\":\"" SHADOW_CLIENT_TOKEN_PREFIX "%u\"}",
+            2, token);
+}
+
+/* 推進時鐘後處理一次合併寫入 */
+static void advance_and_process(uint32_t ms) {
+    g_now_ms += ms;
+    dms_shadow_process();
+}
 
 void setUp(void) {
     dms_config_init();
+
+    dms_log_printf_Ignore();
+    Clock_GetTimeMs_StubWithCallback(fake_clock);
+    dms_aws_iot_register_message_callback_StubWithCallback(capture_handler);
+    dms_command_register_shadow_interface_Ignore();
+    dms_command_process_shadow_delta_IgnoreAndReturn(DMS_SUCCESS);
+    dms_command_process_shadow_delta_index_IgnoreAndReturn(DMS_SUCCESS);
+    dms_shadow_mirror_init_IgnoreAndReturn(DMS_SUCCESS);
+    dms_shadow_mirror_watch_IgnoreAndReturn(DMS_SUCCESS);
+    dms_shadow_mirror_apply_IgnoreAndReturn(DMS_ERROR_INVALID_JSON);
+    dms_shadow_mirror_apply_index_IgnoreAndReturn(DMS_SUCCESS);
+    dms_shadow_mirror_cleanup_Ignore();
+    dms_sysstat_init_IgnoreAndReturn(DMS_SUCCESS);
+    dms_sysstat_cleanup_Ignore();
+
+    g_handler = NULL;
+    g_now_ms = 1000;
+    g_connected = true;
+    g_publish_count = 0;
+    g_last_payload[0] = '\0';
+
+    mqtt_interface_t mqtt_if = { 0 };
+    mqtt_if.publish = fake_publish;
+    mqtt_if.is_connected = fake_is_connected;
+    dms_shadow_init(&mqtt_if);
 }
 
 void tearDown(void) {
+    g_connected = false;
+    dms_shadow_cleanup();
     dms_config_cleanup();
 }
 
@@ -34,3 +131,105 @@ void test_shadow_timeout_should_be_configured(void) {
     TEST_ASSERT_NOT_NULL(reconnect_config);
     TEST_ASSERT_TRUE(reconnect_config->shadow_get_timeout_ms > 0);
 }
+
+void test_shadow_throttled_update_should_be_republished_after_backoff(void) {
+    /* Arrange */
+    TEST_ASSERT_NOT_NULL(g_handler);
+    dms_shadow_reset_desired("upload_logs");
+    dms_shadow_report_command_result("upload_logs", true);
+    advance_and_process(SHADOW_COALESCE_WINDOW_MS);
+    TEST_ASSERT_EQUAL(1, g_publish_count);
+    uint32_t token = last_token();
+
+    /* Act */
+    reject_update(SHADOW_REJECT_CODE_THROTTLED, token);
+    advance_and_process(SHADOW_THROTTLE_BACKOFF_BASE_MS / 2);
+    int during_backoff = g_publish_count;
+    advance_and_process(SHADOW_THROTTLE_BACKOFF_BASE_MS);
+
+    /* Assert */
+    shadow_write_stats_t stats;
+    dms_shadow_get_write_stats(&stats);
+    TEST_ASSERT_EQUAL(1, during_backoff);
+    TEST_ASSERT_EQUAL(2, g_publish_count);
+    TEST_ASSERT_NOT_EQUAL(token, last_token());
+    TEST_ASSERT_NOT_NULL(strstr(g_last_payload, "\"upload_logs\":null"));
+    TEST_ASSERT_NOT_NULL(strstr(g_last_payload, "upload_logs_result"));
+    TEST_ASSERT_EQUAL(1, stats.throttled_count);
+}
+
+void test_shadow_should_not_publish_while_update_is_pending(void) {
+    /* Arrange */
+    dms_shadow_report_command_result("upload_logs", true);
+    advance_and_process(SHADOW_COALESCE_WINDOW_MS);
+    uint32_t first_token = last_token();
+
+    /* Act - 等待 accepted 期間的寫入不發布，429 後先重送第一批 */
+    dms_shadow_report_command_result("fw_upgrade", true);
+    advance_and_process(SHADOW_COALESCE_WINDOW_MS);
+    int while_pending = g_publish_count;
+    reject_update(SHADOW_REJECT_CODE_THROTTLED, first_token);
+    advance_and_process(SHADOW_THROTTLE_BACKOFF_BASE_MS);
+    bool resent_first = (strstr(g_last_payload, "upload_logs_result") != NULL &&
+                         strstr(g_last_payload, "fw_upgrade_result") == NULL);
+    accept_update(last_token());
+    advance_and_process(SHADOW_UPDATE_MIN_INTERVAL_MS);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, while_pending);
+    TEST_ASSERT_TRUE(resent_first);
+    TEST_ASSERT_EQUAL(3, g_publish_count);
+    TEST_ASSERT_NOT_NULL(strstr(g_last_payload, "fw_upgrade_result"));
+}
+
+void test_shadow_client_error_rejection_should_drop_update(void) {
+    /* Arrange */
+    dms_shadow_report_command_result("upload_logs", true);
+    advance_and_process(SHADOW_COALESCE_WINDOW_MS);
+
+    /* Act */
+    reject_update(400, last_token());
+    advance_and_process(SHADOW_UPDATE_ACK_TIMEOUT_MS);
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(1, g_publish_count);
+}
+
+void test_shadow_cleanup_should_flush_while_throttled(void) {
+    /* Arrange */
+    dms_shadow_report_command_result("upload_logs", true);
+    advance_and_process(SHADOW_COALESCE_WINDOW_MS);
+    reject_update(SHADOW_REJECT_CODE_THROTTLED, last_token());
+    dms_shadow_report_command_result("fw_upgrade", false);
+
+    /* Act - 仍在節流退避中 */
+    dms_shadow_cleanup();
+
+    /* Assert */
+    TEST_ASSERT_EQUAL(3, g_publish_count);
+    TEST_ASSERT_NOT_NULL(strstr(g_last_payload, "fw_upgrade_result"));
+}
+
+void test_shadow_should_match_client_token_in_unindexable_document(void) {
+    /* Arrange - reported 陣列的 token 數超過 SHADOW_DOCUMENT_MAX_TOKENS */
+    static char payload[SHADOW_DOCUMENT_MAX_TOKENS * 4 + 128];
+    dms_shadow_report_command_result("upload_logs", true);
+    advance_and_process(SHADOW_COALESCE_WINDOW_MS);
+
+    size_t length = (size_t)snprintf(payload, sizeof(payload), "{\"state\":{\"reported\":{\"list\":[");
+    for (int i = 0; i < SHADOW_DOCUMENT_MAX_TOKENS; i++) {
+        length += (size_t)snprintf(payload + length, sizeof(payload) - length, "%s1", (i == 0) ? "" : ",");
+    }
+    length += (size_t)snprintf(payload + length, sizeof(payload) - length,
+                               "]}},\"version\":2,\"clientToken\" : \"" SHADOW_CLIENT_TOKEN_PREFIX "%u\"}",
+                               last_token());
+
+    /* Act */
+    g_handler(SHADOW_UPDATE_ACCEPTED_TOPIC, payload, length);
+    dms_shadow_report_command_result("fw_upgrade", true);
+    advance_and_process(SHADOW_UPDATE_MIN_INTERVAL_MS);
+
+    /* Assert - 已確認第一批，第二批不需等待逾時即發布 */
+    TEST_ASSERT_EQUAL(2, g_publish_count);
+    TEST_ASSERT_NOT_NULL(strstr(g_last_payload, "fw_upgrade_result"));
+}
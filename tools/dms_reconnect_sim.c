@@ -0,0 +1,402 @@
+/*
+ * DMS Reconnect Storm Simulator
+ *
+ * 離線模擬整批裝置在 broker 中斷後重連的到達分布，用於調整重連延遲參數。
+ * 每台裝置的延遲直接呼叫 src/dms_reconnect_jitter.c，種子由連續的 MAC 地址計算，與裝置上的行為一致。
+ *
+ * 模型：
+ * - 時間 0 時 broker 中斷，持續 --outage 秒；各裝置在 [0, --detect) 秒內的隨機時間發現斷線
+ * - 發現斷線後立即嘗試一次（對應 dms_reconnect_attempt() 第一次不等待）
+ * - 失敗後等待 jitter 延遲再試；--extra 可加上每次失敗後的固定等待（重連計時器之前的版本為 sleep(5)）
+ * - broker 恢復後每秒最多接受 --capacity 個連線（0 表示不限），超過的視為失敗
+ *
+ * 輸出每秒的連線嘗試數與成功數（沒有嘗試的秒數省略），以及尖峰與完成時間摘要。
+ *
+ * 編譯（主機端，不需要 AWS IoT SDK）：
+ *   gcc -std=c99 -O2 -Isrc -o dms-reconnect-sim tools/dms_reconnect_sim.c src/dms_reconnect_jitter.c
+ *
+ * 範例：
+ *   ./dms-reconnect-sim --devices 100000 --outage 600 --capacity 2000
+ *   ./dms-reconnect-sim --strategy exponential --csv > exponential.csv
+ */
+
+#include "dms_reconnect_jitter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*-----------------------------------------------------------*/
+/* 常數定義 */
+
+#define SIM_MAC_BASE                   ( 0x001A2B000000ULL )
+#define SIM_DEFAULT_DEVICES            ( 100000U )
+#define SIM_DEFAULT_OUTAGE_S           ( 600U )
+#define SIM_DEFAULT_DETECT_S           ( 60U )     /* MQTT_KEEP_ALIVE_INTERVAL_SECONDS */
+#define SIM_DEFAULT_EXTRA_S            ( 0U )
+#define SIM_DEFAULT_BASE_S             ( 2U )      /* dms_config 預設 base_delay_seconds */
+#define SIM_DEFAULT_CAP_S              ( 300U )    /* dms_config 預設 max_delay_seconds */
+#define SIM_DEFAULT_SEED               ( 1U )
+#define SIM_BAR_WIDTH                  ( 50U )
+
+/*-----------------------------------------------------------*/
+/* 類型定義 */
+
+typedef enum {
+    SIM_STRATEGY_DECORRELATED = 0,      // dms_reconnect_jitter（裝置上使用的算法）
+    SIM_STRATEGY_EXPONENTIAL            // base * 2^n，不加 jitter，作為對照
+} sim_strategy_t;
+
+typedef struct {
+    uint32_t devices;
+    uint32_t outage_s;
+    uint32_t detect_s;
+    uint32_t extra_s;
+    uint32_t capacity;
+    uint32_t base_s;
+    uint32_t cap_s;
+    uint32_t seed;
+    sim_strategy_t strategy;
+    bool csv;
+} sim_options_t;
+
+typedef struct {
+    dms_reconnect_jitter_t jitter;
+    uint32_t failures;
+} sim_device_t;
+
+/* 下一次嘗試的事件，以 (時間, 裝置) 排序的最小堆 */
+typedef struct {
+    uint64_t time_ms;
+    uint32_t device;
+} sim_event_t;
+
+typedef struct {
+    uint32_t attempts;
+    uint32_t connected;
+} sim_second_t;
+
+/*-----------------------------------------------------------*/
+/* 內部函數宣告 */
+
+static bool parse_options(int argc, char** argv, sim_options_t* options);
+static void print_usage(const char* program);
+static uint32_t next_delay_ms(const sim_options_t* options, sim_device_t* device);
+static uint64_t splitmix64(uint64_t* state);
+static void heap_push(sim_event_t* heap, uint32_t* size, sim_event_t event);
+static sim_event_t heap_pop(sim_event_t* heap, uint32_t* size);
+static bool event_before(const sim_event_t* a, const sim_event_t* b);
+
+/*-----------------------------------------------------------*/
+/* 主程式 */
+
+int main(int argc, char** argv)
+{
+    sim_options_t options;
+    if (!parse_options(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    sim_device_t* devices = calloc(options.devices, sizeof(*devices));
+    sim_event_t* heap = calloc(options.devices, sizeof(*heap));
+    uint32_t* connect_s = calloc(options.devices, sizeof(*connect_s));
+    if (devices == NULL || heap == NULL || connect_s == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    /* 裝置種子與發現斷線的時間 */
+    uint64_t detect_rng = options.seed;
+    uint32_t heap_size = 0;
+    for (uint32_t i = 0; i < options.devices; i++) {
+        char mac[16];
+        snprintf(mac, sizeof(mac), "%012llX", (unsigned long long)(SIM_MAC_BASE + i));
+        dms_reconnect_jitter_init(&devices[i].jitter, dms_reconnect_jitter_seed(mac),
+                                  options.base_s * 1000U, options.cap_s * 1000U);
+
+        sim_event_t event = {
+            .time_ms = options.detect_s > 0 ? splitmix64(&detect_rng) % (options.detect_s * 1000ULL) : 0,
+            .device = i
+        };
+        heap_push(heap, &heap_size, event);
+    }
+
+    /* 事件依時間處理，直到所有裝置都連上 */
+    size_t seconds_len = 0;
+    sim_second_t* seconds = NULL;
+    uint64_t outage_end_ms = options.outage_s * 1000ULL;
+    uint64_t total_attempts = 0;
+    uint32_t accept_second = UINT32_MAX;
+    uint32_t accepted_this_second = 0;
+    uint32_t connected = 0;
+
+    while (heap_size > 0) {
+        sim_event_t event = heap_pop(heap, &heap_size);
+        uint32_t second = (uint32_t)(event.time_ms / 1000U);
+
+        if (second >= seconds_len) {
+            size_t new_len = seconds_len > 0 ? seconds_len : 1024;
+            while (new_len <= second) {
+                new_len *= 2;
+            }
+            sim_second_t* grown = realloc(seconds, new_len * sizeof(*seconds));
+            if (grown == NULL) {
+                fprintf(stderr, "out of memory\n");
+                return EXIT_FAILURE;
+            }
+            memset(&grown[seconds_len], 0, (new_len - seconds_len) * sizeof(*seconds));
+            seconds = grown;
+            seconds_len = new_len;
+        }
+
+        seconds[second].attempts++;
+        total_attempts++;
+
+        if (second != accept_second) {
+            accept_second = second;
+            accepted_this_second = 0;
+        }
+
+        bool accepted = event.time_ms >= outage_end_ms &&
+                        (options.capacity == 0 || accepted_this_second < options.capacity);
+        if (accepted) {
+            accepted_this_second++;
+            seconds[second].connected++;
+            connect_s[connected++] = second;
+            continue;
+        }
+
+        sim_device_t* device = &devices[event.device];
+        device->failures++;
+        event.time_ms += next_delay_ms(&options, device) + options.extra_s * 1000ULL;
+        heap_push(heap, &heap_size, event);
+    }
+
+    /* 每秒分布 */
+    uint32_t last_second = connect_s[connected - 1];
+    uint32_t peak_attempts = 0;
+    uint32_t peak_attempts_at = 0;
+    uint32_t peak_connected = 0;
+    uint32_t peak_connected_at = 0;
+    for (uint32_t s = 0; s <= last_second; s++) {
+        if (seconds[s].attempts > peak_attempts) {
+            peak_attempts = seconds[s].attempts;
+            peak_attempts_at = s;
+        }
+        if (seconds[s].connected > peak_connected) {
+            peak_connected = seconds[s].connected;
+            peak_connected_at = s;
+        }
+    }
+
+    printf("%s devices=%u outage=%us detect=%us extra=%us capacity=%u/s base=%us cap=%us strategy=%s\n",
+           options.csv ? "#" : "# dms-reconnect-sim:",
+           options.devices, options.outage_s, options.detect_s, options.extra_s, options.capacity,
+           options.base_s, options.cap_s,
+           options.strategy == SIM_STRATEGY_DECORRELATED ? "decorrelated" : "exponential");
+    printf(options.csv ? "second,attempts,connected\n" : "# second  attempts  connected\n");
+
+    for (uint32_t s = 0; s <= last_second; s++) {
+        if (seconds[s].attempts == 0) {
+            continue;
+        }
+        if (options.csv) {
+            printf("%u,%u,%u\n", s, seconds[s].attempts, seconds[s].connected);
+        } else {
+            uint32_t bar = (uint32_t)((uint64_t)seconds[s].attempts * SIM_BAR_WIDTH / peak_attempts);
+            printf("%8u %9u %10u  %.*s\n", s, seconds[s].attempts, seconds[s].connected,
+                   (int)(bar > 0 ? bar : 1),
+                   "##################################################");
+        }
+    }
+
+    /* 摘要：connect_s 依事件順序寫入，已經排序；完成時間以 broker 恢復的時間為 0 */
+    uint32_t p50 = connect_s[(connected - 1) / 2] - options.outage_s;
+    uint32_t p99 = connect_s[(uint32_t)(((uint64_t)connected - 1) * 99 / 100)] - options.outage_s;
+
+    printf("# peak attempts/s: %u at %us\n", peak_attempts, peak_attempts_at);
+    printf("# peak connects/s: %u at %us\n", peak_connected, peak_connected_at);
+    printf("# connected after recovery: p50 %us, p99 %us, all %us\n",
+           p50, p99, last_second - options.outage_s);
+    printf("# attempts: %llu total, %.2f per device\n",
+           (unsigned long long)total_attempts, (double)total_attempts / options.devices);
+
+    free(seconds);
+    free(connect_s);
+    free(heap);
+    free(devices);
+    return EXIT_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+/* 內部函數實作 */
+
+/**
+ * @brief 解析命令列參數
+ */
+static bool parse_options(int argc, char** argv, sim_options_t* options)
+{
+    *options = (sim_options_t){
+        .devices = SIM_DEFAULT_DEVICES,
+        .outage_s = SIM_DEFAULT_OUTAGE_S,
+        .detect_s = SIM_DEFAULT_DETECT_S,
+        .extra_s = SIM_DEFAULT_EXTRA_S,
+        .capacity = 0,
+        .base_s = SIM_DEFAULT_BASE_S,
+        .cap_s = SIM_DEFAULT_CAP_S,
+        .seed = SIM_DEFAULT_SEED,
+        .strategy = SIM_STRATEGY_DECORRELATED,
+        .csv = false
+    };
+
+    static const struct {
+        const char* name;
+        size_t offset;
+    } numeric[] = {
+        { "--devices",  offsetof(sim_options_t, devices) },
+        { "--outage",   offsetof(sim_options_t, outage_s) },
+        { "--detect",   offsetof(sim_options_t, detect_s) },
+        { "--extra",    offsetof(sim_options_t, extra_s) },
+        { "--capacity", offsetof(sim_options_t, capacity) },
+        { "--base",     offsetof(sim_options_t, base_s) },
+        { "--cap",      offsetof(sim_options_t, cap_s) },
+        { "--seed",     offsetof(sim_options_t, seed) }
+    };
+
+    for (int i = 1; i < argc; i++) {
+        bool matched = false;
+
+        for (size_t n = 0; n < sizeof(numeric) / sizeof(numeric[0]); n++) {
+            if (strcmp(argv[i], numeric[n].name) == 0 && i + 1 < argc) {
+                char* end = NULL;
+                unsigned long value = strtoul(argv[++i], &end, 10);
+                if (end == argv[i] || *end != '\0' || value > UINT32_MAX / 1000U) {
+                    fprintf(stderr, "invalid value for %s: %s\n", numeric[n].name, argv[i]);
+                    return false;
+                }
+                *(uint32_t*)((char*)options + numeric[n].offset) = (uint32_t)value;
+                matched = true;
+                break;
+            }
+        }
+
+        if (matched) {
+            continue;
+        } else if (strcmp(argv[i], "--strategy") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "decorrelated") == 0) {
+                options->strategy = SIM_STRATEGY_DECORRELATED;
+            } else if (strcmp(argv[i], "exponential") == 0) {
+                options->strategy = SIM_STRATEGY_EXPONENTIAL;
+            } else {
+                fprintf(stderr, "unknown strategy: %s\n", argv[i]);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            options->csv = true;
+        } else {
+            return false;
+        }
+    }
+
+    if (options->devices == 0 || options->base_s == 0) {
+        fprintf(stderr, "--devices and --base must be greater than 0\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 顯示使用說明
+ */
+static void print_usage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --devices N       fleet size (default %u)\n"
+            "  --outage S        broker outage in seconds (default %u)\n"
+            "  --detect S        spread of disconnect detection in seconds (default %u)\n"
+            "  --extra S         fixed extra wait after each failure (default %u)\n"
+            "  --capacity N      connections accepted per second, 0 = unlimited (default 0)\n"
+            "  --base S          reconnect base delay (default %u)\n"
+            "  --cap S           reconnect max delay (default %u)\n"
+            "  --seed N          seed for detection times (default %u)\n"
+            "  --strategy NAME   decorrelated | exponential (default decorrelated)\n"
+            "  --csv             print second,attempts,connected rows\n",
+            program, SIM_DEFAULT_DEVICES, SIM_DEFAULT_OUTAGE_S, SIM_DEFAULT_DETECT_S,
+            SIM_DEFAULT_EXTRA_S, SIM_DEFAULT_BASE_S, SIM_DEFAULT_CAP_S, SIM_DEFAULT_SEED);
+}
+
+/**
+ * @brief 依策略產生裝置的下一次延遲
+ */
+static uint32_t next_delay_ms(const sim_options_t* options, sim_device_t* device)
+{
+    if (options->strategy == SIM_STRATEGY_DECORRELATED) {
+        return dms_reconnect_jitter_next(&device->jitter);
+    }
+
+    uint64_t delay = (uint64_t)options->base_s * 1000U << (device->failures < 32 ? device->failures - 1 : 31);
+    uint64_t cap = (uint64_t)options->cap_s * 1000U;
+    return (uint32_t)(delay < cap ? delay : cap);
+}
+
+/**
+ * @brief splitmix64，只用於產生發現斷線的時間
+ */
+static uint64_t splitmix64(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static bool event_before(const sim_event_t* a, const sim_event_t* b)
+{
+    return a->time_ms < b->time_ms || (a->time_ms == b->time_ms && a->device < b->device);
+}
+
+static void heap_push(sim_event_t* heap, uint32_t* size, sim_event_t event)
+{
+    uint32_t i = (*size)++;
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!event_before(&event, &heap[parent])) {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = event;
+}
+
+static sim_event_t heap_pop(sim_event_t* heap, uint32_t* size)
+{
+    sim_event_t top = heap[0];
+    sim_event_t last = heap[--(*size)];
+    uint32_t i = 0;
+
+    for (;;) {
+        uint32_t child = i * 2 + 1;
+        if (child >= *size) {
+            break;
+        }
+        if (child + 1 < *size && event_before(&heap[child + 1], &heap[child])) {
+            child++;
+        }
+        if (!event_before(&heap[child], &last)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (*size > 0) {
+        heap[i] = last;
+    }
+    return top;
+}